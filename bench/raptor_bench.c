@@ -0,0 +1,643 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * raptor_bench.c - Raptor parser and serializer throughput benchmark
+ *
+ * Copyright (C) 2026, agent agent@local
+ *
+ * This package is Free Software and part of Redland http://librdf.org/
+ *
+ * It is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ *
+ * Generates synthetic graphs, serializes them with every serializer
+ * and parses each result with the parser of the same name.  The guess
+ * parser is given the N-Triples output.  Parsers with no matching
+ * serializer such as rdfa and grddl are not run.  One line of tab
+ * separated values is written to stdout per run:
+ *
+ *   shape operation name triples bytes seconds triples/sec bytes/sec
+ *   peak-RSS-KB mallocs errors
+ *
+ * Each run is made in a child process where fork() is available so
+ * peak-RSS-KB is the peak resident set size of that run, including
+ * the graph and parser input it was given.  Otherwise it is the peak
+ * of the whole process so far.
+ * mallocs is the number of malloc(), calloc() and realloc() calls
+ * during the run or -1 if they cannot be counted.
+ *
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <raptor_config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#include <time.h>
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_SYS_WAIT_H
+#include <sys/wait.h>
+#endif
+
+/* Raptor includes */
+#include <raptor2.h>
+
+
+/* Count allocations by replacing the glibc allocator entry points.
+ * Not done under a sanitizer which replaces them itself.
+ */
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define BENCH_COUNT_MALLOCS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static unsigned long malloc_count = 0;
+
+#if defined(__GNUC__)
+#define BENCH_COUNT_MALLOC() __atomic_fetch_add(&malloc_count, 1, __ATOMIC_RELAXED)
+#else
+#define BENCH_COUNT_MALLOC() malloc_count++
+#endif
+
+void*
+malloc(size_t size)
+{
+  BENCH_COUNT_MALLOC();
+  return __libc_malloc(size);
+}
+
+void*
+calloc(size_t nmemb, size_t size)
+{
+  BENCH_COUNT_MALLOC();
+  return __libc_calloc(nmemb, size);
+}
+
+void*
+realloc(void *ptr, size_t size)
+{
+  BENCH_COUNT_MALLOC();
+  return __libc_realloc(ptr, size);
+}
+
+void
+free(void *ptr)
+{
+  __libc_free(ptr);
+}
+#endif
+
+
+#if defined(HAVE_FORK) && defined(HAVE_UNISTD_H) && defined(HAVE_SYS_WAIT_H)
+#define BENCH_FORK_RUNS 1
+#endif
+
+
+#define DEFAULT_TRIPLES_COUNT 20000
+#define DEFAULT_DEPTH 16
+#define DEFAULT_SHAPES "iri,literal,bnode,nested"
+
+#define BASE_URI "http://example.org/bench/"
+
+typedef enum {
+  SHAPE_IRI,
+  SHAPE_LITERAL,
+  SHAPE_BNODE,
+  SHAPE_NESTED
+} bench_shape;
+
+static const char* const shape_names[] = {
+  "iri", "literal", "bnode", "nested", NULL
+};
+
+typedef struct {
+  const char* shape;
+  const char* operation;
+  const char* name;
+  int errors;
+  int triples;
+  size_t bytes;
+  /* values at the start of the run */
+  double start_time;
+  unsigned long start_mallocs;
+} bench_run;
+
+int main(int argc, char *argv[]);
+
+static const char *program = "raptor_bench";
+static int depth = DEFAULT_DEPTH;
+
+
+static double
+bench_now(void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+
+/* Return value: peak RSS in kilobytes or -1 if not known */
+static long
+bench_peak_rss(void)
+{
+#ifdef HAVE_SYS_RESOURCE_H
+  struct rusage usage;
+
+  if(!getrusage(RUSAGE_SELF, &usage))
+    return (long)usage.ru_maxrss;
+#endif
+
+  return -1;
+}
+
+
+/*
+ * bench_fork:
+ * @child_p: pointer to store non-0 if this is a new child process
+ *
+ * Start a child process for one or more runs so that their peak RSS
+ * does not include that of earlier runs.  If the child cannot be
+ * started, the runs are made in this process.
+ *
+ * Return value: non-0 if the caller should make the runs
+ */
+static int
+bench_fork(int *child_p)
+{
+#ifdef BENCH_FORK_RUNS
+  pid_t pid;
+
+  fflush(stdout);
+  pid = fork();
+  if(pid > 0) {
+    int status;
+
+    /* the child made the runs */
+    waitpid(pid, &status, 0);
+    *child_p = 0;
+    return 0;
+  }
+
+  *child_p = !pid;
+#else
+  *child_p = 0;
+#endif
+
+  return 1;
+}
+
+
+/* end a child process started by bench_fork() */
+static void
+bench_fork_end(int child)
+{
+#ifdef BENCH_FORK_RUNS
+  if(child) {
+    fflush(stdout);
+    _exit(0);
+  }
+#endif
+}
+
+
+static void
+bench_start(bench_run *run, const char *shape, const char *operation,
+            const char *name)
+{
+  run->shape = shape;
+  run->operation = operation;
+  run->name = name;
+  run->errors = 0;
+  run->triples = 0;
+  run->bytes = 0;
+
+#ifdef BENCH_COUNT_MALLOCS
+  run->start_mallocs = malloc_count;
+#endif
+  run->start_time = bench_now();
+}
+
+
+static void
+bench_end(bench_run *run)
+{
+  double seconds = bench_now() - run->start_time;
+  long mallocs = -1;
+
+#ifdef BENCH_COUNT_MALLOCS
+  mallocs = (long)(malloc_count - run->start_mallocs);
+#endif
+
+  if(seconds <= 0.0)
+    seconds = 1e-9;
+
+  printf("%s\t%s\t%s\t%d\t%lu\t%.6f\t%.0f\t%.0f\t%ld\t%ld\t%d\n",
+         run->shape, run->operation, run->name,
+         run->triples, (unsigned long)run->bytes, seconds,
+         (double)run->triples / seconds, (double)run->bytes / seconds,
+         bench_peak_rss(), mallocs, run->errors);
+  fflush(stdout);
+}
+
+
+static void
+bench_log_handler(void *user_data, raptor_log_message *message)
+{
+  bench_run *run = (bench_run*)user_data;
+
+  if(message->level >= RAPTOR_LOG_LEVEL_ERROR)
+    run->errors++;
+}
+
+
+static raptor_term*
+bench_new_uri_term(raptor_world *world, const char *kind, int i)
+{
+  char buffer[64];
+
+  sprintf(buffer, BASE_URI "%s/%d", kind, i);
+  return raptor_new_term_from_uri_string(world, (const unsigned char*)buffer);
+}
+
+
+/* predicate URIs end in a letter so that RDF/XML can write them */
+static raptor_term*
+bench_new_predicate_term(raptor_world *world, int i)
+{
+  char buffer[64];
+
+  sprintf(buffer, BASE_URI "p/prop%c", 'a' + i);
+  return raptor_new_term_from_uri_string(world, (const unsigned char*)buffer);
+}
+
+
+static raptor_term*
+bench_new_blank_term(raptor_world *world, int i)
+{
+  char buffer[32];
+
+  sprintf(buffer, "b%d", i);
+  return raptor_new_term_from_blank(world, (const unsigned char*)buffer);
+}
+
+
+static raptor_term*
+bench_new_literal_term(raptor_world *world, int i)
+{
+  static const char words[] = "lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod tempor incididunt ut labore et dolore magna aliqua";
+  char buffer[sizeof(words) + 32];
+  /* 16 to all of the words */
+  size_t len = 16 + (size_t)i % (sizeof(words) - 16);
+  int offset;
+  raptor_term *term;
+  raptor_uri *datatype;
+
+  offset = sprintf(buffer, "%d ", i);
+  memcpy(buffer + offset, words, len);
+  buffer[offset + (int)len] = '\0';
+
+  switch(i % 3) {
+    case 0:
+      return raptor_new_term_from_literal(world, (const unsigned char*)buffer,
+                                          NULL, NULL);
+
+    case 1:
+      return raptor_new_term_from_literal(world, (const unsigned char*)buffer,
+                                          NULL, (const unsigned char*)"en");
+
+    default:
+      sprintf(buffer, "%d", i);
+      datatype = raptor_new_uri(world, (const unsigned char*)"http://www.w3.org/2001/XMLSchema#integer");
+      term = raptor_new_term_from_literal(world, (const unsigned char*)buffer,
+                                          datatype, NULL);
+      raptor_free_uri(datatype);
+      return term;
+  }
+}
+
+
+/*
+ * bench_new_statement:
+ *
+ * Make statement @i of a graph with the given shape:
+ *   iri     - URI subjects, predicates and objects
+ *   literal - URI subjects and plain, language and typed literal objects
+ *   bnode   - blank node subjects and objects
+ *   nested  - chains of blank nodes @depth long from a URI subject
+ *             which nest deeply in abbreviated syntaxes
+ */
+static raptor_statement*
+bench_new_statement(raptor_world *world, bench_shape shape, int i)
+{
+  raptor_term *s, *p, *o;
+
+  p = bench_new_predicate_term(world, i % 20);
+
+  switch(shape) {
+    case SHAPE_IRI:
+      s = bench_new_uri_term(world, "s", i / 10);
+      o = bench_new_uri_term(world, "o", (i * 7) % 100000);
+      break;
+
+    case SHAPE_LITERAL:
+      s = bench_new_uri_term(world, "s", i / 10);
+      o = bench_new_literal_term(world, i);
+      break;
+
+    case SHAPE_BNODE:
+      s = bench_new_blank_term(world, i / 10);
+      o = (i % 2) ? bench_new_blank_term(world, (i * 7) % 100000) :
+                    bench_new_literal_term(world, i);
+      break;
+
+    case SHAPE_NESTED:
+    default:
+      if(!(i % depth))
+        s = bench_new_uri_term(world, "s", i / depth);
+      else
+        s = bench_new_blank_term(world, i - 1);
+
+      if(i % depth == depth - 1)
+        o = bench_new_literal_term(world, i);
+      else
+        o = bench_new_blank_term(world, i);
+      break;
+  }
+
+  return raptor_new_statement_from_nodes(world, s, p, o, NULL);
+}
+
+
+static void
+bench_count_statement(void *user_data, raptor_statement *statement)
+{
+  bench_run *run = (bench_run*)user_data;
+
+  run->triples++;
+}
+
+
+/* Return value: serialized graph or NULL on failure */
+static unsigned char*
+bench_serialize(raptor_world *world, const char *shape, const char *name,
+                raptor_statement **statements, int count, int report,
+                size_t *length_p)
+{
+  raptor_serializer *serializer;
+  raptor_uri *base_uri;
+  void *string = NULL;
+  size_t length = 0;
+  bench_run run;
+  int i;
+
+  serializer = raptor_new_serializer(world, name);
+  if(!serializer)
+    return NULL;
+
+  base_uri = raptor_new_uri(world, (const unsigned char*)BASE_URI);
+  raptor_world_set_log_handler(world, &run, bench_log_handler);
+
+  bench_start(&run, shape, "serialize", name);
+  raptor_serializer_start_to_string(serializer, base_uri, &string, &length);
+  for(i = 0; i < count; i++) {
+    raptor_serializer_serialize_statement(serializer, statements[i]);
+    run.triples++;
+  }
+  raptor_serializer_serialize_end(serializer);
+  raptor_free_serializer(serializer);
+  run.bytes = length;
+  if(report)
+    bench_end(&run);
+
+  raptor_free_uri(base_uri);
+
+  *length_p = length;
+  return (unsigned char*)string;
+}
+
+
+static void
+bench_parse(raptor_world *world, const char *shape, const char *name,
+            const unsigned char *string, size_t length)
+{
+  raptor_parser *parser;
+  raptor_uri *base_uri;
+  bench_run run;
+
+  parser = raptor_new_parser(world, name);
+  if(!parser)
+    return;
+
+  base_uri = raptor_new_uri(world, (const unsigned char*)BASE_URI);
+  raptor_world_set_log_handler(world, &run, bench_log_handler);
+  raptor_parser_set_statement_handler(parser, &run, bench_count_statement);
+
+  bench_start(&run, shape, "parse", name);
+  if(raptor_parser_parse_start(parser, base_uri) ||
+     raptor_parser_parse_chunk(parser, string, length, 1))
+    run.errors++;
+  run.bytes = length;
+  bench_end(&run);
+
+  raptor_free_parser(parser);
+  raptor_free_uri(base_uri);
+}
+
+
+/* Return value: non-0 if @name is in comma separated @list or @list is NULL */
+static int
+bench_name_in_list(const char *list, const char *name)
+{
+  size_t len = strlen(name);
+
+  if(!list)
+    return 1;
+
+  while(*list) {
+    const char *end = strchr(list, ',');
+    size_t item_len = end ? (size_t)(end - list) : strlen(list);
+
+    if(item_len == len && !strncmp(list, name, len))
+      return 1;
+
+    if(!end)
+      break;
+    list = end + 1;
+  }
+
+  return 0;
+}
+
+
+static void
+bench_usage(FILE *fh)
+{
+  fprintf(fh,
+          "Usage: %s [OPTIONS]\n"
+          "Measure the throughput of Raptor parsers and serializers.\n"
+          "\nOPTIONS:\n"
+          "  -n COUNT       Triples in each graph (default %d)\n"
+          "  -d DEPTH       Blank node chain depth of nested graphs (default %d)\n"
+          "  -g SHAPES      Comma separated graph shapes (default %s)\n"
+          "  -p PARSERS     Comma separated parser names (default all)\n"
+          "  -s SERIALIZERS Comma separated serializer names (default all)\n"
+          "  -h             Print this help, then exit\n",
+          program, DEFAULT_TRIPLES_COUNT, DEFAULT_DEPTH, DEFAULT_SHAPES);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  raptor_world *world;
+  int count = DEFAULT_TRIPLES_COUNT;
+  const char *shapes = DEFAULT_SHAPES;
+  const char *parsers = NULL;
+  const char *serializers = NULL;
+  raptor_statement **statements;
+  int shape;
+  int i;
+
+  for(i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+
+    if(!strcmp(arg, "-h")) {
+      bench_usage(stdout);
+      return 0;
+    }
+
+    if(arg[0] != '-' || !arg[1] || arg[2] || i + 1 == argc) {
+      bench_usage(stderr);
+      return 1;
+    }
+
+    switch(arg[1]) {
+      case 'n':
+        count = atoi(argv[++i]);
+        break;
+
+      case 'd':
+        depth = atoi(argv[++i]);
+        break;
+
+      case 'g':
+        shapes = argv[++i];
+        break;
+
+      case 'p':
+        parsers = argv[++i];
+        break;
+
+      case 's':
+        serializers = argv[++i];
+        break;
+
+      default:
+        bench_usage(stderr);
+        return 1;
+    }
+  }
+
+  if(count < 1 || depth < 1) {
+    fprintf(stderr, "%s: count and depth must be at least 1\n", program);
+    return 1;
+  }
+
+  world = raptor_new_world();
+  if(!world || raptor_world_open(world))
+    return 1;
+
+  statements = (raptor_statement**)calloc((size_t)count, sizeof(*statements));
+  if(!statements)
+    return 1;
+
+  printf("#shape\toperation\tname\ttriples\tbytes\tseconds\ttriples_per_sec\tbytes_per_sec\tpeak_rss_kb\tmallocs\terrors\n");
+
+  for(shape = 0; shape_names[shape]; shape++) {
+    const char *shape_name = shape_names[shape];
+    const raptor_syntax_description *desc;
+
+    if(!bench_name_in_list(shapes, shape_name))
+      continue;
+
+    for(i = 0; i < count; i++)
+      statements[i] = bench_new_statement(world, (bench_shape)shape, i);
+
+    for(i = 0; (desc = raptor_world_get_serializer_description(world, (unsigned int)i)); i++) {
+      const char *name = desc->names[0];
+      unsigned char *string;
+      size_t length = 0;
+      int run_serializer = bench_name_in_list(serializers, name);
+      int run_parser = bench_name_in_list(parsers, name) &&
+                       raptor_world_is_parser_name(world, name);
+      int run_guess = !strcmp(name, "ntriples") &&
+                      bench_name_in_list(parsers, "guess") &&
+                      raptor_world_is_parser_name(world, "guess");
+      int child;
+      int parse_child;
+
+      if(!run_serializer && !run_parser && !run_guess)
+        continue;
+
+      if(!bench_fork(&child))
+        continue;
+
+      /* the parser input is always made with the serializer */
+      string = bench_serialize(world, shape_name, name, statements, count,
+                               run_serializer, &length);
+      if(string) {
+        if(run_parser && bench_fork(&parse_child)) {
+          bench_parse(world, shape_name, name, string, length);
+          bench_fork_end(parse_child);
+        }
+        if(run_guess && bench_fork(&parse_child)) {
+          bench_parse(world, shape_name, "guess", string, length);
+          bench_fork_end(parse_child);
+        }
+
+        raptor_free_memory(string);
+      }
+
+      bench_fork_end(child);
+    }
+
+    for(i = 0; i < count; i++)
+      raptor_free_statement(statements[i]);
+  }
+
+  free(statements);
+  raptor_free_world(world);
+
+  return 0;
+}
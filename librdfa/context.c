@@ -87,10 +87,12 @@ void rdfa_init_context(rdfacontext* context)
    /* the [parent object] is set to null; */
    context->parent_object = NULL;
 
+   /* mappings already shared from a parent context are kept */
 #ifdef LIBRDFA_IN_RAPTOR
 #else
    /* the [list of URI mappings] is cleared; */
-   context->uri_mappings = rdfa_create_mapping(MAX_URI_MAPPINGS);
+   if(context->uri_mappings == NULL)
+      context->uri_mappings = rdfa_create_mapping(MAX_URI_MAPPINGS);
 #endif
 
    /* the [list of incomplete triples] is cleared; */
@@ -104,14 +106,17 @@ void rdfa_init_context(rdfacontext* context)
 
    /* the list of term mappings is set to null
     * (or a list defined in the initial context of the Host Language). */
-   context->term_mappings = rdfa_create_mapping(MAX_TERM_MAPPINGS);
+   if(context->term_mappings == NULL)
+      context->term_mappings = rdfa_create_mapping(MAX_TERM_MAPPINGS);
 
    /* the maximum number of list mappings */
-   context->list_mappings = rdfa_create_mapping(MAX_LIST_MAPPINGS);
+   if(context->list_mappings == NULL)
+      context->list_mappings = rdfa_create_mapping(MAX_LIST_MAPPINGS);
 
    /* the maximum number of local list mappings */
-   context->local_list_mappings =
-      rdfa_create_mapping(MAX_LOCAL_LIST_MAPPINGS);
+   if(context->local_list_mappings == NULL)
+      context->local_list_mappings =
+         rdfa_create_mapping(MAX_LOCAL_LIST_MAPPINGS);
 
    /* the default vocabulary is set to null
     * (or a IRI defined in the initial context of the Host Language). */
@@ -174,7 +179,7 @@ void rdfa_setup_initial_context(rdfacontext* context)
 #else
    char* key = NULL;
    void* value = NULL;
-   void** mptr = context->uri_mappings;
+   void** mptr = rdfa_get_mapping_items(context->uri_mappings);
 #endif
 
    /* Setup the base RDFa 1.1 prefix and term mappings */
@@ -375,37 +380,32 @@ rdfacontext* rdfa_create_new_element_context(rdfalist* context_stack)
    /* * the [ base ] is set to the [ base ] value of the current
     *   [ evaluation context ]; */
    rval->base = rdfa_replace_string(rval->base, parent_context->base);
-   rdfa_init_context(rval);
-
-   /* Set the processing depth as parent + 1 */
-   rval->depth = parent_context->depth + 1;
 
-   /* copy the URI mappings */
-#ifdef LIBRDFA_IN_RAPTOR
-   /* Raptor does this automatically for URIs */
-#else
-   rdfa_free_mapping(rval->uri_mappings, (free_mapping_value_fp)free);
-#endif
-   rdfa_free_mapping(rval->term_mappings, (free_mapping_value_fp)free);
-   rdfa_free_mapping(rval->list_mappings, (free_mapping_value_fp)rdfa_free_list);
-   rdfa_free_mapping(rval->local_list_mappings, (free_mapping_value_fp)rdfa_free_list);
+   /* copy the URI mappings before rdfa_init_context() would create
+    * empty ones; the copies share the parent's mappings until they
+    * are modified */
 #ifdef LIBRDFA_IN_RAPTOR
    /* Raptor does this automatically for URIs */
 #else
    rval->uri_mappings =
-      rdfa_copy_mapping((void**)parent_context->uri_mappings,
+      rdfa_copy_mapping(parent_context->uri_mappings,
          (copy_mapping_value_fp)rdfa_replace_string);
 #endif
    rval->term_mappings =
-      rdfa_copy_mapping((void**)parent_context->term_mappings,
+      rdfa_copy_mapping(parent_context->term_mappings,
          (copy_mapping_value_fp)rdfa_replace_string);
    rval->list_mappings =
-      rdfa_copy_mapping((void**)parent_context->local_list_mappings,
+      rdfa_copy_mapping(parent_context->local_list_mappings,
          (copy_mapping_value_fp)rdfa_replace_list);
    rval->local_list_mappings =
-      rdfa_copy_mapping((void**)parent_context->local_list_mappings,
+      rdfa_copy_mapping(parent_context->local_list_mappings,
          (copy_mapping_value_fp)rdfa_replace_list);
 
+   rdfa_init_context(rval);
+
+   /* Set the processing depth as parent + 1 */
+   rval->depth = parent_context->depth + 1;
+
    /* inherit the parent context's host language and RDFa processor mode */
    rval->host_language = parent_context->host_language;
    rval->rdfa_version = parent_context->rdfa_version;
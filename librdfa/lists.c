@@ -90,6 +90,30 @@ void rdfa_save_incomplete_list_triples(
 #endif
 }
 
+/* Check if rdfa_complete_list_triples() will complete any list */
+static int rdfa_has_list_triples_to_complete(rdfacontext* context)
+{
+   void** mptr = rdfa_get_mapping_items(context->local_list_mappings);
+   char* key = NULL;
+   void* value = NULL;
+
+   while(*mptr != NULL)
+   {
+      rdfa_next_mapping(mptr++, &key, &value);
+      mptr++;
+
+      if((context->depth < (int)((rdfalist*)value)->user_data) &&
+         (rdfa_get_list_mapping(
+            context->list_mappings, context->new_subject, key) == NULL) &&
+         (strcmp(key, RDFA_MAPPING_DELETED_KEY) != 0))
+      {
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
 void rdfa_complete_list_triples(rdfacontext* context)
 {
    /* For each IRI in the local list mapping, if the equivalent list does
@@ -98,7 +122,7 @@ void rdfa_complete_list_triples(rdfacontext* context)
    int i;
    rdfalist* list;
    rdftriple* triple;
-   void** mptr = context->local_list_mappings;
+   void** mptr;
    char* key = NULL;
    void** kptr = NULL;
    void* value = NULL;
@@ -110,6 +134,15 @@ void rdfa_complete_list_triples(rdfacontext* context)
          (print_mapping_value_fp)rdfa_print_triple_list);
 #endif
 
+   /* the lists are emptied below so stop sharing them with the parent
+    * context, but only if there is something to do */
+   if(!rdfa_has_list_triples_to_complete(context))
+   {
+      return;
+   }
+   rdfa_unshare_mapping(context->local_list_mappings);
+
+   mptr = rdfa_get_mapping_items(context->local_list_mappings);
    while(*mptr != NULL)
    {
       kptr = mptr;
@@ -135,11 +168,9 @@ void rdfa_complete_list_triples(rdfacontext* context)
             rdfa_free_triple(triple);
 
             /* the list is empty, generate an empty list triple */
-            triple = rdfa_create_triple(context->new_subject, predicate,
+            rdfa_generate_triple(context, context->new_subject, predicate,
                "http://www.w3.org/1999/02/22-rdf-syntax-ns#nil",
                RDF_TYPE_IRI, NULL, NULL);
-            context->default_graph_triple_callback(
-               triple, context->callback_data);
          }
          else
          {
@@ -167,8 +198,7 @@ void rdfa_complete_list_triples(rdfacontext* context)
                triple->predicate =
                   rdfa_replace_string(triple->predicate,
                      "http://www.w3.org/1999/02/22-rdf-syntax-ns#first");
-               context->default_graph_triple_callback(
-                  triple, context->callback_data);
+               rdfa_generate_created_triple(context, triple);
 
                /* Free the list item */
                free(list->items[i]);
@@ -193,11 +223,9 @@ void rdfa_complete_list_triples(rdfacontext* context)
                   next = rdfa_strdup((char*)"http://www.w3.org/1999/02/22-rdf-syntax-ns#nil");
                }
 
-               triple = rdfa_create_triple(bnode,
+               rdfa_generate_triple(context, bnode,
                   "http://www.w3.org/1999/02/22-rdf-syntax-ns#rest",
                   next, RDF_TYPE_IRI, NULL, NULL);
-               context->default_graph_triple_callback(
-                  triple, context->callback_data);
 
                /* Free the bnode, setting 'next' appropriately */
                free(bnode);
@@ -222,8 +250,7 @@ void rdfa_complete_list_triples(rdfacontext* context)
                 rdfa_replace_string(triple->subject, subject);
               triple->predicate =
                 rdfa_replace_string(triple->predicate, predicate);
-              context->default_graph_triple_callback(
-                triple, context->callback_data);
+              rdfa_generate_created_triple(context, triple);
             }
             if(subject)
               free(subject);
@@ -236,8 +263,11 @@ void rdfa_complete_list_triples(rdfacontext* context)
          list->items[0] = NULL;
          list->num_items = 0;
 
-         /* clear the entry from the mapping */
-         *kptr = rdfa_replace_string((char*)*kptr, RDFA_MAPPING_DELETED_KEY);
+         /* remove the entry from the mapping; the next entry moves
+          * down to where this one was */
+         rdfa_delete_mapping_key(context->local_list_mappings, key,
+            (free_mapping_value_fp)rdfa_free_list);
+         mptr = kptr;
       }
    }
 }
@@ -311,7 +311,7 @@ static void start_element(void *parser_context, const char* name,
       raptor_namespace** ns_list = NULL;
       size_t ns_size;
 #else
-      void** umap = context->uri_mappings;
+      void** umap = rdfa_get_mapping_items(context->uri_mappings);
 #endif
       const char* umap_key = NULL;
       void* umap_value = NULL;
@@ -529,7 +529,6 @@ static void start_element(void *parser_context, const char* name,
                else
                {
                   char* resolved_uri;
-                  rdftriple* triple;
 
                   /* If @vocab is present and contains a value, the local
                    * default vocabulary is updated according to the
@@ -539,11 +538,9 @@ static void start_element(void *parser_context, const char* name,
                      context->default_vocabulary, resolved_uri);
 
                   /* The value of @vocab is used to generate a triple */
-                  triple = rdfa_create_triple(
+                  rdfa_generate_triple(context,
                      context->base, "http://www.w3.org/ns/rdfa#usesVocabulary",
                      resolved_uri, RDF_TYPE_IRI, NULL, NULL);
-                  context->default_graph_triple_callback(
-                     triple, context->callback_data);
 
                   free(resolved_uri);
                }
@@ -1186,7 +1183,7 @@ static void end_element(void* parser_context, const char* name,
          rdfa_free_mapping(parent_context->local_list_mappings,
             (free_mapping_value_fp)rdfa_free_list);
          parent_context->local_list_mappings = rdfa_copy_mapping(
-            (void**)context->local_list_mappings,
+            context->local_list_mappings,
             (copy_mapping_value_fp)rdfa_replace_list);
 
 #if defined(DEBUG) && DEBUG > 0
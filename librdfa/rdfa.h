@@ -158,6 +158,9 @@ typedef struct rdftriple
  * The specification for a callback that is capable of handling
  * triples. Produces a triple that must be freed once the application
  * is done with the object.
+ *
+ * When built inside raptor, the default graph triple is only lent to
+ * the callback; it must not be freed or kept after the callback returns.
  */
 typedef void (*triple_handler_fp)(rdftriple*, void*);
 
@@ -191,6 +194,12 @@ typedef struct rdfalist
    unsigned int user_data;
 } rdfalist;
 
+/**
+ * An RDFa mapping associates string keys with values such as IRIs or
+ * lists. See rdfa_utils.h for its structure.
+ */
+typedef struct rdfamapping rdfamapping;
+
 /**
  * The RDFa Parser structure is responsible for keeping track of the state of
  * the current RDFa parser. Things such as the default namespace,
@@ -204,11 +213,11 @@ typedef struct rdfacontext
    char* parent_object;
    char* default_vocabulary;
 #ifndef LIBRDFA_IN_RAPTOR
-   void** uri_mappings;
+   rdfamapping* uri_mappings;
 #endif
-   void** term_mappings;
-   void** list_mappings;
-   void** local_list_mappings;
+   rdfamapping* term_mappings;
+   rdfamapping* list_mappings;
+   rdfamapping* local_list_mappings;
    rdfalist* incomplete_triples;
    rdfalist* local_incomplete_triples;
    char* language;
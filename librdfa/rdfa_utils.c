@@ -309,22 +309,158 @@ void rdfa_add_item(rdfalist* list, void* data, liflag_t flags)
    ++list->num_items;
 }
 
-void** rdfa_create_mapping(size_t elements)
+/* hash a mapping key; djb2 works well on short keys */
+static size_t rdfa_hash_mapping_key(const char* key)
 {
-   size_t mapping_size = sizeof(void*) * MAX_URI_MAPPINGS * 2;
-   void** mapping = (void**)malloc(mapping_size);
+   size_t hash = 5381;
+   int c;
+
+   while((c = (unsigned char)*key++))
+   {
+      hash = ((hash << 5) + hash) + c;
+   }
+
+   return hash;
+}
+
+/* find the index slot holding a key or the empty slot where it goes */
+static size_t rdfa_find_mapping_slot(rdfamappingdata* data, const char* key)
+{
+   size_t mask = data->index_size - 1;
+   size_t i = rdfa_hash_mapping_key(key) & mask;
+
+   while(data->index[i] != 0 &&
+      strcmp((const char*)data->items[(data->index[i] - 1) * 2], key) != 0)
+   {
+      i = (i + 1) & mask;
+   }
+
+   return i;
+}
+
+/* rebuild the hash index for the current pairs */
+static void rdfa_index_mapping(rdfamappingdata* data)
+{
+   size_t n;
+
+   memset(data->index, 0, data->index_size * sizeof(size_t));
+   for(n = 0; n < data->num_items; n++)
+   {
+      const char* key = (const char*)data->items[n * 2];
+
+      /* deleted entries are kept in order but never looked up */
+      if(strcmp(key, RDFA_MAPPING_DELETED_KEY) != 0)
+      {
+         data->index[rdfa_find_mapping_slot(data, key)] = n + 1;
+      }
+   }
+}
+
+static rdfamappingdata* rdfa_create_mapping_data(size_t elements)
+{
+   rdfamappingdata* data;
+
+   if(elements < 4)
+   {
+      elements = 4;
+   }
+
+   data = (rdfamappingdata*)calloc(1, sizeof(rdfamappingdata));
+   if(data == NULL)
+   {
+      return NULL;
+   }
+
+   data->refs = 1;
+   data->max_items = elements;
+   /* keep the index at most half full */
+   data->index_size = 8;
+   while(data->index_size < elements * 2)
+   {
+      data->index_size <<= 1;
+   }
+
+   data->items = (void**)calloc(elements * 2 + 2, sizeof(void*));
+   data->index = (size_t*)calloc(data->index_size, sizeof(size_t));
+   if(data->items == NULL || data->index == NULL)
+   {
+      free(data->items);
+      free(data->index);
+      free(data);
+      return NULL;
+   }
+
+   return data;
+}
+
+static void rdfa_free_mapping_data(
+   rdfamappingdata* data, free_mapping_value_fp free_value)
+{
+   void** mptr = data->items;
+
+   /* free all of the memory in the mapping */
+   while(*mptr != NULL)
+   {
+      free(*mptr);
+      mptr++;
+      free_value(*mptr);
+      mptr++;
+   }
+
+   free(data->items);
+   free(data->index);
+   free(data);
+}
+
+/* make room for one more key-value pair */
+static int rdfa_grow_mapping(rdfamappingdata* data)
+{
+   size_t max_items = data->max_items * 2;
+   void** items;
+   size_t* index;
+
+   items = (void**)realloc(data->items, (max_items * 2 + 2) * sizeof(void*));
+   if(items == NULL)
+   {
+      return 1;
+   }
+   memset(items + data->max_items * 2 + 2, 0,
+      (max_items - data->max_items) * 2 * sizeof(void*));
+   data->items = items;
+   data->max_items = max_items;
+
+   index = (size_t*)realloc(data->index, data->index_size * 2 * sizeof(size_t));
+   if(index == NULL)
+   {
+      return 1;
+   }
+   data->index = index;
+   data->index_size *= 2;
+   rdfa_index_mapping(data);
+
+   return 0;
+}
+
+rdfamapping* rdfa_create_mapping(size_t elements)
+{
+   rdfamapping* mapping = (rdfamapping*)malloc(sizeof(rdfamapping));
 
    /* only initialize the mapping if it is not null. */
    if(mapping != NULL)
    {
-      memset(mapping, 0, mapping_size);
+      mapping->data = rdfa_create_mapping_data(elements);
+      if(mapping->data == NULL)
+      {
+         free(mapping);
+         mapping = NULL;
+      }
    }
 
    return mapping;
 }
 
 void rdfa_create_list_mapping(
-   rdfacontext* context, void** mapping,
+   rdfacontext* context, rdfamapping* mapping,
    const char* subject, const char* key)
 {
    char* realkey = NULL;
@@ -362,20 +498,53 @@ void rdfa_create_list_mapping(
 }
 
 void rdfa_append_to_list_mapping(
-   void** mapping, const char* subject, const char* key, void* value)
+   rdfamapping* mapping, const char* subject, const char* key, void* value)
 {
-   rdfalist* list = (rdfalist*)rdfa_get_list_mapping(mapping, subject, key);
+   rdfalist* list;
+
+   /* the list is changed in place so it must not be shared */
+   rdfa_unshare_mapping(mapping);
+   list = (rdfalist*)rdfa_get_list_mapping(mapping, subject, key);
    rdfa_add_item(list, value, RDFALIST_FLAG_TRIPLE);
 }
 
-void** rdfa_copy_mapping(
-   void** mapping, copy_mapping_value_fp copy_mapping_value)
+rdfamapping* rdfa_copy_mapping(
+   rdfamapping* mapping, copy_mapping_value_fp copy_mapping_value)
 {
-   void** rval = (void**)calloc(MAX_URI_MAPPINGS * 2, sizeof(void*));
-   void** mptr = mapping;
-   void** rptr = rval;
+   rdfamapping* rval = (rdfamapping*)malloc(sizeof(rdfamapping));
+
+   if(rval != NULL)
+   {
+      /* share the data; it is copied when either mapping changes it */
+      rval->data = mapping->data;
+      rval->data->refs++;
+      rval->data->copy_value = copy_mapping_value;
+   }
+
+   return rval;
+}
+
+void rdfa_unshare_mapping(rdfamapping* mapping)
+{
+   rdfamappingdata* data = mapping->data;
+   rdfamappingdata* rval;
+   void** mptr;
+   void** rptr;
+
+   if(data->refs == 1)
+   {
+      return;
+   }
+
+   rval = rdfa_create_mapping_data(data->max_items);
+   if(rval == NULL)
+   {
+      return;
+   }
 
    /* copy each element of the old mapping to the new mapping. */
+   mptr = data->items;
+   rptr = rval->items;
    while(*mptr != NULL)
    {
       /* copy the key */
@@ -384,71 +553,105 @@ void** rdfa_copy_mapping(
       mptr++;
 
       /* copy the value */
-      *rptr = copy_mapping_value(*rptr, *mptr);
+      *rptr = data->copy_value(*rptr, *mptr);
       rptr++;
       mptr++;
    }
+   rval->num_items = data->num_items;
+   rval->copy_value = data->copy_value;
 
-   return rval;
+   /* pairs are at the same positions so the index is the same */
+   memcpy(rval->index, data->index, data->index_size * sizeof(size_t));
+
+   data->refs--;
+   mapping->data = rval;
 }
 
-void rdfa_update_mapping(void** mapping, const char* key, const void* value,
-   update_mapping_value_fp update_mapping_value)
+void rdfa_update_mapping(rdfamapping* mapping, const char* key,
+   const void* value, update_mapping_value_fp update_mapping_value)
 {
-   int found = 0;
-   void** mptr = mapping;
+   rdfamappingdata* data;
+   size_t slot;
+   void** mptr;
+
+   rdfa_unshare_mapping(mapping);
+   data = mapping->data;
 
    /* search the current mapping to see if the key exists in the mapping */
-   while(!found && (*mptr != NULL))
+   slot = rdfa_find_mapping_slot(data, key);
+   if(data->index[slot] != 0)
    {
-      if(strcmp((char*)*mptr, key) == 0)
-      {
-         mptr++;
-         *mptr = update_mapping_value(*mptr, value);
-         found = 1;
-      }
-      else
+      mptr = data->items + (data->index[slot] - 1) * 2 + 1;
+      *mptr = update_mapping_value(*mptr, value);
+      return;
+   }
+
+   /* the key was not found, create a new key-value pair. */
+   if(data->num_items == data->max_items)
+   {
+      if(rdfa_grow_mapping(data))
       {
-         mptr++;
+         return;
       }
-      mptr++;
+      slot = rdfa_find_mapping_slot(data, key);
    }
 
-   /* if we made it through the entire URI mapping and the key was not
-    * found, create a new key-value pair. */
-   if(!found)
+   mptr = data->items + data->num_items * 2;
+   *mptr = rdfa_replace_string((char*)*mptr, key);
+   mptr++;
+   *mptr = update_mapping_value(*mptr, value);
+   data->num_items++;
+   data->index[slot] = data->num_items;
+}
+
+const void* rdfa_get_mapping(rdfamapping* mapping, const char* key)
+{
+   rdfamappingdata* data = mapping->data;
+   size_t slot;
+
+   /* search the current mapping to see if the key exists in the mapping. */
+   slot = rdfa_find_mapping_slot(data, key);
+   if(data->index[slot] == 0)
    {
-     *mptr = rdfa_replace_string((char*)*mptr, key);
-      mptr++;
-      *mptr = update_mapping_value(*mptr, value);
+      return NULL;
    }
+
+   return data->items[(data->index[slot] - 1) * 2 + 1];
 }
 
-const void* rdfa_get_mapping(void** mapping, const char* key)
+void rdfa_delete_mapping_key(rdfamapping* mapping, const char* key,
+   free_mapping_value_fp free_value)
 {
-   const void* rval = NULL;
-   char** mptr = (char**)mapping;
+   rdfamappingdata* data = mapping->data;
+   size_t slot = rdfa_find_mapping_slot(data, key);
+   size_t n;
 
-   /* search the current mapping to see if the key exists in the mapping. */
-   while(*mptr != NULL)
+   if(data->index[slot] == 0)
    {
-      if(strcmp(*mptr, key) == 0)
-      {
-         mptr++;
-         rval = *mptr;
-      }
-      else
-      {
-         mptr++;
-      }
-      mptr++;
+      return;
    }
 
-   return rval;
+   n = data->index[slot] - 1;
+   free(data->items[n * 2]);
+   free_value(data->items[n * 2 + 1]);
+
+   /* move the later pairs down, keeping the NULL terminator */
+   memmove(data->items + n * 2, data->items + n * 2 + 2,
+      (data->num_items - n - 1) * 2 * sizeof(void*));
+   data->num_items--;
+   data->items[data->num_items * 2] = NULL;
+   data->items[data->num_items * 2 + 1] = NULL;
+
+   rdfa_index_mapping(data);
+}
+
+void** rdfa_get_mapping_items(rdfamapping* mapping)
+{
+   return mapping->data->items;
 }
 
 const void* rdfa_get_list_mapping(
-   void** mapping, const char* subject, const char* key)
+   rdfamapping* mapping, const char* subject, const char* key)
 {
    void* rval;
    char* realkey = NULL;
@@ -476,9 +679,10 @@ void rdfa_next_mapping(void** mapping, char** key, void** value)
    }
 }
 
-void rdfa_print_mapping(void** mapping, print_mapping_value_fp print_value)
+void rdfa_print_mapping(
+   rdfamapping* mapping, print_mapping_value_fp print_value)
 {
-   void** mptr = mapping;
+   void** mptr = mapping->data->items;
    printf("{\n");
    while(*mptr != NULL)
    {
@@ -507,19 +711,14 @@ void rdfa_print_string(const char* str)
    printf("%s", str);
 }
 
-void rdfa_free_mapping(void** mapping, free_mapping_value_fp free_value)
+void rdfa_free_mapping(
+   rdfamapping* mapping, free_mapping_value_fp free_value)
 {
-   void** mptr = mapping;
-
    if(mapping != NULL)
    {
-      /* free all of the memory in the mapping */
-      while(*mptr != NULL)
+      if(--mapping->data->refs == 0)
       {
-         free(*mptr);
-         mptr++;
-         free_value(*mptr);
-         mptr++;
+         rdfa_free_mapping_data(mapping->data, free_value);
       }
 
       free(mapping);
@@ -102,6 +102,33 @@ typedef void (*print_mapping_value_fp)(void*);
  */
 typedef void (*free_mapping_value_fp)(void*);
 
+/**
+ * The contents of a mapping, which may be shared by several mappings.
+ * The key-value pairs are kept in insertion order in a NULL terminated
+ * key, value, key, value, ... array and indexed by an open addressing
+ * hash table holding their pair numbers plus one (0 is an empty slot).
+ */
+typedef struct rdfamappingdata
+{
+   unsigned int refs;
+   size_t num_items;
+   size_t max_items;
+   void** items;
+   size_t* index;
+   size_t index_size;
+   copy_mapping_value_fp copy_value;
+} rdfamappingdata;
+
+/**
+ * A mapping. Copies of a mapping share its data until one of them is
+ * modified, so creating an element context does not copy the mappings
+ * of its parent.
+ */
+struct rdfamapping
+{
+   rdfamappingdata* data;
+};
+
 /**
  * Initializes a mapping given the number of elements the mapping is
  * expected to hold.
@@ -109,9 +136,9 @@ typedef void (*free_mapping_value_fp)(void*);
  * @param elements the maximum number of elements the mapping is
  *                 supposed to hold.
  *
- * @return an initialized void**, with all of the elements set to NULL.
+ * @return an initialized, empty mapping.
  */
-void** rdfa_create_mapping(size_t elements);
+rdfamapping* rdfa_create_mapping(size_t elements);
 
 /**
  * Adds a list to a mapping given a key to create. The result will be a
@@ -124,7 +151,8 @@ void** rdfa_create_mapping(size_t elements);
  * @param user_data the user-defined data to store with the list information.
  */
 void rdfa_create_list_mapping(
-   rdfacontext* context, void** mapping, const char* subject, const char* key);
+   rdfacontext* context, rdfamapping* mapping, const char* subject,
+   const char* key);
 
 /**
  * Adds an item to the end of the list that is associated with the given
@@ -136,7 +164,7 @@ void rdfa_create_list_mapping(
  * @param value the value to append to the end of the list.
  */
 void rdfa_append_to_list_mapping(
-   void** mapping, const char* subject, const char* key, void* value);
+   rdfamapping* mapping, const char* subject, const char* key, void* value);
 
 /**
  * Gets the value for a given list mapping when presented with a subject
@@ -150,20 +178,31 @@ void rdfa_append_to_list_mapping(
  * @return value the value in the mapping for the given key.
  */
 const void* rdfa_get_list_mapping(
-   void** mapping, const char* subject, const char* key);
+   rdfamapping* mapping, const char* subject, const char* key);
 
 /**
- * Copies the entire contents of a mapping verbatim and returns a
- * pointer to the copied mapping.
+ * Copies a mapping and returns a pointer to the copied mapping.
+ *
+ * The copy shares the contents of the original until either of them
+ * is modified, at which point that one gets its own copy of the keys
+ * and values made with the copy function.
  *
  * @param mapping the mapping to copy
+ * @param copy_mapping_value the function used to copy values.
+ *
+ * @return the copied mapping. You MUST free the returned mapping
+ *         when you are done with it.
+ */
+rdfamapping* rdfa_copy_mapping(
+   rdfamapping* mapping, copy_mapping_value_fp copy_mapping_value);
+
+/**
+ * Makes sure a mapping does not share its contents with any copies so
+ * that its values can be modified in place.
  *
- * @return the copied mapping, with all of the memory newly
- *         allocated. You MUST free the returned mapping when you are
- *         done with it.
+ * @param mapping the mapping to be modified.
  */
-void** rdfa_copy_mapping(
-   void** mapping, copy_mapping_value_fp copy_mapping_value);
+void rdfa_unshare_mapping(rdfamapping* mapping);
 
 /**
  * Updates the given mapping when presented with a key and a value. If
@@ -175,8 +214,8 @@ void** rdfa_copy_mapping(
  * @param replace_mapping_value a pointer to a function that will replace the
  *    old
  */
-void rdfa_update_mapping(void** mapping, const char* key, const void* value,
-   update_mapping_value_fp update_mapping_value);
+void rdfa_update_mapping(rdfamapping* mapping, const char* key,
+   const void* value, update_mapping_value_fp update_mapping_value);
 
 /**
  * Gets the value for a given mapping when presented with a key. If
@@ -187,7 +226,27 @@ void rdfa_update_mapping(void** mapping, const char* key, const void* value,
  *
  * @return value the value in the mapping for the given key.
  */
-const void* rdfa_get_mapping(void** mapping, const char* key);
+const void* rdfa_get_mapping(rdfamapping* mapping, const char* key);
+
+/**
+ * Removes the entry for a key from a mapping. Later entries move down
+ * to take its place in the key-value pairs.
+ *
+ * @param mapping the mapping to modify, which must not be shared.
+ * @param key the key.
+ * @param free_value the function to free the mapping value.
+ */
+void rdfa_delete_mapping_key(rdfamapping* mapping, const char* key,
+   free_mapping_value_fp free_value);
+
+/**
+ * Gets the key-value pairs of a mapping to walk with rdfa_next_mapping().
+ *
+ * @param mapping the mapping.
+ *
+ * @return the NULL terminated key, value, key, value, ... array.
+ */
+void** rdfa_get_mapping_items(rdfamapping* mapping);
 
 /**
  * Gets the current mapping for the given mapping and increments the
@@ -207,7 +266,8 @@ void rdfa_next_mapping(void** mapping, char** key, void** value);
  * @param mapping the mapping to print to the screen.
  * @param print_value the function pointer to use to print the mapping values.
  */
-void rdfa_print_mapping(void** mapping, print_mapping_value_fp print_value);
+void rdfa_print_mapping(
+   rdfamapping* mapping, print_mapping_value_fp print_value);
 
 /**
  * Frees all memory associated with a mapping.
@@ -215,7 +275,8 @@ void rdfa_print_mapping(void** mapping, print_mapping_value_fp print_value);
  * @param mapping the mapping to free.
  * @param free_value the function to free mapping values.
  */
-void rdfa_free_mapping(void** mapping, free_mapping_value_fp free_value);
+void rdfa_free_mapping(
+   rdfamapping* mapping, free_mapping_value_fp free_value);
 
 /**
  * Creates a list and initializes it to the given size.
@@ -371,6 +432,32 @@ rdftriple* rdfa_create_triple(const char* subject, const char* predicate,
    const char* object, rdfresource_t object_type, const char* datatype,
    const char* language);
 
+/**
+ * Generates a triple in the default graph from the given subject,
+ * predicate, object, datatype and language. When built inside raptor
+ * the strings are lent to the triple handler instead of being copied.
+ *
+ * @param context the current processing context.
+ * @param subject the subject for the triple.
+ * @param predicate the predicate for the triple.
+ * @param object the object for the triple.
+ * @param object_type the type of the object, which must be an rdfresource_t.
+ * @param datatype the datatype of the triple.
+ * @param language the language for the triple.
+ */
+void rdfa_generate_triple(rdfacontext* context, const char* subject,
+   const char* predicate, const char* object, rdfresource_t object_type,
+   const char* datatype, const char* language);
+
+/**
+ * Generates an already created triple in the default graph. The triple
+ * is owned by this call and must not be used afterwards.
+ *
+ * @param context the current processing context.
+ * @param triple the triple, as returned by rdfa_create_triple().
+ */
+void rdfa_generate_created_triple(rdfacontext* context, rdftriple* triple);
+
 /**
  * Prints a triple in a human-readable fashion.
  *
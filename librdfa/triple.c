@@ -78,6 +78,47 @@ rdftriple* rdfa_create_triple(const char* subject, const char* predicate,
    return rval;
 }
 
+void rdfa_generate_triple(rdfacontext* context, const char* subject,
+   const char* predicate, const char* object, rdfresource_t object_type,
+   const char* datatype, const char* language)
+{
+#ifdef LIBRDFA_IN_RAPTOR
+   /* raptor turns the strings into terms before the handler returns so
+    * they are lent rather than copied */
+   rdftriple triple;
+
+   triple.subject = NULL;
+   triple.predicate = NULL;
+   triple.object = NULL;
+   triple.object_type = object_type;
+   triple.datatype = NULL;
+   triple.language = NULL;
+
+   /* the same rules as rdfa_create_triple() for incomplete triples */
+   if((subject != NULL) && (predicate != NULL) && (object != NULL))
+   {
+      triple.subject = (char*)subject;
+      triple.predicate = (char*)predicate;
+      triple.object = (char*)object;
+      triple.datatype = (char*)datatype;
+      triple.language = (char*)language;
+   }
+
+   context->default_graph_triple_callback(&triple, context->callback_data);
+#else
+   rdfa_generate_triple(context, subject, predicate, object,
+      object_type, datatype, language);
+#endif
+}
+
+void rdfa_generate_created_triple(rdfacontext* context, rdftriple* triple)
+{
+   context->default_graph_triple_callback(triple, context->callback_data);
+#ifdef LIBRDFA_IN_RAPTOR
+   rdfa_free_triple(triple);
+#endif
+}
+
 void rdfa_print_triple(rdftriple* triple)
 {
    if(triple->object_type == RDF_TYPE_NAMESPACE_PREFIX)
@@ -322,11 +363,9 @@ void rdfa_complete_incomplete_triples(rdfacontext* context)
           *    the predicate from the iterated incomplete triple
           * object
           *    [new subject] */
-         rdftriple* triple =
-            rdfa_create_triple(context->parent_subject,
-               (const char*)incomplete_triple->data, context->new_subject,
-               RDF_TYPE_IRI, NULL, NULL);
-         context->default_graph_triple_callback(triple, context->callback_data);
+         rdfa_generate_triple(context, context->parent_subject,
+            (const char*)incomplete_triple->data, context->new_subject,
+            RDF_TYPE_IRI, NULL, NULL);
       }
       else
       {
@@ -338,11 +377,9 @@ void rdfa_complete_incomplete_triples(rdfacontext* context)
           *    the predicate from the iterated incomplete triple
           * object
           *    [parent subject] */
-         rdftriple* triple =
-            rdfa_create_triple(context->new_subject,
-               (const char*)incomplete_triple->data, context->parent_subject,
-               RDF_TYPE_IRI, NULL, NULL);
-         context->default_graph_triple_callback(triple, context->callback_data);
+         rdfa_generate_triple(context, context->new_subject,
+            (const char*)incomplete_triple->data, context->parent_subject,
+            RDF_TYPE_IRI, NULL, NULL);
       }
       free(incomplete_triple->data);
       free(incomplete_triple);
@@ -394,14 +431,11 @@ void rdfa_complete_type_triples(
    for(i = 0; i < type_of->num_items; i++)
    {
       rdfalistitem* iri = *iptr;
-      rdftriple* triple;
       type = (const char*)iri->data;
 
-      triple = rdfa_create_triple(subject,
+      rdfa_generate_triple(context, subject,
          "http://www.w3.org/1999/02/22-rdf-syntax-ns#type", type, RDF_TYPE_IRI,
          NULL, NULL);
-
-      context->default_graph_triple_callback(triple, context->callback_data);
       iptr++;
    }
 }
@@ -433,11 +467,9 @@ void rdfa_complete_relrev_triples(
       {
          rdfalistitem* curie = *relptr;
 
-         rdftriple* triple = rdfa_create_triple(context->new_subject,
+         rdfa_generate_triple(context, context->new_subject,
             (const char*)curie->data, context->current_object_resource,
             RDF_TYPE_IRI, NULL, NULL);
-
-         context->default_graph_triple_callback(triple, context->callback_data);
          relptr++;
       }
    }
@@ -459,11 +491,9 @@ void rdfa_complete_relrev_triples(
       {
          rdfalistitem* curie = *revptr;
 
-         rdftriple* triple = rdfa_create_triple(
+         rdfa_generate_triple(context,
             context->current_object_resource, (const char*)curie->data,
             context->new_subject, RDF_TYPE_IRI, NULL, NULL);
-
-         context->default_graph_triple_callback(triple, context->callback_data);
          revptr++;
       }
    }
@@ -657,13 +687,10 @@ void rdfa_complete_object_literal_triples(rdfacontext* context)
    {
 
       rdfalistitem* curie = *pptr;
-      rdftriple* triple = NULL;
 
-      triple = rdfa_create_triple(context->new_subject,
+      rdfa_generate_triple(context, context->new_subject,
          (const char*)curie->data, current_object_literal, type,
          context->datatype, context->language);
-
-      context->default_graph_triple_callback(triple, context->callback_data);
       pptr++;
    }
 
@@ -835,12 +862,10 @@ void rdfa_complete_current_property_value_triples(rdfacontext* context)
           * object
           *   current property value */
          rdfalistitem* curie = *pptr;
-         rdftriple* triple = rdfa_create_triple(context->new_subject,
+         rdfa_generate_triple(context, context->new_subject,
             (const char*)curie->data, current_property_value, type,
             context->datatype, context->language);
 
-         context->default_graph_triple_callback(triple, context->callback_data);
-
          pptr++;
       }
    }
@@ -55,16 +55,82 @@
 /* Prototypes for local functions */
 static void raptor_ntriples_generate_statement(raptor_parser* parser, raptor_term* subject_term, raptor_term* predicate_term, raptor_term* object_term, raptor_term* graph_term);
 
+
+typedef struct raptor_ntriples_segment_message_s raptor_ntriples_segment_message;
+
+/*
+ * A message logged while parsing a segment, kept to be logged when
+ * the segment's statements are returned.
+ */
+struct raptor_ntriples_segment_message_s {
+  raptor_ntriples_segment_message* next;
+  /* index of the segment statement that was parsed after the message */
+  int statement_index;
+  raptor_log_level level;
+  int has_locator;
+  raptor_locator locator;
+  /* NULL for the N-Quads literal contexts warning */
+  char* text;
+};
+
+
+typedef struct raptor_ntriples_segment_s raptor_ntriples_segment;
+
+/*
+ * A run of complete lines of input parsed by a worker thread when
+ * the parallelThreads option is set.
+ */
+struct raptor_ntriples_segment_s {
+  raptor_thread_task task;
+
+  raptor_parser* rdf_parser;
+
+  /* lines of input (NUL terminated) */
+  unsigned char* buffer;
+  size_t length;
+
+  /* Non-0 if this segment ends the input */
+  int is_end;
+
+  /* position of the segment in the input and the line end seen
+   * before it; updated as the segment is parsed
+   */
+  raptor_locator locator;
+  char last_char;
+
+  /* parsed statements; terms are owned until returned to the user */
+  raptor_statement* statements;
+  /* arena the terms are allocated in or NULL */
+  raptor_arena* arena;
+  int statements_count;
+  int statements_size;
+
+  raptor_ntriples_segment_message* messages;
+  raptor_ntriples_segment_message* messages_tail;
+
+  int literal_graph_warning;
+
+  /* Non-0 if parsing the segment failed */
+  int rc;
+
+  /* Non-0 when parsed and the statements can be returned */
+  int done;
+
+  /* next segment in input order */
+  raptor_ntriples_segment* next;
+};
+
+
 /*
  * NTriples parser object
  */
 struct raptor_ntriples_parser_context_s {
-  /* current line */
+  /* line buffer: holds unparsed input (a partial line between chunks) */
   unsigned char *line;
-  /* current line length */
+  /* length of data in line buffer */
   size_t line_length;
-  /* current char in line buffer */
-  size_t offset;
+  /* allocated size of line buffer */
+  size_t line_size;
 
   char last_char;
   
@@ -75,12 +141,44 @@ struct raptor_ntriples_parser_context_s {
   int is_nquads;
 
   int literal_graph_warning;
+
+  /* Worker threads when parsing in parallel or NULL */
+  raptor_thread_pool* pool;
+
+  /* Segments given to the pool and not yet returned, in input order */
+  raptor_ntriples_segment* segments;
+  raptor_ntriples_segment* segments_tail;
+  int segments_count;
+
+  /* Maximum number of segments parsed or waiting at one time */
+  int segments_max;
+
+  /* Non-0 to return segments as they are parsed, not in input order */
+  int unordered;
+
+  /* arena for the terms of the statement being parsed when the
+   * termArena option is set or NULL */
+  raptor_arena* arena;
+
+  /* bytes that raptor_ntriples_line_end() stops at */
+  raptor_scan_set line_scan_set;
 };
 
 
 typedef struct raptor_ntriples_parser_context_s raptor_ntriples_parser_context;
 
 
+static void raptor_ntriples_parallel_finish(raptor_parser* rdf_parser);
+
+
+/* Bytes that the line splitter must look at: line ends and the
+ * quote, URI and escape characters that hide them.
+ */
+static const unsigned char raptor_ntriples_line_scan_set[7] = {
+  '\n', '\r', '"', '\'', '<', '>', '\\'
+};
+
+
 
 /**
  * raptor_ntriples_parse_init:
@@ -98,6 +196,10 @@ raptor_ntriples_parse_init(raptor_parser* rdf_parser, const char *name)
 
   raptor_statement_init(&ntriples_parser->statement, rdf_parser->world);
 
+  raptor_scan_set_init(&ntriples_parser->line_scan_set,
+                       raptor_ntriples_line_scan_set,
+                       sizeof(raptor_ntriples_line_scan_set));
+
   if(!strcmp(name, "nquads"))
     ntriples_parser->is_nquads = 1;
   
@@ -118,7 +220,13 @@ raptor_ntriples_parse_terminate(raptor_parser* rdf_parser)
 {
   raptor_ntriples_parser_context *ntriples_parser;
   ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
-  if(ntriples_parser->line_length)
+
+  raptor_ntriples_parallel_finish(rdf_parser);
+
+  if(ntriples_parser->arena)
+    raptor_free_arena(ntriples_parser->arena);
+
+  if(ntriples_parser->line)
     RAPTOR_FREE(cdata, ntriples_parser->line);
 }
 
@@ -160,10 +268,211 @@ raptor_ntriples_generate_statement(raptor_parser* parser,
 
 
 
+
+static void
+raptor_ntriples_line_error(raptor_parser* rdf_parser, raptor_locator* locator,
+                           const char* message, ...)
+  RAPTOR_PRINTF_FORMAT(3, 4);
+
+/* Error on a line at @locator which need not be the parser locator */
+static void
+raptor_ntriples_line_error(raptor_parser* rdf_parser, raptor_locator* locator,
+                           const char* message, ...)
+{
+  va_list arguments;
+
+  va_start(arguments, message);
+  raptor_log_error_varargs(rdf_parser->world, RAPTOR_LOG_LEVEL_ERROR,
+                           locator, message, arguments);
+  va_end(arguments);
+}
+
+
+/* Warn once per parse that N-Quads literal contexts are dropped */
+static void
+raptor_ntriples_literal_graph_warning(raptor_parser* rdf_parser,
+                                      raptor_locator* locator)
+{
+  raptor_ntriples_parser_context *ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
+
+  if(!ntriples_parser->literal_graph_warning++)
+    raptor_log_error(rdf_parser->world, RAPTOR_LOG_LEVEL_WARN, locator,
+                     "Ignoring N-Quad literal contexts");
+}
+
+
+static void
+raptor_free_ntriples_segment(raptor_ntriples_segment* segment)
+{
+  raptor_ntriples_segment_message* message;
+  int i;
+
+  for(i = 0; i < segment->statements_count; i++) {
+    raptor_statement* statement = &segment->statements[i];
+
+    raptor_free_term(statement->subject);
+    raptor_free_term(statement->predicate);
+    raptor_free_term(statement->object);
+    raptor_free_term(statement->graph);
+  }
+  if(segment->statements)
+    RAPTOR_FREE(raptor_statement*, segment->statements);
+
+  if(segment->arena)
+    raptor_free_arena(segment->arena);
+
+  while((message = segment->messages)) {
+    segment->messages = message->next;
+    if(message->text)
+      RAPTOR_FREE(char*, message->text);
+    RAPTOR_FREE(raptor_ntriples_segment_message, message);
+  }
+
+  if(segment->buffer)
+    RAPTOR_FREE(cdata, segment->buffer);
+
+  RAPTOR_FREE(raptor_ntriples_segment, segment);
+}
+
+
+/*
+ * raptor_ntriples_segment_add_message:
+ * @segment: segment
+ * @level: log level
+ * @locator: locator or NULL
+ * @text: message text or NULL for the N-Quads literal contexts warning
+ *
+ * Keep a message logged while parsing a segment
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_ntriples_segment_add_message(raptor_ntriples_segment* segment,
+                                    raptor_log_level level,
+                                    raptor_locator* locator,
+                                    const char* text)
+{
+  raptor_ntriples_segment_message* message;
+
+  message = RAPTOR_CALLOC(raptor_ntriples_segment_message*, 1,
+                          sizeof(*message));
+  if(!message)
+    return 1;
+
+  message->statement_index = segment->statements_count;
+  message->level = level;
+  if(locator) {
+    message->has_locator = 1;
+    message->locator = *locator;
+  }
+
+  if(text) {
+    size_t len = strlen(text);
+
+    message->text = RAPTOR_MALLOC(char*, len + 1);
+    if(!message->text) {
+      RAPTOR_FREE(raptor_ntriples_segment_message, message);
+      return 1;
+    }
+    memcpy(message->text, text, len + 1);
+  }
+
+  if(segment->messages_tail)
+    segment->messages_tail->next = message;
+  else
+    segment->messages = message;
+  segment->messages_tail = message;
+
+  return 0;
+}
+
+
+/* raptor_thread_task_log_handler for segments */
+static void
+raptor_ntriples_segment_log_handler(raptor_thread_task* task,
+                                    raptor_log_level level,
+                                    raptor_locator* locator,
+                                    const char* text)
+{
+  raptor_ntriples_segment* segment = (raptor_ntriples_segment*)task->user_data;
+
+  raptor_ntriples_segment_add_message(segment, level, locator, text);
+}
+
+
+/*
+ * raptor_ntriples_segment_add_statement:
+ * @segment: segment
+ * @locator: locator for errors
+ * @subject: subject term (owned)
+ * @predicate: predicate term (owned)
+ * @object: object term (owned)
+ * @graph: graph term or NULL (owned)
+ *
+ * Keep a statement parsed in a segment until it is returned to the user
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_ntriples_segment_add_statement(raptor_ntriples_segment* segment,
+                                      raptor_locator* locator,
+                                      raptor_term *subject,
+                                      raptor_term *predicate,
+                                      raptor_term *object,
+                                      raptor_term *graph)
+{
+  raptor_statement* statement;
+
+  if(segment->statements_count == segment->statements_size) {
+    int new_size = segment->statements_size ? segment->statements_size << 1 : 256;
+    raptor_statement* statements;
+
+    statements = RAPTOR_REALLOC(raptor_statement*, segment->statements,
+                                RAPTOR_GOOD_CAST(size_t, new_size) * sizeof(*statements));
+    if(!statements) {
+      raptor_free_term(subject);
+      raptor_free_term(predicate);
+      raptor_free_term(object);
+      raptor_free_term(graph);
+      raptor_log_error(segment->rdf_parser->world, RAPTOR_LOG_LEVEL_FATAL,
+                       locator, "Out of memory");
+      return 1;
+    }
+
+    segment->statements = statements;
+    segment->statements_size = new_size;
+  }
+
+  statement = &segment->statements[segment->statements_count++];
+  statement->subject = subject;
+  statement->predicate = predicate;
+  statement->object = object;
+  statement->graph = graph;
+
+  return 0;
+}
+
+
 #define MAX_NTRIPLES_TERMS 4
 
+/*
+ * raptor_ntriples_parse_line:
+ * @rdf_parser: parser
+ * @segment: segment being parsed by a worker thread or NULL
+ * @locator: position of @buffer in the input, updated as it is parsed
+ * @buffer: line (NUL terminated)
+ * @len: length of @buffer
+ * @max_terms: maximum number of terms
+ *
+ * Parse one line, returning the statement to the user or, if
+ * @segment is given, adding it to @segment to be returned later.
+ *
+ * Return value: non-0 on failure
+ */
 static int
 raptor_ntriples_parse_line(raptor_parser* rdf_parser,
+                           raptor_ntriples_segment* segment,
+                           raptor_locator* locator,
                            unsigned char *buffer, size_t len,
                            int max_terms)
 {
@@ -171,6 +480,7 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
   int i;
   unsigned char *p;
   raptor_term* terms[MAX_NTRIPLES_TERMS+1] = {NULL, NULL, NULL, NULL, NULL};
+  raptor_arena* arena;
   int rc = 0;
   
   /* ASSERTION:
@@ -182,6 +492,16 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
   if(!len)
     return 0;
 
+  if(segment)
+    /* terms live until the segment is returned */
+    arena = segment->arena;
+  else {
+    /* terms of the previous statement are no longer in use */
+    arena = ntriples_parser->arena;
+    if(arena)
+      raptor_arena_reset(arena);
+  }
+
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
   RAPTOR_DEBUG3("handling line '%s' (%d bytes)\n", buffer, (unsigned int)len);
 #endif
@@ -190,8 +510,8 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
 
   while(len > 0 && isspace((int)*p)) {
     p++;
-    rdf_parser->locator.column++;
-    rdf_parser->locator.byte++;
+    locator->column++;
+    locator->byte++;
     len--;
   }
 
@@ -225,7 +545,7 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
         if(i == 3)
           break;
       }
-      raptor_parser_error(rdf_parser, "Unexpected end of line");
+      raptor_ntriples_line_error(rdf_parser, locator, "Unexpected end of line");
       goto cleanup;
     }
     
@@ -233,32 +553,32 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
     if(i == 3) {
       /* graph term (3): blank node or <URI> */
       if(*p != '<' && *p != '_') {
-        raptor_parser_error(rdf_parser, "Saw '%c', expected Graph term <URIref>, _:bnodeID", *p);
+        raptor_ntriples_line_error(rdf_parser, locator, "Saw '%c', expected Graph term <URIref>, _:bnodeID", *p);
         goto cleanup;
       }
     } else if(i == 2) {
       /* object term (2): expect either <URI> or _:name or literal */
       if(*p != '<' && *p != '_' && *p != '"') {
-        raptor_parser_error(rdf_parser, "Saw '%c', expected object term <URIref>, _:bnodeID or \"literal\"", *p);
+        raptor_ntriples_line_error(rdf_parser, locator, "Saw '%c', expected object term <URIref>, _:bnodeID or \"literal\"", *p);
         goto cleanup;
       }
     } else if(i == 1) {
       /* predicate term (1): expect URI only */
       if(*p != '<') {
-        raptor_parser_error(rdf_parser, "Saw '%c', expected predict term <URIref>", *p);
+        raptor_ntriples_line_error(rdf_parser, locator, "Saw '%c', expected predict term <URIref>", *p);
         goto cleanup;
       }
     } else {
       /* subject (0) or graph (3) terms: expect <URI> or _:name */
       if(*p != '<' && *p != '_') {
-        raptor_parser_error(rdf_parser, "Saw '%c', expected subject term <URIref> or _:bnodeID", *p);
+        raptor_ntriples_line_error(rdf_parser, locator, "Saw '%c', expected subject term <URIref> or _:bnodeID", *p);
         goto cleanup;
       }
     }
 
 
-    term_len = raptor_ntriples_parse_term(rdf_parser->world, &rdf_parser->locator,
-                                          p, &len, &terms[i], 0);
+    term_len = raptor_ntriples_parse_term(rdf_parser->world, locator,
+                                          p, &len, &terms[i], 0, arena);
     if(!term_len) {
       rc = 1;
       goto cleanup;
@@ -273,7 +593,7 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
       /* Check for absolute URI */
       uri_string = raptor_uri_as_string(terms[i]->value.uri);
       if(!raptor_uri_uri_string_is_absolute(uri_string)) {
-        raptor_parser_error(rdf_parser, "URI %s is not absolute", uri_string);
+        raptor_ntriples_line_error(rdf_parser, locator, "URI %s is not absolute", uri_string);
         goto cleanup;
       }
     }
@@ -282,8 +602,8 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
     while(len > 0 && isspace((int)*p)) {
       p++;
       len--;
-      rdf_parser->locator.column++;
-      rdf_parser->locator.byte++;
+      locator->column++;
+      locator->byte++;
     }
 
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
@@ -298,7 +618,7 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
 
     /* Look for terminating '.' after 3rd (ntriples) or 3rd/4th (nquads) term */
     if(i == (ntriples_parser->is_nquads ? 4 : 3) && *p != '.') {
-      raptor_parser_error(rdf_parser, "Missing terminating \".\"");
+      raptor_ntriples_line_error(rdf_parser, locator, "Missing terminating \".\"");
       return 0;
     }
 
@@ -306,20 +626,20 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
     if(*p == '.') {
       p++;
       len--;
-      rdf_parser->locator.column++;
-      rdf_parser->locator.byte++;
+      locator->column++;
+      locator->byte++;
 
       /* Skip whitespace after '.' */
       while(len > 0 && isspace((int)*p)) {
         p++;
         len--;
-        rdf_parser->locator.column++;
-        rdf_parser->locator.byte++;
+        locator->column++;
+        locator->byte++;
       }
 
       /* Only a comment is allowed here */
       if(*p && *p != '#') {
-        raptor_parser_error(rdf_parser, "Junk after terminating \".\"");
+        raptor_ntriples_line_error(rdf_parser, locator, "Junk after terminating \".\"");
         return 0;
       }
 
@@ -333,7 +653,7 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
     if(terms[4]) {
       raptor_free_term(terms[4]);
       terms[4] = NULL;
-      raptor_parser_error(rdf_parser, "N-Quads only allows 3 or 4 terms");
+      raptor_ntriples_line_error(rdf_parser, locator, "N-Quads only allows 3 or 4 terms");
       goto cleanup;
     }
   } else {
@@ -347,23 +667,32 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
         raptor_free_term(terms[3]);
         terms[3] = NULL;
       }
-      raptor_parser_error(rdf_parser, "N-Triples only allows 3 terms");
+      raptor_ntriples_line_error(rdf_parser, locator, "N-Triples only allows 3 terms");
       goto cleanup;
     }
   }
 
   if(terms[3] && terms[3]->type == RAPTOR_TERM_TYPE_LITERAL) {
-    if(!ntriples_parser->literal_graph_warning++)
-      raptor_parser_warning(rdf_parser, "Ignoring N-Quad literal contexts");
+    if(!segment)
+      raptor_ntriples_literal_graph_warning(rdf_parser, locator);
+    else if(!segment->literal_graph_warning++)
+      /* decided when the segment is returned */
+      raptor_ntriples_segment_add_message(segment, RAPTOR_LOG_LEVEL_WARN,
+                                          locator, NULL);
 
     raptor_free_term(terms[3]);
     terms[3] = NULL;
   }
 
-  raptor_ntriples_generate_statement(rdf_parser, 
-                                     terms[0], terms[1], terms[2], terms[3]);
+  if(segment) {
+    if(raptor_ntriples_segment_add_statement(segment, locator, terms[0],
+                                             terms[1], terms[2], terms[3]))
+      return 1;
+  } else
+    raptor_ntriples_generate_statement(rdf_parser, 
+                                       terms[0], terms[1], terms[2], terms[3]);
 
-  rdf_parser->locator.byte += RAPTOR_BAD_CAST(int, len);
+  locator->byte += RAPTOR_BAD_CAST(int, len);
 
  cleanup:
 
@@ -371,108 +700,125 @@ raptor_ntriples_parse_line(raptor_parser* rdf_parser,
 }
 
 
-static int
-raptor_ntriples_parse_chunk(raptor_parser* rdf_parser, 
-                            const unsigned char *s, size_t len,
-                            int is_end)
-{
-  unsigned char *buffer;
-  unsigned char *ptr;
-  unsigned char *start;
-  raptor_ntriples_parser_context *ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
-  int max_terms = ntriples_parser->is_nquads ? 4 : 3;
-  unsigned char* end_ptr;
+/* Initial size of the reusable line buffer */
+#define RAPTOR_NTRIPLES_LINE_BUFFER_SIZE 4096
 
-#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-  RAPTOR_DEBUG2("adding %d bytes to buffer\n", (unsigned int)len);
-#endif
+/* Input collected before it is handed to a worker thread */
+#define RAPTOR_NTRIPLES_SEGMENT_SIZE (1 << 16)
 
-  if(len) {
-    buffer = RAPTOR_MALLOC(unsigned char*, ntriples_parser->line_length + len + 1);
-    if(!buffer) {
-      raptor_parser_fatal_error(rdf_parser, "Out of memory");
-      return 1;
-    }
+/* Arena block size for the terms of one statement */
+#define RAPTOR_NTRIPLES_ARENA_BLOCK_SIZE 4096
 
-    if(ntriples_parser->line_length) {
-      memcpy(buffer, ntriples_parser->line, ntriples_parser->line_length);
-      RAPTOR_FREE(char*, ntriples_parser->line);
-    }
-
-    ntriples_parser->line = buffer;
+/*
+ * raptor_ntriples_line_end:
+ * @ptr: start of line
+ * @end_ptr: end of buffer
+ * @scan_set: raptor_ntriples_line_scan_set prepared for raptor_scan_bytes()
+ *
+ * Find the \n or \r ending a line, skipping any inside quotes.
+ *
+ * Return value: pointer to the line end or @end_ptr if none was found
+ */
+static unsigned char*
+raptor_ntriples_line_end(unsigned char* ptr, unsigned char* end_ptr,
+                         const raptor_scan_set* scan_set)
+{
+  int quote = '\0';
+  int in_uri = '\0';
+  int bq = 0;
+
+  while(ptr < end_ptr) {
+    if(!bq) {
+      /* skip to the next byte that can change the scan state */
+      ptr += raptor_scan_bytes(ptr, RAPTOR_BAD_CAST(size_t, end_ptr - ptr),
+                               scan_set);
+      if(ptr == end_ptr)
+        break;
 
-    /* move pointer to end of cdata buffer */
-    ptr = buffer + ntriples_parser->line_length;
+      if(*ptr == '\\') {
+        bq = 1;
+        ptr++;
+        continue;
+      }
 
-    /* adjust stored length */
-    ntriples_parser->line_length += len;
+      if(*ptr == '<')
+        in_uri = 1;
+      else if (in_uri && *ptr == '>')
+        in_uri = 0;
 
-    /* now write new stuff at end of cdata buffer */
-    memcpy(ptr, s, len);
-    ptr += len;
-    *ptr = '\0';
-  } else
-    buffer = ntriples_parser->line;
+      if(!quote) {
+        if((!in_uri && *ptr == '\'') || *ptr == '"')
+          quote = *ptr;
+        if(*ptr == '\n' || *ptr == '\r')
+          break;
+      } else {
+        if(*ptr == quote)
+          quote = 0;
+      }
+    }
+    ptr++;
+    bq = 0;
+  }
 
+  return ptr;
+}
 
-#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-  RAPTOR_DEBUG2("buffer now %ld bytes\n", ntriples_parser->line_length);
-#endif
 
-  if(!ntriples_parser->line_length)
-    return 0;
+/*
+ * raptor_ntriples_parse_lines:
+ * @rdf_parser: parser
+ * @segment: segment being parsed by a worker thread or NULL
+ * @locator: position of @buffer in the input; updated
+ * @last_char_p: last line end character seen; updated
+ * @buffer: input
+ * @length: length of @buffer
+ * @is_end: non-0 if @buffer ends the input
+ * @parse: non-0 to parse the lines, 0 to only step over them
+ * @rest_p: pointer to store the start of the partial last line
+ *
+ * Parse (or count) the complete lines in a buffer.
+ *
+ * Lines are split the same way whether parsed or not so that a
+ * parallel parse gives the same lines and locators.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_ntriples_parse_lines(raptor_parser* rdf_parser,
+                            raptor_ntriples_segment* segment,
+                            raptor_locator* locator, char* last_char_p,
+                            unsigned char* buffer, size_t length,
+                            int is_end, int parse, unsigned char** rest_p)
+{
+  raptor_ntriples_parser_context *ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
+  int max_terms = ntriples_parser->is_nquads ? 4 : 3;
+  unsigned char *ptr;
+  unsigned char *start;
+  unsigned char* end_ptr;
+  size_t len;
 
-  ptr = buffer + ntriples_parser->offset;
-  end_ptr = buffer + ntriples_parser->line_length;
+  ptr = buffer;
+  end_ptr = buffer + length;
   while((start = ptr) < end_ptr) {
     unsigned char *line_start = ptr;
 
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-  RAPTOR_DEBUG3("line buffer now '%s' (offset %ld)\n", ptr, ptr-(buffer+ntriples_parser->offset));
+  RAPTOR_DEBUG3("line buffer now '%s' (offset %ld)\n", ptr, ptr-buffer);
 #endif
 
     /* skip \n when just seen \r - i.e. \r\n or CR LF */
-    if(ntriples_parser->last_char == '\r' && *ptr == '\n') {
+    if(*last_char_p == '\r' && *ptr == '\n') {
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
       RAPTOR_DEBUG1("skipping a \\n\n");
 #endif
       ptr++;
-      rdf_parser->locator.byte++;
-      rdf_parser->locator.column = 0;
+      locator->byte++;
+      locator->column = 0;
       start = line_start = ptr;
     }
 
-    if(1) {
-      int quote = '\0';
-      int in_uri = '\0';
-      int bq = 0;
-      while(ptr < end_ptr) {
-        if(!bq) {
-          if(*ptr == '\\') {
-            bq = 1;
-            ptr++;
-            continue;
-          }
-
-          if(*ptr == '<')
-            in_uri = 1;
-          else if (in_uri && *ptr == '>')
-            in_uri = 0;
-
-          if(!quote) {
-            if((!in_uri && *ptr == '\'') || *ptr == '"')
-              quote = *ptr;
-            if(*ptr == '\n' || *ptr == '\r')
-              break;
-          } else {
-            if(*ptr == quote)
-              quote = 0;
-          }
-        }
-        ptr++;
-        bq = 0;
-      }
-    }
+    ptr = raptor_ntriples_line_end(ptr, end_ptr,
+                                   &ntriples_parser->line_scan_set);
 
     if(ptr == end_ptr) {
       if(!is_end)
@@ -483,73 +829,389 @@ raptor_ntriples_parse_chunk(raptor_parser* rdf_parser,
       RAPTOR_DEBUG3("found newline \\x%02x at offset %ld\n", *ptr,
                     ptr-line_start);
 #endif
-      ntriples_parser->last_char = *ptr;
+      *last_char_p = *ptr;
     }
     
     len = ptr - line_start;
-    rdf_parser->locator.column = 0;
+    locator->column = 0;
 
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
     RAPTOR_DEBUG2("line (%ld) : >>>", len);
     fwrite(line_start, sizeof(char), len, stderr);
     fputs("<<<\n", stderr);
 #endif
-    *ptr = '\0';
-    if(raptor_ntriples_parse_line(rdf_parser, line_start, len, max_terms))
-      return 1;
+    if(parse) {
+      *ptr = '\0';
+      if(raptor_ntriples_parse_line(rdf_parser, segment, locator,
+                                    line_start, len, max_terms)) {
+        *rest_p = start;
+        return 1;
+      }
+    } else
+      locator->byte += RAPTOR_BAD_CAST(int, len);
     
-    rdf_parser->locator.line++;
+    locator->line++;
 
     /* go past newline */
     if(ptr < end_ptr) {
       ptr++;
-      rdf_parser->locator.byte++;
+      locator->byte++;
     }
 
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
     /* Do not peek if too far */
-    if(RAPTOR_BAD_CAST(size_t, ptr - buffer) < ntriples_parser->line_length)
+    if(ptr < end_ptr)
       RAPTOR_DEBUG2("next char is \\x%02x\n", *ptr);
     else
       RAPTOR_DEBUG1("next char unknown - end of buffer\n");
 #endif
   }
 
-  ntriples_parser->offset = start - buffer;
+  *rest_p = start;
 
-  len = ntriples_parser->line_length - ntriples_parser->offset;
-    
-  if(len && ntriples_parser->line_length != len) {
-    /* collapse buffer */
+  return 0;
+}
+
+
+/* raptor_thread_task_handler for segments */
+static void
+raptor_ntriples_segment_run(raptor_thread_task* task)
+{
+  raptor_ntriples_segment* segment = (raptor_ntriples_segment*)task->user_data;
+  unsigned char* rest;
+
+  segment->rc = raptor_ntriples_parse_lines(segment->rdf_parser, segment,
+                                            &segment->locator,
+                                            &segment->last_char,
+                                            segment->buffer, segment->length,
+                                            segment->is_end, 1, &rest);
+}
+
+
+/*
+ * raptor_ntriples_segment_deliver:
+ * @rdf_parser: parser
+ * @segment: parsed segment
+ *
+ * Return the statements parsed in a segment to the user, logging the
+ * messages from parsing in the same order as a sequential parse.
+ *
+ * Return value: non-0 if parsing the segment failed
+ */
+static int
+raptor_ntriples_segment_deliver(raptor_parser* rdf_parser,
+                                raptor_ntriples_segment* segment)
+{
+  raptor_ntriples_segment_message* message = segment->messages;
+  int i;
+
+  for(i = 0; i <= segment->statements_count; i++) {
+    for(; message && message->statement_index == i; message = message->next) {
+      raptor_locator* locator = message->has_locator ? &message->locator : NULL;
+
+      if(!message->text)
+        raptor_ntriples_literal_graph_warning(rdf_parser, locator);
+      else {
+        if(message->level == RAPTOR_LOG_LEVEL_FATAL)
+          rdf_parser->failed = 1;
+        raptor_log_error(rdf_parser->world, message->level, locator,
+                         message->text);
+      }
+    }
+
+    if(i < segment->statements_count) {
+      raptor_statement* statement = &segment->statements[i];
+
+      raptor_ntriples_generate_statement(rdf_parser, statement->subject,
+                                         statement->predicate,
+                                         statement->object,
+                                         statement->graph);
+      /* terms are now freed */
+      statement->subject = NULL;
+      statement->predicate = NULL;
+      statement->object = NULL;
+      statement->graph = NULL;
+    }
+  }
+
+  return segment->rc;
+}
+
+
+/*
+ * raptor_ntriples_parallel_wait:
+ * @rdf_parser: parser
+ * @max_segments: number of segments that may be left unreturned
+ *
+ * Wait for segments to be parsed and return their statements until
+ * no more than @max_segments remain.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_ntriples_parallel_wait(raptor_parser* rdf_parser, int max_segments)
+{
+  raptor_ntriples_parser_context *ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
+
+  while(ntriples_parser->segments_count > max_segments) {
+    raptor_thread_task* task;
+    raptor_ntriples_segment* segment;
+    raptor_ntriples_segment* prev = NULL;
+
+    task = raptor_thread_pool_wait_task(ntriples_parser->pool);
+    if(!task)
+      break;
+
+    ((raptor_ntriples_segment*)task->user_data)->done = 1;
+
+    /* return the done segments at the start of the list or, if
+     * unordered, anywhere in the list
+     */
+    segment = ntriples_parser->segments;
+    while(segment) {
+      raptor_ntriples_segment* next = segment->next;
+      int rc;
+
+      if(!segment->done) {
+        if(!ntriples_parser->unordered)
+          break;
+        prev = segment;
+        segment = next;
+        continue;
+      }
+
+      if(prev)
+        prev->next = next;
+      else
+        ntriples_parser->segments = next;
+      if(ntriples_parser->segments_tail == segment)
+        ntriples_parser->segments_tail = prev;
+      ntriples_parser->segments_count--;
+
+      rc = raptor_ntriples_segment_deliver(rdf_parser, segment);
+      raptor_free_ntriples_segment(segment);
+      if(rc)
+        return rc;
+
+      segment = next;
+    }
+  }
+
+  return 0;
+}
+
+
+/*
+ * raptor_ntriples_parallel_finish:
+ * @rdf_parser: parser
+ *
+ * Stop the worker threads and drop any segments not yet returned.
+ */
+static void
+raptor_ntriples_parallel_finish(raptor_parser* rdf_parser)
+{
+  raptor_ntriples_parser_context *ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
+  raptor_ntriples_segment* segment;
+
+  if(ntriples_parser->pool) {
+    raptor_free_thread_pool(ntriples_parser->pool);
+    ntriples_parser->pool = NULL;
+  }
+
+  while((segment = ntriples_parser->segments)) {
+    ntriples_parser->segments = segment->next;
+    raptor_free_ntriples_segment(segment);
+  }
+  ntriples_parser->segments_tail = NULL;
+  ntriples_parser->segments_count = 0;
+}
+
+
+/*
+ * raptor_ntriples_parse_chunk_parallel:
+ * @rdf_parser: parser
+ * @is_end: non-0 if no more input follows
+ *
+ * Hand the complete lines in the line buffer to a worker thread once
+ * there is enough of them and return statements from parsed segments.
+ *
+ * The locator and last line end character are stepped over the lines
+ * here so each segment starts with the state a sequential parse would
+ * have there.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_ntriples_parse_chunk_parallel(raptor_parser* rdf_parser, int is_end)
+{
+  raptor_ntriples_parser_context *ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
+  raptor_ntriples_segment* segment;
+  unsigned char* rest;
+  size_t length;
+  size_t rest_length;
+  unsigned char* new_line;
+
+  if(!is_end && ntriples_parser->line_length < RAPTOR_NTRIPLES_SEGMENT_SIZE)
+    return 0;
+
+  segment = RAPTOR_CALLOC(raptor_ntriples_segment*, 1, sizeof(*segment));
+  if(!segment) {
+    raptor_parser_fatal_error(rdf_parser, "Out of memory");
+    goto failed;
+  }
+
+  if(ntriples_parser->arena) {
+    segment->arena = raptor_new_arena(RAPTOR_NTRIPLES_SEGMENT_SIZE);
+    if(!segment->arena) {
+      RAPTOR_FREE(raptor_ntriples_segment, segment);
+      raptor_parser_fatal_error(rdf_parser, "Out of memory");
+      goto failed;
+    }
+  }
+
+  segment->rdf_parser = rdf_parser;
+  segment->is_end = is_end;
+  segment->locator = rdf_parser->locator;
+  segment->last_char = ntriples_parser->last_char;
+
+  raptor_ntriples_parse_lines(rdf_parser, NULL, &rdf_parser->locator,
+                              &ntriples_parser->last_char,
+                              ntriples_parser->line,
+                              ntriples_parser->line_length, is_end, 0, &rest);
+  length = RAPTOR_BAD_CAST(size_t, rest - ntriples_parser->line);
+  rest_length = ntriples_parser->line_length - length;
+
+  if(!length) {
+    /* no complete line yet */
+    raptor_free_ntriples_segment(segment);
+    goto wait;
+  }
+
+  /* the segment takes the line buffer; the rest goes in a new one */
+  new_line = RAPTOR_MALLOC(unsigned char*, ntriples_parser->line_size);
+  if(!new_line) {
+    raptor_free_ntriples_segment(segment);
+    raptor_parser_fatal_error(rdf_parser, "Out of memory");
+    goto failed;
+  }
+  memcpy(new_line, rest, rest_length);
+  new_line[rest_length] = '\0';
+
+  segment->buffer = ntriples_parser->line;
+  segment->length = length;
+  segment->buffer[length] = '\0';
+
+  ntriples_parser->line = new_line;
+  ntriples_parser->line_length = rest_length;
+
+  segment->task.handler = raptor_ntriples_segment_run;
+  segment->task.log_handler = raptor_ntriples_segment_log_handler;
+  segment->task.user_data = segment;
+
+  if(ntriples_parser->segments_tail)
+    ntriples_parser->segments_tail->next = segment;
+  else
+    ntriples_parser->segments = segment;
+  ntriples_parser->segments_tail = segment;
+  ntriples_parser->segments_count++;
+
+  raptor_thread_pool_add_task(ntriples_parser->pool, &segment->task);
+
+  wait:
+  if(raptor_ntriples_parallel_wait(rdf_parser,
+                                   is_end ? 0 : ntriples_parser->segments_max))
+    goto failed;
+
+  if(is_end) {
+    raptor_ntriples_parallel_finish(rdf_parser);
+
+    if(rdf_parser->emitted_default_graph) {
+      raptor_parser_end_graph(rdf_parser, NULL, 0);
+      rdf_parser->emitted_default_graph--;
+    }
+  }
+
+  return 0;
+
+  failed:
+  raptor_ntriples_parallel_finish(rdf_parser);
+  return 1;
+}
+
+
+static int
+raptor_ntriples_parse_chunk(raptor_parser* rdf_parser, 
+                            const unsigned char *s, size_t len,
+                            int is_end)
+{
+  unsigned char *buffer;
+  unsigned char *start;
+  raptor_ntriples_parser_context *ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
 
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-    RAPTOR_DEBUG3("collapsing buffer from %ld to %ld bytes\n", ntriples_parser->line_length, len);
+  RAPTOR_DEBUG2("adding %d bytes to buffer\n", (unsigned int)len);
 #endif
-    buffer = RAPTOR_MALLOC(unsigned char*, len + 1);
-    if(!buffer) {
-      raptor_parser_fatal_error(rdf_parser, "Out of memory");
-      return 1;
+
+  if(len) {
+    size_t need = ntriples_parser->line_length + len + 1;
+
+    /* Grow the line buffer geometrically; once it is big enough for
+     * a chunk plus the carried over partial line it is reused as-is.
+     */
+    if(need > ntriples_parser->line_size) {
+      size_t new_size = ntriples_parser->line_size ?
+                        ntriples_parser->line_size : RAPTOR_NTRIPLES_LINE_BUFFER_SIZE;
+
+      while(new_size < need)
+        new_size <<= 1;
+
+      buffer = RAPTOR_REALLOC(unsigned char*, ntriples_parser->line, new_size);
+      if(!buffer) {
+        raptor_parser_fatal_error(rdf_parser, "Out of memory");
+        return 1;
+      }
+
+      ntriples_parser->line = buffer;
+      ntriples_parser->line_size = new_size;
     }
 
-    memcpy(buffer, 
-           ntriples_parser->line + ntriples_parser->line_length - len,
-           len);
-    buffer[len] = '\0';
+    /* now write new stuff after any partial line */
+    memcpy(ntriples_parser->line + ntriples_parser->line_length, s, len);
+    ntriples_parser->line_length += len;
+    ntriples_parser->line[ntriples_parser->line_length] = '\0';
+  }
+
+  if(ntriples_parser->pool)
+    return raptor_ntriples_parse_chunk_parallel(rdf_parser, is_end);
+
+  buffer = ntriples_parser->line;
 
-    RAPTOR_FREE(char*, ntriples_parser->line);
 
-    ntriples_parser->line = buffer;
-    ntriples_parser->line_length -= ntriples_parser->offset;
-    ntriples_parser->offset = 0;
+#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
+  RAPTOR_DEBUG2("buffer now %ld bytes\n", ntriples_parser->line_length);
+#endif
 
+  if(raptor_ntriples_parse_lines(rdf_parser, NULL, &rdf_parser->locator,
+                                 &ntriples_parser->last_char,
+                                 buffer, ntriples_parser->line_length,
+                                 is_end, 1, &start))
+    return 1;
+
+  /* keep only the unparsed partial line, moved to the buffer start */
+  len = ntriples_parser->line_length - RAPTOR_BAD_CAST(size_t, start - buffer);
+  if(len && start != buffer) {
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-    RAPTOR_DEBUG3("buffer now '%s' (%ld bytes)\n", ntriples_parser->line, ntriples_parser->line_length);
-#endif    
+    RAPTOR_DEBUG3("collapsing buffer from %ld to %ld bytes\n", ntriples_parser->line_length, len);
+#endif
+    memmove(buffer, start, len);
   }
+  ntriples_parser->line_length = len;
+  if(buffer)
+    buffer[len] = '\0';
 
   /* exit now, no more input */
   if(is_end) {
-    if(ntriples_parser->offset != ntriples_parser->line_length) {
+    if(ntriples_parser->line_length) {
        raptor_parser_error(rdf_parser, "Junk at end of input.");
        return 1;
     }
@@ -571,12 +1233,39 @@ raptor_ntriples_parse_start(raptor_parser* rdf_parser)
 {
   raptor_locator *locator = &rdf_parser->locator;
   raptor_ntriples_parser_context *ntriples_parser = (raptor_ntriples_parser_context*)rdf_parser->context;
+  int threads;
 
   locator->line = 1;
   locator->column = 0;
   locator->byte = 0;
 
   ntriples_parser->last_char = '\0';
+  ntriples_parser->line_length = 0;
+
+  /* drop any earlier parse that did not reach the end */
+  raptor_ntriples_parallel_finish(rdf_parser);
+
+  if(RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_TERM_ARENA)) {
+    if(!ntriples_parser->arena) {
+      ntriples_parser->arena = raptor_new_arena(RAPTOR_NTRIPLES_ARENA_BLOCK_SIZE);
+      if(!ntriples_parser->arena) {
+        raptor_parser_fatal_error(rdf_parser, "Out of memory");
+        return 1;
+      }
+    }
+  } else if(ntriples_parser->arena) {
+    raptor_free_arena(ntriples_parser->arena);
+    ntriples_parser->arena = NULL;
+  }
+
+  threads = RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_PARALLEL_THREADS);
+  if(threads > 1) {
+    /* falls back to parsing in this thread if there are no threads */
+    ntriples_parser->pool = raptor_new_thread_pool(rdf_parser->world,
+                                                   threads);
+    ntriples_parser->segments_max = threads << 1;
+    ntriples_parser->unordered = RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_PARALLEL_UNORDERED);
+  }
 
   return 0;
 }
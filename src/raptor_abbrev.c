@@ -102,6 +102,24 @@ raptor_free_abbrev_node(raptor_abbrev_node* node)
 }
 
 
+/*
+ * raptor_abbrev_node_get_hash:
+ * @node: node
+ *
+ * INTERNAL - Get the hash of the node term, calculating it on first use
+ *
+ * Return value: raptor_term_hash() of the node term
+ */
+static uint64_t
+raptor_abbrev_node_get_hash(raptor_abbrev_node* node)
+{
+  if(!node->hash)
+    node->hash = raptor_term_hash(node->term);
+
+  return node->hash;
+}
+
+
 /**
  * raptor_abbrev_node_compare:
  * @node1: node 1
@@ -137,10 +155,51 @@ raptor_abbrev_node_compare(raptor_abbrev_node* node1, raptor_abbrev_node* node2)
 int
 raptor_abbrev_node_equals(raptor_abbrev_node* node1, raptor_abbrev_node* node2)
 {
+  /* nodes are shared so the same term is usually the same node */
+  if(node1 == node2)
+    return 1;
+
+  if(raptor_abbrev_node_get_hash(node1) != raptor_abbrev_node_get_hash(node2))
+    return 0;
+
   return raptor_term_equals(node1->term, node2->term);
 }
 
 
+/**
+ * raptor_abbrev_node_lookup_compare:
+ * @node1: node 1
+ * @node2: node 2
+ *
+ * INTERNAL - compare two raptor_abbrev_nodes by hash and then by term
+ *
+ * This is a strong ordering for the raptor_avltree of nodes used by
+ * raptor_abbrev_node_lookup() where only finding the node matters,
+ * not the order.  Most nodes differ in hash so the terms are rarely
+ * compared.
+ *
+ * Return value: <0, 0 or 1 if @node1 less than, equal or greater
+ * than @node2 respectively
+ */
+int
+raptor_abbrev_node_lookup_compare(raptor_abbrev_node* node1,
+                                  raptor_abbrev_node* node2)
+{
+  uint64_t hash1;
+  uint64_t hash2;
+
+  if(node1 == node2)
+    return 0;
+
+  hash1 = raptor_abbrev_node_get_hash(node1);
+  hash2 = raptor_abbrev_node_get_hash(node2);
+  if(hash1 != hash2)
+    return (hash1 < hash2) ? -1 : 1;
+
+  return raptor_term_compare(node1->term, node2->term);
+}
+
+
 /**
  * raptor_abbrev_node_lookup:
  * @nodes: Tree of nodes to search
@@ -149,6 +208,8 @@ raptor_abbrev_node_equals(raptor_abbrev_node* node1, raptor_abbrev_node* node2)
  * INTERNAL - Look in an avltree of nodes for a node described by parameters
  *   and if present create it, add it and return it
  *
+ * The @nodes tree must be ordered by raptor_abbrev_node_lookup_compare().
+ *
  * Return value: the node found/created or NULL on failure
  */
 raptor_abbrev_node* 
@@ -557,7 +618,6 @@ raptor_new_qname_from_resource(raptor_sequence* namespaces,
   size_t name_len = 1;
   unsigned char *uri_string;
   size_t uri_len;
-  unsigned char *p;
   raptor_uri *ns_uri;
   raptor_namespace *ns;
   raptor_qname *qname;
@@ -578,15 +638,9 @@ raptor_new_qname_from_resource(raptor_sequence* namespaces,
   
   uri_string = raptor_uri_as_counted_string(node->term->value.uri, &uri_len);
 
-  p= uri_string;
-  name_len = uri_len;
-  while(name_len >0) {
-    if(raptor_xml_name_check(p, name_len, 10)) {
-      name = p;
-      break;
-    }
-    p++; name_len--;
-  }
+  name_len = uri_len - raptor_xml_name_split_offset(uri_string, uri_len, 10);
+  if(name_len > 0)
+    name = uri_string + uri_len - name_len;
       
   if(!name || (name == uri_string))
     return NULL;
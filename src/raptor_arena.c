@@ -0,0 +1,385 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * raptor_arena.c - Raptor bump allocator for short lived terms
+ *
+ * Copyright (C) 2026, agent agent@local
+ *
+ * This package is Free Software and part of Redland http://librdf.org/
+ *
+ * It is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ *
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <raptor_config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+/* Raptor includes */
+#include "raptor2.h"
+#include "raptor_internal.h"
+
+
+/* alignment of every allocation */
+#define RAPTOR_ARENA_ALIGN (2 * sizeof(void*))
+
+#define RAPTOR_ARENA_ROUND(size) \
+  (((size) + RAPTOR_ARENA_ALIGN - 1) & ~(RAPTOR_ARENA_ALIGN - 1))
+
+
+typedef struct raptor_arena_block_s raptor_arena_block;
+
+struct raptor_arena_block_s {
+  raptor_arena_block* next;
+  /* bytes of data */
+  size_t size;
+  /* bytes of data allocated */
+  size_t used;
+};
+
+/* offset of block data from the start of the block */
+#define RAPTOR_ARENA_BLOCK_HEADER RAPTOR_ARENA_ROUND(sizeof(raptor_arena_block))
+
+
+struct raptor_arena_s {
+  /* blocks in the order they are used */
+  raptor_arena_block* blocks;
+  /* block allocations are currently made from */
+  raptor_arena_block* current;
+
+  size_t block_size;
+
+  /* URI references held by terms in the arena */
+  raptor_uri** uris;
+  int uris_count;
+  int uris_size;
+};
+
+
+/*
+ * raptor_new_arena:
+ * @block_size: size of memory blocks to allocate from
+ *
+ * INTERNAL - Constructor - create an arena allocator
+ *
+ * Memory allocated with raptor_arena_alloc() is only released all at
+ * once by raptor_arena_reset() or raptor_free_arena().
+ *
+ * Return value: new arena or NULL on failure
+ */
+raptor_arena*
+raptor_new_arena(size_t block_size)
+{
+  raptor_arena* arena;
+
+  arena = RAPTOR_CALLOC(raptor_arena*, 1, sizeof(*arena));
+  if(!arena)
+    return NULL;
+
+  arena->block_size = RAPTOR_ARENA_ROUND(block_size);
+
+  return arena;
+}
+
+
+/*
+ * raptor_free_arena:
+ * @arena: arena
+ *
+ * INTERNAL - Destructor - free an arena and everything allocated in it
+ */
+void
+raptor_free_arena(raptor_arena* arena)
+{
+  raptor_arena_block* block;
+
+  if(!arena)
+    return;
+
+  raptor_arena_reset(arena);
+
+  while((block = arena->blocks)) {
+    arena->blocks = block->next;
+    RAPTOR_FREE(raptor_arena_block, block);
+  }
+
+  if(arena->uris)
+    RAPTOR_FREE(raptor_uri**, arena->uris);
+
+  RAPTOR_FREE(raptor_arena, arena);
+}
+
+
+static raptor_arena_block*
+raptor_new_arena_block(size_t size)
+{
+  raptor_arena_block* block;
+
+  block = RAPTOR_MALLOC(raptor_arena_block*, RAPTOR_ARENA_BLOCK_HEADER + size);
+  if(!block)
+    return NULL;
+
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+
+  return block;
+}
+
+
+/*
+ * raptor_arena_alloc:
+ * @arena: arena
+ * @size: number of bytes
+ *
+ * INTERNAL - Allocate memory from an arena
+ *
+ * Return value: pointer to uninitialised memory or NULL on failure
+ */
+void*
+raptor_arena_alloc(raptor_arena* arena, size_t size)
+{
+  raptor_arena_block* block = arena->current;
+
+  size = RAPTOR_ARENA_ROUND(size);
+
+  if(!block || block->size - block->used < size) {
+    /* try the next block kept from before the last reset */
+    if(block && block->next && block->next->size >= size) {
+      block = block->next;
+      block->used = 0;
+    } else {
+      raptor_arena_block* new_block;
+      size_t block_size = arena->block_size;
+
+      if(size > block_size)
+        block_size = size;
+
+      new_block = raptor_new_arena_block(block_size);
+      if(!new_block)
+        return NULL;
+
+      if(block) {
+        new_block->next = block->next;
+        block->next = new_block;
+      } else {
+        new_block->next = arena->blocks;
+        arena->blocks = new_block;
+      }
+      block = new_block;
+    }
+
+    arena->current = block;
+  }
+
+  block->used += size;
+
+  return (unsigned char*)block + RAPTOR_ARENA_BLOCK_HEADER + block->used - size;
+}
+
+
+/*
+ * raptor_arena_add_uri:
+ * @arena: arena
+ * @uri: URI
+ *
+ * INTERNAL - Keep a reference to a URI until the arena is reset
+ *
+ * Return value: non-0 on failure
+ */
+int
+raptor_arena_add_uri(raptor_arena* arena, raptor_uri* uri)
+{
+  if(arena->uris_count == arena->uris_size) {
+    int new_size = arena->uris_size ? arena->uris_size << 1 : 8;
+    raptor_uri** uris;
+
+    uris = RAPTOR_REALLOC(raptor_uri**, arena->uris,
+                          RAPTOR_GOOD_CAST(size_t, new_size) * sizeof(*uris));
+    if(!uris)
+      return 1;
+
+    arena->uris = uris;
+    arena->uris_size = new_size;
+  }
+
+  arena->uris[arena->uris_count++] = raptor_uri_copy(uri);
+
+  return 0;
+}
+
+
+/*
+ * raptor_arena_reset:
+ * @arena: arena
+ *
+ * INTERNAL - Release everything allocated in an arena
+ *
+ * Blocks of the usual size are kept to be used again.
+ */
+void
+raptor_arena_reset(raptor_arena* arena)
+{
+  raptor_arena_block* block;
+  raptor_arena_block** prev_p;
+
+  while(arena->uris_count)
+    raptor_free_uri(arena->uris[--arena->uris_count]);
+
+  prev_p = &arena->blocks;
+  while((block = *prev_p)) {
+    if(block->size > arena->block_size) {
+      /* a single large allocation */
+      *prev_p = block->next;
+      RAPTOR_FREE(raptor_arena_block, block);
+      continue;
+    }
+
+    block->used = 0;
+    prev_p = &block->next;
+  }
+
+  arena->current = arena->blocks;
+}
+
+
+
+#ifdef STANDALONE
+
+/* one more prototype */
+int main(int argc, char *argv[]);
+
+
+int
+main(int argc, char *argv[])
+{
+  const char *program = raptor_basename(argv[0]);
+  raptor_world *world;
+  raptor_arena* arena;
+  raptor_uri* uri;
+  raptor_term* terms[3];
+  raptor_term* copies[3];
+  const char* expected[3] = {
+    "<http://example.org/>", "\"hello\"@en", "_:b1"
+  };
+  unsigned char* p;
+  int failures = 0;
+  int round;
+  int i;
+
+  world = raptor_new_world();
+  if(!world || raptor_world_open(world))
+    exit(1);
+
+  arena = raptor_new_arena(256);
+
+  for(round = 0; round < 3; round++) {
+    unsigned char* ptrs[100];
+
+    /* small allocations across several blocks plus one large one */
+    for(i = 0; i < 100; i++) {
+      size_t size = RAPTOR_GOOD_CAST(size_t, 1 + (i * 7) % 60);
+
+      ptrs[i] = (unsigned char*)raptor_arena_alloc(arena, size);
+      if(!ptrs[i] || ((size_t)ptrs[i] % RAPTOR_ARENA_ALIGN)) {
+        fprintf(stderr, "%s: raptor_arena_alloc() returned bad pointer %p\n",
+                program, RAPTOR_VOIDP(ptrs[i]));
+        failures++;
+        break;
+      }
+      memset(ptrs[i], i, size);
+    }
+
+    p = (unsigned char*)raptor_arena_alloc(arena, 1000);
+    memset(p, 0xff, 1000);
+
+    for(i = 0; i < 100; i++) {
+      size_t size = RAPTOR_GOOD_CAST(size_t, 1 + (i * 7) % 60);
+      size_t j;
+
+      for(j = 0; j < size; j++) {
+        if(ptrs[i][j] != i) {
+          fprintf(stderr, "%s: allocation %d overwritten in round %d\n",
+                  program, i, round);
+          failures++;
+          break;
+        }
+      }
+    }
+
+    raptor_arena_reset(arena);
+  }
+
+  /* terms in the arena are promoted to the heap when copied */
+  uri = raptor_new_uri(world, (const unsigned char*)"http://example.org/");
+  terms[0] = raptor_arena_new_term_from_uri(arena, world, uri);
+  terms[1] = raptor_arena_new_term_from_counted_literal(arena, world,
+                                                        (const unsigned char*)"hello", 5,
+                                                        NULL,
+                                                        (const unsigned char*)"en", 2);
+  terms[2] = raptor_arena_new_term_from_counted_blank(arena, world,
+                                                      (const unsigned char*)"b1", 2);
+  raptor_free_uri(uri);
+
+  for(i = 0; i < 3; i++) {
+    copies[i] = NULL;
+
+    if(!terms[i] || terms[i]->usage >= 0) {
+      fprintf(stderr, "%s: arena term %d not created\n", program, i);
+      failures++;
+      continue;
+    }
+
+    copies[i] = raptor_term_copy(terms[i]);
+    if(!copies[i] || copies[i] == terms[i] || copies[i]->usage != 1 ||
+       !raptor_term_equals(copies[i], terms[i])) {
+      fprintf(stderr, "%s: arena term %d copy is not a heap term\n",
+              program, i);
+      failures++;
+    }
+
+    /* does nothing to an arena term */
+    raptor_free_term(terms[i]);
+  }
+
+  raptor_arena_reset(arena);
+
+  for(i = 0; i < 3; i++) {
+    if(!copies[i])
+      continue;
+
+    p = raptor_term_to_string(copies[i]);
+    if(!p || strcmp((const char*)p, expected[i])) {
+      fprintf(stderr, "%s: heap copy of arena term %d is '%s' expected '%s'\n",
+              program, i, p ? (const char*)p : "NULL", expected[i]);
+      failures++;
+    }
+    if(p)
+      raptor_free_memory(p);
+    raptor_free_term(copies[i]);
+  }
+
+  raptor_free_arena(arena);
+  raptor_free_world(world);
+
+  return failures;
+}
+
+#endif
@@ -0,0 +1,1526 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * raptor_binary.c - Raptor binary RDF parser and serializer
+ *
+ * Copyright (C) 2026, agent agent@local
+ *
+ * This package is Free Software and part of Redland http://librdf.org/
+ *
+ * It is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ *
+ * A compact length-prefixed format for passing triples and quads
+ * between programs without escaping or re-parsing terms.
+ *
+ * A stream is the header RAPTOR_BINARY_MAGIC followed by the format
+ * version byte and then a sequence of records, each starting with a
+ * record type byte:
+ *
+ *   TRIPLE     subject predicate object
+ *   QUAD       subject predicate object graph
+ *   NAMESPACE  prefix-string uri-string  (empty strings for none)
+ *   RESET      forget all dictionary terms
+ *
+ * Numbers are unsigned LEB128 varints and strings are a varint byte
+ * length followed by the UTF-8 bytes.
+ *
+ * A term is a varint dictionary ID counting from 1 for a term seen
+ * earlier in the stream, or 0 followed by a term kind byte and the
+ * term value:
+ *
+ *   URI            uri-string
+ *   BLANK          id-string
+ *   LITERAL        string
+ *   LANG_LITERAL   string language-string
+ *   TYPED_LITERAL  string datatype-term
+ *
+ * A URI or blank node term value is given the next ID.  Literals are
+ * mostly distinct so they are always written in full and get no ID;
+ * the datatype of a typed literal is a URI term.  The writer emits
+ * RESET when the dictionary reaches RAPTOR_BINARY_DICTIONARY_SIZE
+ * terms so both sides use bounded memory.
+ *
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <raptor_config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+/* Raptor includes */
+#include "raptor2.h"
+#include "raptor_internal.h"
+
+
+#define RAPTOR_BINARY_MAGIC "RDFB"
+#define RAPTOR_BINARY_MAGIC_LEN 4
+#define RAPTOR_BINARY_VERSION 1
+#define RAPTOR_BINARY_HEADER_LEN (RAPTOR_BINARY_MAGIC_LEN + 1)
+
+/* record types */
+#define RAPTOR_BINARY_RECORD_TRIPLE    1
+#define RAPTOR_BINARY_RECORD_QUAD      2
+#define RAPTOR_BINARY_RECORD_NAMESPACE 3
+#define RAPTOR_BINARY_RECORD_RESET     4
+
+/* term kinds */
+#define RAPTOR_BINARY_TERM_URI           1
+#define RAPTOR_BINARY_TERM_BLANK         2
+#define RAPTOR_BINARY_TERM_LITERAL       3
+#define RAPTOR_BINARY_TERM_LANG_LITERAL  4
+#define RAPTOR_BINARY_TERM_TYPED_LITERAL 5
+
+/* maximum number of terms in the dictionary before a reset */
+#define RAPTOR_BINARY_DICTIONARY_SIZE (1 << 18)
+
+/* most terms one statement can add to the dictionary: 4 terms or
+ * 3 terms and a literal datatype
+ */
+#define RAPTOR_BINARY_STATEMENT_MAX_TERMS 4
+
+/* bytes in the largest varint */
+#define RAPTOR_BINARY_VARINT_MAX_LEN ((sizeof(size_t) * 8 + 6) / 7)
+
+
+#ifdef RAPTOR_PARSER_BINARY
+
+/* size of the first buffer used for records split across chunks */
+#define RAPTOR_BINARY_BUFFER_SIZE 4096
+
+/*
+ * Binary RDF parser object
+ */
+struct raptor_binary_parser_context_s {
+  /* unparsed bytes of a record split across chunks */
+  unsigned char *buffer;
+  size_t buffer_length;
+  size_t buffer_size;
+
+  /* non-0 once the stream header has been checked */
+  int header_read;
+
+  /* dictionary: term with ID i is at terms[i - 1] */
+  raptor_term** terms;
+  int terms_count;
+  int terms_size;
+
+  /* literals in the current record */
+  raptor_term* literals[RAPTOR_BINARY_STATEMENT_MAX_TERMS];
+  int literals_count;
+
+  /* namespaces declared by the stream */
+  raptor_namespace_stack namespaces;
+};
+
+typedef struct raptor_binary_parser_context_s raptor_binary_parser_context;
+
+
+static int
+raptor_binary_parse_init(raptor_parser* rdf_parser, const char *name)
+{
+  raptor_binary_parser_context* binary_parser;
+  binary_parser = (raptor_binary_parser_context*)rdf_parser->context;
+
+  if(raptor_namespaces_init(rdf_parser->world, &binary_parser->namespaces, 0))
+    return 1;
+
+  return 0;
+}
+
+
+/*
+ * raptor_binary_parse_reset_terms:
+ * @binary_parser: binary parser context
+ * @count: number of terms to keep
+ *
+ * INTERNAL - Forget dictionary terms after the first @count
+ */
+static void
+raptor_binary_parse_reset_terms(raptor_binary_parser_context* binary_parser,
+                                int count)
+{
+  while(binary_parser->terms_count > count)
+    raptor_free_term(binary_parser->terms[--binary_parser->terms_count]);
+}
+
+
+static void
+raptor_binary_parse_terminate(raptor_parser* rdf_parser)
+{
+  raptor_binary_parser_context* binary_parser;
+  binary_parser = (raptor_binary_parser_context*)rdf_parser->context;
+
+  raptor_binary_parse_reset_terms(binary_parser, 0);
+  if(binary_parser->terms)
+    RAPTOR_FREE(raptor_term**, binary_parser->terms);
+
+  if(binary_parser->buffer)
+    RAPTOR_FREE(cdata, binary_parser->buffer);
+
+  raptor_namespaces_clear(&binary_parser->namespaces);
+}
+
+
+/*
+ * raptor_binary_read_varint:
+ * @p_p: pointer to read pointer
+ * @end: end of input
+ * @value_p: pointer to store value
+ *
+ * INTERNAL - Read an unsigned LEB128 varint
+ *
+ * Return value: 0 on success, <0 if more input is needed, >0 if the
+ * varint is too large
+ */
+static int
+raptor_binary_read_varint(const unsigned char** p_p, const unsigned char* end,
+                          size_t* value_p)
+{
+  const unsigned char* p = *p_p;
+  size_t value = 0;
+  unsigned int shift = 0;
+
+  while(1) {
+    unsigned char c;
+
+    if(p == end)
+      return -1;
+
+    if(shift >= sizeof(size_t) * 8)
+      return 1;
+
+    c = *p++;
+    value |= RAPTOR_GOOD_CAST(size_t, c & 0x7f) << shift;
+    if(!(c & 0x80))
+      break;
+    shift += 7;
+  }
+
+  *p_p = p;
+  *value_p = value;
+  return 0;
+}
+
+
+/*
+ * raptor_binary_read_string:
+ * @p_p: pointer to read pointer
+ * @end: end of input
+ * @string_p: pointer to store start of string
+ * @length_p: pointer to store string length
+ *
+ * INTERNAL - Read a counted string
+ *
+ * Return value: 0 on success, <0 if more input is needed, >0 on error
+ */
+static int
+raptor_binary_read_string(const unsigned char** p_p, const unsigned char* end,
+                          const unsigned char** string_p, size_t* length_p)
+{
+  const unsigned char* p = *p_p;
+  size_t length;
+  int rc;
+
+  rc = raptor_binary_read_varint(&p, end, &length);
+  if(rc)
+    return rc;
+
+  if(RAPTOR_BAD_CAST(size_t, end - p) < length)
+    return -1;
+
+  *string_p = p;
+  *length_p = length;
+  *p_p = p + length;
+  return 0;
+}
+
+
+/*
+ * raptor_binary_parse_term:
+ * @rdf_parser: parser
+ * @p_p: pointer to read pointer
+ * @end: end of input
+ * @is_datatype: non-0 if the term must be a literal datatype URI
+ * @term_p: pointer to store the term (shared with the dictionary)
+ *
+ * INTERNAL - Read a term reference or definition
+ *
+ * Literals are kept until the end of the current record.
+ *
+ * Return value: 0 on success, <0 if more input is needed, >0 on error
+ */
+static int
+raptor_binary_parse_term(raptor_parser* rdf_parser,
+                         const unsigned char** p_p, const unsigned char* end,
+                         int is_datatype, raptor_term** term_p)
+{
+  raptor_binary_parser_context* binary_parser;
+  const unsigned char* p = *p_p;
+  const unsigned char* string;
+  size_t length;
+  const unsigned char* language;
+  size_t language_length;
+  unsigned char language_buffer[256];
+  raptor_term* datatype;
+  raptor_term* term = NULL;
+  size_t id;
+  int kind;
+  int rc;
+
+  binary_parser = (raptor_binary_parser_context*)rdf_parser->context;
+
+  rc = raptor_binary_read_varint(&p, end, &id);
+  if(rc) {
+    if(rc > 0)
+      raptor_parser_error(rdf_parser, "Bad term ID");
+    return rc;
+  }
+
+  if(id) {
+    if(id > RAPTOR_GOOD_CAST(size_t, binary_parser->terms_count)) {
+      raptor_parser_error(rdf_parser, "Unknown term ID %lu",
+                          RAPTOR_GOOD_CAST(unsigned long, id));
+      return 1;
+    }
+
+    *term_p = binary_parser->terms[id - 1];
+    *p_p = p;
+    return 0;
+  }
+
+  if(p == end)
+    return -1;
+  kind = *p++;
+
+  if(is_datatype && kind != RAPTOR_BINARY_TERM_URI) {
+    raptor_parser_error(rdf_parser, "Literal datatype is not a URI");
+    return 1;
+  }
+
+  rc = raptor_binary_read_string(&p, end, &string, &length);
+  if(rc) {
+    if(rc > 0)
+      raptor_parser_error(rdf_parser, "Bad term string length");
+    return rc;
+  }
+
+  switch(kind) {
+    case RAPTOR_BINARY_TERM_URI:
+      term = raptor_new_term_from_counted_uri_string(rdf_parser->world,
+                                                     string, length);
+      break;
+
+    case RAPTOR_BINARY_TERM_BLANK:
+      if(!length) {
+        raptor_parser_error(rdf_parser, "Empty blank node ID");
+        return 1;
+      }
+      term = raptor_new_term_from_counted_blank(rdf_parser->world,
+                                                string, length);
+      break;
+
+    case RAPTOR_BINARY_TERM_LITERAL:
+      term = raptor_new_term_from_counted_literal(rdf_parser->world,
+                                                  string, length,
+                                                  NULL, NULL, 0);
+      break;
+
+    case RAPTOR_BINARY_TERM_LANG_LITERAL:
+      rc = raptor_binary_read_string(&p, end, &language, &language_length);
+      if(rc) {
+        if(rc > 0)
+          raptor_parser_error(rdf_parser, "Bad language length");
+        return rc;
+      }
+      if(!language_length || language_length >= sizeof(language_buffer)) {
+        raptor_parser_error(rdf_parser, "Bad language length");
+        return 1;
+      }
+      /* the constructor needs a '\0' terminated language */
+      memcpy(language_buffer, language, language_length);
+      language_buffer[language_length] = '\0';
+      term = raptor_new_term_from_counted_literal(rdf_parser->world,
+                                                  string, length,
+                                                  NULL, language_buffer,
+                                                  RAPTOR_GOOD_CAST(unsigned char, language_length));
+      break;
+
+    case RAPTOR_BINARY_TERM_TYPED_LITERAL:
+      rc = raptor_binary_parse_term(rdf_parser, &p, end, 1, &datatype);
+      if(rc)
+        return rc;
+      if(datatype->type != RAPTOR_TERM_TYPE_URI) {
+        raptor_parser_error(rdf_parser, "Literal datatype is not a URI");
+        return 1;
+      }
+      term = raptor_new_term_from_counted_literal(rdf_parser->world,
+                                                  string, length,
+                                                  datatype->value.uri,
+                                                  NULL, 0);
+      break;
+
+    default:
+      raptor_parser_error(rdf_parser, "Unknown term kind %d", kind);
+      return 1;
+  }
+
+  if(!term) {
+    raptor_parser_fatal_error(rdf_parser, "Out of memory");
+    return 1;
+  }
+
+  if(term->type == RAPTOR_TERM_TYPE_LITERAL) {
+    /* at most one literal per term of a record */
+    binary_parser->literals[binary_parser->literals_count++] = term;
+    *term_p = term;
+    *p_p = p;
+    return 0;
+  }
+
+  if(binary_parser->terms_count == binary_parser->terms_size) {
+    int new_size = binary_parser->terms_size ? binary_parser->terms_size << 1 : 1024;
+    raptor_term** terms;
+
+    terms = RAPTOR_REALLOC(raptor_term**, binary_parser->terms,
+                           RAPTOR_GOOD_CAST(size_t, new_size) * sizeof(*terms));
+    if(!terms) {
+      raptor_free_term(term);
+      raptor_parser_fatal_error(rdf_parser, "Out of memory");
+      return 1;
+    }
+
+    binary_parser->terms = terms;
+    binary_parser->terms_size = new_size;
+  }
+  binary_parser->terms[binary_parser->terms_count++] = term;
+
+  *term_p = term;
+  *p_p = p;
+  return 0;
+}
+
+
+/*
+ * raptor_binary_parse_namespace:
+ * @rdf_parser: parser
+ * @p_p: pointer to read pointer
+ * @end: end of input
+ *
+ * INTERNAL - Read a namespace record and report the namespace
+ *
+ * Return value: 0 on success, <0 if more input is needed, >0 on error
+ */
+static int
+raptor_binary_parse_namespace(raptor_parser* rdf_parser,
+                              const unsigned char** p_p,
+                              const unsigned char* end)
+{
+  raptor_binary_parser_context* binary_parser;
+  const unsigned char* p = *p_p;
+  const unsigned char* prefix;
+  size_t prefix_length;
+  const unsigned char* uri_string;
+  size_t uri_length;
+  unsigned char* prefix_copy = NULL;
+  raptor_uri* uri = NULL;
+  raptor_namespace* ns;
+  int rc;
+
+  binary_parser = (raptor_binary_parser_context*)rdf_parser->context;
+
+  rc = raptor_binary_read_string(&p, end, &prefix, &prefix_length);
+  if(!rc)
+    rc = raptor_binary_read_string(&p, end, &uri_string, &uri_length);
+  if(rc) {
+    if(rc > 0)
+      raptor_parser_error(rdf_parser, "Bad namespace string length");
+    return rc;
+  }
+  *p_p = p;
+
+  if(prefix_length) {
+    prefix_copy = RAPTOR_MALLOC(unsigned char*, prefix_length + 1);
+    if(!prefix_copy)
+      goto oom;
+    memcpy(prefix_copy, prefix, prefix_length);
+    prefix_copy[prefix_length] = '\0';
+  }
+
+  if(uri_length) {
+    uri = raptor_new_uri_from_counted_string(rdf_parser->world, uri_string,
+                                             uri_length);
+    if(!uri)
+      goto oom;
+  }
+
+  ns = raptor_new_namespace_from_uri(&binary_parser->namespaces, prefix_copy,
+                                     uri, 0);
+  if(uri)
+    raptor_free_uri(uri);
+  if(prefix_copy)
+    RAPTOR_FREE(char*, prefix_copy);
+
+  if(ns) {
+    raptor_namespaces_start_namespace(&binary_parser->namespaces, ns);
+    raptor_parser_start_namespace(rdf_parser, ns);
+  }
+
+  return 0;
+
+  oom:
+  if(prefix_copy)
+    RAPTOR_FREE(char*, prefix_copy);
+  raptor_parser_fatal_error(rdf_parser, "Out of memory");
+  return 1;
+}
+
+
+/*
+ * raptor_binary_parse_record:
+ * @rdf_parser: parser
+ * @p_p: pointer to read pointer
+ * @end: end of input
+ *
+ * INTERNAL - Read one record and generate any statement
+ *
+ * If the record is incomplete, terms it defined are removed from the
+ * dictionary so that it can be read again when there is more input.
+ *
+ * Return value: 0 on success, <0 if more input is needed, >0 on error
+ */
+static int
+raptor_binary_parse_record(raptor_parser* rdf_parser,
+                           const unsigned char** p_p, const unsigned char* end)
+{
+  raptor_binary_parser_context* binary_parser;
+  raptor_statement *statement = &rdf_parser->statement;
+  const unsigned char* p = *p_p;
+  int terms_count;
+  int type;
+  int rc = 0;
+
+  binary_parser = (raptor_binary_parser_context*)rdf_parser->context;
+  terms_count = binary_parser->terms_count;
+
+  type = *p++;
+  switch(type) {
+    case RAPTOR_BINARY_RECORD_TRIPLE:
+    case RAPTOR_BINARY_RECORD_QUAD:
+      statement->graph = NULL;
+      rc = raptor_binary_parse_term(rdf_parser, &p, end, 0,
+                                    &statement->subject);
+      if(!rc)
+        rc = raptor_binary_parse_term(rdf_parser, &p, end, 0,
+                                      &statement->predicate);
+      if(!rc)
+        rc = raptor_binary_parse_term(rdf_parser, &p, end, 0,
+                                      &statement->object);
+      if(!rc && type == RAPTOR_BINARY_RECORD_QUAD)
+        rc = raptor_binary_parse_term(rdf_parser, &p, end, 0,
+                                      &statement->graph);
+      if(rc)
+        break;
+
+      if(statement->subject->type == RAPTOR_TERM_TYPE_LITERAL ||
+         statement->predicate->type != RAPTOR_TERM_TYPE_URI ||
+         (statement->graph &&
+          statement->graph->type == RAPTOR_TERM_TYPE_LITERAL)) {
+        raptor_parser_error(rdf_parser, "Bad term type in statement");
+        rc = 1;
+        break;
+      }
+
+      if(!rdf_parser->emitted_default_graph) {
+        raptor_parser_start_graph(rdf_parser, NULL, 0);
+        rdf_parser->emitted_default_graph++;
+      }
+
+      /* the terms are owned by the dictionary or the record */
+      if(rdf_parser->statement_handler)
+        (*rdf_parser->statement_handler)(rdf_parser->user_data, statement);
+      break;
+
+    case RAPTOR_BINARY_RECORD_NAMESPACE:
+      rc = raptor_binary_parse_namespace(rdf_parser, &p, end);
+      break;
+
+    case RAPTOR_BINARY_RECORD_RESET:
+      raptor_binary_parse_reset_terms(binary_parser, 0);
+      terms_count = 0;
+      break;
+
+    default:
+      raptor_parser_error(rdf_parser, "Unknown record type %d", type);
+      rc = 1;
+      break;
+  }
+
+  statement->subject = NULL;
+  statement->predicate = NULL;
+  statement->object = NULL;
+  statement->graph = NULL;
+
+  while(binary_parser->literals_count)
+    raptor_free_term(binary_parser->literals[--binary_parser->literals_count]);
+
+  if(rc < 0)
+    raptor_binary_parse_reset_terms(binary_parser, terms_count);
+  else if(!rc)
+    *p_p = p;
+
+  return rc;
+}
+
+
+/*
+ * raptor_binary_parse_records:
+ * @rdf_parser: parser
+ * @buffer: input
+ * @len: length of input
+ * @used_p: pointer to store number of bytes of complete records read
+ *
+ * INTERNAL - Read as many complete records as possible
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_binary_parse_records(raptor_parser* rdf_parser,
+                            const unsigned char* buffer, size_t len,
+                            size_t* used_p)
+{
+  raptor_binary_parser_context* binary_parser;
+  const unsigned char* p = buffer;
+  const unsigned char* end = buffer + len;
+  int rc = 0;
+
+  binary_parser = (raptor_binary_parser_context*)rdf_parser->context;
+
+  if(!binary_parser->header_read) {
+    if(len < RAPTOR_BINARY_HEADER_LEN) {
+      *used_p = 0;
+      return 0;
+    }
+
+    if(memcmp(p, RAPTOR_BINARY_MAGIC, RAPTOR_BINARY_MAGIC_LEN)) {
+      raptor_parser_error(rdf_parser, "Not a binary RDF stream");
+      return 1;
+    }
+    if(p[RAPTOR_BINARY_MAGIC_LEN] != RAPTOR_BINARY_VERSION) {
+      raptor_parser_error(rdf_parser, "Unsupported binary RDF version %d",
+                          p[RAPTOR_BINARY_MAGIC_LEN]);
+      return 1;
+    }
+
+    p += RAPTOR_BINARY_HEADER_LEN;
+    binary_parser->header_read = 1;
+  }
+
+  while(p < end && !rdf_parser->failed) {
+    rc = raptor_binary_parse_record(rdf_parser, &p, end);
+    if(rc)
+      break;
+  }
+
+  rdf_parser->locator.byte += RAPTOR_BAD_CAST(int, p - buffer);
+  *used_p = RAPTOR_BAD_CAST(size_t, p - buffer);
+
+  return rc > 0;
+}
+
+
+static int
+raptor_binary_parse_chunk(raptor_parser* rdf_parser,
+                          const unsigned char *s, size_t len,
+                          int is_end)
+{
+  raptor_binary_parser_context* binary_parser;
+  size_t used = 0;
+
+  binary_parser = (raptor_binary_parser_context*)rdf_parser->context;
+
+  if(!binary_parser->buffer_length) {
+    /* read records directly from the chunk */
+    if(len && raptor_binary_parse_records(rdf_parser, s, len, &used))
+      return 1;
+
+    s += used;
+    len -= used;
+  }
+
+  if(len) {
+    size_t need = binary_parser->buffer_length + len;
+
+    if(need > binary_parser->buffer_size) {
+      size_t new_size = binary_parser->buffer_size ?
+                        binary_parser->buffer_size : RAPTOR_BINARY_BUFFER_SIZE;
+      unsigned char *buffer;
+
+      while(new_size < need)
+        new_size <<= 1;
+
+      buffer = RAPTOR_REALLOC(unsigned char*, binary_parser->buffer, new_size);
+      if(!buffer) {
+        raptor_parser_fatal_error(rdf_parser, "Out of memory");
+        return 1;
+      }
+
+      binary_parser->buffer = buffer;
+      binary_parser->buffer_size = new_size;
+    }
+
+    memcpy(binary_parser->buffer + binary_parser->buffer_length, s, len);
+    binary_parser->buffer_length += len;
+
+    /* a chunk read directly only leaves a partial record so only
+     * look again if bytes were already waiting
+     */
+    if(binary_parser->buffer_length > len || used == 0) {
+      if(raptor_binary_parse_records(rdf_parser, binary_parser->buffer,
+                                     binary_parser->buffer_length, &used))
+        return 1;
+
+      binary_parser->buffer_length -= used;
+      if(binary_parser->buffer_length && used)
+        memmove(binary_parser->buffer, binary_parser->buffer + used,
+                binary_parser->buffer_length);
+    }
+  }
+
+  if(is_end) {
+    if(binary_parser->buffer_length || !binary_parser->header_read) {
+      raptor_parser_error(rdf_parser, "Truncated binary RDF stream");
+      return 1;
+    }
+
+    if(rdf_parser->emitted_default_graph) {
+      raptor_parser_end_graph(rdf_parser, NULL, 0);
+      rdf_parser->emitted_default_graph--;
+    }
+  }
+
+  return 0;
+}
+
+
+static int
+raptor_binary_parse_start(raptor_parser* rdf_parser)
+{
+  raptor_binary_parser_context* binary_parser;
+  raptor_locator *locator = &rdf_parser->locator;
+
+  binary_parser = (raptor_binary_parser_context*)rdf_parser->context;
+
+  locator->line = -1;
+  locator->column = -1;
+  locator->byte = 0;
+
+  binary_parser->header_read = 0;
+  binary_parser->buffer_length = 0;
+  raptor_binary_parse_reset_terms(binary_parser, 0);
+
+  return 0;
+}
+
+
+static int
+raptor_binary_parse_recognise_syntax(raptor_parser_factory* factory,
+                                     const unsigned char *buffer, size_t len,
+                                     const unsigned char *identifier,
+                                     const unsigned char *suffix,
+                                     const char *mime_type)
+{
+  int score = 0;
+
+  if(suffix && !strcmp((const char*)suffix, "rdfb"))
+    score = 7;
+
+  if(buffer && len >= RAPTOR_BINARY_MAGIC_LEN &&
+     !memcmp(buffer, RAPTOR_BINARY_MAGIC, RAPTOR_BINARY_MAGIC_LEN))
+    score += 10;
+
+  return score;
+}
+
+
+static const char* const binary_parser_names[2] = { "binary", NULL };
+
+#define BINARY_PARSER_TYPES_COUNT 1
+static const raptor_type_q binary_parser_types[BINARY_PARSER_TYPES_COUNT + 1] = {
+  { "application/x-raptor-binary-rdf", 31, 10},
+  { NULL, 0, 0}
+};
+
+static int
+raptor_binary_parser_register_factory(raptor_parser_factory *factory)
+{
+  factory->desc.names = binary_parser_names;
+
+  factory->desc.mime_types = binary_parser_types;
+
+  factory->desc.label = "Raptor binary RDF";
+  factory->desc.uri_strings = NULL;
+
+  factory->desc.flags = 0;
+
+  factory->context_length     = sizeof(raptor_binary_parser_context);
+
+  factory->init      = raptor_binary_parse_init;
+  factory->terminate = raptor_binary_parse_terminate;
+  factory->start     = raptor_binary_parse_start;
+  factory->chunk     = raptor_binary_parse_chunk;
+  factory->recognise_syntax = raptor_binary_parse_recognise_syntax;
+
+  return 0;
+}
+
+
+int
+raptor_init_parser_binary(raptor_world* world)
+{
+  return !raptor_world_register_parser_factory(world,
+                                               &raptor_binary_parser_register_factory);
+}
+
+#endif
+
+
+#ifdef RAPTOR_SERIALIZER_BINARY
+
+#define RAPTOR_BINARY_TABLE_INITIAL_SIZE 1024
+
+typedef struct {
+  raptor_term* term;
+  /* URI of a URI term, to match without reading the term */
+  raptor_uri* uri;
+  unsigned int hash;
+  unsigned int id;
+} raptor_binary_dictionary_entry;
+
+
+/*
+ * Binary RDF serializer object
+ */
+typedef struct {
+  /* dictionary: open addressing hash table of terms to IDs */
+  raptor_binary_dictionary_entry* table;
+  unsigned int table_size;
+  unsigned int table_count;
+
+  /* namespaces declared before the serializing started */
+  raptor_namespace_stack *nstack;
+  raptor_sequence *namespaces;
+
+  /* non-0 after the header is written */
+  int started;
+} raptor_binary_serializer_context;
+
+
+static int
+raptor_binary_serialize_init(raptor_serializer* serializer, const char *name)
+{
+  raptor_binary_serializer_context* context;
+  context = (raptor_binary_serializer_context*)serializer->context;
+
+  context->nstack = raptor_new_namespaces(serializer->world, 0);
+  if(!context->nstack)
+    return 1;
+
+  context->namespaces = raptor_new_sequence((raptor_data_free_handler)raptor_free_namespace, NULL);
+  if(!context->namespaces)
+    return 1;
+
+  return 0;
+}
+
+
+/*
+ * raptor_binary_serialize_reset_terms:
+ * @context: binary serializer context
+ *
+ * INTERNAL - Empty the dictionary
+ */
+static void
+raptor_binary_serialize_reset_terms(raptor_binary_serializer_context* context)
+{
+  unsigned int i;
+
+  if(!context->table_count)
+    return;
+
+  for(i = 0; i < context->table_size; i++) {
+    if(context->table[i].term) {
+      raptor_free_term(context->table[i].term);
+      context->table[i].term = NULL;
+    }
+  }
+
+  context->table_count = 0;
+}
+
+
+static void
+raptor_binary_serialize_terminate(raptor_serializer* serializer)
+{
+  raptor_binary_serializer_context* context;
+  context = (raptor_binary_serializer_context*)serializer->context;
+
+  if(context->table) {
+    raptor_binary_serialize_reset_terms(context);
+    RAPTOR_FREE(raptor_binary_dictionary_entry*, context->table);
+    context->table = NULL;
+  }
+
+  if(context->namespaces) {
+    raptor_free_sequence(context->namespaces);
+    context->namespaces = NULL;
+  }
+
+  if(context->nstack) {
+    raptor_free_namespaces(context->nstack);
+    context->nstack = NULL;
+  }
+}
+
+
+static void
+raptor_binary_write_varint(size_t value, raptor_iostream* iostr)
+{
+  unsigned char buf[RAPTOR_BINARY_VARINT_MAX_LEN];
+  size_t len = 0;
+
+  while(value >= 0x80) {
+    buf[len++] = RAPTOR_GOOD_CAST(unsigned char, (value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  buf[len++] = RAPTOR_GOOD_CAST(unsigned char, value);
+
+  raptor_iostream_write_bytes(buf, 1, len, iostr);
+}
+
+
+static void
+raptor_binary_write_string(const unsigned char* string, size_t length,
+                           raptor_iostream* iostr)
+{
+  raptor_binary_write_varint(length, iostr);
+  if(length)
+    raptor_iostream_write_bytes(string, 1, length, iostr);
+}
+
+
+static void
+raptor_binary_write_namespace(raptor_namespace* nspace, raptor_iostream* iostr)
+{
+  const unsigned char* prefix;
+  raptor_uri* uri;
+  const unsigned char* uri_string = NULL;
+  size_t uri_length = 0;
+
+  prefix = raptor_namespace_get_prefix(nspace);
+  uri = raptor_namespace_get_uri(nspace);
+  if(uri)
+    uri_string = raptor_uri_as_counted_string(uri, &uri_length);
+
+  raptor_iostream_write_byte(RAPTOR_BINARY_RECORD_NAMESPACE, iostr);
+  raptor_binary_write_string(prefix, prefix ? strlen((const char*)prefix) : 0,
+                             iostr);
+  raptor_binary_write_string(uri_string, uri_length, iostr);
+}
+
+
+/* add a namespace */
+static int
+raptor_binary_serialize_declare_namespace_from_namespace(raptor_serializer* serializer,
+                                                         raptor_namespace *nspace)
+{
+  raptor_binary_serializer_context* context;
+  context = (raptor_binary_serializer_context*)serializer->context;
+
+  if(context->started) {
+    raptor_binary_write_namespace(nspace, serializer->iostream);
+    return 0;
+  }
+
+  nspace = raptor_new_namespace_from_uri(context->nstack,
+                                         raptor_namespace_get_prefix(nspace),
+                                         raptor_namespace_get_uri(nspace), 0);
+  if(!nspace)
+    return 1;
+
+  return raptor_sequence_push(context->namespaces, nspace);
+}
+
+
+/* add a namespace */
+static int
+raptor_binary_serialize_declare_namespace(raptor_serializer* serializer,
+                                          raptor_uri *uri,
+                                          const unsigned char *prefix)
+{
+  raptor_binary_serializer_context* context;
+  raptor_namespace *ns;
+  int rc;
+
+  context = (raptor_binary_serializer_context*)serializer->context;
+
+  ns = raptor_new_namespace_from_uri(context->nstack, prefix, uri, 0);
+  if(!ns)
+    return 1;
+
+  rc = raptor_binary_serialize_declare_namespace_from_namespace(serializer, ns);
+  raptor_free_namespace(ns);
+
+  return rc;
+}
+
+
+/* start a serialize */
+static int
+raptor_binary_serialize_start(raptor_serializer* serializer)
+{
+  raptor_binary_serializer_context* context;
+  raptor_iostream* iostr = serializer->iostream;
+  raptor_namespace* ns;
+
+  context = (raptor_binary_serializer_context*)serializer->context;
+
+  raptor_binary_serialize_reset_terms(context);
+
+  raptor_iostream_write_bytes(RAPTOR_BINARY_MAGIC, 1, RAPTOR_BINARY_MAGIC_LEN,
+                              iostr);
+  raptor_iostream_write_byte(RAPTOR_BINARY_VERSION, iostr);
+
+  while((ns = (raptor_namespace*)raptor_sequence_unshift(context->namespaces))) {
+    raptor_binary_write_namespace(ns, iostr);
+    raptor_free_namespace(ns);
+  }
+
+  context->started = 1;
+
+  return 0;
+}
+
+
+/*
+ * raptor_binary_serialize_grow_table:
+ * @context: binary serializer context
+ *
+ * INTERNAL - Double the size of the dictionary hash table
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_binary_serialize_grow_table(raptor_binary_serializer_context* context)
+{
+  raptor_binary_dictionary_entry* old_table = context->table;
+  unsigned int old_size = context->table_size;
+  unsigned int new_size;
+  unsigned int mask;
+  raptor_binary_dictionary_entry* new_table;
+  unsigned int i;
+
+  new_size = old_size ? old_size << 1 : RAPTOR_BINARY_TABLE_INITIAL_SIZE;
+  mask = new_size - 1;
+
+  new_table = RAPTOR_CALLOC(raptor_binary_dictionary_entry*, new_size,
+                            sizeof(*new_table));
+  if(!new_table)
+    return 1;
+
+  for(i = 0; i < old_size; i++) {
+    unsigned int j;
+
+    if(!old_table[i].term)
+      continue;
+
+    /* all entries are distinct so no need to compare terms */
+    j = old_table[i].hash & mask;
+    while(new_table[j].term)
+      j = (j + 1) & mask;
+    new_table[j] = old_table[i];
+  }
+
+  if(old_table)
+    RAPTOR_FREE(raptor_binary_dictionary_entry*, old_table);
+  context->table = new_table;
+  context->table_size = new_size;
+
+  return 0;
+}
+
+
+/*
+ * raptor_binary_term_key:
+ * @term: URI or blank node term
+ *
+ * INTERNAL - Get the dictionary hash of a term
+ *
+ * URIs are interned so they are keyed on the #raptor_uri pointer
+ * without hashing the URI string.
+ *
+ * Return value: hash
+ */
+static unsigned int
+raptor_binary_term_key(raptor_term* term)
+{
+  uint64_t hash;
+
+  if(term->type != RAPTOR_TERM_TYPE_URI)
+    hash = raptor_term_hash(term);
+  else {
+    hash = RAPTOR_GOOD_CAST(uint64_t, RAPTOR_GOOD_CAST(size_t, term->value.uri) >> 4);
+    hash *= UINT64_C(0x9E3779B97F4A7C15);
+  }
+
+  return RAPTOR_GOOD_CAST(unsigned int, hash ^ (hash >> 32));
+}
+
+
+/*
+ * raptor_binary_serialize_term:
+ * @serializer: serializer
+ * @term: term
+ *
+ * INTERNAL - Write a term as a dictionary ID or a definition
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_binary_serialize_term(raptor_serializer* serializer, raptor_term* term)
+{
+  raptor_binary_serializer_context* context;
+  raptor_iostream* iostr = serializer->iostream;
+  raptor_binary_dictionary_entry* entry;
+  unsigned int hash;
+  unsigned int mask;
+  unsigned int i;
+  const unsigned char* string;
+  size_t length;
+
+  context = (raptor_binary_serializer_context*)serializer->context;
+
+  if(term->type == RAPTOR_TERM_TYPE_LITERAL) {
+    raptor_binary_write_varint(0, iostr);
+
+    if(term->value.literal.language_len) {
+      raptor_iostream_write_byte(RAPTOR_BINARY_TERM_LANG_LITERAL, iostr);
+      raptor_binary_write_string(term->value.literal.string,
+                                 term->value.literal.string_len, iostr);
+      raptor_binary_write_string(term->value.literal.language,
+                                 term->value.literal.language_len, iostr);
+    } else if(term->value.literal.datatype) {
+      raptor_term datatype;
+
+      raptor_iostream_write_byte(RAPTOR_BINARY_TERM_TYPED_LITERAL, iostr);
+      raptor_binary_write_string(term->value.literal.string,
+                                 term->value.literal.string_len, iostr);
+
+      /* on stack - copied if added to the dictionary */
+      memset(&datatype, 0, sizeof(datatype));
+      datatype.world = term->world;
+      datatype.usage = -1;
+      datatype.type = RAPTOR_TERM_TYPE_URI;
+      datatype.value.uri = term->value.literal.datatype;
+      return raptor_binary_serialize_term(serializer, &datatype);
+    } else {
+      raptor_iostream_write_byte(RAPTOR_BINARY_TERM_LITERAL, iostr);
+      raptor_binary_write_string(term->value.literal.string,
+                                 term->value.literal.string_len, iostr);
+    }
+
+    return 0;
+  }
+
+  if(term->type != RAPTOR_TERM_TYPE_URI && term->type != RAPTOR_TERM_TYPE_BLANK) {
+    raptor_log_error_formatted(serializer->world, RAPTOR_LOG_LEVEL_ERROR,
+                               NULL, "Unknown term type %d", term->type);
+    return 1;
+  }
+
+  /* keep the table at most half full */
+  if((context->table_count + 1) << 1 > context->table_size &&
+     raptor_binary_serialize_grow_table(context))
+    return 1;
+
+  hash = raptor_binary_term_key(term);
+  mask = context->table_size - 1;
+  for(i = hash & mask; (entry = &context->table[i])->term; i = (i + 1) & mask) {
+    if(entry->hash != hash)
+      continue;
+
+    if(term->type == RAPTOR_TERM_TYPE_URI ?
+       entry->uri == term->value.uri :
+       (!entry->uri && raptor_term_equals(entry->term, term))) {
+      raptor_binary_write_varint(entry->id, iostr);
+      return 0;
+    }
+  }
+
+  raptor_binary_write_varint(0, iostr);
+
+  if(term->type == RAPTOR_TERM_TYPE_URI) {
+    string = raptor_uri_as_counted_string(term->value.uri, &length);
+    raptor_iostream_write_byte(RAPTOR_BINARY_TERM_URI, iostr);
+  } else {
+    string = term->value.blank.string;
+    length = term->value.blank.string_len;
+    raptor_iostream_write_byte(RAPTOR_BINARY_TERM_BLANK, iostr);
+  }
+  raptor_binary_write_string(string, length, iostr);
+
+  /* copies a stack or arena term to the heap */
+  entry->term = raptor_term_copy(term);
+  if(!entry->term)
+    return 1;
+  entry->uri = (term->type == RAPTOR_TERM_TYPE_URI) ? term->value.uri : NULL;
+  entry->hash = hash;
+  entry->id = ++context->table_count;
+
+  return 0;
+}
+
+
+/* serialize a statement */
+static int
+raptor_binary_serialize_statement(raptor_serializer* serializer,
+                                  raptor_statement *statement)
+{
+  raptor_binary_serializer_context* context;
+  raptor_iostream* iostr = serializer->iostream;
+
+  context = (raptor_binary_serializer_context*)serializer->context;
+
+  if(!statement->subject || !statement->predicate || !statement->object)
+    return 1;
+
+  if(context->table_count + RAPTOR_BINARY_STATEMENT_MAX_TERMS >
+     RAPTOR_BINARY_DICTIONARY_SIZE) {
+    raptor_iostream_write_byte(RAPTOR_BINARY_RECORD_RESET, iostr);
+    raptor_binary_serialize_reset_terms(context);
+  }
+
+  raptor_iostream_write_byte(statement->graph ? RAPTOR_BINARY_RECORD_QUAD :
+                             RAPTOR_BINARY_RECORD_TRIPLE, iostr);
+
+  if(raptor_binary_serialize_term(serializer, statement->subject) ||
+     raptor_binary_serialize_term(serializer, statement->predicate) ||
+     raptor_binary_serialize_term(serializer, statement->object))
+    return 1;
+
+  if(statement->graph &&
+     raptor_binary_serialize_term(serializer, statement->graph))
+    return 1;
+
+  return 0;
+}
+
+
+/* end a serialize */
+static int
+raptor_binary_serialize_end(raptor_serializer* serializer)
+{
+  raptor_binary_serializer_context* context;
+  context = (raptor_binary_serializer_context*)serializer->context;
+
+  context->started = 0;
+  raptor_binary_serialize_reset_terms(context);
+
+  return 0;
+}
+
+
+/* finish the serializer factory */
+static void
+raptor_binary_serialize_finish_factory(raptor_serializer_factory* factory)
+{
+
+}
+
+
+static const char* const binary_serializer_names[2] = { "binary", NULL};
+
+#define BINARY_SERIALIZER_TYPES_COUNT 1
+static const raptor_type_q binary_serializer_types[BINARY_SERIALIZER_TYPES_COUNT + 1] = {
+  { "application/x-raptor-binary-rdf", 31, 10},
+  { NULL, 0, 0}
+};
+
+static int
+raptor_binary_serializer_register_factory(raptor_serializer_factory *factory)
+{
+  factory->desc.names = binary_serializer_names;
+  factory->desc.mime_types = binary_serializer_types;
+
+  factory->desc.label = "Raptor binary RDF";
+  factory->desc.uri_strings = NULL;
+
+  factory->context_length     = sizeof(raptor_binary_serializer_context);
+
+  factory->init                = raptor_binary_serialize_init;
+  factory->terminate           = raptor_binary_serialize_terminate;
+  factory->declare_namespace   = raptor_binary_serialize_declare_namespace;
+  factory->declare_namespace_from_namespace = raptor_binary_serialize_declare_namespace_from_namespace;
+  factory->serialize_start     = raptor_binary_serialize_start;
+  factory->serialize_statement = raptor_binary_serialize_statement;
+  factory->serialize_end       = raptor_binary_serialize_end;
+  factory->finish_factory      = raptor_binary_serialize_finish_factory;
+
+  return 0;
+}
+
+
+int
+raptor_init_serializer_binary(raptor_world* world)
+{
+  return !raptor_serializer_register_factory(world,
+                                             &raptor_binary_serializer_register_factory);
+}
+
+#endif
+
+
+
+#ifdef STANDALONE
+
+/* one more prototype */
+int main(int argc, char *argv[]);
+
+
+#define TEST_STATEMENTS_COUNT 300000
+#define TEST_CHUNK_SIZE 7
+
+typedef struct {
+  raptor_world* world;
+  int count;
+  int namespaces_count;
+  int failures;
+} binary_test_state;
+
+
+static raptor_statement*
+make_statement(raptor_world* world, int i)
+{
+  char buffer[64];
+  raptor_uri* uri;
+  raptor_term *s, *p, *o, *g = NULL;
+
+  if(!(i % 5)) {
+    sprintf(buffer, "b%d", i);
+    s = raptor_new_term_from_blank(world, (const unsigned char*)buffer);
+  } else {
+    sprintf(buffer, "http://example.org/s/%d", i);
+    s = raptor_new_term_from_uri_string(world, (const unsigned char*)buffer);
+  }
+
+  sprintf(buffer, "http://example.org/p/%d", i % 7);
+  p = raptor_new_term_from_uri_string(world, (const unsigned char*)buffer);
+
+  switch(i % 5) {
+    case 0:
+      sprintf(buffer, "http://example.org/o/%d", i % 1000);
+      o = raptor_new_term_from_uri_string(world, (const unsigned char*)buffer);
+      break;
+
+    case 1:
+      if(!(i % 97))
+        *buffer = '\0';
+      else
+        sprintf(buffer, "value %d", i);
+      o = raptor_new_term_from_literal(world, (const unsigned char*)buffer,
+                                       NULL, NULL);
+      break;
+
+    case 2:
+      sprintf(buffer, "valeur %d", i);
+      o = raptor_new_term_from_literal(world, (const unsigned char*)buffer,
+                                       NULL, (const unsigned char*)"fr");
+      break;
+
+    case 3:
+      sprintf(buffer, "%d", i);
+      uri = raptor_new_uri(world, (const unsigned char*)"http://www.w3.org/2001/XMLSchema#integer");
+      o = raptor_new_term_from_literal(world, (const unsigned char*)buffer,
+                                       uri, NULL);
+      raptor_free_uri(uri);
+      break;
+
+    default:
+      sprintf(buffer, "o%d", i % 100);
+      o = raptor_new_term_from_blank(world, (const unsigned char*)buffer);
+      break;
+  }
+
+  if(!(i % 3)) {
+    sprintf(buffer, "http://example.org/g/%d", i % 4);
+    g = raptor_new_term_from_uri_string(world, (const unsigned char*)buffer);
+  }
+
+  return raptor_new_statement_from_nodes(world, s, p, o, g);
+}
+
+
+static void
+binary_test_statement_handler(void *user_data, raptor_statement *statement)
+{
+  binary_test_state* state = (binary_test_state*)user_data;
+  raptor_statement* expected;
+
+  expected = make_statement(state->world, state->count);
+  if(!raptor_statement_equals(statement, expected) ||
+     (statement->graph ? !expected->graph ||
+      !raptor_term_equals(statement->graph, expected->graph) :
+      expected->graph != NULL)) {
+    if(state->failures < 10)
+      fprintf(stderr, "statement %d was not the one serialized\n",
+              state->count);
+    state->failures++;
+  }
+  raptor_free_statement(expected);
+
+  state->count++;
+}
+
+
+static void
+binary_test_namespace_handler(void *user_data, raptor_namespace *nspace)
+{
+  binary_test_state* state = (binary_test_state*)user_data;
+
+  state->namespaces_count++;
+}
+
+
+static void
+binary_test_log_handler(void *user_data, raptor_log_message *message)
+{
+  /* expected errors are not reported */
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  const char *program = raptor_basename(argv[0]);
+  raptor_world *world;
+  raptor_serializer* serializer;
+  raptor_parser* parser;
+  raptor_uri* base_uri;
+  raptor_uri* ns_uri;
+  void *string = NULL;
+  size_t length = 0;
+  int failures = 0;
+  int pass;
+  int i;
+
+  world = raptor_new_world();
+  if(!world || raptor_world_open(world))
+    exit(1);
+
+  base_uri = raptor_new_uri(world, (const unsigned char*)"http://example.org/base");
+  ns_uri = raptor_new_uri(world, (const unsigned char*)"http://example.org/p/");
+
+  serializer = raptor_new_serializer(world, "binary");
+  if(!serializer) {
+    fprintf(stderr, "%s: Failed to create binary serializer\n", program);
+    exit(1);
+  }
+
+  raptor_serializer_set_namespace(serializer, ns_uri,
+                                  (const unsigned char*)"ex");
+  raptor_serializer_start_to_string(serializer, base_uri, &string, &length);
+  for(i = 0; i < TEST_STATEMENTS_COUNT; i++) {
+    raptor_statement* statement = make_statement(world, i);
+
+    raptor_serializer_serialize_statement(serializer, statement);
+    raptor_free_statement(statement);
+  }
+  raptor_serializer_serialize_end(serializer);
+  raptor_free_serializer(serializer);
+
+  if(!string) {
+    fprintf(stderr, "%s: Binary serializer returned no output\n", program);
+    exit(1);
+  }
+
+  /* parse it back all at once and then in small chunks */
+  for(pass = 0; pass < 2; pass++) {
+    binary_test_state state;
+    const unsigned char* p = (const unsigned char*)string;
+    size_t left = length;
+
+    state.world = world;
+    state.count = 0;
+    state.namespaces_count = 0;
+    state.failures = 0;
+
+    parser = raptor_new_parser(world, "binary");
+    raptor_parser_set_statement_handler(parser, &state,
+                                        binary_test_statement_handler);
+    raptor_parser_set_namespace_handler(parser, &state,
+                                        binary_test_namespace_handler);
+
+    raptor_parser_parse_start(parser, base_uri);
+    if(!pass)
+      raptor_parser_parse_chunk(parser, p, left, 1);
+    else {
+      while(left) {
+        size_t len = left < TEST_CHUNK_SIZE ? left : TEST_CHUNK_SIZE;
+
+        raptor_parser_parse_chunk(parser, p, len, 0);
+        p += len;
+        left -= len;
+      }
+      raptor_parser_parse_chunk(parser, NULL, 0, 1);
+    }
+    raptor_free_parser(parser);
+
+    if(state.count != TEST_STATEMENTS_COUNT) {
+      fprintf(stderr, "%s: Parse pass %d returned %d statements expected %d\n",
+              program, pass, state.count, TEST_STATEMENTS_COUNT);
+      failures++;
+    }
+    if(state.namespaces_count != 1) {
+      fprintf(stderr, "%s: Parse pass %d returned %d namespaces expected 1\n",
+              program, pass, state.namespaces_count);
+      failures++;
+    }
+    failures += state.failures;
+  }
+
+  /* a stream cut short is an error */
+  parser = raptor_new_parser(world, "binary");
+  raptor_world_set_log_handler(world, NULL, binary_test_log_handler);
+  raptor_parser_parse_start(parser, base_uri);
+  if(!raptor_parser_parse_chunk(parser, (const unsigned char*)string,
+                                length - 1, 1)) {
+    fprintf(stderr, "%s: Truncated stream was not an error\n", program);
+    failures++;
+  }
+  raptor_free_parser(parser);
+
+  raptor_free_memory(string);
+  raptor_free_uri(ns_uri);
+  raptor_free_uri(base_uri);
+  raptor_free_world(world);
+
+  return failures;
+}
+
+#endif
@@ -165,6 +165,9 @@ raptor_concepts_init(raptor_world* world)
   if(!world->xsd_integer_uri)
     return 1;
 
+  if(raptor_uri_ordinals_init(world))
+    return 1;
+
   return 0;
 }
 
@@ -175,6 +178,8 @@ raptor_concepts_finish(raptor_world* world)
 {
   int i;
   
+  raptor_uri_ordinals_finish(world);
+
   for(i = 0; i < RDF_NS_LAST + 1; i++) {
     raptor_uri* concept_uri = world->concepts[i];
     if(concept_uri) {
@@ -34,6 +34,88 @@
 #include "raptor_internal.h"
 
 
+/* strings shorter than this are not worth preparing a raptor_scan_set */
+#define RAPTOR_ESCAPED_SCAN_MIN_LEN 64
+
+
+/*
+ * raptor_string_escaped_scan_set_init:
+ * @scan_set: set to initialise
+ * @delim: delimiter or \0
+ * @flags: bit flags - see #raptor_escaped_write_bitflags
+ *
+ * INTERNAL - Prepare the bytes raptor_string_escaped_safe_length() stops at
+ */
+static void
+raptor_string_escaped_scan_set_init(raptor_scan_set *scan_set,
+                                    const char delim, unsigned int flags)
+{
+  static const unsigned char sparql_bytes[8] = {
+    '<', '>', '"', '{', '}', '|', '^', '`'
+  };
+  unsigned char bytes[RAPTOR_SCAN_SET_MAX];
+  unsigned int len = 0;
+  int sparql = (flags & RAPTOR_ESCAPED_WRITE_BITFLAG_SPARQL_URI_ESCAPES);
+
+  bytes[len++] = '\\';
+  if(delim)
+    bytes[len++] = RAPTOR_GOOD_CAST(unsigned char, delim);
+  if(sparql) {
+    memcpy(&bytes[len], sparql_bytes, sizeof(sparql_bytes));
+    len += sizeof(sparql_bytes);
+  }
+
+  raptor_scan_set_init(scan_set, bytes, len);
+  raptor_scan_set_add_nonprintable(scan_set, sparql ? 0x21 : 0x20);
+}
+
+
+/*
+ * raptor_string_escaped_safe_length:
+ * @string: UTF-8 string
+ * @len: bytes of @string that may be read in blocks
+ * @delim: delimiter or \0
+ * @flags: bit flags - see #raptor_escaped_write_bitflags
+ * @scan_set: set from raptor_string_escaped_scan_set_init() or NULL
+ *
+ * INTERNAL - Count the leading bytes that are written unchanged
+ *
+ * These are printable ASCII other than backslash, @delim and when
+ * SPARQL URI escaping, space and <>"{}|^` so the answer does not
+ * depend on any other flags.  Scanning also stops at a NUL.  With a
+ * @scan_set the first @len bytes are searched with raptor_scan_bytes()
+ * and never more, so any @len shorter than the string is safe.
+ *
+ * Return value: number of bytes
+ */
+static size_t
+raptor_string_escaped_safe_length(const unsigned char *string, size_t len,
+                                  const char delim, unsigned int flags,
+                                  const raptor_scan_set *scan_set)
+{
+  const unsigned char* p = string;
+  int sparql = (flags & RAPTOR_ESCAPED_WRITE_BITFLAG_SPARQL_URI_ESCAPES);
+  unsigned char first = sparql ? 0x21 : 0x20;
+  unsigned char c;
+
+  if(scan_set) {
+    p += raptor_scan_bytes(string, len, scan_set);
+    if(p < string + len)
+      return RAPTOR_GOOD_CAST(size_t, p - string);
+  }
+
+  for(; (c = *p); p++) {
+    if(c < first || c >= 0x7f || c == '\\' || c == (unsigned char)delim)
+      break;
+    if(sparql && (c == '<' || c == '>' || c == '"' || c == '{' ||
+                  c == '}' || c == '|' || c == '^' || c == '`'))
+      break;
+  }
+
+  return RAPTOR_GOOD_CAST(size_t, p - string);
+}
+
+
 /**
  * raptor_string_escaped_write:
  * @string: UTF-8 string to write
@@ -59,11 +141,36 @@ raptor_string_escaped_write(const unsigned char *string,
   unsigned char c;
   int unichar_len;
   raptor_unichar unichar;
+  size_t string_len = len;
+  raptor_scan_set scan_set;
+  raptor_scan_set *scan_set_p = NULL;
 
   if(!string)
     return 1;
+
+  if(len >= RAPTOR_ESCAPED_SCAN_MIN_LEN) {
+    raptor_string_escaped_scan_set_init(&scan_set, delim, flags);
+    scan_set_p = &scan_set;
+  }
   
-  for(; (c=*string); string++, len--) {
+  for(; ; string++, len--) {
+    /* Write any run of bytes that need no escaping in one go; len
+     * wraps around if it was given shorter than the string */
+    size_t safe_len;
+
+    safe_len = raptor_string_escaped_safe_length(string,
+                                                 (len <= string_len) ? len : 0,
+                                                 delim, flags, scan_set_p);
+    if(safe_len) {
+      raptor_iostream_counted_string_write(string, safe_len, iostr);
+      string += safe_len;
+      len -= safe_len;
+    }
+
+    c = *string;
+    if(!c)
+      break;
+
     if((delim && c == delim && (delim == '\'' || delim == '"')) ||
        c == '\\') {
       raptor_iostream_write_byte('\\', iostr);
@@ -0,0 +1,895 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * raptor_extsort.c - Raptor external memory statement sorter
+ *
+ * Copyright (C) 2026, agent agent@local
+ *
+ * This package is Free Software and part of Redland http://librdf.org/
+ *
+ * It is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ *
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <raptor_config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+/* Raptor includes */
+#include "raptor2.h"
+#include "raptor_internal.h"
+
+
+/*
+ * Statements are kept in an AVL tree ordered by
+ * raptor_statement_compare() until there are more than the limit.
+ * The tree is then written in order to a temporary file as a sorted
+ * run and emptied.  Each run has a level and whenever there are
+ * RAPTOR_EXTSORT_MERGE_WIDTH runs of the same level they are merged
+ * into one run of the next level, so each statement is rewritten a
+ * logarithmic number of times.  When visited, all runs are merged.
+ *
+ * Run file format, per statement: subject, predicate, object and
+ * graph terms each as a type byte followed by:
+ *   URI:     string
+ *   blank:   string
+ *   literal: string, flags byte, [language string], [datatype string]
+ * where a string is a variable length byte count (7 bits per byte,
+ * high bit set on all but the last) and then the bytes.  A graph
+ * type byte of 0 means no graph.
+ */
+
+/* number of runs of one level that are merged into one */
+#define RAPTOR_EXTSORT_MERGE_WIDTH 16
+
+/* levels of runs; merging runs of the last level keeps that level */
+#define RAPTOR_EXTSORT_MAX_LEVELS 8
+
+#define RAPTOR_EXTSORT_MAX_RUNS \
+  ((RAPTOR_EXTSORT_MERGE_WIDTH - 1) * RAPTOR_EXTSORT_MAX_LEVELS + 1)
+
+/* flags byte for literals */
+#define RAPTOR_EXTSORT_LITERAL_LANGUAGE 1
+#define RAPTOR_EXTSORT_LITERAL_DATATYPE 2
+
+
+typedef struct {
+  FILE* fh;
+
+  /* 0 for a run written from memory, n+1 for a merge of level n runs */
+  int level;
+
+  /* statement read from the run waiting to be merged or NULL at end */
+  raptor_statement* statement;
+} raptor_extsort_run;
+
+
+struct raptor_extsort_s {
+  raptor_world* world;
+
+  /* statements in memory */
+  raptor_avltree* tree;
+
+  /* maximum number of statements in memory or 0 for no limit */
+  int limit;
+
+  /* sorted runs written to temporary files in decreasing level order */
+  raptor_extsort_run runs[RAPTOR_EXTSORT_MAX_RUNS];
+  int runs_count;
+
+  /* run being written by raptor_extsort_write_visit() */
+  FILE* write_fh;
+  int write_error;
+
+  /* non-0 after failing to write or read a run */
+  int failed;
+
+  /* buffer for reading strings back from runs */
+  unsigned char* buffer;
+  size_t buffer_size;
+};
+
+
+/*
+ * raptor_new_extsort:
+ * @world: world
+ * @limit: maximum number of statements to hold in memory or 0 for no limit
+ *
+ * INTERNAL - Constructor - create a statement sorter
+ *
+ * Return value: new sorter or NULL on failure
+ */
+raptor_extsort*
+raptor_new_extsort(raptor_world* world, int limit)
+{
+  raptor_extsort* sorter;
+
+  sorter = RAPTOR_CALLOC(raptor_extsort*, 1, sizeof(*sorter));
+  if(!sorter)
+    return NULL;
+
+  sorter->world = world;
+  sorter->limit = limit > 0 ? limit : 0;
+
+  sorter->tree = raptor_new_avltree((raptor_data_compare_handler)raptor_statement_compare,
+                                    (raptor_data_free_handler)raptor_free_statement,
+                                    0);
+  if(!sorter->tree) {
+    RAPTOR_FREE(raptor_extsort, sorter);
+    return NULL;
+  }
+
+  return sorter;
+}
+
+
+/*
+ * raptor_free_extsort:
+ * @sorter: sorter
+ *
+ * INTERNAL - Destructor - free a statement sorter and any runs
+ */
+void
+raptor_free_extsort(raptor_extsort* sorter)
+{
+  int i;
+
+  if(!sorter)
+    return;
+
+  for(i = 0; i < sorter->runs_count; i++) {
+    raptor_extsort_run* run = &sorter->runs[i];
+
+    if(run->statement)
+      raptor_free_statement(run->statement);
+    if(run->fh)
+      fclose(run->fh);
+  }
+
+  if(sorter->buffer)
+    RAPTOR_FREE(char*, sorter->buffer);
+
+  if(sorter->tree)
+    raptor_free_avltree(sorter->tree);
+
+  RAPTOR_FREE(raptor_extsort, sorter);
+}
+
+
+static int raptor_extsort_merge_runs(raptor_extsort* sorter, int first);
+
+
+static void
+raptor_extsort_write_string(FILE* fh, const unsigned char* string,
+                            size_t length)
+{
+  size_t n = length;
+
+  while(n > 0x7f) {
+    fputc((int)((n & 0x7f) | 0x80), fh);
+    n >>= 7;
+  }
+  fputc((int)n, fh);
+
+  if(length)
+    fwrite(string, 1, length, fh);
+}
+
+
+static void
+raptor_extsort_write_term(FILE* fh, raptor_term* term)
+{
+  const unsigned char* string;
+  size_t length;
+
+  if(!term) {
+    fputc(0, fh);
+    return;
+  }
+
+  fputc((int)term->type, fh);
+
+  switch(term->type) {
+    case RAPTOR_TERM_TYPE_URI:
+      string = raptor_uri_as_counted_string(term->value.uri, &length);
+      raptor_extsort_write_string(fh, string, length);
+      break;
+
+    case RAPTOR_TERM_TYPE_BLANK:
+      raptor_extsort_write_string(fh, term->value.blank.string,
+                                  term->value.blank.string_len);
+      break;
+
+    case RAPTOR_TERM_TYPE_LITERAL:
+      raptor_extsort_write_string(fh, term->value.literal.string,
+                                  term->value.literal.string_len);
+      fputc((term->value.literal.language ? RAPTOR_EXTSORT_LITERAL_LANGUAGE : 0) |
+            (term->value.literal.datatype ? RAPTOR_EXTSORT_LITERAL_DATATYPE : 0),
+            fh);
+      if(term->value.literal.language)
+        raptor_extsort_write_string(fh, term->value.literal.language,
+                                    term->value.literal.language_len);
+      if(term->value.literal.datatype) {
+        string = raptor_uri_as_counted_string(term->value.literal.datatype,
+                                              &length);
+        raptor_extsort_write_string(fh, string, length);
+      }
+      break;
+
+    case RAPTOR_TERM_TYPE_UNKNOWN:
+    default:
+      break;
+  }
+}
+
+
+/* return 0 to abort visit */
+static int
+raptor_extsort_write_visit(int depth, void* data, void *user_data)
+{
+  raptor_extsort* sorter = (raptor_extsort*)user_data;
+  raptor_statement* statement = (raptor_statement*)data;
+
+  raptor_extsort_write_term(sorter->write_fh, statement->subject);
+  raptor_extsort_write_term(sorter->write_fh, statement->predicate);
+  raptor_extsort_write_term(sorter->write_fh, statement->object);
+  raptor_extsort_write_term(sorter->write_fh, statement->graph);
+
+  if(ferror(sorter->write_fh)) {
+    sorter->write_error = 1;
+    return 0;
+  }
+
+  return 1;
+}
+
+
+static FILE*
+raptor_extsort_new_run_file(raptor_extsort* sorter)
+{
+  FILE* fh;
+
+  fh = tmpfile();
+  if(!fh)
+    raptor_log_error(sorter->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
+                     "Failed to create temporary file for sorting");
+
+  return fh;
+}
+
+
+/* finish writing a run and rewind it for reading */
+static int
+raptor_extsort_end_run_file(raptor_extsort* sorter, FILE* fh)
+{
+  if(sorter->write_error || fflush(fh) || fseek(fh, 0L, SEEK_SET)) {
+    raptor_log_error(sorter->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
+                     "Failed to write temporary file for sorting");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+/*
+ * raptor_extsort_spill:
+ * @sorter: sorter
+ *
+ * Write the statements in memory to a new sorted run and empty the tree
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_extsort_spill(raptor_extsort* sorter)
+{
+  FILE* fh;
+
+  if(!raptor_avltree_size(sorter->tree))
+    return 0;
+
+  fh = raptor_extsort_new_run_file(sorter);
+  if(!fh)
+    return 1;
+
+  sorter->write_fh = fh;
+  sorter->write_error = 0;
+  raptor_avltree_visit(sorter->tree, raptor_extsort_write_visit, sorter);
+  sorter->write_fh = NULL;
+
+  if(raptor_extsort_end_run_file(sorter, fh)) {
+    fclose(fh);
+    return 1;
+  }
+
+  sorter->runs[sorter->runs_count].fh = fh;
+  sorter->runs[sorter->runs_count].level = 0;
+  sorter->runs[sorter->runs_count].statement = NULL;
+  sorter->runs_count++;
+
+  raptor_free_avltree(sorter->tree);
+  sorter->tree = raptor_new_avltree((raptor_data_compare_handler)raptor_statement_compare,
+                                    (raptor_data_free_handler)raptor_free_statement,
+                                    0);
+  if(!sorter->tree)
+    return 1;
+
+  /* merge the last runs while they are a full set of one level */
+  while(sorter->runs_count >= RAPTOR_EXTSORT_MERGE_WIDTH) {
+    int first = sorter->runs_count - RAPTOR_EXTSORT_MERGE_WIDTH;
+
+    if(sorter->runs[first].level != sorter->runs[sorter->runs_count - 1].level)
+      break;
+
+    if(raptor_extsort_merge_runs(sorter, first))
+      return 1;
+  }
+
+  return 0;
+}
+
+
+/*
+ * raptor_extsort_add:
+ * @sorter: sorter
+ * @statement: statement (becomes owned by the sorter)
+ *
+ * INTERNAL - Add a statement to a sorter
+ *
+ * Return value: 0 on success, >0 if an equivalent statement is already
+ * in memory (and @statement was freed), <0 on failure
+ */
+int
+raptor_extsort_add(raptor_extsort* sorter, raptor_statement* statement)
+{
+  int rc;
+
+  if(sorter->failed) {
+    raptor_free_statement(statement);
+    return -1;
+  }
+
+  rc = raptor_avltree_add(sorter->tree, statement);
+  if(rc)
+    return rc;
+
+  if(sorter->limit && raptor_avltree_size(sorter->tree) >= sorter->limit) {
+    if(raptor_extsort_spill(sorter)) {
+      sorter->failed = 1;
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+
+static int
+raptor_extsort_read_length(FILE* fh, size_t* length_p)
+{
+  size_t length = 0;
+  int shift = 0;
+  int c;
+
+  do {
+    c = getc(fh);
+    if(c == EOF || shift > 56)
+      return 1;
+    length |= RAPTOR_GOOD_CAST(size_t, c & 0x7f) << shift;
+    shift += 7;
+  } while(c & 0x80);
+
+  *length_p = length;
+  return 0;
+}
+
+
+/* read a string into the sorter buffer; NUL terminated */
+static unsigned char*
+raptor_extsort_read_string(raptor_extsort* sorter, FILE* fh, size_t offset,
+                           size_t* length_p)
+{
+  size_t length;
+
+  if(raptor_extsort_read_length(fh, &length))
+    return NULL;
+
+  if(offset + length + 1 > sorter->buffer_size) {
+    size_t new_size = (offset + length + 1) << 1;
+    unsigned char* buffer;
+
+    buffer = RAPTOR_REALLOC(unsigned char*, sorter->buffer, new_size);
+    if(!buffer)
+      return NULL;
+
+    sorter->buffer = buffer;
+    sorter->buffer_size = new_size;
+  }
+
+  if(length && fread(sorter->buffer + offset, 1, length, fh) != length)
+    return NULL;
+  sorter->buffer[offset + length] = '\0';
+
+  *length_p = length;
+  return sorter->buffer + offset;
+}
+
+
+static int
+raptor_extsort_read_term(raptor_extsort* sorter, FILE* fh,
+                         raptor_term** term_p)
+{
+  unsigned char* string;
+  size_t length;
+  int type;
+
+  *term_p = NULL;
+
+  type = getc(fh);
+  if(type == EOF)
+    return 1;
+
+  switch(type) {
+    case 0:
+      return 0;
+
+    case RAPTOR_TERM_TYPE_URI:
+      string = raptor_extsort_read_string(sorter, fh, 0, &length);
+      if(!string)
+        return 1;
+      *term_p = raptor_new_term_from_counted_uri_string(sorter->world,
+                                                        string, length);
+      break;
+
+    case RAPTOR_TERM_TYPE_BLANK:
+      string = raptor_extsort_read_string(sorter, fh, 0, &length);
+      if(!string)
+        return 1;
+      *term_p = raptor_new_term_from_counted_blank(sorter->world,
+                                                   string, length);
+      break;
+
+    case RAPTOR_TERM_TYPE_LITERAL:
+      {
+        unsigned char* language = NULL;
+        size_t language_len = 0;
+        raptor_uri* datatype = NULL;
+        int flags;
+
+        /* the literal string stays at the start of the buffer and
+         * the other parts follow it; buffer may move so use offsets */
+        if(!raptor_extsort_read_string(sorter, fh, 0, &length))
+          return 1;
+
+        flags = getc(fh);
+        if(flags == EOF)
+          return 1;
+
+        if(flags & RAPTOR_EXTSORT_LITERAL_LANGUAGE) {
+          if(!raptor_extsort_read_string(sorter, fh, length + 1, &language_len))
+            return 1;
+        }
+
+        if(flags & RAPTOR_EXTSORT_LITERAL_DATATYPE) {
+          size_t datatype_len;
+
+          string = raptor_extsort_read_string(sorter, fh,
+                                              length + 1 + language_len + 1,
+                                              &datatype_len);
+          if(!string)
+            return 1;
+          datatype = raptor_new_uri_from_counted_string(sorter->world,
+                                                        string, datatype_len);
+          if(!datatype)
+            return 1;
+        }
+
+        if(flags & RAPTOR_EXTSORT_LITERAL_LANGUAGE)
+          language = sorter->buffer + length + 1;
+
+        *term_p = raptor_new_term_from_counted_literal(sorter->world,
+                                                       sorter->buffer, length,
+                                                       datatype, language,
+                                                       RAPTOR_BAD_CAST(unsigned char, language_len));
+        if(datatype)
+          raptor_free_uri(datatype);
+      }
+      break;
+
+    default:
+      return 1;
+  }
+
+  return (*term_p == NULL);
+}
+
+
+/*
+ * raptor_extsort_run_next:
+ * @sorter: sorter
+ * @run: run
+ *
+ * Read the next statement from a run into run->statement or set it
+ * to NULL at the end of the run.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_extsort_run_next(raptor_extsort* sorter, raptor_extsort_run* run)
+{
+  raptor_statement* statement;
+  int c;
+
+  run->statement = NULL;
+
+  c = getc(run->fh);
+  if(c == EOF)
+    return 0;
+  ungetc(c, run->fh);
+
+  statement = raptor_new_statement(sorter->world);
+  if(!statement)
+    return 1;
+
+  if(raptor_extsort_read_term(sorter, run->fh, &statement->subject) ||
+     raptor_extsort_read_term(sorter, run->fh, &statement->predicate) ||
+     raptor_extsort_read_term(sorter, run->fh, &statement->object) ||
+     raptor_extsort_read_term(sorter, run->fh, &statement->graph) ||
+     !statement->subject || !statement->predicate || !statement->object) {
+    raptor_free_statement(statement);
+    raptor_log_error(sorter->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
+                     "Failed to read temporary file for sorting");
+    return 1;
+  }
+
+  run->statement = statement;
+  return 0;
+}
+
+
+static int
+raptor_extsort_run_compare(raptor_extsort* sorter, int a, int b)
+{
+  return raptor_statement_compare(sorter->runs[a].statement,
+                                  sorter->runs[b].statement);
+}
+
+
+/* restore the min-heap of run indexes below position i */
+static void
+raptor_extsort_heap_down(raptor_extsort* sorter, int* heap, int size, int i)
+{
+  while(1) {
+    int left = 2 * i + 1;
+    int smallest = i;
+    int tmp;
+
+    if(left < size &&
+       raptor_extsort_run_compare(sorter, heap[left], heap[smallest]) < 0)
+      smallest = left;
+    if(left + 1 < size &&
+       raptor_extsort_run_compare(sorter, heap[left + 1], heap[smallest]) < 0)
+      smallest = left + 1;
+
+    if(smallest == i)
+      break;
+
+    tmp = heap[i];
+    heap[i] = heap[smallest];
+    heap[smallest] = tmp;
+    i = smallest;
+  }
+}
+
+
+/*
+ * raptor_extsort_merge:
+ * @sorter: sorter
+ * @first: index of first run to merge
+ * @visit_handler: handler to call for each statement in order
+ * @user_data: user data for @visit_handler
+ *
+ * Merge the runs from @first to the end in order, dropping
+ * duplicates, and close them.
+ *
+ * The statement passed to @visit_handler remains valid until the
+ * next call to it returns.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_extsort_merge(raptor_extsort* sorter, int first,
+                     raptor_avltree_visit_handler visit_handler,
+                     void* user_data)
+{
+  raptor_statement* last = NULL;
+  int heap[RAPTOR_EXTSORT_MAX_RUNS];
+  int heap_size = 0;
+  int rc = 0;
+  int i;
+
+  for(i = first; i < sorter->runs_count; i++) {
+    if(raptor_extsort_run_next(sorter, &sorter->runs[i])) {
+      rc = 1;
+      goto tidy;
+    }
+    if(sorter->runs[i].statement)
+      heap[heap_size++] = i;
+  }
+
+  for(i = heap_size / 2 - 1; i >= 0; i--)
+    raptor_extsort_heap_down(sorter, heap, heap_size, i);
+
+  while(heap_size) {
+    raptor_extsort_run* run = &sorter->runs[heap[0]];
+    raptor_statement* statement = run->statement;
+
+    if(raptor_extsort_run_next(sorter, run)) {
+      raptor_free_statement(statement);
+      rc = 1;
+      break;
+    }
+
+    if(!run->statement)
+      heap[0] = heap[--heap_size];
+    raptor_extsort_heap_down(sorter, heap, heap_size, 0);
+
+    /* runs are unique but may share statements with each other */
+    if(last && !raptor_statement_compare(last, statement)) {
+      raptor_free_statement(statement);
+      continue;
+    }
+
+    if(!visit_handler(0, statement, user_data)) {
+      raptor_free_statement(statement);
+      break;
+    }
+
+    if(last)
+      raptor_free_statement(last);
+    last = statement;
+  }
+
+  tidy:
+  if(last)
+    raptor_free_statement(last);
+
+  for(i = first; i < sorter->runs_count; i++) {
+    raptor_extsort_run* run = &sorter->runs[i];
+
+    if(run->statement) {
+      raptor_free_statement(run->statement);
+      run->statement = NULL;
+    }
+    fclose(run->fh);
+    run->fh = NULL;
+  }
+  sorter->runs_count = first;
+
+  return rc;
+}
+
+
+/*
+ * raptor_extsort_merge_runs:
+ * @sorter: sorter
+ * @first: index of first run to merge
+ *
+ * Merge the runs from @first to the end into one run of the next level
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_extsort_merge_runs(raptor_extsort* sorter, int first)
+{
+  int level = sorter->runs[first].level;
+  FILE* fh;
+
+  if(level < RAPTOR_EXTSORT_MAX_LEVELS - 1)
+    level++;
+
+  fh = raptor_extsort_new_run_file(sorter);
+  if(!fh)
+    return 1;
+
+  sorter->write_fh = fh;
+  sorter->write_error = 0;
+  if(raptor_extsort_merge(sorter, first, raptor_extsort_write_visit, sorter) ||
+     raptor_extsort_end_run_file(sorter, fh)) {
+    sorter->write_fh = NULL;
+    fclose(fh);
+    return 1;
+  }
+  sorter->write_fh = NULL;
+
+  sorter->runs[first].fh = fh;
+  sorter->runs[first].level = level;
+  sorter->runs[first].statement = NULL;
+  sorter->runs_count = first + 1;
+
+  return 0;
+}
+
+
+/*
+ * raptor_extsort_visit:
+ * @sorter: sorter
+ * @visit_handler: handler to call for each statement in order
+ * @user_data: user data for @visit_handler
+ *
+ * INTERNAL - Visit the sorted and unique statements in a sorter
+ *
+ * The statement passed to @visit_handler remains valid until the
+ * next call to it returns.  This may only be done once per sorter.
+ *
+ * Return value: non-0 on failure
+ */
+int
+raptor_extsort_visit(raptor_extsort* sorter,
+                     raptor_avltree_visit_handler visit_handler,
+                     void* user_data)
+{
+  if(sorter->failed)
+    return 1;
+
+  if(!sorter->runs_count) {
+    raptor_avltree_visit(sorter->tree, visit_handler, user_data);
+    return 0;
+  }
+
+  /* the last partial run goes to disk too so all runs are alike */
+  if(raptor_extsort_spill(sorter))
+    return 1;
+
+  return raptor_extsort_merge(sorter, 0, visit_handler, user_data);
+}
+
+
+
+#ifdef STANDALONE
+
+/* one more prototype */
+int main(int argc, char *argv[]);
+
+
+struct extsort_test_state {
+  const char* program;
+  raptor_statement* last;
+  int count;
+  int failures;
+};
+
+
+static int
+extsort_test_visit(int depth, void* data, void *user_data)
+{
+  struct extsort_test_state* state = (struct extsort_test_state*)user_data;
+  raptor_statement* statement = (raptor_statement*)data;
+
+  /* the previous statement must still be valid */
+  if(state->last && raptor_statement_compare(state->last, statement) >= 0) {
+    fprintf(stderr, "%s: statement %d is out of order\n", state->program,
+            state->count);
+    state->failures++;
+  }
+
+  state->last = statement;
+  state->count++;
+
+  return 1;
+}
+
+
+#define EXTSORT_TEST_COUNT 500
+
+int
+main(int argc, char *argv[])
+{
+  const char *program = raptor_basename(argv[0]);
+  raptor_world *world;
+  raptor_uri* datatype;
+  /* 0: all in memory, 1: enough runs for two levels of merges */
+  const int limits[4] = { 0, 1, 7, 64 };
+  int failures = 0;
+  int l;
+
+  world = raptor_new_world();
+  if(!world || raptor_world_open(world))
+    exit(1);
+
+  datatype = raptor_new_uri(world, (const unsigned char*)"http://example.org/dt");
+
+  for(l = 0; l < 4; l++) {
+    int limit = limits[l];
+    raptor_extsort* sorter;
+    struct extsort_test_state state;
+    int i;
+
+    sorter = raptor_new_extsort(world, limit);
+    if(!sorter) {
+      fprintf(stderr, "%s: raptor_new_extsort() failed\n", program);
+      failures++;
+      break;
+    }
+
+    /* every value is added twice, spread across runs */
+    for(i = 0; i < 2 * EXTSORT_TEST_COUNT; i++) {
+      int n = (i * 37) % EXTSORT_TEST_COUNT;
+      raptor_statement* s;
+      char buffer[40];
+      size_t len;
+
+      len = RAPTOR_GOOD_CAST(size_t, sprintf(buffer, "n%d", n));
+
+      s = raptor_new_statement(world);
+      s->subject = raptor_new_term_from_counted_blank(world,
+                                                      (const unsigned char*)buffer,
+                                                      len);
+      s->predicate = raptor_new_term_from_uri_string(world,
+                                                     (const unsigned char*)"http://example.org/p");
+      if(n % 3)
+        s->object = raptor_new_term_from_counted_literal(world,
+                                                         (const unsigned char*)buffer, len,
+                                                         (n % 3 == 1) ? datatype : NULL,
+                                                         (n % 3 == 2) ? (const unsigned char*)"en" : NULL,
+                                                         (n % 3 == 2) ? 2 : 0);
+      else
+        s->object = raptor_new_term_from_uri_string(world,
+                                                    (const unsigned char*)"http://example.org/o");
+      if(n % 2)
+        s->graph = raptor_new_term_from_uri_string(world,
+                                                   (const unsigned char*)"http://example.org/g");
+
+      if(raptor_extsort_add(sorter, s) < 0) {
+        fprintf(stderr, "%s: raptor_extsort_add() failed with limit %d\n",
+                program, limit);
+        failures++;
+        break;
+      }
+    }
+
+    state.program = program;
+    state.last = NULL;
+    state.count = 0;
+    state.failures = 0;
+
+    if(raptor_extsort_visit(sorter, extsort_test_visit, &state)) {
+      fprintf(stderr, "%s: raptor_extsort_visit() failed with limit %d\n",
+              program, limit);
+      failures++;
+    }
+
+    if(state.count != EXTSORT_TEST_COUNT) {
+      fprintf(stderr, "%s: visited %d statements with limit %d, expected %d\n",
+              program, state.count, limit, EXTSORT_TEST_COUNT);
+      failures++;
+    }
+    failures += state.failures;
+
+    raptor_free_extsort(sorter);
+  }
+
+  raptor_free_uri(datatype);
+  raptor_free_world(world);
+
+  return failures;
+}
+
+#endif
@@ -179,6 +179,10 @@ raptor_world_open(raptor_world* world)
 
   world->opened = 1;
 
+  rc = raptor_threads_init(world);
+  if(rc)
+    return rc;
+
   rc = raptor_uri_init(world);
   if(rc)
     return rc;
@@ -246,6 +250,8 @@ raptor_free_world(raptor_world* world)
 
   raptor_uri_finish(world);
 
+  raptor_threads_finish(world);
+
   RAPTOR_FREE(raptor_world, world);
 }
 
@@ -279,23 +285,36 @@ raptor_world_set_generate_bnodeid_handler(raptor_world* world,
 }
 
 
+/* enough digits for any unsigned int in base 10 */
+#define RAPTOR_BNODEID_DIGITS_SIZE (sizeof(unsigned int) * 3)
+
 static unsigned char*
 raptor_world_default_generate_bnodeid_handler(void *user_data,
                                               unsigned char *user_bnodeid) 
 {
   raptor_world *world = (raptor_world*)user_data;
-  int id;
+  unsigned int id;
   unsigned char *buffer;
   const char* prefix;
   unsigned int prefix_length;
+  char digits[RAPTOR_BNODEID_DIGITS_SIZE];
+  char *p;
   size_t id_length;
 
   if(user_bnodeid)
     return user_bnodeid;
 
-  id = ++world->default_generate_bnodeid_handler_base;
+  id = RAPTOR_GOOD_CAST(unsigned int,
+                        raptor_world_atomic_add(world, &world->default_generate_bnodeid_handler_base, 1));
 
-  id_length = raptor_format_integer(NULL, 0, id, /* base */ 10, -1, '\0');
+  /* Format the digits backwards into a stack buffer in one pass so
+   * the length is known before the single allocation */
+  p = digits + RAPTOR_BNODEID_DIGITS_SIZE;
+  do {
+    *--p = RAPTOR_GOOD_CAST(char, '0' + (id % 10));
+    id /= 10;
+  } while(id);
+  id_length = RAPTOR_GOOD_CAST(size_t, digits + RAPTOR_BNODEID_DIGITS_SIZE - p);
 
   if(world->default_generate_bnodeid_handler_prefix) {
     prefix = world->default_generate_bnodeid_handler_prefix;
@@ -310,8 +329,8 @@ raptor_world_default_generate_bnodeid_handler(void *user_data,
     return NULL;
 
   memcpy(buffer, prefix, prefix_length);
-  (void)raptor_format_integer(RAPTOR_GOOD_CAST(char*, &buffer[prefix_length]),
-                              id_length + 1, id, /* base */ 10,-1, '\0');
+  memcpy(&buffer[prefix_length], p, id_length);
+  buffer[prefix_length + id_length] = '\0';
 
   return buffer;
 }
@@ -476,6 +495,15 @@ raptor_world_set_flag(raptor_world *world, raptor_world_flag flag, int value)
     case RAPTOR_WORLD_FLAG_WWW_SKIP_INIT_FINISH:
       world->www_skip_www_init_finish = value;
       break;
+
+    case RAPTOR_WORLD_FLAG_THREAD_SAFE:
+#ifdef HAVE_PTHREAD_H
+      world->thread_safe = value;
+#else
+      if(value)
+        rc = -2;
+#endif
+      break;
   }
 
   return rc;
@@ -507,6 +535,37 @@ raptor_world_set_log_handler(raptor_world *world, void *user_data,
 }
 
 
+/**
+ * raptor_world_set_thread_log_handler:
+ * @world: world object
+ * @user_data: user data to pass to function
+ * @handler: pointer to the function or NULL
+ *
+ * Set the message handling function for the calling thread.
+ *
+ * Messages logged by the calling thread, such as those from a parser
+ * it runs, go to @handler instead of the handler set with
+ * raptor_world_set_log_handler().  A NULL @handler goes back to that
+ * handler.
+ *
+ * This is for several threads sharing a world opened with
+ * #RAPTOR_WORLD_FLAG_THREAD_SAFE set; it has no effect otherwise.
+ * 
+ * Return value: non-0 on failure or if threads are not supported
+ **/
+int
+raptor_world_set_thread_log_handler(raptor_world *world, void *user_data,
+                                    raptor_log_handler handler)
+{
+  RAPTOR_ASSERT_OBJECT_POINTER_RETURN_VALUE(world, raptor_world, -1);
+
+  if(raptor_world_open(world))
+    return 1;
+
+  return raptor_threads_set_log_handler(world, user_data, handler);
+}
+
+
 /**
  * raptor_basename:
  * @name: path
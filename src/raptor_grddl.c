@@ -1293,6 +1293,7 @@ raptor_grddl_run_recursive(raptor_parser* rdf_parser, raptor_uri* uri,
   rpbc.base_uri = NULL;
   rpbc.final_uri = NULL;
   rpbc.started = 0;
+  rpbc.buffer = NULL;
   
   if(ignore_errors)
     fetch_uri_flags |=FETCH_IGNORE_ERRORS;
@@ -42,6 +42,10 @@ extern "C" {
 #undef HAVE_STDLIB_H
 #endif
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 /* Some internal functions are needed by the test programs */
 #ifndef RAPTOR_INTERNAL_API
 #define RAPTOR_INTERNAL_API RAPTOR_API
@@ -425,6 +429,19 @@ raptor_world* raptor_iostream_get_world(raptor_iostream *iostr);
 
 
 /* Raptor Namespace Stack node */
+/* Node in the namespace URI prefix trie: one per byte of every
+ * in-scope namespace URI, shared between URIs with common prefixes */
+typedef struct raptor_namespace_trie_node_s raptor_namespace_trie_node;
+struct raptor_namespace_trie_node_s {
+  raptor_namespace_trie_node* parent;
+  /* first child and next sibling; siblings have distinct bytes */
+  raptor_namespace_trie_node* children;
+  raptor_namespace_trie_node* sibling;
+  /* namespaces with exactly the URI ending here, innermost first */
+  struct raptor_namespace_s* nspaces;
+  unsigned char c;
+};
+
 struct raptor_namespace_stack_s {
   raptor_world* world;
   int size;
@@ -435,6 +452,11 @@ struct raptor_namespace_stack_s {
 
   raptor_uri *rdf_ms_uri;
   raptor_uri *rdf_schema_uri;
+
+  /* root of the prefix trie indexing namespaces by URI */
+  raptor_namespace_trie_node* uri_trie;
+  /* non-0 if a namespace could not be indexed; lookups scan instead */
+  int uri_trie_incomplete;
 };
 
 
@@ -465,6 +487,9 @@ struct raptor_namespace_s {
   int is_rdf_ms;
   /* Non 0 if is RDF Schema Namespace */
   int is_rdf_schema;
+  /* URI trie node holding this namespace (or NULL) and next there */
+  raptor_namespace_trie_node* uri_node;
+  struct raptor_namespace_s* uri_next;
 };
 
 raptor_namespace** raptor_namespace_stack_to_array(raptor_namespace_stack *nstack, size_t *size_p);
@@ -474,13 +499,21 @@ raptor_namespace** raptor_namespace_stack_to_array(raptor_namespace_stack *nstac
 #endif
 
 
-/* Size of buffer to use when reading from a file */
+/* Default size of buffer to use when reading from a file; see
+ * RAPTOR_OPTION_READ_BUFFER_SIZE */
 #if defined(BUFSIZ) && BUFSIZ > 4096
 #define RAPTOR_READ_BUFFER_SIZE BUFSIZ
 #else
 #define RAPTOR_READ_BUFFER_SIZE 4096
 #endif
 
+/* Smallest RAPTOR_OPTION_READ_BUFFER_SIZE used; the first chunk must
+ * be large enough for the guess parser to recognise the syntax */
+#define RAPTOR_READ_BUFFER_SIZE_MIN 1024
+
+/* Write buffer size of iostreams created by a serializer */
+#define RAPTOR_SERIALIZER_WRITE_BUFFER_SIZE 8192
+
 
 /*
  * Raptor parser object
@@ -548,8 +581,9 @@ struct raptor_parser_s {
   /* internal data for lexers */
   void* lexer_user_data;
 
-  /* internal read buffer */
-  unsigned char buffer[RAPTOR_READ_BUFFER_SIZE + 1];
+  /* internal read buffer of buffer_size bytes plus a NUL */
+  unsigned char* buffer;
+  size_t buffer_size;
 };
 
 
@@ -690,6 +724,10 @@ typedef struct
   raptor_uri* base_uri;
   raptor_uri* final_uri;
   int started;
+  /* if not NULL, gather written bytes into chunks of buffer_size */
+  unsigned char* buffer;
+  size_t buffer_size;
+  size_t buffer_length;
 } raptor_parse_bytes_context;
 
 
@@ -710,8 +748,30 @@ void raptor_stats_print(raptor_parser *rdf_parser, FILE *stream);
 RAPTOR_INTERNAL_API const char* raptor_basename(const char *name);
 int raptor_term_print_as_ntriples(const raptor_term *term, FILE* stream);
 
+/* raptor_arena.c */
+typedef struct raptor_arena_s raptor_arena;
+
+raptor_arena* raptor_new_arena(size_t block_size);
+void raptor_free_arena(raptor_arena* arena);
+void* raptor_arena_alloc(raptor_arena* arena, size_t size);
+int raptor_arena_add_uri(raptor_arena* arena, raptor_uri* uri);
+void raptor_arena_reset(raptor_arena* arena);
+
+/* raptor_extsort.c */
+typedef struct raptor_extsort_s raptor_extsort;
+
+raptor_extsort* raptor_new_extsort(raptor_world* world, int limit);
+void raptor_free_extsort(raptor_extsort* sorter);
+int raptor_extsort_add(raptor_extsort* sorter, raptor_statement* statement);
+int raptor_extsort_visit(raptor_extsort* sorter, raptor_avltree_visit_handler visit_handler, void* user_data);
+
+/* raptor_term.c */
+raptor_term* raptor_arena_new_term_from_uri(raptor_arena* arena, raptor_world* world, raptor_uri* uri);
+raptor_term* raptor_arena_new_term_from_counted_literal(raptor_arena* arena, raptor_world* world, const unsigned char* literal, size_t literal_len, raptor_uri* datatype, const unsigned char* language, unsigned char language_len);
+raptor_term* raptor_arena_new_term_from_counted_blank(raptor_arena* arena, raptor_world* world, const unsigned char* blank, size_t length);
+
 /* raptor_ntriples.c */
-size_t raptor_ntriples_parse_term(raptor_world* world, raptor_locator* locator, unsigned char *string, size_t *len_p, raptor_term** term_p, int allow_turtle);
+size_t raptor_ntriples_parse_term(raptor_world* world, raptor_locator* locator, unsigned char *string, size_t *len_p, raptor_term** term_p, int allow_turtle, raptor_arena* arena);
 
 /* raptor_parse.c */
 raptor_parser_factory* raptor_world_get_parser_factory(raptor_world* world, const char *name);  
@@ -755,6 +815,11 @@ int raptor_parser_copy_user_state(raptor_parser *to_parser, raptor_parser *from_
 extern int raptor_valid_xml_ID(raptor_parser *rdf_parser, const unsigned char *string);
 int raptor_check_ordinal(const unsigned char *name);
 
+/* raptor_xml.c */
+size_t raptor_xml_namechars_suffix_offset(const unsigned char *string, size_t length, int xml_version);
+int raptor_xml_name_suffix_check(const unsigned char *string, size_t length, size_t offset, size_t run_offset, int xml_version);
+size_t raptor_xml_name_split_offset(const unsigned char *string, size_t length, int xml_version);
+
 /* raptor_locator.c */
 
 
@@ -813,8 +878,12 @@ void raptor_qname_print(FILE *stream, raptor_qname* name);
 
 int raptor_uri_init(raptor_world* world);
 void raptor_uri_finish(raptor_world* world);
-raptor_uri* raptor_new_uri_from_rdf_ordinal(raptor_world* world, int ordinal);
+RAPTOR_INTERNAL_API unsigned int raptor_uri_interned_count(raptor_world* world);
+RAPTOR_INTERNAL_API raptor_uri* raptor_new_uri_from_rdf_ordinal(raptor_world* world, int ordinal);
+int raptor_uri_ordinals_init(raptor_world* world);
+void raptor_uri_ordinals_finish(raptor_world* world);
 size_t raptor_uri_normalize_path(unsigned char* path_buffer, size_t path_len);
+raptor_uri_detail* raptor_uri_get_detail(raptor_uri* uri);
 
 /* parsers */
 int raptor_init_parser_rdfxml(raptor_world* world);
@@ -829,6 +898,7 @@ int raptor_init_parser_rss(raptor_world* world);
 int raptor_init_parser_rdfa(raptor_world* world);
 int raptor_init_parser_json(raptor_world* world);
 int raptor_init_parser_nquads(raptor_world* world);
+int raptor_init_parser_binary(raptor_world* world);
 
 void raptor_terminate_parser_grddl_common(raptor_world *world);
 
@@ -861,6 +931,8 @@ void raptor_terminate_parser_grddl_common(raptor_world *world);
 #define rdfa_free_list raptor_librdfa_rdfa_free_list
 #define rdfa_free_mapping raptor_librdfa_rdfa_free_mapping
 #define rdfa_free_triple raptor_librdfa_rdfa_free_triple
+#define rdfa_generate_created_triple raptor_librdfa_rdfa_generate_created_triple
+#define rdfa_generate_triple raptor_librdfa_rdfa_generate_triple
 #define rdfa_get_buffer raptor_librdfa_rdfa_get_buffer
 #define rdfa_get_curie_type raptor_librdfa_rdfa_get_curie_type
 #define rdfa_get_list_mapping raptor_librdfa_rdfa_get_list_mapping
@@ -921,6 +993,7 @@ extern const unsigned char * const raptor_atom_namespace_uri;
 RAPTOR_INTERNAL_API raptor_uri_detail* raptor_new_uri_detail(const unsigned char *uri_string);
 RAPTOR_INTERNAL_API void raptor_free_uri_detail(raptor_uri_detail* uri_detail);
 unsigned char* raptor_uri_detail_to_string(raptor_uri_detail *ud, size_t* len_p);
+RAPTOR_INTERNAL_API size_t raptor_uri_resolve_uri_reference_detail(const unsigned char *base_uri, raptor_uri_detail* base, const unsigned char *reference_uri, unsigned char *buffer, size_t length);
 
 /* serializers */
 /* raptor_serializer.c */
@@ -950,6 +1023,9 @@ int raptor_init_serializer_html(raptor_world* world);
 /* raptor_serialize_json.c */  
 int raptor_init_serializer_json(raptor_world* world);
 
+/* raptor_binary.c */
+int raptor_init_serializer_binary(raptor_world* world);
+
 /* raptor_unicode.c */
 extern const raptor_unichar raptor_unicode_max_codepoint;
 
@@ -1258,6 +1334,7 @@ typedef struct {
   int count_as_object;   /* count of this blank/resource node as object */
   
   raptor_term* term;
+  uint64_t hash;         /* raptor_term_hash() of term or 0 if not yet used */
 } raptor_abbrev_node;
 
 #ifdef RAPTOR_DEBUG
@@ -1292,6 +1369,7 @@ raptor_abbrev_node* raptor_new_abbrev_node(raptor_world* world, raptor_term* ter
 void raptor_free_abbrev_node(raptor_abbrev_node* node);
 int raptor_abbrev_node_compare(raptor_abbrev_node* node1, raptor_abbrev_node* node2);
 int raptor_abbrev_node_equals(raptor_abbrev_node* node1, raptor_abbrev_node* node2);
+int raptor_abbrev_node_lookup_compare(raptor_abbrev_node* node1, raptor_abbrev_node* node2);
 raptor_abbrev_node* raptor_abbrev_node_lookup(raptor_avltree* nodes, raptor_term* term);
 
 void raptor_free_abbrev_subject(raptor_abbrev_subject* subject);
@@ -1383,6 +1461,57 @@ int raptor_json_writer_key_uri_value(raptor_json_writer* json_writer, const char
 /* raptor_memstr.c */
 const char* raptor_memstr(const char *haystack, size_t haystack_len, const char *needle);
 
+/* raptor_scan.c */
+/* maximum number of bytes in a raptor_scan_bytes() set */
+#define RAPTOR_SCAN_SET_MAX 10
+
+/* set of bytes prepared by raptor_scan_set_init() */
+typedef struct {
+  unsigned int len;
+  /* each byte repeated for the SIMD compares */
+  unsigned char needles[RAPTOR_SCAN_SET_MAX][32];
+  /* if non-0, bytes below this and from 0x7f up are in the set too */
+  unsigned char printable_first;
+  /* non-0 for the bytes in the set */
+  unsigned char in_set[256];
+} raptor_scan_set;
+
+void raptor_scan_set_init(raptor_scan_set *set, const unsigned char *bytes, unsigned int len);
+void raptor_scan_set_add_nonprintable(raptor_scan_set *set, unsigned char first);
+size_t raptor_scan_bytes(const unsigned char *buffer, size_t len, const raptor_scan_set *set);
+
+/* raptor_thread.c */
+typedef struct raptor_thread_pool_s raptor_thread_pool;
+typedef struct raptor_thread_task_s raptor_thread_task;
+typedef struct raptor_thread_log_handler_s raptor_thread_log_handler;
+
+/* run a task in a worker thread */
+typedef void (*raptor_thread_task_handler)(raptor_thread_task* task);
+/* receives messages logged by the worker thread while it runs a task */
+typedef void (*raptor_thread_task_log_handler)(raptor_thread_task* task, raptor_log_level level, raptor_locator* locator, const char* text);
+
+struct raptor_thread_task_s {
+  raptor_thread_task_handler handler;
+  /* if NULL, messages go to the world log handler */
+  raptor_thread_task_log_handler log_handler;
+  void* user_data;
+
+  /* next task in the pool queue or completed list */
+  raptor_thread_task* next;
+};
+
+int raptor_threads_init(raptor_world* world);
+void raptor_threads_finish(raptor_world* world);
+raptor_thread_task* raptor_thread_current_task(raptor_world* world);
+raptor_thread_log_handler* raptor_thread_current_log_handler(raptor_world* world);
+raptor_thread_pool* raptor_new_thread_pool(raptor_world* world, int threads_count);
+void raptor_free_thread_pool(raptor_thread_pool* pool);
+int raptor_thread_pool_add_task(raptor_thread_pool* pool, raptor_thread_task* task);
+raptor_thread_task* raptor_thread_pool_wait_task(raptor_thread_pool* pool);
+int raptor_threads_set_log_handler(raptor_world* world, void* user_data, raptor_log_handler handler);
+int raptor_world_atomic_add(raptor_world* world, int* value, int delta);
+int raptor_world_atomic_add_unless(raptor_world* world, int* value, int delta, int unless);
+
 /* raptor_serialize_rdfxmla.c special functions for embedding rdf/xml */
 int raptor_rdfxmla_serialize_set_write_rdf_RDF(raptor_serializer* serializer, int value);
 int raptor_rdfxmla_serialize_set_xml_writer(raptor_serializer* serializer, raptor_xml_writer* xml_writer, raptor_namespace_stack *nstack);
@@ -1407,6 +1536,35 @@ size_t raptor_format_integer(char* buffer, size_t bufsize, int integer, unsigned
 RAPTOR_INTERNAL_API int raptor_check_world_internal(raptor_world* world, const char* name);
 
 
+/* number of URI interning tables in a thread-safe world: a power of 2
+ * up to 16 */
+#define RAPTOR_URI_TABLES_COUNT 16
+
+/* URI interning table: open addressing with linear probing.  size is
+ * a power of 2 and the table is kept at most half full. */
+typedef struct {
+  raptor_uri **uris;
+  unsigned int size;
+  unsigned int count;
+#ifdef HAVE_PTHREAD_H
+  /* held while the table is used in a locking world */
+  pthread_mutex_t mutex;
+#endif
+} raptor_uri_table;
+
+/* chunks of world rdf:_n ordinal URIs; see raptor_uri.c */
+#define RAPTOR_URI_ORDINALS_CHUNKS 12
+
+/* log handler set for one thread with
+ * raptor_world_set_thread_log_handler() */
+struct raptor_thread_log_handler_s {
+  void* user_data;
+  raptor_log_handler handler;
+
+  /* next in the world list of thread handlers */
+  raptor_thread_log_handler* next;
+};
+
 
 struct raptor_world_s {
   /* signature to check this is a world object */
@@ -1464,7 +1622,12 @@ struct raptor_world_s {
   xmlGenericErrorFunc libxml_saved_generic_error_handler;
 #endif  
 
-  raptor_avltree *uris_tree;
+  /* URI interning tables, picked by the top bits of the URI hash.
+   * There is one table unless the world is thread-safe, so that
+   * threads interning URIs rarely wait for each other.
+   */
+  raptor_uri_table *uris_tables;
+  unsigned int uris_tables_count;
 
   raptor_uri* concepts[RDF_NS_LAST + 1];
 
@@ -1489,8 +1652,62 @@ struct raptor_world_s {
   raptor_uri* xsd_decimal_uri;
   raptor_uri* xsd_double_uri;
   raptor_uri* xsd_integer_uri;
+
+  /* rdf:_n ordinal URIs in chunks of growing size; the small ones are
+   * made when the world is opened, later ones on first use.  See
+   * raptor_new_uri_from_rdf_ordinal() */
+  raptor_uri** ordinal_uris[RAPTOR_URI_ORDINALS_CHUNKS];
+
+  /* Non-0 if set with RAPTOR_WORLD_FLAG_THREAD_SAFE: the world is
+   * always locking once opened */
+  int thread_safe;
+
+  /* Non-0 while raptor_thread_pool worker threads are running or the
+   * world is thread-safe.  URI tables are then only touched with their
+   * mutex held, usage counts and the blank node ID counter change
+   * atomically and messages may be routed by thread.  Read it with
+   * RAPTOR_WORLD_LOCKING() as other threads may change it.
+   */
+  int locking;
+#ifdef HAVE_PTHREAD_H
+  int threads_initialized;
+  /* held for the thread log handlers list and world data made on
+   * first use; see RAPTOR_WORLD_LOCK() */
+  pthread_mutex_t mutex;
+  /* held by raptor_world_atomic_add() without atomic builtins */
+  pthread_mutex_t atomic_mutex;
+  /* raptor_thread_task* being run by the current worker thread */
+  pthread_key_t thread_task_key;
+  /* raptor_thread_log_handler* for the current thread */
+  pthread_key_t thread_log_key;
+  /* all thread log handlers, freed with the world */
+  raptor_thread_log_handler* thread_log_handlers;
+#endif
 };
 
+#ifdef HAVE_ATOMIC_BUILTINS
+#define RAPTOR_WORLD_LOCKING(world) \
+  __atomic_load_n(&(world)->locking, __ATOMIC_ACQUIRE)
+#else
+#define RAPTOR_WORLD_LOCKING(world) ((world)->locking)
+#endif
+
+#ifdef HAVE_PTHREAD_H
+#define RAPTOR_WORLD_LOCK(world)                                        \
+  do {                                                                  \
+    if(RAPTOR_WORLD_LOCKING(world))                                     \
+      pthread_mutex_lock(&(world)->mutex);                              \
+  } while(0)
+#define RAPTOR_WORLD_UNLOCK(world)                                      \
+  do {                                                                  \
+    if(RAPTOR_WORLD_LOCKING(world))                                     \
+      pthread_mutex_unlock(&(world)->mutex);                            \
+  } while(0)
+#else
+#define RAPTOR_WORLD_LOCK(world) do { } while(0)
+#define RAPTOR_WORLD_UNLOCK(world) do { } while(0)
+#endif
+
 /* raptor_www.c */
 int raptor_www_init(raptor_world* world);
 void raptor_www_finish(raptor_world* world);
@@ -53,6 +53,13 @@ struct raptor_iostream_s
   size_t offset;
   unsigned int mode;
   int flags;
+
+  /* write buffer or NULL if writes go straight to the handler */
+  unsigned char* buffer;
+  /* size of buffer; 0 when there is no buffer */
+  size_t buffer_size;
+  /* bytes in buffer waiting to be written */
+  size_t buffer_length;
 };
 
 
@@ -694,6 +701,11 @@ raptor_free_iostream(raptor_iostream *iostr)
   if(iostr->flags & RAPTOR_IOSTREAM_FLAGS_EOF)
     raptor_iostream_write_end(iostr);
 
+  if(iostr->buffer) {
+    raptor_iostream_write_flush(iostr);
+    RAPTOR_FREE(char*, iostr->buffer);
+  }
+
   if(iostr->handler->finish)
     iostr->handler->finish(iostr->user_data);
 
@@ -717,6 +729,17 @@ raptor_free_iostream(raptor_iostream *iostr)
 int
 raptor_iostream_write_byte(const int byte, raptor_iostream *iostr)
 {
+  if(iostr->buffer_size) {
+    if(iostr->buffer_length == iostr->buffer_size &&
+       raptor_iostream_write_flush(iostr)) {
+      iostr->offset++;
+      return 1;
+    }
+    iostr->buffer[iostr->buffer_length++] = RAPTOR_GOOD_CAST(unsigned char, byte);
+    iostr->offset++;
+    return 0;
+  }
+
   iostr->offset++;
 
   if(iostr->flags & RAPTOR_IOSTREAM_FLAGS_EOF)
@@ -753,6 +776,23 @@ raptor_iostream_write_bytes(const void *ptr, size_t size, size_t nmemb,
   if(!(iostr->mode & RAPTOR_IOSTREAM_MODE_WRITE))
     return -1;
 
+  if(iostr->buffer_size) {
+    size_t len = size * nmemb;
+
+    if(len > iostr->buffer_size - iostr->buffer_length) {
+      if(raptor_iostream_write_flush(iostr))
+        return -1;
+    }
+
+    if(len <= iostr->buffer_size - iostr->buffer_length) {
+      memcpy(iostr->buffer + iostr->buffer_length, ptr, len);
+      iostr->buffer_length += len;
+      iostr->offset += len;
+      return RAPTOR_BAD_CAST(int, nmemb);
+    }
+    /* otherwise too big to buffer so write it directly */
+  }
+
   nobj = iostr->handler->write_bytes(iostr->user_data, ptr, size, nmemb);
   if(nobj > 0)
     iostr->offset += (size * nobj);
@@ -832,14 +872,110 @@ raptor_iostream_write_end(raptor_iostream *iostr)
   
   if(iostr->flags & RAPTOR_IOSTREAM_FLAGS_EOF)
     return 1;
-  if(iostr->handler->write_end)
-    rc = iostr->handler->write_end(iostr->user_data);
+  if(iostr->buffer_size) {
+    rc = raptor_iostream_write_flush(iostr);
+    /* no more writes so no more buffering */
+    iostr->buffer_size = 0;
+  }
+  if(iostr->handler->write_end) {
+    int end_rc = iostr->handler->write_end(iostr->user_data);
+    if(end_rc)
+      rc = end_rc;
+  }
   iostr->flags |= RAPTOR_IOSTREAM_FLAGS_EOF;
 
   return rc;
 }
 
 
+/**
+ * raptor_iostream_write_flush:
+ * @iostr: raptor iostream
+ *
+ * Write any buffered bytes to the iostream handler.
+ *
+ * See raptor_iostream_set_write_buffer_size().
+ *
+ * Return value: non-0 on failure
+ **/
+int
+raptor_iostream_write_flush(raptor_iostream *iostr)
+{
+  size_t length = iostr->buffer_length;
+  int rc = 0;
+
+  if(!length)
+    return 0;
+
+  iostr->buffer_length = 0;
+
+  if(iostr->handler->write_bytes) {
+    int nobj;
+
+    nobj = iostr->handler->write_bytes(iostr->user_data, iostr->buffer,
+                                       1, length);
+    rc = (nobj < 0 || RAPTOR_BAD_CAST(size_t, nobj) != length);
+  } else {
+    size_t i;
+
+    for(i = 0; i < length && !rc; i++)
+      rc = iostr->handler->write_byte(iostr->user_data, iostr->buffer[i]);
+  }
+
+  return rc;
+}
+
+
+/**
+ * raptor_iostream_set_write_buffer_size:
+ * @iostr: raptor iostream
+ * @size: buffer size in bytes or 0 for no buffer
+ *
+ * Set the size of the buffer collecting writes to the iostream.
+ *
+ * When @size is greater than 0, small writes are collected and
+ * passed to the handler in blocks of up to @size bytes when the
+ * buffer is full, on raptor_iostream_write_flush(),
+ * raptor_iostream_write_end() or when the iostream is freed.  Writes
+ * are passed on at once when @size is 0, which is the default for
+ * iostreams created by the raptor_new_iostream_to_...() constructors.
+ *
+ * Any bytes already buffered are written first.
+ *
+ * Return value: non-0 on failure or if the iostream is not writable
+ **/
+int
+raptor_iostream_set_write_buffer_size(raptor_iostream *iostr, size_t size)
+{
+  unsigned char* buffer;
+
+  if(!(iostr->mode & RAPTOR_IOSTREAM_MODE_WRITE) ||
+     (iostr->flags & RAPTOR_IOSTREAM_FLAGS_EOF))
+    return 1;
+
+  if(raptor_iostream_write_flush(iostr))
+    return 1;
+
+  if(!size) {
+    if(iostr->buffer) {
+      RAPTOR_FREE(char*, iostr->buffer);
+      iostr->buffer = NULL;
+    }
+    iostr->buffer_size = 0;
+    return 0;
+  }
+
+  buffer = RAPTOR_REALLOC(unsigned char*, iostr->buffer, size);
+  if(!buffer)
+    return 1;
+
+  iostr->buffer = buffer;
+  iostr->buffer_size = size;
+
+  return 0;
+}
+
+
 /**
  * raptor_stringbuffer_write:
  * @sb: #raptor_stringbuffer to write
@@ -1359,6 +1495,144 @@ test_write_to_sink(raptor_world *world,
 }
 
 
+static int
+test_write_buffered_to_string(raptor_world *world,
+                              const char* test_string, size_t test_string_len,
+                              size_t buffer_size)
+{
+  raptor_iostream *iostr = NULL;
+  int rc = 0;
+  void *string = NULL;
+  size_t string_len;
+  size_t expected_len = (2 * test_string_len) + 2;
+  size_t i;
+  const char* const label="write buffered iostream to a string";
+
+#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
+  fprintf(stderr, "%s: Testing %s\n", program, label);
+#endif
+
+  iostr = raptor_new_iostream_to_string(world, &string, &string_len, NULL);
+  if(!iostr) {
+    fprintf(stderr, "%s: Failed to create write iostream to string\n",
+            program);
+    rc = 1;
+    goto tidy;
+  }
+
+  if(raptor_iostream_set_write_buffer_size(iostr, buffer_size)) {
+    fprintf(stderr, "%s: %s failed to set buffer size %d\n", program, label,
+            (int)buffer_size);
+    rc = 1;
+    goto tidy;
+  }
+
+  /* one block write, then byte by byte */
+  raptor_iostream_write_bytes(test_string, 1, test_string_len, iostr);
+  raptor_iostream_write_byte('\n', iostr);
+  for(i = 0; i < test_string_len; i++)
+    raptor_iostream_write_byte(test_string[i], iostr);
+  raptor_iostream_write_byte('\n', iostr);
+
+  if(raptor_iostream_tell(iostr) != expected_len) {
+    fprintf(stderr, "%s: %s wrote %d bytes, expected %d\n", program, label,
+            (int)raptor_iostream_tell(iostr), (int)expected_len);
+    rc = 1;
+  }
+
+  raptor_free_iostream(iostr); iostr = NULL;
+
+  if(!string || string_len != expected_len ||
+     strncmp((const char*)string, test_string, test_string_len) ||
+     strncmp((const char*)string + test_string_len + 1, test_string,
+             test_string_len)) {
+    fprintf(stderr, "%s: %s with buffer size %d created string '%s'\n",
+            program, label, (int)buffer_size,
+            string ? (const char*)string : "NULL");
+    rc = 1;
+  }
+
+  tidy:
+  if(string)
+    raptor_free_memory(string);
+  if(iostr)
+    raptor_free_iostream(iostr);
+
+  if(rc)
+    fprintf(stderr, "%s: FAILED Testing %s\n", program, label);
+
+  return rc;
+}
+
+
+#ifdef RAPTOR_SERIALIZER_NTRIPLES
+static int
+test_serializer_flush_to_file_handle(raptor_world *world, FILE* handle,
+                                     const char* test_string)
+{
+  raptor_serializer *serializer = NULL;
+  raptor_statement *statement = NULL;
+  long before;
+  long after;
+  int rc = 0;
+  const char* const label="flush serializer to file handle";
+
+#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
+  fprintf(stderr, "%s: Testing %s\n", program, label);
+#endif
+
+  serializer = raptor_new_serializer(world, "ntriples");
+  statement = raptor_new_statement_from_nodes(world,
+    raptor_new_term_from_uri_string(world,
+                                    (const unsigned char*)"http://example.org/s"),
+    raptor_new_term_from_uri_string(world,
+                                    (const unsigned char*)"http://example.org/p"),
+    raptor_new_term_from_literal(world, (const unsigned char*)test_string,
+                                 NULL, NULL),
+    NULL);
+  if(!serializer || !statement ||
+     raptor_serializer_start_to_file_handle(serializer, NULL, handle)) {
+    fprintf(stderr, "%s: Failed to create %s\n", program, label);
+    rc = 1;
+    goto tidy;
+  }
+
+  raptor_serializer_serialize_statement(serializer, statement);
+
+  /* the triple is smaller than the serializer's write buffer */
+  fflush(handle);
+  before = ftell(handle);
+
+  if(raptor_serializer_flush(serializer)) {
+    fprintf(stderr, "%s: %s failed\n", program, label);
+    rc = 1;
+    goto tidy;
+  }
+
+  fflush(handle);
+  after = ftell(handle);
+  if(after <= before) {
+    fprintf(stderr, "%s: %s left %d bytes in the file after flush\n",
+            program, label, (int)after);
+    rc = 1;
+  }
+
+  raptor_serializer_serialize_end(serializer);
+
+  tidy:
+  if(statement)
+    raptor_free_statement(statement);
+  if(serializer)
+    raptor_free_serializer(serializer);
+
+  if(rc)
+    fprintf(stderr, "%s: FAILED Testing %s\n", program, label);
+
+  return rc;
+}
+#endif
+
+
 static int
 test_read_from_filename(raptor_world *world,
                         const char* filename, 
@@ -1619,6 +1893,24 @@ main(int argc, char *argv[])
   failures+= test_write_to_sink(world,
                                 TEST_STRING,
                                 TEST_STRING_LEN, (int)OUT_BYTES_COUNT);
+  /* buffer smaller than and larger than the test string */
+  failures+= test_write_buffered_to_string(world,
+                                           TEST_STRING, TEST_STRING_LEN, 5);
+  failures+= test_write_buffered_to_string(world,
+                                           TEST_STRING, TEST_STRING_LEN, 1024);
+
+#ifdef RAPTOR_SERIALIZER_NTRIPLES
+  handle = fopen((const char*)OUT_FILENAME, "wb");
+  if(!handle) {
+    fprintf(stderr, "%s: Failed to create write file handle to file %s\n",
+            program, OUT_FILENAME);
+    failures++;
+  } else {
+    failures+= test_serializer_flush_to_file_handle(world, handle,
+                                                    TEST_STRING);
+    fclose(handle);
+  }
+#endif
 
   remove(OUT_FILENAME);
 
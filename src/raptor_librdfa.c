@@ -59,6 +59,10 @@ struct raptor_librdfa_parser_context_s {
 
   /* 10 for 1.0  11 for 1.1 or otherwise is default (== 1.1) */
   int rdfa_version;
+
+  /* terms for the last subject and predicate generated */
+  raptor_term* subject_term;
+  raptor_term* predicate_term;
 };
 
 
@@ -98,19 +102,88 @@ raptor_librdfa_parse_terminate(raptor_parser* rdf_parser)
     rdfa_free_context(librdfa_parser->context);
     librdfa_parser->context = NULL;
   }
+
+  if(librdfa_parser->subject_term) {
+    raptor_free_term(librdfa_parser->subject_term);
+    librdfa_parser->subject_term = NULL;
+  }
+  if(librdfa_parser->predicate_term) {
+    raptor_free_term(librdfa_parser->predicate_term);
+    librdfa_parser->predicate_term = NULL;
+  }
 }
 
 
+/*
+ * raptor_librdfa_resource_term:
+ * @parser: parser
+ * @cache: pointer to the term last made for this triple part
+ * @string: subject, predicate or object IRI or "_:" blank node string
+ *
+ * INTERNAL - Get a term for an RDFa resource string
+ *
+ * Consecutive triples usually share a subject and often a predicate so
+ * the term last made for the triple part is reused while the string
+ * matches, otherwise the string is interned as a URI.
+ *
+ * Return value: new term or NULL on failure
+ */
+static raptor_term*
+raptor_librdfa_resource_term(raptor_parser* parser, raptor_term** cache,
+                             const char* string)
+{
+  raptor_term* term = *cache;
+  int is_blank = (string[0] == '_' && string[1] == ':');
+
+  if(term) {
+    if(is_blank && term->type == RAPTOR_TERM_TYPE_BLANK) {
+      if(!strcmp((const char*)term->value.blank.string, string + 2))
+        return raptor_term_copy(term);
+    } else if(!is_blank && term->type == RAPTOR_TERM_TYPE_URI) {
+      if(!strcmp((const char*)raptor_uri_as_string(term->value.uri), string))
+        return raptor_term_copy(term);
+    }
+  }
+
+  if(is_blank)
+    term = raptor_new_term_from_blank(parser->world,
+                                      (const unsigned char*)string + 2);
+  else {
+    raptor_uri* uri;
+
+    uri = raptor_new_uri(parser->world, (const unsigned char*)string);
+    if(!uri)
+      return NULL;
+
+    term = raptor_new_term_from_uri(parser->world, uri);
+    raptor_free_uri(uri);
+  }
+  if(!term)
+    return NULL;
+
+  if(*cache)
+    raptor_free_term(*cache);
+  *cache = raptor_term_copy(term);
+
+  return term;
+}
+
+
+/*
+ * The triple is lent by librdfa and is only valid during this call.
+ */
 static void
 raptor_librdfa_generate_statement(rdftriple* triple, void* callback_data)
 {
   raptor_parser* parser = (raptor_parser*)callback_data;
+  raptor_librdfa_parser_context *librdfa_parser;
   raptor_statement *s = &parser->statement;
   raptor_term *subject_term = NULL;
   raptor_term *predicate_term = NULL;
-  raptor_uri *predicate_uri = NULL;
   raptor_term *object_term = NULL;
 
+  librdfa_parser = (raptor_librdfa_parser_context*)parser->context;
+
   if(!parser->emitted_default_graph) {
     raptor_parser_start_graph(parser, NULL, 0);
     parser->emitted_default_graph++;
@@ -123,7 +196,6 @@ raptor_librdfa_generate_statement(rdftriple* triple, void* callback_data)
 #ifdef RAPTOR_DEBUG
     RAPTOR_FATAL1("Triple has NULL parts\n");
 #else
-    rdfa_free_triple(triple);
     return;
 #endif
   }
@@ -132,7 +204,6 @@ raptor_librdfa_generate_statement(rdftriple* triple, void* callback_data)
     raptor_parser_warning(parser, 
                           "Ignoring RDFa triple with blank node predicate %s.",
                           triple->predicate);
-    rdfa_free_triple(triple);
     return;
   }
   
@@ -140,34 +211,23 @@ raptor_librdfa_generate_statement(rdftriple* triple, void* callback_data)
 #ifdef RAPTOR_DEBUG
     RAPTOR_FATAL1("Triple has namespace object type\n");
 #else
-    rdfa_free_triple(triple);
     return;
 #endif
   }
   
-  if((triple->subject[0] == '_') && (triple->subject[1] == ':')) {
-    subject_term = raptor_new_term_from_blank(parser->world,
-                                              (const unsigned char*)triple->subject + 2);
-  } else {
-    raptor_uri* subject_uri;
-    
-    subject_uri = raptor_new_uri(parser->world,
-                                 (const unsigned char*)triple->subject);
-    subject_term = raptor_new_term_from_uri(parser->world, subject_uri);
-    raptor_free_uri(subject_uri);
-    subject_uri = NULL;
-  }
+  subject_term = raptor_librdfa_resource_term(parser,
+                                              &librdfa_parser->subject_term,
+                                              triple->subject);
+  if(!subject_term)
+    goto cleanup;
   s->subject = subject_term;
   
 
-  predicate_uri = raptor_new_uri(parser->world,
-                                 (const unsigned char*)triple->predicate);
-  if(!predicate_uri)
+  predicate_term = raptor_librdfa_resource_term(parser,
+                                                &librdfa_parser->predicate_term,
+                                                triple->predicate);
+  if(!predicate_term)
     goto cleanup;
-
-  predicate_term = raptor_new_term_from_uri(parser->world, predicate_uri);
-  raptor_free_uri(predicate_uri);
-  predicate_uri = NULL;
   s->predicate = predicate_term;
  
 
@@ -231,8 +291,6 @@ raptor_librdfa_generate_statement(rdftriple* triple, void* callback_data)
   (*parser->statement_handler)(parser->user_data, s);
 
   cleanup:
-  rdfa_free_triple(triple);
-  
   if(subject_term)
     raptor_free_term(subject_term);
   if(predicate_term)
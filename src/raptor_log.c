@@ -125,6 +125,9 @@ raptor_log_error(raptor_world* world, raptor_log_level level,
                  raptor_locator* locator, const char* text)
 {
   raptor_log_handler handler;
+  void* handler_user_data;
+  raptor_log_message* message;
+  raptor_log_message thread_message;
 
   if(level == RAPTOR_LOG_LEVEL_NONE)
     return;
@@ -133,19 +136,42 @@ raptor_log_error(raptor_world* world, raptor_log_level level,
     if(world->internal_ignore_errors)
       return;
 
-    memset(&world->message, '\0', sizeof(world->message));
-    world->message.code = -1;
-    world->message.domain = RAPTOR_DOMAIN_NONE;
-    world->message.level = level;
-    world->message.locator = locator;
-    world->message.text = text;
-  
     handler = world->message_handler;
+    handler_user_data = world->message_handler_user_data;
+    message = &world->message;
+
+    if(RAPTOR_WORLD_LOCKING(world)) {
+      /* messages from a worker thread go to the task it is running */
+      raptor_thread_task* task = raptor_thread_current_task(world);
+      raptor_thread_log_handler* thread_handler;
+
+      if(task && task->log_handler) {
+        task->log_handler(task, level, locator, text);
+        return;
+      }
+
+      thread_handler = raptor_thread_current_log_handler(world);
+      if(thread_handler) {
+        handler = thread_handler->handler;
+        handler_user_data = thread_handler->user_data;
+      }
+
+      /* threads may log at once so do not use the world message */
+      message = &thread_message;
+    }
+
+    memset(message, '\0', sizeof(*message));
+    message->code = -1;
+    message->domain = RAPTOR_DOMAIN_NONE;
+    message->level = level;
+    message->locator = locator;
+    message->text = text;
+  
     if(handler) {
       /* This is the place in raptor that ALL of the user error handler
        * functions are called.
        */
-      handler(world->message_handler_user_data, &world->message);
+      handler(handler_user_data, message);
       return;
     }
   }
@@ -111,6 +111,145 @@ raptor_hash_ns_string(const unsigned char *str, int length)
 }
 
 
+/*
+ * Namespace URI prefix trie
+ *
+ * Every started namespace with a URI is indexed by the bytes of its
+ * URI so that finding a namespace by URI and finding the namespace
+ * whose URI is the longest prefix of a given URI take time linear in
+ * the URI length rather than scanning every namespace in the stack.
+ */
+
+/* find the child of @node for byte @c */
+static raptor_namespace_trie_node*
+raptor_namespace_trie_child(raptor_namespace_trie_node* node, unsigned char c)
+{
+  for(node = node->children; node; node = node->sibling)
+    if(node->c == c)
+      break;
+  return node;
+}
+
+
+/* find the trie node for exactly the URI string or NULL */
+static raptor_namespace_trie_node*
+raptor_namespaces_trie_find(raptor_namespace_stack *nstack,
+                            const unsigned char *uri_string, size_t uri_len)
+{
+  raptor_namespace_trie_node* node = nstack->uri_trie;
+  size_t i;
+
+  for(i = 0; node && i < uri_len; i++)
+    node = raptor_namespace_trie_child(node, uri_string[i]);
+
+  return node;
+}
+
+
+/* free unused nodes from @node back up to (but not including) the root */
+static void
+raptor_namespace_trie_prune(raptor_namespace_trie_node* node)
+{
+  while(node->parent && !node->nspaces && !node->children) {
+    raptor_namespace_trie_node* parent = node->parent;
+    raptor_namespace_trie_node** np;
+
+    for(np = &parent->children; *np != node; np = &(*np)->sibling)
+      ;
+    *np = node->sibling;
+    RAPTOR_FREE(raptor_namespace_trie_node, node);
+    node = parent;
+  }
+}
+
+
+/*
+ * raptor_namespaces_index_namespace:
+ * @nstack: namespace stack
+ * @nspace: namespace being started
+ *
+ * INTERNAL - Add a namespace to the URI prefix trie
+ *
+ * On failure the stack is marked so lookups fall back to scanning.
+ */
+static void
+raptor_namespaces_index_namespace(raptor_namespace_stack *nstack,
+                                  raptor_namespace *nspace)
+{
+  raptor_namespace_trie_node* node;
+  const unsigned char *uri_string;
+  size_t uri_len;
+  size_t i;
+
+  if(!nspace->uri)
+    return;
+
+  if(!nstack->uri_trie) {
+    nstack->uri_trie = RAPTOR_CALLOC(raptor_namespace_trie_node*, 1,
+                                     sizeof(*node));
+    if(!nstack->uri_trie) {
+      nstack->uri_trie_incomplete = 1;
+      return;
+    }
+  }
+
+  uri_string = raptor_uri_as_counted_string(nspace->uri, &uri_len);
+  node = nstack->uri_trie;
+  for(i = 0; i < uri_len; i++) {
+    raptor_namespace_trie_node* child;
+
+    child = raptor_namespace_trie_child(node, uri_string[i]);
+    if(!child) {
+      child = RAPTOR_CALLOC(raptor_namespace_trie_node*, 1, sizeof(*child));
+      if(!child) {
+        raptor_namespace_trie_prune(node);
+        nstack->uri_trie_incomplete = 1;
+        return;
+      }
+      child->parent = node;
+      child->c = uri_string[i];
+      child->sibling = node->children;
+      node->children = child;
+    }
+    node = child;
+  }
+
+  nspace->uri_next = node->nspaces;
+  node->nspaces = nspace;
+  nspace->uri_node = node;
+}
+
+
+/*
+ * raptor_namespaces_unindex_namespace:
+ * @nspace: namespace being ended or freed
+ *
+ * INTERNAL - Remove a namespace from its stack's URI prefix trie
+ *
+ * Trie nodes left with no namespaces and no children are freed.
+ */
+static void
+raptor_namespaces_unindex_namespace(raptor_namespace *nspace)
+{
+  raptor_namespace_trie_node* node = nspace->uri_node;
+  raptor_namespace** nsp;
+
+  if(!node)
+    return;
+
+  for(nsp = &node->nspaces; *nsp; nsp = &(*nsp)->uri_next) {
+    if(*nsp == nspace) {
+      *nsp = nspace->uri_next;
+      break;
+    }
+  }
+  nspace->uri_node = NULL;
+  nspace->uri_next = NULL;
+
+  raptor_namespace_trie_prune(node);
+}
+
+
 #define RAPTOR_NAMESPACES_HASHTABLE_SIZE 1024
 /**
  * raptor_namespaces_init:
@@ -147,6 +286,9 @@ raptor_namespaces_init(raptor_world* world,
 
   nstack->def_namespace = NULL;
 
+  nstack->uri_trie = NULL;
+  nstack->uri_trie_incomplete = 0;
+
   nstack->rdf_ms_uri = raptor_new_uri_from_counted_string(nstack->world,
                                                           (const unsigned char*)raptor_rdf_namespace_uri,
                                                           raptor_rdf_namespace_uri_len);
@@ -242,6 +384,8 @@ raptor_namespaces_start_namespace(raptor_namespace_stack *nstack,
   if(!nstack->def_namespace)
     nstack->def_namespace = nspace;
 
+  raptor_namespaces_index_namespace(nstack, nspace);
+
 #ifndef STANDALONE
 #ifdef RAPTOR_DEBUG_VERBOSE
     RAPTOR_DEBUG3("start namespace prefix %s depth %d\n", nspace->prefix ? (char*)nspace->prefix : "(default)", nspace->depth);
@@ -311,6 +455,13 @@ raptor_namespaces_clear(raptor_namespace_stack *nstack)
     nstack->table_size = 0;
   }
 
+  /* freeing the namespaces pruned the trie back to the root */
+  if(nstack->uri_trie) {
+    RAPTOR_FREE(raptor_namespace_trie_node, nstack->uri_trie);
+    nstack->uri_trie = NULL;
+  }
+  nstack->uri_trie_incomplete = 0;
+
   if(nstack->world) {
     if(nstack->rdf_ms_uri) {
       raptor_free_uri(nstack->rdf_ms_uri);
@@ -454,18 +605,27 @@ raptor_namespaces_find_namespace_by_uri(raptor_namespace_stack *nstack,
                                         raptor_uri *ns_uri)
 {
   int bucket;
+  raptor_namespace_trie_node* node;
+  const unsigned char *uri_string;
+  size_t uri_len;
 
   if(!ns_uri)
     return NULL;
-  
-  for(bucket = 0; bucket < nstack->table_size; bucket++) {
-    raptor_namespace* ns;
-    for(ns = nstack->table[bucket]; ns ; ns = ns->next)
-      if(raptor_uri_equals(ns->uri, ns_uri))
-        return ns;
-   }
-  
-  return NULL;
+
+  if(nstack->uri_trie_incomplete) {
+    for(bucket = 0; bucket < nstack->table_size; bucket++) {
+      raptor_namespace* ns;
+      for(ns = nstack->table[bucket]; ns ; ns = ns->next)
+        if(raptor_uri_equals(ns->uri, ns_uri))
+          return ns;
+    }
+    return NULL;
+  }
+
+  uri_string = raptor_uri_as_counted_string(ns_uri, &uri_len);
+  node = raptor_namespaces_trie_find(nstack, uri_string, uri_len);
+
+  return node ? node->nspaces : NULL;
 }
 
 
@@ -484,6 +644,10 @@ raptor_namespaces_namespace_in_scope(raptor_namespace_stack *nstack,
 {
   raptor_namespace* ns;
   int bucket;
+
+  if(nspace->uri && !nstack->uri_trie_incomplete)
+    return raptor_namespaces_find_namespace_by_uri(nstack,
+                                                   nspace->uri) != NULL;
   
   for(bucket = 0; bucket < nstack->table_size; bucket++) {
     for(ns = nstack->table[bucket]; ns ; ns = ns->next)
@@ -683,6 +847,8 @@ raptor_free_namespace(raptor_namespace *ns)
   if(!ns)
     return;
 
+  raptor_namespaces_unindex_namespace(ns);
+
   if(ns->uri)
     raptor_free_uri(ns->uri);
 
@@ -963,7 +1129,8 @@ raptor_xml_namespace_string_parse(const unsigned char *string,
  * Make an appropriate XML Qname from the namespaces on a namespace stack
  * 
  * Makes a qname from the in-scope namespaces in a stack if the URI matches
- * the prefix and the rest is a legal XML name.
+ * the prefix and the rest is a legal XML name.  When several namespace
+ * URIs match, the longest is used.
  *
  * Return value: #raptor_qname for the URI or NULL on failure
  **/
@@ -978,12 +1145,38 @@ raptor_new_qname_from_namespace_uri(raptor_namespace_stack *nstack,
   size_t ns_uri_len;
   unsigned char *name = NULL;
   int bucket;
+  raptor_namespace_trie_node* node;
+  size_t run_offset;
+  size_t i;
 
   if(!uri)
     return NULL;
   
   uri_string = raptor_uri_as_counted_string(uri, &uri_len);
 
+  if(!nstack->uri_trie_incomplete) {
+    /* One pass over the URI finds where a local name may start, then
+     * one walk down the trie visits every namespace URI prefix */
+    run_offset = raptor_xml_namechars_suffix_offset(uri_string, uri_len,
+                                                    xml_version);
+    node = nstack->uri_trie;
+    for(i = 0; node && i < uri_len; i++) {
+      if(node->nspaces &&
+         raptor_xml_name_suffix_check(uri_string, uri_len, i, run_offset,
+                                      xml_version)) {
+        ns = node->nspaces;
+        name = uri_string + i;
+      }
+      node = raptor_namespace_trie_child(node, uri_string[i]);
+    }
+
+    if(!ns)
+      return NULL;
+
+    return raptor_new_qname_from_namespace_local_name(nstack->world, ns,
+                                                      name, NULL);
+  }
+
   for(bucket = 0; bucket < nstack->table_size; bucket++) {
     for(ns = nstack->table[bucket]; ns ; ns = ns->next) {
       if(!ns->uri)
@@ -1091,6 +1284,8 @@ main(int argc, char *argv[])
   const char *program = raptor_basename(argv[0]);
   raptor_namespace_stack namespaces; /* static */
   raptor_namespace* ns;
+  raptor_uri* uri;
+  raptor_qname* qname;
 
   world = raptor_new_world();
   if(!world || raptor_world_open(world))
@@ -1133,10 +1328,66 @@ main(int argc, char *argv[])
     return(1);
   }
 
+  raptor_namespaces_start_namespace_full(&namespaces,
+                                         (const unsigned char*)"ex4",
+                                         (const unsigned char*)"http://example.org/ns1/sub/",
+                                         2);
+
+  /* longest namespace URI prefix wins */
+  uri = raptor_new_uri(world,
+                       (const unsigned char*)"http://example.org/ns1/sub/name");
+  qname = raptor_new_qname_from_namespace_uri(&namespaces, uri, 10);
+  if(!qname || !qname->nspace || !qname->nspace->prefix ||
+     strcmp((const char*)qname->nspace->prefix, "ex4") ||
+     strcmp((const char*)qname->local_name, "name")) {
+    fprintf(stderr, "%s: qname for %s not ex4:name, returning error\n",
+            program, raptor_uri_as_string(uri));
+    return(1);
+  }
+  raptor_free_qname(qname);
+  raptor_free_uri(uri);
+
+  uri = raptor_new_uri(world, (const unsigned char*)"http://example.org/ns2");
+  ns = raptor_namespaces_find_namespace_by_uri(&namespaces, uri);
+  if(!ns || strcmp((const char*)ns->prefix, "ex2")) {
+    fprintf(stderr, "%s: namespace for %s not ex2, returning error\n",
+            program, raptor_uri_as_string(uri));
+    return(1);
+  }
+
   raptor_namespaces_end_for_depth(&namespaces, 2);
 
   raptor_namespaces_end_for_depth(&namespaces, 1);
 
+  if(raptor_namespaces_find_namespace_by_uri(&namespaces, uri)) {
+    fprintf(stderr, "%s: namespace for %s found after ending it, returning error\n",
+            program, raptor_uri_as_string(uri));
+    return(1);
+  }
+  raptor_free_uri(uri);
+
+  /* the remaining local name must be a legal XML name */
+  uri = raptor_new_uri(world,
+                       (const unsigned char*)"http://example.org/ns1/sub/name");
+  qname = raptor_new_qname_from_namespace_uri(&namespaces, uri, 10);
+  if(qname) {
+    fprintf(stderr, "%s: unexpected qname for %s, returning error\n",
+            program, raptor_uri_as_string(uri));
+    return(1);
+  }
+  raptor_free_uri(uri);
+
+  uri = raptor_new_uri(world, (const unsigned char*)"http://example.org/ns1name");
+  qname = raptor_new_qname_from_namespace_uri(&namespaces, uri, 10);
+  if(!qname || strcmp((const char*)qname->nspace->prefix, "ex1") ||
+     strcmp((const char*)qname->local_name, "name")) {
+    fprintf(stderr, "%s: qname for %s not ex1:name, returning error\n",
+            program, raptor_uri_as_string(uri));
+    return(1);
+  }
+  raptor_free_qname(qname);
+  raptor_free_uri(uri);
+
   raptor_namespaces_end_for_depth(&namespaces, 0);
 
   raptor_namespaces_clear(&namespaces);
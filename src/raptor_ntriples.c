@@ -446,6 +446,7 @@ raptor_parse_turtle_term_internal(raptor_world* world,
  * @len_p: pointer to length of @string (in/out)
  * @term_p: pointer to store term (out)
  * @allow_turtle: non-0 to allow Turtle forms such as integers, boolean
+ * @arena: arena to allocate the term in or NULL
  *
  * INTERNAL - Parse an N-Triples string into a #raptor_term
  *
@@ -458,7 +459,8 @@ raptor_parse_turtle_term_internal(raptor_world* world,
 size_t
 raptor_ntriples_parse_term(raptor_world* world, raptor_locator* locator,
                            unsigned char *string, size_t *len_p,
-                           raptor_term** term_p, int allow_turtle)
+                           raptor_term** term_p, int allow_turtle,
+                           raptor_arena* arena)
 {
   unsigned char *p = string;
   unsigned char *dest;
@@ -503,7 +505,10 @@ raptor_ntriples_parse_term(raptor_world* world, raptor_locator* locator,
           goto fail;
         }
 
-        *term_p = raptor_new_term_from_uri(world, uri);
+        if(arena)
+          *term_p = raptor_arena_new_term_from_uri(arena, world, uri);
+        else
+          *term_p = raptor_new_term_from_uri(world, uri);
         raptor_free_uri(uri);
       }
       break;
@@ -532,10 +537,19 @@ raptor_ntriples_parse_term(raptor_world* world, raptor_locator* locator,
           goto fail;
         }
 
-        *term_p = raptor_new_term_from_literal(world,
-                                               dest,
-                                               datatype_uri,
-                                               NULL /* language */);
+        if(arena)
+          *term_p = raptor_arena_new_term_from_counted_literal(arena, world,
+                                                               dest,
+                                                               strlen((const char*)dest),
+                                                               datatype_uri,
+                                                               NULL, 0);
+        else
+          *term_p = raptor_new_term_from_literal(world,
+                                                 dest,
+                                                 datatype_uri,
+                                                 NULL /* language */);
+        if(datatype_uri)
+          raptor_free_uri(datatype_uri);
       } else
         goto fail;
       break;
@@ -659,10 +673,20 @@ raptor_ntriples_parse_term(raptor_world* world, raptor_locator* locator,
           object_literal_language = NULL;
         }
 
-        *term_p = raptor_new_term_from_literal(world,
-                                               dest,
-                                               datatype_uri,
-                                               object_literal_language);
+        if(arena)
+          *term_p = raptor_arena_new_term_from_counted_literal(arena, world,
+                                                               dest,
+                                                               strlen((const char*)dest),
+                                                               datatype_uri,
+                                                               object_literal_language,
+                                                               object_literal_language ? RAPTOR_BAD_CAST(unsigned char, strlen((const char*)object_literal_language)) : 0);
+        else
+          *term_p = raptor_new_term_from_literal(world,
+                                                 dest,
+                                                 datatype_uri,
+                                                 object_literal_language);
+        if(datatype_uri)
+          raptor_free_uri(datatype_uri);
       }
 
       break;
@@ -706,7 +730,12 @@ raptor_ntriples_parse_term(raptor_world* world, raptor_locator* locator,
           goto fail;
         }
 
-        *term_p = raptor_new_term_from_blank(world, dest);
+        if(arena)
+          *term_p = raptor_arena_new_term_from_counted_blank(arena, world,
+                                                             dest,
+                                                             strlen((const char*)dest));
+        else
+          *term_p = raptor_new_term_from_blank(world, dest);
 
         break;
 
@@ -296,6 +296,54 @@ static const struct
     RAPTOR_OPTION_VALUE_TYPE_BOOL,
     "loadExternalEntities",
     "Parsers and SAX2 should load external entities."
+  },
+  { RAPTOR_OPTION_PARALLEL_THREADS,
+    RAPTOR_OPTION_AREA_PARSER,
+    RAPTOR_OPTION_VALUE_TYPE_INT,
+    "parallelThreads",
+    "N-Triples, N-Quads, Turtle and TriG parsers use this many threads."
+  },
+  { RAPTOR_OPTION_PARALLEL_UNORDERED,
+    RAPTOR_OPTION_AREA_PARSER,
+    RAPTOR_OPTION_VALUE_TYPE_BOOL,
+    "parallelUnordered",
+    "Parallel parsers may return statements out of input order."
+  },
+  { RAPTOR_OPTION_READ_BUFFER_SIZE,
+    RAPTOR_OPTION_AREA_PARSER,
+    RAPTOR_OPTION_VALUE_TYPE_INT,
+    "readBufferSize",
+    "Parsers read content in chunks of this many bytes."
+  },
+  { RAPTOR_OPTION_READ_AHEAD,
+    RAPTOR_OPTION_AREA_PARSER,
+    RAPTOR_OPTION_VALUE_TYPE_BOOL,
+    "readAhead",
+    "Parsers read the next chunk of content in the background."
+  },
+  { RAPTOR_OPTION_TERM_ARENA,
+    RAPTOR_OPTION_AREA_PARSER,
+    RAPTOR_OPTION_VALUE_TYPE_BOOL,
+    "termArena",
+    "N-Triples and N-Quads parsers reuse statement term memory."
+  },
+  { RAPTOR_OPTION_STREAMING,
+    RAPTOR_OPTION_AREA_SERIALIZER,
+    RAPTOR_OPTION_VALUE_TYPE_BOOL,
+    "streaming",
+    "Turtle serializer writes statements as they are given."
+  },
+  { RAPTOR_OPTION_JSON_SORT_LIMIT,
+    RAPTOR_OPTION_AREA_SERIALIZER,
+    RAPTOR_OPTION_VALUE_TYPE_INT,
+    "jsonSortLimit",
+    "JSON resource serializer sorts this many statements in memory before using temporary files."
+  },
+  { RAPTOR_OPTION_MAP_FILES,
+    RAPTOR_OPTION_AREA_PARSER,
+    RAPTOR_OPTION_VALUE_TYPE_BOOL,
+    "mapFiles",
+    "Parsers memory map files; a file truncated while parsing raises SIGBUS."
   }
 };
 
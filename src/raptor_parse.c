@@ -43,6 +43,9 @@
 #ifdef HAVE_FCNTL_H
 #include <fcntl.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 /* Raptor includes */
 #include "raptor2.h"
@@ -128,6 +131,10 @@ raptor_parsers_init(raptor_world *world)
   rc+= raptor_init_parser_nquads(world) != 0;
 #endif
 
+#ifdef RAPTOR_PARSER_BINARY
+  rc+= raptor_init_parser_binary(world) != 0;
+#endif
+
   return rc;
 }
 
@@ -511,12 +518,272 @@ raptor_free_parser(raptor_parser* rdf_parser)
   if(rdf_parser->sb)
     raptor_free_stringbuffer(rdf_parser->sb);
 
+  if(rdf_parser->buffer)
+    RAPTOR_FREE(char*, rdf_parser->buffer);
+
   raptor_object_options_clear(&rdf_parser->options);
 
   RAPTOR_FREE(raptor_parser, rdf_parser);
 }
 
 
+/*
+ * raptor_parser_read_buffer_size:
+ * @rdf_parser: parser
+ *
+ * INTERNAL - Get the number of bytes to read from content at a time
+ *
+ * Return value: RAPTOR_OPTION_READ_BUFFER_SIZE or the default size
+ */
+static size_t
+raptor_parser_read_buffer_size(raptor_parser* rdf_parser)
+{
+  int size;
+
+  size = RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_READ_BUFFER_SIZE);
+  if(size > 0) {
+    if(size < RAPTOR_READ_BUFFER_SIZE_MIN)
+      size = RAPTOR_READ_BUFFER_SIZE_MIN;
+    return RAPTOR_GOOD_CAST(size_t, size);
+  }
+
+  return RAPTOR_READ_BUFFER_SIZE;
+}
+
+
+/*
+ * raptor_parser_get_read_buffer:
+ * @rdf_parser: parser
+ * @size: buffer size
+ *
+ * INTERNAL - Get the parser read buffer, allocating it to hold @size bytes and a NUL
+ *
+ * Return value: buffer or NULL on failure
+ */
+static unsigned char*
+raptor_parser_get_read_buffer(raptor_parser* rdf_parser, size_t size)
+{
+  if(rdf_parser->buffer && rdf_parser->buffer_size == size)
+    return rdf_parser->buffer;
+
+  if(rdf_parser->buffer)
+    RAPTOR_FREE(char*, rdf_parser->buffer);
+
+  rdf_parser->buffer = RAPTOR_MALLOC(unsigned char*, size + 1);
+  rdf_parser->buffer_size = rdf_parser->buffer ? size : 0;
+
+  if(!rdf_parser->buffer)
+    raptor_parser_fatal_error(rdf_parser, "Out of memory");
+
+  return rdf_parser->buffer;
+}
+
+
+/*
+ * raptor_parser_read_handler:
+ * @source: source of content
+ * @buffer: buffer to read into
+ * @size: maximum bytes to read
+ *
+ * INTERNAL - Read content for raptor_parser_parse_read_loop()
+ *
+ * Return value: number of bytes read, less than @size at the end of
+ * content, or <0 if there is no more content to read
+ */
+typedef int (*raptor_parser_read_handler)(void* source, unsigned char* buffer,
+                                          size_t size);
+
+
+static int
+raptor_parser_read_file_stream(void* source, unsigned char* buffer,
+                               size_t size)
+{
+  FILE* stream = (FILE*)source;
+
+  if(feof(stream))
+    return -1;
+
+  return RAPTOR_BAD_CAST(int, fread(buffer, 1, size, stream));
+}
+
+
+static int
+raptor_parser_read_iostream(void* source, unsigned char* buffer, size_t size)
+{
+  raptor_iostream* iostr = (raptor_iostream*)source;
+
+  if(raptor_iostream_read_eof(iostr))
+    return -1;
+
+  return raptor_iostream_read_bytes(buffer, 1, size, iostr);
+}
+
+
+/* a background read of one chunk for raptor_parser_parse_read_ahead() */
+typedef struct {
+  raptor_thread_task task;
+  raptor_parser_read_handler read_handler;
+  void* source;
+  unsigned char* buffer;
+  size_t size;
+  /* result of read_handler */
+  int length;
+} raptor_parser_read_task;
+
+
+static void
+raptor_parser_read_task_handler(raptor_thread_task* task)
+{
+  raptor_parser_read_task* read_task;
+
+  read_task = (raptor_parser_read_task*)task->user_data;
+  read_task->length = read_task->read_handler(read_task->source,
+                                              read_task->buffer,
+                                              read_task->size);
+}
+
+
+/*
+ * raptor_parser_parse_read_ahead:
+ * @rdf_parser: parser
+ * @read_handler: content read function
+ * @source: content source for @read_handler
+ * @size: chunk size
+ *
+ * INTERNAL - Parse content read in chunks by a background thread
+ *
+ * Two buffers are used: while the parser works on one, the next chunk
+ * is read into the other by a worker thread.
+ *
+ * Return value: <0 if a worker thread cannot be started and the
+ * content should be read in the calling thread, otherwise the result
+ * of the last raptor_parser_parse_chunk()
+ */
+static int
+raptor_parser_parse_read_ahead(raptor_parser* rdf_parser,
+                               raptor_parser_read_handler read_handler,
+                               void* source, size_t size)
+{
+  raptor_thread_pool* pool;
+  raptor_parser_read_task read_tasks[2];
+  unsigned char* ahead_buffer;
+  int current = 0;
+  int rc = 0;
+  int i;
+
+  if(!raptor_parser_get_read_buffer(rdf_parser, size))
+    return 1;
+
+  ahead_buffer = RAPTOR_MALLOC(unsigned char*, size + 1);
+  if(!ahead_buffer)
+    return -1;
+
+  pool = raptor_new_thread_pool(rdf_parser->world, 1);
+  if(!pool) {
+    RAPTOR_FREE(char*, ahead_buffer);
+    return -1;
+  }
+
+  for(i = 0; i < 2; i++) {
+    read_tasks[i].task.handler = raptor_parser_read_task_handler;
+    read_tasks[i].task.log_handler = NULL;
+    read_tasks[i].task.user_data = &read_tasks[i];
+    read_tasks[i].read_handler = read_handler;
+    read_tasks[i].source = source;
+    read_tasks[i].size = size;
+    read_tasks[i].length = -1;
+  }
+  read_tasks[0].buffer = rdf_parser->buffer;
+  read_tasks[1].buffer = ahead_buffer;
+
+  raptor_thread_pool_add_task(pool, &read_tasks[0].task);
+
+  while(raptor_thread_pool_wait_task(pool)) {
+    raptor_parser_read_task* read_task = &read_tasks[current];
+    size_t len;
+    int is_end;
+
+    if(read_task->length < 0)
+      break;
+
+    len = RAPTOR_GOOD_CAST(size_t, read_task->length);
+    is_end = (len < size);
+
+    /* start reading the next chunk before parsing this one */
+    current = 1 - current;
+    if(!is_end)
+      raptor_thread_pool_add_task(pool, &read_tasks[current].task);
+
+    read_task->buffer[len] = '\0';
+    rc = raptor_parser_parse_chunk(rdf_parser, read_task->buffer, len, is_end);
+    if(rc || is_end)
+      break;
+  }
+
+  /* waits for any read still running */
+  raptor_free_thread_pool(pool);
+
+  RAPTOR_FREE(char*, ahead_buffer);
+
+  return rc;
+}
+
+
+/*
+ * raptor_parser_parse_read_loop:
+ * @rdf_parser: parser
+ * @read_handler: content read function
+ * @source: content source for @read_handler
+ *
+ * INTERNAL - Parse content read in chunks of RAPTOR_OPTION_READ_BUFFER_SIZE
+ *
+ * Uses raptor_parser_parse_read_ahead() if RAPTOR_OPTION_READ_AHEAD
+ * is set and threads are available.
+ *
+ * Return value: result of the last raptor_parser_parse_chunk()
+ */
+static int
+raptor_parser_parse_read_loop(raptor_parser* rdf_parser,
+                              raptor_parser_read_handler read_handler,
+                              void* source)
+{
+  size_t size = raptor_parser_read_buffer_size(rdf_parser);
+  unsigned char* buffer;
+  int rc = 0;
+
+  if(RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_READ_AHEAD)) {
+    rc = raptor_parser_parse_read_ahead(rdf_parser, read_handler, source,
+                                        size);
+    if(rc >= 0)
+      return rc;
+    rc = 0;
+  }
+
+  buffer = raptor_parser_get_read_buffer(rdf_parser, size);
+  if(!buffer)
+    return 1;
+
+  while(1) {
+    int ilen;
+    size_t len;
+    int is_end;
+
+    ilen = read_handler(source, buffer, size);
+    if(ilen < 0)
+      break;
+    len = RAPTOR_GOOD_CAST(size_t, ilen);
+    is_end = (len < size);
+
+    buffer[len] = '\0';
+    rc = raptor_parser_parse_chunk(rdf_parser, buffer, len, is_end);
+    if(rc || is_end)
+      break;
+  }
+
+  return rc;
+}
+
+
 /**
  * raptor_parser_parse_file_stream:
  * @rdf_parser: parser
@@ -546,18 +813,106 @@ raptor_parser_parse_file_stream(raptor_parser* rdf_parser,
 
   if(raptor_parser_parse_start(rdf_parser, base_uri))
     return 1;
-  
-  while(!feof(stream)) {
-    size_t len = fread(rdf_parser->buffer, 1, RAPTOR_READ_BUFFER_SIZE, stream);
-    int is_end = (len < RAPTOR_READ_BUFFER_SIZE);
-    rdf_parser->buffer[len] = '\0';
-    rc = raptor_parser_parse_chunk(rdf_parser, rdf_parser->buffer, len, is_end);
-    if(rc || is_end)
+
+  rc = raptor_parser_parse_read_loop(rdf_parser,
+                                     raptor_parser_read_file_stream, stream);
+
+  return (rc != 0);
+}
+
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && defined(HAVE_SYS_STAT_H)
+#define RAPTOR_PARSE_FILE_MMAP 1
+
+/* Bytes of a memory mapped file passed to the parser at a time unless
+ * RAPTOR_OPTION_READ_BUFFER_SIZE is set */
+#define RAPTOR_MMAP_CHUNK_SIZE (1 << 20)
+
+/*
+ * raptor_parser_parse_file_mmap:
+ * @rdf_parser: parser
+ * @stream: FILE* of RDF content that has not been read from
+ * @filename: filename of content
+ * @base_uri: the base URI to use
+ *
+ * Parse RDF content from a regular file by memory mapping it.
+ *
+ * The parser chunk method is given the mapped bytes directly in
+ * large pieces, saving the copy into the parser read buffer.  The
+ * mapping is private and writable so parsers that temporarily modify
+ * the buffer they are given (such as the guess parser) still work.
+ *
+ * Only used when #RAPTOR_OPTION_MAP_FILES is set: if the file is
+ * truncated while it is parsed, touching the pages past the new end
+ * raises SIGBUS rather than giving a short read.
+ *
+ * Return value: <0 if the file cannot be mapped and should be read
+ * with raptor_parser_parse_file_stream(), >0 on failure, 0 on success
+ */
+static int
+raptor_parser_parse_file_mmap(raptor_parser* rdf_parser,
+                              FILE *stream, const char* filename,
+                              raptor_uri *base_uri)
+{
+  raptor_locator *locator = &rdf_parser->locator;
+  struct stat buf;
+  int fd = fileno(stream);
+  unsigned char* data;
+  size_t size;
+  size_t offset;
+  size_t chunk_size = RAPTOR_MMAP_CHUNK_SIZE;
+  int rc = 0;
+
+  if(fd < 0 || fstat(fd, &buf) || !S_ISREG(buf.st_mode) || buf.st_size <= 0)
+    return -1;
+
+  size = RAPTOR_BAD_CAST(size_t, buf.st_size);
+  if(RAPTOR_GOOD_CAST(off_t, size) != buf.st_size)
+    /* too big to map in this address space */
+    return -1;
+
+  data = (unsigned char*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE, fd, 0);
+  if(data == (unsigned char*)MAP_FAILED)
+    return -1;
+
+#ifdef HAVE_MADVISE
+  madvise(data, size, MADV_SEQUENTIAL);
+#endif
+
+  locator->line= locator->column = -1;
+  locator->file= filename;
+
+  if(raptor_parser_parse_start(rdf_parser, base_uri)) {
+    munmap(data, size);
+    return 1;
+  }
+
+  if(RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_READ_BUFFER_SIZE) > 0)
+    chunk_size = raptor_parser_read_buffer_size(rdf_parser);
+
+  for(offset = 0; offset < size; offset += chunk_size) {
+    size_t len = size - offset;
+
+    if(len > chunk_size)
+      len = chunk_size;
+
+    rc = raptor_parser_parse_chunk(rdf_parser, data + offset, len, 0);
+    if(rc)
       break;
   }
 
+  /* the end is signalled separately since the mapping may end
+   * exactly at the end of the data with no room for a NUL
+   */
+  if(!rc)
+    rc = raptor_parser_parse_chunk(rdf_parser, NULL, 0, 1);
+
+  munmap(data, size);
+
   return (rc != 0);
 }
+#endif
 
 
 /**
@@ -569,6 +924,11 @@ raptor_parser_parse_file_stream(raptor_parser* rdf_parser,
  * Parse RDF content at a file URI.
  *
  * If @uri is NULL (source is stdin), then the @base_uri is required.
+ *
+ * If #RAPTOR_OPTION_MAP_FILES is set and #RAPTOR_OPTION_READ_AHEAD
+ * is not, regular files are memory mapped and passed to the parser in
+ * large pieces rather than read with stdio.  A file truncated while
+ * it is mapped makes the process get a SIGBUS signal.
  * 
  * Return value: non 0 on failure
  **/
@@ -613,6 +973,17 @@ raptor_parser_parse_file(raptor_parser* rdf_parser, raptor_uri *uri,
     fh = stdin;
   }
 
+#ifdef RAPTOR_PARSE_FILE_MMAP
+  if(uri &&
+     RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_MAP_FILES) &&
+     !RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_READ_AHEAD)) {
+    rc = raptor_parser_parse_file_mmap(rdf_parser, fh, filename, base_uri);
+    if(rc >= 0)
+      goto cleanup;
+    rc = 0;
+  }
+#endif
+
   rc = raptor_parser_parse_file_stream(rdf_parser, fh, filename, base_uri);
 
   cleanup:
@@ -650,6 +1021,24 @@ raptor_parser_parse_uri_write_bytes(raptor_www* www,
     rpbc->started = 1;
   }
 
+  if(rpbc->buffer) {
+    /* gather small network reads into chunks of the read buffer size */
+    if(rpbc->buffer_length + len > rpbc->buffer_size &&
+       rpbc->buffer_length) {
+      rpbc->buffer[rpbc->buffer_length] = '\0';
+      if(raptor_parser_parse_chunk(rpbc->rdf_parser, rpbc->buffer,
+                                   rpbc->buffer_length, 0))
+        raptor_www_abort(www, "Parsing failed");
+      rpbc->buffer_length = 0;
+    }
+
+    if(len < rpbc->buffer_size) {
+      memcpy(rpbc->buffer + rpbc->buffer_length, ptr, len);
+      rpbc->buffer_length += len;
+      return;
+    }
+  }
+
   if(raptor_parser_parse_chunk(rpbc->rdf_parser, (unsigned char*)ptr, len, 0))
     raptor_www_abort(www, "Parsing failed");
 }
@@ -767,6 +1156,16 @@ raptor_parser_parse_uri_with_connection(raptor_parser* rdf_parser,
   rpbc.base_uri = base_uri;
   rpbc.final_uri = NULL;
   rpbc.started = 0;
+  rpbc.buffer = NULL;
+  rpbc.buffer_size = 0;
+  rpbc.buffer_length = 0;
+
+  if(RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_READ_BUFFER_SIZE) > 0) {
+    rpbc.buffer_size = raptor_parser_read_buffer_size(rdf_parser);
+    rpbc.buffer = raptor_parser_get_read_buffer(rdf_parser, rpbc.buffer_size);
+    if(!rpbc.buffer)
+      return 1;
+  }
   
   if(rdf_parser->uri_filter)
     raptor_www_set_uri_filter(rdf_parser->www, rdf_parser->uri_filter,
@@ -822,7 +1221,13 @@ raptor_parser_parse_uri_with_connection(raptor_parser* rdf_parser,
     return 1;
   }
 
-  if(raptor_parser_parse_chunk(rdf_parser, NULL, 0, 1))
+  if(rpbc.buffer_length) {
+    rpbc.buffer[rpbc.buffer_length] = '\0';
+    ret = raptor_parser_parse_chunk(rdf_parser, rpbc.buffer,
+                                    rpbc.buffer_length, 1);
+  } else
+    ret = raptor_parser_parse_chunk(rdf_parser, NULL, 0, 1);
+  if(ret)
     rdf_parser->failed = 1;
 
   raptor_free_www(rdf_parser->www);
@@ -1371,8 +1776,8 @@ raptor_world_guess_parser_name(raptor_world* world,
        * RDF/XML examples
        */
 #define FIRSTN 1024
-#if FIRSTN > RAPTOR_READ_BUFFER_SIZE
-#error "RAPTOR_READ_BUFFER_SIZE is not large enough"
+#if FIRSTN > RAPTOR_READ_BUFFER_SIZE_MIN
+#error "RAPTOR_READ_BUFFER_SIZE_MIN is not large enough"
 #endif
       if(buffer && len && len > FIRSTN) {
         c = buffer[FIRSTN];
@@ -1737,25 +2142,9 @@ raptor_parser_parse_iostream(raptor_parser* rdf_parser, raptor_iostream *iostr,
   rc = raptor_parser_parse_start(rdf_parser, base_uri);
   if(rc)
     return rc;
-  
-  while(!raptor_iostream_read_eof(iostr)) {
-    int ilen;
-    size_t len;
-    int is_end;
-
-    ilen = raptor_iostream_read_bytes(rdf_parser->buffer, 1,
-                                      RAPTOR_READ_BUFFER_SIZE, iostr);
-    if(ilen < 0)
-      break;
-    len = RAPTOR_GOOD_CAST(size_t, ilen);
-    is_end = (len < RAPTOR_READ_BUFFER_SIZE);
 
-    rc = raptor_parser_parse_chunk(rdf_parser, rdf_parser->buffer, len, is_end);
-    if(rc || is_end)
-      break;
-  }
-  
-  return rc;
+  return raptor_parser_parse_read_loop(rdf_parser,
+                                       raptor_parser_read_iostream, iostr);
 }
 
 
@@ -1262,16 +1262,8 @@ raptor_rdfxml_generate_statement(raptor_parser *rdf_parser,
     statement->predicate = bag_predicate_term;
 
     if(!reified_term || !reified_term->value.blank.string) {
-      unsigned char *reified_id = NULL;
-
       /* reified_term is NULL so generate a bag ID */
-      reified_id = raptor_world_generate_bnodeid(rdf_parser->world);
-      if(!reified_id)
-        goto generate_tidy;
-
-      reified_term = raptor_new_term_from_blank(rdf_parser->world, reified_id);
-      RAPTOR_FREE(char*, reified_id);
-
+      reified_term = raptor_new_term_from_blank(rdf_parser->world, NULL);
       if(!reified_term)
         goto generate_tidy;
       free_reified_term = 1;
@@ -1825,15 +1817,8 @@ raptor_rdfxml_start_element_grammar(raptor_parser *rdf_parser,
           /* copy from parent (property element), it has a URI for us */
           element->subject = raptor_term_copy(element->parent->object);
         } else {
-          unsigned char* subject_id;
-          subject_id = raptor_world_generate_bnodeid(rdf_parser->world);
-          if(!subject_id)
-            goto oom;
-
           element->subject = raptor_new_term_from_blank(rdf_parser->world,
-                                                        subject_id);
-          RAPTOR_FREE(char*, subject_id);
-
+                                                        NULL);
           if(!element->subject)
             goto oom;
         }
@@ -2249,21 +2234,13 @@ raptor_rdfxml_start_element_grammar(raptor_parser *rdf_parser,
           if(!strcmp((char*)parse_type, "Literal"))
             is_parseType_Literal = 1;
           else if(!strcmp((char*)parse_type, "Resource")) {
-            unsigned char* subject_id;
-            
             state = RAPTOR_STATE_PARSETYPE_RESOURCE;
             element->child_state = RAPTOR_STATE_PROPERTYELT;
             element->child_content_type = RAPTOR_RDFXML_ELEMENT_CONTENT_TYPE_PROPERTIES;
 
             /* create a node for the subject of the contained properties */
-            subject_id = raptor_world_generate_bnodeid(rdf_parser->world);
-            if(!subject_id)
-              goto oom;
-
             element->subject = raptor_new_term_from_blank(rdf_parser->world,
-                                                          subject_id);
-            RAPTOR_FREE(char*, subject_id);
-
+                                                          NULL);
             if(!element->subject)
               goto oom;
           } else if(!strcmp((char*)parse_type, "Collection")) {
@@ -2651,15 +2628,8 @@ raptor_rdfxml_end_element_grammar(raptor_parser *rdf_parser,
                   break;
                 }
               } else {
-                unsigned char* resource_id;
-                resource_id = raptor_world_generate_bnodeid(rdf_parser->world);
-                if(!resource_id)
-                  goto oom;
-                
                 element->object = raptor_new_term_from_blank(rdf_parser->world,
-                                                             resource_id);
-                RAPTOR_FREE(char*, resource_id);
-
+                                                             NULL);
                 if(!element->object)
                   goto oom;
                 element->content_type = RAPTOR_RDFXML_ELEMENT_CONTENT_TYPE_RESOURCE;
@@ -2723,15 +2693,8 @@ raptor_rdfxml_end_element_grammar(raptor_parser *rdf_parser,
               if(element->content_type == RAPTOR_RDFXML_ELEMENT_CONTENT_TYPE_LITERAL &&
                  raptor_rdfxml_element_has_property_attributes(element) &&
                  !element->object) {
-                unsigned char* object_id;
-                object_id = raptor_world_generate_bnodeid(rdf_parser->world);
-                if(!object_id)
-                  goto oom;
-                
                 element->object = raptor_new_term_from_blank(rdf_parser->world,
-                                                             object_id);
-                RAPTOR_FREE(char*, object_id);
-
+                                                             NULL);
                 if(!element->object)
                   goto oom;
                 element->content_type = RAPTOR_RDFXML_ELEMENT_CONTENT_TYPE_RESOURCE;
@@ -42,34 +42,37 @@
 
 #ifndef STANDALONE
 
-/**
- * raptor_new_uri_detail:
+/* Size of a buffer needed by raptor_uri_detail_init() for a URI of
+ * length len.  The extra +5 is for the 5 \0s that may be added for
+ * each component even if the entire URI is empty
+ */
+#define RAPTOR_URI_DETAIL_BUFFER_SIZE(len) ((len) + 5 + 1)
+
+/* References up to this long are split on the stack when resolving */
+#define RAPTOR_URI_RESOLVE_STACK_DETAIL_SIZE 256
+
+
+/*
+ * raptor_uri_detail_init:
+ * @ud: URI detail to fill in
+ * @buffer: buffer of RAPTOR_URI_DETAIL_BUFFER_SIZE(@uri_len) bytes
  * @uri_string: The URI string to split
+ * @uri_len: length of @uri_string
  *
- * Create a URI detailed structure from a URI string.
- * 
- **/
-raptor_uri_detail*
-raptor_new_uri_detail(const unsigned char *uri_string)
+ * INTERNAL - Split a URI string into a caller-owned URI detail
+ *
+ * The components of @ud point into @buffer.
+ */
+static void
+raptor_uri_detail_init(raptor_uri_detail* ud, unsigned char* buffer,
+                       const unsigned char *uri_string, size_t uri_len)
 {
   const unsigned char *s = NULL;
   unsigned char *b = NULL;
-  raptor_uri_detail *ud;
-  size_t uri_len;
-
-  if(!uri_string)
-    return NULL;
-
-  uri_len = strlen((const char*)uri_string);
 
-  /* The extra +5 is for the 5 \0s that may be added for each component 
-   * even if the entire URI is empty 
-   */
-  ud = RAPTOR_CALLOC(raptor_uri_detail*, 1, sizeof(*ud) + uri_len + 5 + 1);
-  if(!ud)
-    return NULL;
+  memset(ud, 0, sizeof(*ud));
   ud->uri_len = uri_len;
-  ud->buffer = (unsigned char*)((unsigned char*)ud + sizeof(raptor_uri_detail));
+  ud->buffer = buffer;
   
   s = uri_string;
   b = ud->buffer;
@@ -166,6 +169,34 @@ raptor_new_uri_detail(const unsigned char *uri_string)
   }
 
   ud->is_hierarchical = (ud->path && *ud->path == '/');
+}
+
+
+/**
+ * raptor_new_uri_detail:
+ * @uri_string: The URI string to split
+ *
+ * Create a URI detailed structure from a URI string.
+ * 
+ **/
+raptor_uri_detail*
+raptor_new_uri_detail(const unsigned char *uri_string)
+{
+  raptor_uri_detail *ud;
+  size_t uri_len;
+
+  if(!uri_string)
+    return NULL;
+
+  uri_len = strlen((const char*)uri_string);
+
+  ud = RAPTOR_MALLOC(raptor_uri_detail*,
+                     sizeof(*ud) + RAPTOR_URI_DETAIL_BUFFER_SIZE(uri_len));
+  if(!ud)
+    return NULL;
+
+  raptor_uri_detail_init(ud, (unsigned char*)ud + sizeof(raptor_uri_detail),
+                         uri_string, uri_len);
 
   return ud;
 }
@@ -421,26 +452,74 @@ raptor_uri_normalize_path(unsigned char* path_buffer, size_t path_len)
 
 
 
-/**
- * raptor_uri_resolve_uri_reference:
+/*
+ * raptor_uri_resolve_path_buffer:
+ * @result: result URI detail with scheme and authority set
+ * @buffer: destination URI output buffer
+ * @length: length of @buffer
+ * @path_len: maximum length of the path before normalization
+ * @path_alloc_p: location to store an allocated path buffer
+ *
+ * INTERNAL - Find somewhere to build the result path
+ *
+ * If it fits, the path is built where it will end up in @buffer,
+ * after the scheme and authority, so it needs no copy; otherwise a
+ * buffer is allocated and returned in *@path_alloc_p to be freed.
+ *
+ * Return value: path buffer of at least @path_len + 1 bytes or NULL
+ */
+static unsigned char*
+raptor_uri_resolve_path_buffer(raptor_uri_detail* result,
+                               unsigned char *buffer, size_t length,
+                               size_t path_len, unsigned char** path_alloc_p)
+{
+  size_t offset = 0;
+
+  if(result->scheme)
+    offset += result->scheme_len + 1;
+  if(result->authority)
+    offset += 2 + result->authority_len;
+
+  if(offset + path_len < length)
+    return buffer + offset;
+
+  *path_alloc_p = RAPTOR_MALLOC(unsigned char*, path_len + 1);
+  return *path_alloc_p;
+}
+
+
+/*
+ * raptor_uri_resolve_uri_reference_detail:
  * @base_uri: Base URI string
+ * @base: parsed @base_uri or NULL to parse it when needed
  * @reference_uri: Reference URI string
  * @buffer: Destination URI output buffer
  * @length: Length of destination output buffer
  *
- * Resolve a URI against a base URI to create a new absolute URI.
- * 
+ * INTERNAL - Resolve a URI against a base URI with optional parsed base
+ *
+ * @base is not modified so it can be a cached detail shared between
+ * resolutions.  When @base is given, short references are resolved
+ * without any memory allocation.
+ *
  * Return value: length of resolved string or 0 on failure (such as @buffer too small)
- **/
+ */
 size_t
-raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
-                                 const unsigned char *reference_uri,
-                                 unsigned char *buffer, size_t length)
+raptor_uri_resolve_uri_reference_detail(const unsigned char *base_uri,
+                                        raptor_uri_detail* base,
+                                        const unsigned char *reference_uri,
+                                        unsigned char *buffer, size_t length)
 {
   raptor_uri_detail *ref = NULL;
-  raptor_uri_detail *base = NULL;
+  raptor_uri_detail *base_alloc = NULL;
+  raptor_uri_detail *ref_alloc = NULL;
+  raptor_uri_detail ref_detail;
+  unsigned char ref_buffer[RAPTOR_URI_DETAIL_BUFFER_SIZE(RAPTOR_URI_RESOLVE_STACK_DETAIL_SIZE)];
   raptor_uri_detail result; /* static - pointers go to inside ref or base */
   unsigned char *path_buffer = NULL;
+  unsigned char *path_alloc = NULL;
+  const unsigned char *base_path;
+  size_t base_path_len;
   unsigned char *p;
   size_t result_len = 0;
   size_t l;
@@ -455,9 +534,18 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
   *buffer = '\0';
   memset(&result, 0, sizeof(result));
 
-  ref = raptor_new_uri_detail(reference_uri);
-  if(!ref)
+  if(!reference_uri)
     goto resolve_tidy;
+
+  l = strlen((const char*)reference_uri);
+  if(l <= RAPTOR_URI_RESOLVE_STACK_DETAIL_SIZE) {
+    raptor_uri_detail_init(&ref_detail, ref_buffer, reference_uri, l);
+    ref = &ref_detail;
+  } else {
+    ref = ref_alloc = raptor_new_uri_detail(reference_uri);
+    if(!ref)
+      goto resolve_tidy;
+  }
   
 
   /* is reference URI "" or "#frag"? */
@@ -503,9 +591,11 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
     result.authority = ref->authority;
     result.authority_len = ref->authority_len;
     
-    /* Allocate path so it can be normalized below */
+    /* Copy path so it can be normalized below */
     result.path_len = ref->path_len;
-    path_buffer = RAPTOR_MALLOC(unsigned char*, result.path_len + 1);
+    path_buffer = raptor_uri_resolve_path_buffer(&result, buffer, length,
+                                                 result.path_len,
+                                                 &path_alloc);
     if(!path_buffer) {
       result_len = 0;
       goto resolve_tidy;
@@ -520,9 +610,11 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
   
 
   /* now the reference URI must be schemeless, i.e. relative */
-  base = raptor_new_uri_detail(base_uri);
-  if(!base)
-    goto resolve_tidy;
+  if(!base) {
+    base = base_alloc = raptor_new_uri_detail(base_uri);
+    if(!base)
+      goto resolve_tidy;
+  }
 
   /* result URI must be of the base URI scheme */
   result.scheme = base->scheme;
@@ -549,7 +641,9 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
      * is a non-hierarchical URI then just copy the reference path
      * to the result and normalize.
      */
-    path_buffer = RAPTOR_MALLOC(unsigned char*, ref->path_len + 1);
+    path_buffer = raptor_uri_resolve_path_buffer(&result, buffer, length,
+                                                 ref->path_len,
+                                                 &path_alloc);
     if(!path_buffer) {
       result_len = 0;
       goto resolve_tidy;
@@ -568,21 +662,23 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
   /* Build the result path in path_buffer */
   result.path_len = 0;
 
-  if(base->path)
-    result.path_len += base->path_len;
-  else {
+  if(base->path) {
+    base_path = base->path;
+    base_path_len = base->path_len;
+  } else {
     /* Add a missing path - makes the base URI 1 character longer */
-    base->path = (unsigned char*)"/"; /* static, but copied and not free()d  */
-    base->path_len = 1;
-    base->uri_len++;
-    result.path_len++;
+    base_path = (const unsigned char*)"/";
+    base_path_len = 1;
   }
+  result.path_len += base_path_len;
 
   if(ref->path)
     result.path_len += ref->path_len;
 
   /* the resulting path can be no longer than result.path_len */
-  path_buffer = RAPTOR_MALLOC(unsigned char*, result.path_len + 1);
+  path_buffer = raptor_uri_resolve_path_buffer(&result, buffer, length,
+                                               result.path_len,
+                                               &path_alloc);
   if(!path_buffer) {
     result_len = 0;
     goto resolve_tidy;
@@ -592,18 +688,21 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
 
   if(!ref->path) {
     /* If there is no reference path, copy the full base over */
-    result.path_len = base->path_len;
-    memcpy(path_buffer, base->path, result.path_len);
+    result.path_len = base_path_len;
+    memcpy(path_buffer, base_path, result.path_len);
   } else {
+    const unsigned char *bp;
+
     /** Otherwise copy base path up to previous / and append ref path */
-    for(p = base->path + base->path_len - 1; p > base->path && *p != '/'; p--)
+    for(bp = base_path + base_path_len - 1; bp > base_path && *bp != '/'; bp--)
       ;
 
-    if(p >= base->path) {
-      result.path_len = p-base->path + 1;
+    result.path_len = 0;
+    if(bp >= base_path) {
+      result.path_len = bp - base_path + 1;
 
       /* Found a /, copy everything before that to path_buffer */
-      memcpy(path_buffer, base->path, result.path_len);
+      memcpy(path_buffer, base_path, result.path_len);
       path_buffer[result.path_len] = '\0';
     }
 
@@ -642,6 +741,7 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
 
   if(l > length) {
     /* Output buffer is too small */
+    *buffer = '\0';
     result_len = 0;
     goto resolve_tidy;
   }
@@ -661,7 +761,9 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
   }
   
   if(result.path) {
-    memcpy(p, result.path, result.path_len);
+    /* a path built in place in buffer is already here */
+    if(result.path != p)
+      memcpy(p, result.path, result.path_len);
     p+= result.path_len;
   }
   
@@ -681,12 +783,12 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
   result_len = p - buffer;
 
   resolve_tidy:
-  if(path_buffer)
-    RAPTOR_FREE(char*, path_buffer);
-  if(base)
-    raptor_free_uri_detail(base);
-  if(ref)
-    raptor_free_uri_detail(ref);
+  if(path_alloc)
+    RAPTOR_FREE(char*, path_alloc);
+  if(base_alloc)
+    raptor_free_uri_detail(base_alloc);
+  if(ref_alloc)
+    raptor_free_uri_detail(ref_alloc);
 
 #ifdef RAPTOR_DEBUG
   RAPTOR_ASSERT(result_len && strlen((const char*)buffer) != result_len,
@@ -696,6 +798,28 @@ raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
   return result_len;
 }
 
+
+/**
+ * raptor_uri_resolve_uri_reference:
+ * @base_uri: Base URI string
+ * @reference_uri: Reference URI string
+ * @buffer: Destination URI output buffer
+ * @length: Length of destination output buffer
+ *
+ * Resolve a URI against a base URI to create a new absolute URI.
+ * 
+ * Return value: length of resolved string or 0 on failure (such as @buffer too small)
+ **/
+size_t
+raptor_uri_resolve_uri_reference(const unsigned char *base_uri,
+                                 const unsigned char *reference_uri,
+                                 unsigned char *buffer, size_t length)
+{
+  return raptor_uri_resolve_uri_reference_detail(base_uri, NULL,
+                                                 reference_uri,
+                                                 buffer, length);
+}
+
 #endif
 
 
@@ -715,6 +839,7 @@ check_resolve(const char *base_uri, const char *reference_uri,
               const char *result_uri)
 {
   unsigned char buffer[1024];
+  raptor_uri_detail* base_detail;
 
   raptor_uri_resolve_uri_reference((const unsigned char*)base_uri,
                                    (const unsigned char*)reference_uri,
@@ -727,6 +852,24 @@ check_resolve(const char *base_uri, const char *reference_uri,
               buffer, result_uri);
       return 1;
   }
+
+  /* again with a parsed base URI as kept by a raptor_uri */
+  base_detail = raptor_new_uri_detail((const unsigned char*)base_uri);
+  if(!base_detail)
+    return 1;
+  raptor_uri_resolve_uri_reference_detail((const unsigned char*)base_uri,
+                                          base_detail,
+                                          (const unsigned char*)reference_uri,
+                                          buffer, sizeof(buffer));
+  raptor_free_uri_detail(base_detail);
+
+  if(strcmp((const char*)buffer, result_uri)) {
+      fprintf(stderr,
+              "%s: raptor_uri_resolve_uri_reference_detail(%s, %s) FAILED giving '%s' != '%s'\n",
+              program, base_uri, reference_uri, 
+              buffer, result_uri);
+      return 1;
+  }
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 2
   fprintf(stderr,
           "%s: raptor_uri_resolve_uri_reference(%s, %s) OK giving '%s'\n",
@@ -536,7 +536,6 @@ raptor_rss_start_element_handler(void *user_data,
      RAPTOR_RSS_INFO_FLAG_BLOCK_VALUE) {
     raptor_rss_type block_type;
     raptor_rss_item* update_item;
-    const unsigned char *id;
     raptor_term* block_term;
     
     block_type = raptor_rss_fields_info[rss_parser->current_field].block_type;
@@ -546,9 +545,7 @@ raptor_rss_start_element_handler(void *user_data,
 
     update_item = raptor_rss_get_current_item(rss_parser);
 
-    id = raptor_world_generate_bnodeid(rdf_parser->world);
-    block_term = raptor_new_term_from_blank(rdf_parser->world, id);
-    RAPTOR_FREE(char*, id);
+    block_term = raptor_new_term_from_blank(rdf_parser->world, NULL);
 
     block = raptor_new_rss_block(rdf_parser->world, block_type, block_term);
     raptor_free_term(block_term);
@@ -1055,12 +1052,8 @@ raptor_rss_insert_identifiers(raptor_parser* rdf_parser)
         }
       
         if(!item->term) {
-          const unsigned char *id;
-
           /* need to make bnode */
-          id = raptor_world_generate_bnodeid(rdf_parser->world);
-          item->term = raptor_new_term_from_blank(rdf_parser->world, id);
-          RAPTOR_FREE(char*, id);
+          item->term = raptor_new_term_from_blank(rdf_parser->world, NULL);
         }
       }
 
@@ -1112,11 +1105,8 @@ raptor_rss_insert_identifiers(raptor_parser* rdf_parser)
     
     for(block = item->blocks; block; block = block->next) {
       if(!block->identifier) {
-        const unsigned char *id;
         /* need to make bnode */
-        id = raptor_world_generate_bnodeid(rdf_parser->world);
-        item->term = raptor_new_term_from_blank(rdf_parser->world, id);
-        RAPTOR_FREE(char*, id);
+        item->term = raptor_new_term_from_blank(rdf_parser->world, NULL);
       }
     }
     
@@ -1422,14 +1412,10 @@ raptor_rss_emit(raptor_parser* rdf_parser)
 
   /* Emit the feed item blocks */
   if(rss_parser->model.items_count) {
-    const unsigned char* id;
     raptor_term *items;
 
-    id = raptor_world_generate_bnodeid(rdf_parser->world);
-    
     /* make a new genid for the <rdf:Seq> node */
-    items = raptor_new_term_from_blank(rdf_parser->world, id);
-    RAPTOR_FREE(char*, id);
+    items = raptor_new_term_from_blank(rdf_parser->world, NULL);
 
     /* _:genid1 rdf:type rdf:Seq . */
     if(raptor_rss_emit_type_triple(rdf_parser, items,
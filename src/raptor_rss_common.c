@@ -295,8 +295,8 @@ const unsigned char * const raptor_atom_namespace_uri = (const unsigned char *)"
 
 
 
-int
-raptor_rss_common_init(raptor_world* world) {
+static int
+raptor_rss_common_init_uris(raptor_world* world) {
   int i;
   raptor_uri *namespace_uri;
 
@@ -351,8 +351,21 @@ raptor_rss_common_init(raptor_world* world) {
 }
 
 
-void
-raptor_rss_common_terminate(raptor_world* world) {
+int
+raptor_rss_common_init(raptor_world* world) {
+  int rc;
+
+  /* parsers and serializers in several threads may share the URIs */
+  RAPTOR_WORLD_LOCK(world);
+  rc = raptor_rss_common_init_uris(world);
+  RAPTOR_WORLD_UNLOCK(world);
+
+  return rc;
+}
+
+
+static void
+raptor_rss_common_terminate_uris(raptor_world* world) {
   int i;
   if(--world->rss_common_initialised)
     return;
@@ -386,6 +399,14 @@ raptor_rss_common_terminate(raptor_world* world) {
 }
 
 
+void
+raptor_rss_common_terminate(raptor_world* world) {
+  RAPTOR_WORLD_LOCK(world);
+  raptor_rss_common_terminate_uris(world);
+  RAPTOR_WORLD_UNLOCK(world);
+}
+
+
 void
 raptor_rss_model_init(raptor_world* world, raptor_rss_model* rss_model)
 {
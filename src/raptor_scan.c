@@ -0,0 +1,359 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * raptor_scan.c - fast search for a set of bytes in a block of memory
+ *
+ * Copyright (C) 2026, agent agent@local
+ *
+ * This package is Free Software and part of Redland http://librdf.org/
+ *
+ * It is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ *
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <raptor_config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#ifdef HAVE_X86_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+/* Raptor includes */
+#include "raptor2.h"
+#include "raptor_internal.h"
+
+
+typedef size_t (*raptor_scan_bytes_func)(const unsigned char *buffer,
+                                         size_t len,
+                                         const raptor_scan_set *set);
+
+
+/*
+ * raptor_scan_set_init:
+ * @set: set to initialise
+ * @bytes: bytes to search for
+ * @len: number of bytes in @bytes (1 to #RAPTOR_SCAN_SET_MAX)
+ *
+ * INTERNAL - Prepare a set of bytes for raptor_scan_bytes()
+ *
+ * The lookup table and SIMD compare values are made here once so
+ * that each raptor_scan_bytes() call only has to load them.
+ */
+void
+raptor_scan_set_init(raptor_scan_set *set, const unsigned char *bytes,
+                     unsigned int len)
+{
+  unsigned int i;
+
+  memset(set, 0, sizeof(*set));
+  set->len = len;
+  for(i = 0; i < len; i++) {
+    set->in_set[bytes[i]] = 1;
+    memset(set->needles[i], bytes[i], sizeof(set->needles[i]));
+  }
+}
+
+
+/*
+ * raptor_scan_set_add_nonprintable:
+ * @set: set from raptor_scan_set_init()
+ * @first: first printable byte (0x01 to 0x7e)
+ *
+ * INTERNAL - Add the bytes below @first and from 0x7f up to a set
+ *
+ * This covers ASCII controls, DEL and all UTF-8 bytes with two
+ * compares rather than one per byte.
+ */
+void
+raptor_scan_set_add_nonprintable(raptor_scan_set *set, unsigned char first)
+{
+  unsigned int i;
+
+  set->printable_first = first;
+  for(i = 0; i < first; i++)
+    set->in_set[i] = 1;
+  for(i = 0x7f; i < 256; i++)
+    set->in_set[i] = 1;
+}
+
+
+static size_t
+raptor_scan_bytes_scalar(const unsigned char *buffer, size_t len,
+                         const raptor_scan_set *set)
+{
+  const unsigned char *in_set = set->in_set;
+  size_t i;
+
+  for(i = 0; i < len; i++) {
+    if(in_set[buffer[i]])
+      break;
+  }
+
+  return i;
+}
+
+
+#ifdef HAVE_X86_SIMD_DISPATCH
+
+static size_t
+raptor_scan_bytes_sse2(const unsigned char *buffer, size_t len,
+                       const raptor_scan_set *set)
+{
+  __m128i needles[RAPTOR_SCAN_SET_MAX];
+  __m128i first = _mm_set1_epi8((char)set->printable_first);
+  __m128i del = _mm_set1_epi8(0x7f);
+  int nonprintable = (set->printable_first != 0);
+  unsigned int set_len = set->len;
+  size_t i = 0;
+  unsigned int j;
+
+  if(len < 16)
+    return raptor_scan_bytes_scalar(buffer, len, set);
+
+  for(j = 0; j < set_len; j++)
+    needles[j] = _mm_loadu_si128((const __m128i*)set->needles[j]);
+
+  for(; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(buffer + i));
+    __m128i hits = _mm_cmpeq_epi8(v, needles[0]);
+    int mask;
+
+    for(j = 1; j < set_len; j++)
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(v, needles[j]));
+
+    if(nonprintable) {
+      /* signed compare so bytes from 0x80 up are also below first */
+      hits = _mm_or_si128(hits, _mm_cmplt_epi8(v, first));
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(v, del));
+    }
+
+    mask = _mm_movemask_epi8(hits);
+    if(mask)
+      return i + (size_t)__builtin_ctz((unsigned int)mask);
+  }
+
+  return i + raptor_scan_bytes_scalar(buffer + i, len - i, set);
+}
+
+
+__attribute__((target("avx2")))
+static size_t
+raptor_scan_bytes_avx2(const unsigned char *buffer, size_t len,
+                       const raptor_scan_set *set)
+{
+  __m256i needles[RAPTOR_SCAN_SET_MAX];
+  __m256i first = _mm256_set1_epi8((char)set->printable_first);
+  __m256i del = _mm256_set1_epi8(0x7f);
+  int nonprintable = (set->printable_first != 0);
+  unsigned int set_len = set->len;
+  size_t i = 0;
+  unsigned int j;
+
+  if(len < 32)
+    return raptor_scan_bytes_sse2(buffer, len, set);
+
+  for(j = 0; j < set_len; j++)
+    needles[j] = _mm256_loadu_si256((const __m256i*)set->needles[j]);
+
+  for(; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(buffer + i));
+    __m256i hits = _mm256_cmpeq_epi8(v, needles[0]);
+    unsigned int mask;
+
+    for(j = 1; j < set_len; j++)
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(v, needles[j]));
+
+    if(nonprintable) {
+      /* signed compare so bytes from 0x80 up are also below first */
+      hits = _mm256_or_si256(hits, _mm256_cmpgt_epi8(first, v));
+      hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(v, del));
+    }
+
+    mask = (unsigned int)_mm256_movemask_epi8(hits);
+    if(mask)
+      return i + (size_t)__builtin_ctz(mask);
+  }
+
+  return i + raptor_scan_bytes_sse2(buffer + i, len - i, set);
+}
+
+
+#ifdef HAVE_ATOMIC_BUILTINS
+/* Implementation picked on first use.  Threads may pick it at the
+ * same time; they all store the same value.
+ */
+static raptor_scan_bytes_func raptor_scan_bytes_impl = NULL;
+#endif
+
+
+static raptor_scan_bytes_func
+raptor_scan_bytes_get_impl(void)
+{
+  raptor_scan_bytes_func impl;
+
+#ifdef HAVE_ATOMIC_BUILTINS
+  impl = __atomic_load_n(&raptor_scan_bytes_impl, __ATOMIC_RELAXED);
+  if(impl)
+    return impl;
+#endif
+
+  impl = raptor_scan_bytes_scalar;
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx2"))
+    impl = raptor_scan_bytes_avx2;
+  else if(__builtin_cpu_supports("sse2"))
+    impl = raptor_scan_bytes_sse2;
+
+#ifdef HAVE_ATOMIC_BUILTINS
+  __atomic_store_n(&raptor_scan_bytes_impl, impl, __ATOMIC_RELAXED);
+#endif
+
+  return impl;
+}
+
+#endif
+
+
+/*
+ * raptor_scan_bytes:
+ * @buffer: memory block to search in
+ * @len: size of memory block
+ * @set: bytes to search for, from raptor_scan_set_init()
+ *
+ * INTERNAL - Find the first byte in a block of memory that is in a set
+ *
+ * Uses SSE2 or AVX2 to test 16 or 32 bytes at a time when the CPU
+ * supports it, otherwise a table driven byte loop.  Unlike memchr()
+ * and raptor_memstr() a NUL in @buffer is not special.
+ *
+ * Return value: offset of the first matching byte or @len if none match
+ */
+size_t
+raptor_scan_bytes(const unsigned char *buffer, size_t len,
+                  const raptor_scan_set *set)
+{
+#ifdef HAVE_X86_SIMD_DISPATCH
+  return raptor_scan_bytes_get_impl()(buffer, len, set);
+#else
+  return raptor_scan_bytes_scalar(buffer, len, set);
+#endif
+}
+
+
+
+#ifdef STANDALONE
+
+/* one more prototype */
+int main(int argc, char *argv[]);
+
+
+#define TEST_BUFFER_SIZE 1000
+
+int
+main(int argc, char *argv[])
+{
+  const char *program = raptor_basename(argv[0]);
+  static const unsigned char set_bytes[7] = {
+    '\n', '\r', '"', '\'', '<', '>', '\\'
+  };
+  raptor_scan_set set;
+  unsigned char buffer[TEST_BUFFER_SIZE];
+  raptor_scan_bytes_func impls[4];
+  const char* impl_names[4];
+  int impls_count = 0;
+  int failures = 0;
+  int i;
+
+  impls[impls_count] = raptor_scan_bytes;
+  impl_names[impls_count++] = "dispatched";
+  impls[impls_count] = raptor_scan_bytes_scalar;
+  impl_names[impls_count++] = "scalar";
+#ifdef HAVE_X86_SIMD_DISPATCH
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("sse2")) {
+    impls[impls_count] = raptor_scan_bytes_sse2;
+    impl_names[impls_count++] = "sse2";
+  }
+  if(__builtin_cpu_supports("avx2")) {
+    impls[impls_count] = raptor_scan_bytes_avx2;
+    impl_names[impls_count++] = "avx2";
+  }
+#endif
+
+  srand(1);
+
+  /* random buffers with sparse matches at every alignment and length,
+   * including high bit bytes that must not match signed compares
+   */
+  for(i = 0; i < 2000; i++) {
+    size_t offset = (size_t)(rand() % 64);
+    size_t len = (size_t)(rand() % (TEST_BUFFER_SIZE - 64));
+    unsigned int set_len = 1 + (unsigned int)(rand() % 7);
+    /* every fourth run also stops at bytes outside 0x20 to 0x7e */
+    unsigned char first = (i % 4) ? 0 : 0x20;
+    size_t j;
+    size_t expected;
+    int k;
+
+    raptor_scan_set_init(&set, set_bytes, set_len);
+    if(first)
+      raptor_scan_set_add_nonprintable(&set, first);
+
+    for(j = 0; j < TEST_BUFFER_SIZE; j++) {
+      int r = rand() % 300;
+
+      if(r < 2)
+        buffer[j] = set_bytes[rand() % 7];
+      else
+        buffer[j] = (unsigned char)(0x80 + (r % 0x80));
+      if(r > 200)
+        buffer[j] = (unsigned char)('a' + (r % 26));
+      /* printable bytes in runs when testing the range */
+      if(first && r > 4)
+        buffer[j] = (unsigned char)(0x20 + (r % 0x5f));
+    }
+
+    /* the obvious byte loop */
+    for(expected = 0; expected < len; expected++) {
+      unsigned char c = buffer[offset + expected];
+
+      if(memchr(set_bytes, c, set_len))
+        break;
+      if(first && (c < first || c >= 0x7f))
+        break;
+    }
+
+    for(k = 0; k < impls_count; k++) {
+      size_t got = impls[k](buffer + offset, len, &set);
+      if(got != expected) {
+        fprintf(stderr,
+                "%s: raptor_scan_bytes %s FAILED at offset %d len %d set_len %u: got %d expected %d\n",
+                program, impl_names[k], (int)offset, (int)len, set_len,
+                (int)got, (int)expected);
+        failures++;
+      }
+    }
+  }
+
+  return failures;
+}
+
+#endif
@@ -115,6 +115,10 @@ raptor_serializers_init(raptor_world* world)
   rc += raptor_init_serializer_nquads(world) != 0;
 #endif
 
+#ifdef RAPTOR_SERIALIZER_BINARY
+  rc += raptor_init_serializer_binary(world) != 0;
+#endif
+
   return rc;
 }
 
@@ -425,6 +429,9 @@ raptor_serializer_start_to_filename(raptor_serializer *rdf_serializer,
   if(!rdf_serializer->iostream)
     return 1;
 
+  raptor_iostream_set_write_buffer_size(rdf_serializer->iostream,
+                                        RAPTOR_SERIALIZER_WRITE_BUFFER_SIZE);
+
   rdf_serializer->free_iostream_on_end = 1;
 
   if(rdf_serializer->factory->serialize_start)
@@ -467,6 +474,9 @@ raptor_serializer_start_to_string(raptor_serializer *rdf_serializer,
   if(!rdf_serializer->iostream)
     return 1;
 
+  raptor_iostream_set_write_buffer_size(rdf_serializer->iostream,
+                                        RAPTOR_SERIALIZER_WRITE_BUFFER_SIZE);
+
   rdf_serializer->free_iostream_on_end = 1;
 
   if(rdf_serializer->factory->serialize_start)
@@ -483,6 +493,9 @@ raptor_serializer_start_to_string(raptor_serializer *rdf_serializer,
  *
  * Start serializing to a FILE*.
  * 
+ * Output is buffered and is only certain to have been written to @fh
+ * after raptor_serializer_serialize_end().
+ *
  * NOTE: This does not fclose the handle when it is finished.
  *
  * Return value: non-0 on failure.
@@ -505,6 +518,9 @@ raptor_serializer_start_to_file_handle(raptor_serializer *rdf_serializer,
   if(!rdf_serializer->iostream)
     return 1;
 
+  raptor_iostream_set_write_buffer_size(rdf_serializer->iostream,
+                                        RAPTOR_SERIALIZER_WRITE_BUFFER_SIZE);
+
   rdf_serializer->free_iostream_on_end = 1;
 
   if(rdf_serializer->factory->serialize_start)
@@ -608,6 +624,8 @@ raptor_serializer_serialize_end(raptor_serializer *rdf_serializer)
   if(rdf_serializer->iostream) {
     if(rdf_serializer->free_iostream_on_end)
       raptor_free_iostream(rdf_serializer->iostream);
+    else
+      raptor_iostream_write_flush(rdf_serializer->iostream);
     rdf_serializer->iostream = NULL;
   }
   return rc;
@@ -774,6 +792,9 @@ raptor_serializer_get_description(raptor_serializer *rdf_serializer)
  * In serializers that can generate blocks of content, this causes
  * the writing of any current pending block.  For example in Turtle
  * this may write all pending triples.
+ *
+ * Any output held in the serializer's iostream write buffer is then
+ * written too.
  * 
  * Return value: non-0 on failure
  **/
@@ -787,5 +808,9 @@ raptor_serializer_flush(raptor_serializer *rdf_serializer)
   else
     rc = 0;
 
+  /* pass on anything held in the iostream write buffer */
+  if(!rc && rdf_serializer->iostream)
+    rc = raptor_iostream_write_flush(rdf_serializer->iostream);
+
   return rc;
 }
@@ -50,7 +50,7 @@ typedef struct {
   raptor_json_writer* json_writer;
 
   /* Ordered sequence of triples if is_resource */
-  raptor_avltree* avltree;
+  raptor_extsort* sorter;
 
   /* Last statement generated if is_resource (shared pointer) */
   raptor_statement* last_statement;
@@ -101,9 +101,9 @@ raptor_json_serialize_terminate(raptor_serializer* serializer)
     context->json_writer = NULL;
   }
 
-  if(context->avltree) {
-    raptor_free_avltree(context->avltree);
-    context->avltree = NULL;
+  if(context->sorter) {
+    raptor_free_extsort(context->sorter);
+    context->sorter = NULL;
   }
 }
 
@@ -125,10 +125,11 @@ raptor_json_serialize_start(raptor_serializer* serializer)
     return 1;
 
   if(context->is_resource) {
-    context->avltree = raptor_new_avltree((raptor_data_compare_handler)raptor_statement_compare,
-                                          (raptor_data_free_handler)raptor_free_statement,
-                                          0);
-    if(!context->avltree) {
+    int limit;
+
+    limit = RAPTOR_OPTIONS_GET_NUMERIC(serializer, RAPTOR_OPTION_JSON_SORT_LIMIT);
+    context->sorter = raptor_new_extsort(serializer->world, limit);
+    if(!context->sorter) {
       raptor_free_json_writer(context->json_writer);
       context->json_writer = NULL;
       return 1;
@@ -168,7 +169,7 @@ raptor_json_serialize_statement(raptor_serializer* serializer,
     raptor_statement* s = raptor_statement_copy(statement);
     if(!s)
       return 1;
-    return raptor_avltree_add(context->avltree, s);
+    return raptor_extsort_add(context->sorter, s);
   }
 
   if(context->need_subject_comma) {
@@ -210,7 +211,7 @@ raptor_json_serialize_statement(raptor_serializer* serializer,
 
 /* return 0 to abort visit */
 static int
-raptor_json_serialize_avltree_visit(int depth, void* data, void *user_data)
+raptor_json_serialize_sorted_visit(int depth, void* data, void *user_data)
 {
   raptor_serializer* serializer = (raptor_serializer*)user_data;
   raptor_json_context* context = (raptor_json_context*)serializer->context;
@@ -345,9 +346,14 @@ raptor_json_serialize_end(raptor_serializer* serializer)
     raptor_json_writer_start_block(context->json_writer, '{');
     raptor_json_writer_newline(context->json_writer);
     
-    raptor_avltree_visit(context->avltree,
-                         raptor_json_serialize_avltree_visit,
-                         serializer);
+    if(raptor_extsort_visit(context->sorter,
+                            raptor_json_serialize_sorted_visit,
+                            serializer)) {
+      /* statements may be missing so the output cannot be finished */
+      raptor_log_error(serializer->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
+                       "JSON serializer failed to sort statements");
+      return 1;
+    }
 
     /* end last triples block */
     if(context->last_statement) {
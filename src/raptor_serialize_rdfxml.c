@@ -353,7 +353,6 @@ raptor_rdfxml_serialize_statement(raptor_serializer* serializer,
     return 1;
 
   if(statement->predicate->type == RAPTOR_TERM_TYPE_URI) {
-    unsigned char *p;
     size_t uri_len;
     size_t name_len = 1;
     unsigned char c;
@@ -364,16 +363,9 @@ raptor_rdfxml_serialize_statement(raptor_serializer* serializer,
     if(!uri_string)
       goto oom;
 
-    p= uri_string;
-    name_len = uri_len;
-    /* FIXME: this loop could be made smarter */
-    while(name_len >0) {
-      if(raptor_xml_name_check(p, name_len, 10)) {
-        name = p;
-        break;
-      }
-      p++; name_len--;
-    }
+    name_len = uri_len - raptor_xml_name_split_offset(uri_string, uri_len, 10);
+    if(name_len > 0)
+      name = uri_string + uri_len - name_len;
 
     if(!name || (name == uri_string)) {
       raptor_log_error_formatted(serializer->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
@@ -862,7 +862,7 @@ raptor_rdfxmla_serialize_init(raptor_serializer* serializer, const char *name)
                        (raptor_data_free_handler)raptor_free_abbrev_subject, 0);
   
   context->nodes =
-    raptor_new_avltree((raptor_data_compare_handler)raptor_abbrev_node_compare,
+    raptor_new_avltree((raptor_data_compare_handler)raptor_abbrev_node_lookup_compare,
                        (raptor_data_free_handler)raptor_free_abbrev_node, 0);
 
   type_term = RAPTOR_RDF_type_term(serializer->world);
@@ -102,6 +102,13 @@ typedef struct {
   int mkr_rs_ntuple;
   int mkr_rs_nvalue;
   int mkr_rs_processing_value;
+
+  /* non-0 to write statements as they arrive (RAPTOR_OPTION_STREAMING) */
+  int streaming;
+
+  /* streaming: subject and predicate of the last statement written */
+  raptor_term* stream_subject;
+  raptor_term* stream_predicate;
 } raptor_turtle_context;
 
 
@@ -179,19 +186,16 @@ raptor_turtle_is_legal_turtle_qname(raptor_qname* qname)
 }
 
 /*
- * raptor_turtle_emit_resource:
+ * raptor_turtle_emit_uri:
  * @serializer: #raptor_serializer object
- * @node: resource node
- * @depth: depth into tree
+ * @uri: URI
  *
- * Emit a description of a resource using an XML Element
+ * Emit a URI as a QName if possible, otherwise as a URI reference
  *
  * Return value: non-0 on failure
  **/
 static int
-raptor_turtle_emit_resource(raptor_serializer *serializer,
-                            raptor_abbrev_node* node,
-                            int depth)
+raptor_turtle_emit_uri(raptor_serializer *serializer, raptor_uri* uri)
 {
   raptor_turtle_context* context = (raptor_turtle_context*)serializer->context;
   int emit_mkr = context->emit_mkr;
@@ -199,12 +203,7 @@ raptor_turtle_emit_resource(raptor_serializer *serializer,
 
   raptor_qname* qname = NULL;
 
-  RAPTOR_DEBUG_ABBREV_NODE("Emitting resource node", node);
-
-  if(node->term->type != RAPTOR_TERM_TYPE_URI)
-    return 1;
-
-  if(raptor_uri_equals(node->term->value.uri, context->rdf_nil_uri)) {
+  if(raptor_uri_equals(uri, context->rdf_nil_uri)) {
     if(emit_mkr)
       raptor_turtle_writer_raw_counted(turtle_writer, (const unsigned char*)" ", 1);
     else
@@ -212,8 +211,7 @@ raptor_turtle_emit_resource(raptor_serializer *serializer,
     return 0;
   }
 
-  qname = raptor_new_qname_from_namespace_uri(context->nstack,
-                                              node->term->value.uri, 10);
+  qname = raptor_new_qname_from_namespace_uri(context->nstack, uri, 10);
 
   /* XML Names allow leading '_' and '.' anywhere but Turtle does not */
   if(qname && !raptor_turtle_is_legal_turtle_qname(qname)) {
@@ -221,24 +219,44 @@ raptor_turtle_emit_resource(raptor_serializer *serializer,
     qname = NULL;
   }
 
-  if(raptor_uri_equals(node->term->value.uri, context->rdf_nil_uri)) {
-    if(emit_mkr)
-      raptor_turtle_writer_raw_counted(turtle_writer, (const unsigned char*)" ", 1);
-    else
-      raptor_turtle_writer_raw_counted(turtle_writer ,(const unsigned char*)"( )", 3);
-    return 0;
-  }
-
   if(qname) {
     raptor_turtle_writer_qname(turtle_writer, qname);
     raptor_free_qname(qname);
   } else {
-    raptor_turtle_writer_reference(turtle_writer, node->term->value.uri);
+    raptor_turtle_writer_reference(turtle_writer, uri);
   }
 
+  return 0;
+}
+
+
+/*
+ * raptor_turtle_emit_resource:
+ * @serializer: #raptor_serializer object
+ * @node: resource node
+ * @depth: depth into tree
+ *
+ * Emit a description of a resource using an XML Element
+ *
+ * Return value: non-0 on failure
+ **/
+static int
+raptor_turtle_emit_resource(raptor_serializer *serializer,
+                            raptor_abbrev_node* node,
+                            int depth)
+{
+  int rc;
+
+  RAPTOR_DEBUG_ABBREV_NODE("Emitting resource node", node);
+
+  if(node->term->type != RAPTOR_TERM_TYPE_URI)
+    return 1;
+
+  rc = raptor_turtle_emit_uri(serializer, node->term->value.uri);
+
   RAPTOR_DEBUG_ABBREV_NODE("Emitted", node);
 
-  return 0;
+  return rc;
 }
 
 
@@ -1137,7 +1155,7 @@ raptor_turtle_serialize_init(raptor_serializer* serializer, const char *name)
                        (raptor_data_free_handler)raptor_free_abbrev_subject, 0);
 
   context->nodes =
-    raptor_new_avltree((raptor_data_compare_handler)raptor_abbrev_node_compare,
+    raptor_new_avltree((raptor_data_compare_handler)raptor_abbrev_node_lookup_compare,
                        (raptor_data_free_handler)raptor_free_abbrev_node, 0);
 
   rdf_type_uri = raptor_new_uri_for_rdf_concept(serializer->world,
@@ -1186,6 +1204,16 @@ raptor_turtle_serialize_terminate(raptor_serializer* serializer)
 {
   raptor_turtle_context* context = (raptor_turtle_context*)serializer->context;
 
+  if(context->stream_subject) {
+    raptor_free_term(context->stream_subject);
+    context->stream_subject = NULL;
+  }
+
+  if(context->stream_predicate) {
+    raptor_free_term(context->stream_predicate);
+    context->stream_predicate = NULL;
+  }
+
   if(context->turtle_writer) {
     raptor_free_turtle_writer(context->turtle_writer);
     context->turtle_writer = NULL;
@@ -1356,6 +1384,9 @@ raptor_turtle_serialize_start(raptor_serializer* serializer)
 
   context->turtle_writer = turtle_writer;
 
+  context->streaming = !context->emit_mkr &&
+    RAPTOR_OPTIONS_GET_NUMERIC(serializer, RAPTOR_OPTION_STREAMING);
+
   return 0;
 }
 
@@ -1384,6 +1415,176 @@ raptor_turtle_ensure_writen_header(raptor_serializer* serializer,
   context->written_header = 1;
 }
 
+/*
+ * raptor_turtle_stream_emit_term:
+ * @serializer: #raptor_serializer object
+ * @term: subject or object term
+ *
+ * Emit a term when streaming; blank nodes always get an explicit name.
+ *
+ * Return value: non-0 on failure
+ **/
+static int
+raptor_turtle_stream_emit_term(raptor_serializer* serializer,
+                               raptor_term* term)
+{
+  raptor_turtle_context* context = (raptor_turtle_context*)serializer->context;
+
+  switch(term->type) {
+    case RAPTOR_TERM_TYPE_URI:
+      return raptor_turtle_emit_uri(serializer, term->value.uri);
+
+    case RAPTOR_TERM_TYPE_LITERAL:
+      return raptor_turtle_writer_literal(context->turtle_writer,
+                                          context->nstack,
+                                          term->value.literal.string,
+                                          term->value.literal.language,
+                                          term->value.literal.datatype);
+
+    case RAPTOR_TERM_TYPE_BLANK:
+      raptor_turtle_writer_bnodeid(context->turtle_writer,
+                                   term->value.blank.string,
+                                   term->value.blank.string_len);
+      return 0;
+
+    case RAPTOR_TERM_TYPE_UNKNOWN:
+    default:
+      break;
+  }
+
+  return 1;
+}
+
+
+/*
+ * raptor_turtle_stream_end_subject:
+ * @serializer: #raptor_serializer object
+ *
+ * Terminate the statements about the current streamed subject, if any.
+ **/
+static void
+raptor_turtle_stream_end_subject(raptor_serializer* serializer)
+{
+  raptor_turtle_context* context = (raptor_turtle_context*)serializer->context;
+  raptor_turtle_writer* turtle_writer = context->turtle_writer;
+
+  if(!context->stream_subject)
+    return;
+
+  raptor_turtle_writer_decrease_indent(turtle_writer);
+  /* space before . is needed after numeric literals */
+  raptor_turtle_writer_raw_counted(turtle_writer, (const unsigned char*)" .", 2);
+  raptor_turtle_writer_newline(turtle_writer);
+  raptor_turtle_writer_newline(turtle_writer);
+
+  raptor_free_term(context->stream_subject);
+  context->stream_subject = NULL;
+  raptor_free_term(context->stream_predicate);
+  context->stream_predicate = NULL;
+}
+
+
+/*
+ * raptor_turtle_serialize_statement_streaming:
+ * @serializer: #raptor_serializer object
+ * @statement: statement
+ *
+ * Write a statement immediately, abbreviating runs of statements with
+ * the same subject using ';' and then the same predicate using ','.
+ *
+ * Only the current subject and predicate are kept so no nesting of
+ * blank nodes or collections is done and namespaces declared after
+ * the first statement are not used.
+ *
+ * Return value: non-0 on failure
+ **/
+static int
+raptor_turtle_serialize_statement_streaming(raptor_serializer* serializer,
+                                            raptor_statement *statement)
+{
+  raptor_turtle_context* context = (raptor_turtle_context*)serializer->context;
+  raptor_turtle_writer* turtle_writer = context->turtle_writer;
+  raptor_term_type object_type = statement->object->type;
+
+  if(!(statement->subject->type == RAPTOR_TERM_TYPE_URI ||
+       statement->subject->type == RAPTOR_TERM_TYPE_BLANK)) {
+    raptor_log_error_formatted(serializer->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
+                               "Do not know how to serialize node type %u",
+                               statement->subject->type);
+    return 1;
+  }
+
+  if(statement->predicate->type != RAPTOR_TERM_TYPE_URI) {
+    raptor_log_error_formatted(serializer->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
+                               "Do not know how to serialize node type %u",
+                               statement->predicate->type);
+    return 1;
+  }
+
+  if(!(object_type == RAPTOR_TERM_TYPE_URI ||
+       object_type == RAPTOR_TERM_TYPE_BLANK ||
+       object_type == RAPTOR_TERM_TYPE_LITERAL)) {
+    raptor_log_error_formatted(serializer->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
+                               "Cannot serialize a triple with object node type %u",
+                               object_type);
+    return 1;
+  }
+
+  raptor_turtle_ensure_writen_header(serializer, context);
+
+  if(context->stream_subject &&
+     raptor_term_equals(context->stream_subject, statement->subject)) {
+    if(raptor_term_equals(context->stream_predicate, statement->predicate)) {
+      /* same subject and predicate: add to the object list */
+      raptor_turtle_writer_raw_counted(turtle_writer,
+                                       (const unsigned char*)", ", 2);
+      return raptor_turtle_stream_emit_term(serializer, statement->object);
+    }
+
+    /* same subject: add to the predicate list */
+    raptor_turtle_writer_raw_counted(turtle_writer,
+                                     (const unsigned char*)" ;", 2);
+    raptor_turtle_writer_newline(turtle_writer);
+    raptor_free_term(context->stream_predicate);
+  } else {
+    raptor_turtle_stream_end_subject(serializer);
+
+    context->stream_subject = raptor_term_copy(statement->subject);
+    if(!context->stream_subject)
+      return 1;
+
+    if(raptor_turtle_stream_emit_term(serializer, statement->subject))
+      return 1;
+    raptor_turtle_writer_increase_indent(turtle_writer);
+    raptor_turtle_writer_newline(turtle_writer);
+  }
+
+  context->stream_predicate = raptor_term_copy(statement->predicate);
+  if(!context->stream_predicate)
+    return 1;
+
+  if(raptor_term_equals(statement->predicate, context->rdf_type->term)) {
+    raptor_turtle_writer_raw_counted(turtle_writer,
+                                     (const unsigned char*)"a", 1);
+  } else {
+    raptor_qname* qname;
+
+    qname = raptor_new_qname_from_namespace_uri(context->nstack,
+                                                statement->predicate->value.uri,
+                                                10);
+    if(qname) {
+      raptor_turtle_writer_qname(turtle_writer, qname);
+      raptor_free_qname(qname);
+    } else
+      raptor_turtle_writer_reference(turtle_writer,
+                                     statement->predicate->value.uri);
+  }
+  raptor_turtle_writer_raw_counted(turtle_writer, (const unsigned char*)" ", 1);
+
+  return raptor_turtle_stream_emit_term(serializer, statement->object);
+}
+
+
 /* serialize a statement */
 static int
 raptor_turtle_serialize_statement(raptor_serializer* serializer,
@@ -1396,6 +1597,9 @@ raptor_turtle_serialize_statement(raptor_serializer* serializer,
   int rv;
   raptor_term_type object_type;
 
+  if(context->streaming)
+    return raptor_turtle_serialize_statement_streaming(serializer, statement);
+
   if(!(statement->subject->type == RAPTOR_TERM_TYPE_URI ||
        statement->subject->type == RAPTOR_TERM_TYPE_BLANK)) {
     raptor_log_error_formatted(serializer->world, RAPTOR_LOG_LEVEL_ERROR, NULL,
@@ -1463,7 +1667,10 @@ raptor_turtle_serialize_end(raptor_serializer* serializer)
 
   raptor_turtle_ensure_writen_header(serializer, context);
 
-  raptor_turtle_emit(serializer);
+  if(context->streaming)
+    raptor_turtle_stream_end_subject(serializer);
+  else
+    raptor_turtle_emit(serializer);
 
   /* reset serializer for reuse */
   context->written_header = 0;
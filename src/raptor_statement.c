@@ -148,6 +148,10 @@ raptor_statement_init(raptor_statement *statement, raptor_world *world)
  *
  * Copy a #raptor_statement.
  *
+ * Terms owned by a parser arena (see #RAPTOR_OPTION_TERM_ARENA) are
+ * copied to the heap so a statement handler can keep the copy after
+ * it returns.
+ *
  * Return value: a new #raptor_statement or NULL on error
  */
 raptor_statement*
@@ -44,27 +44,19 @@
 
 #ifndef STANDALONE
 
-struct raptor_stringbuffer_node_s
-{
-  struct raptor_stringbuffer_node_s* next;
-  unsigned char *string;
-  size_t length;
-};
-typedef struct raptor_stringbuffer_node_s raptor_stringbuffer_node;
-
+/* smallest buffer allocated for a stringbuffer */
+#define RAPTOR_STRINGBUFFER_MIN_SIZE 64
 
 struct raptor_stringbuffer_s
 {
-  /* Pointing to the first item in the list of nodes */
-  raptor_stringbuffer_node* head;
-  /* and the last */
-  raptor_stringbuffer_node* tail;
-  
+  /* string content, always '\0' terminated when allocated */
+  unsigned char *string;
+
   /* total length of the string */
   size_t length;
 
-  /* frozen string if already calculated, or NULL if not present */
-  unsigned char *string;
+  /* allocated size of @string */
+  size_t size;
 };
 
 
@@ -104,19 +96,6 @@ raptor_free_stringbuffer(raptor_stringbuffer *stringbuffer)
   if(!stringbuffer)
     return;
 
-  if(stringbuffer->head) {
-    raptor_stringbuffer_node *node = stringbuffer->head;
-  
-    while(node) {
-      raptor_stringbuffer_node *next = node->next;
-      
-      if(node->string)
-        RAPTOR_FREE(char*, node->string);
-      RAPTOR_FREE(raptor_stringbuffer_node, node);
-      node = next;
-    }
-  }
-
   if(stringbuffer->string)
     RAPTOR_FREE(char*, stringbuffer->string);
 
@@ -124,6 +103,43 @@ raptor_free_stringbuffer(raptor_stringbuffer *stringbuffer)
 }
 
 
+/*
+ * raptor_stringbuffer_ensure:
+ * @stringbuffer: raptor stringbuffer
+ * @length: number of bytes to add
+ *
+ * INTERNAL - Make room for @length more bytes plus a '\0'
+ *
+ * The buffer grows geometrically so that a sequence of appends takes
+ * an amortized constant number of allocations.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_stringbuffer_ensure(raptor_stringbuffer* stringbuffer, size_t length)
+{
+  size_t need = stringbuffer->length + length + 1;
+  size_t size;
+  unsigned char *string;
+
+  if(need <= stringbuffer->size)
+    return 0;
+
+  size = stringbuffer->size ? stringbuffer->size : RAPTOR_STRINGBUFFER_MIN_SIZE;
+  while(size < need)
+    size <<= 1;
+
+  string = RAPTOR_REALLOC(unsigned char*, stringbuffer->string, size);
+  if(!string)
+    return 1;
+
+  stringbuffer->string = string;
+  stringbuffer->size = size;
+
+  return 0;
+}
+
+
 
 /**
  * raptor_stringbuffer_append_string_common:
@@ -150,45 +166,24 @@ raptor_stringbuffer_append_string_common(raptor_stringbuffer* stringbuffer,
                                          size_t length,
                                          int do_copy)
 {
-  raptor_stringbuffer_node *node;
+  int rc = 0;
 
   if(!string || !length)
     return 0;
   
-  node = RAPTOR_MALLOC(raptor_stringbuffer_node*, sizeof(*node));
-  if(!node) {
-    if(!do_copy)
-      RAPTOR_FREE(char*, string);
-    return 1;
+  if(raptor_stringbuffer_ensure(stringbuffer, length))
+    rc = 1;
+  else {
+    memcpy(stringbuffer->string + stringbuffer->length, string, length);
+    stringbuffer->length += length;
+    stringbuffer->string[stringbuffer->length] = '\0';
   }
 
-  if(do_copy) {
-    /* Note this copy does not include the \0 character - not needed  */
-    node->string = RAPTOR_MALLOC(unsigned char*, length);
-    if(!node->string) {
-      RAPTOR_FREE(raptor_stringbuffer_node, node);
-      return 1;
-    }
-    memcpy(node->string, string, length);
-  } else
-    node->string = (unsigned char*)string;
-  node->length = length;
-
-
-  if(stringbuffer->tail) {
-    stringbuffer->tail->next = node;
-    stringbuffer->tail = node;
-  } else
-    stringbuffer->head = stringbuffer->tail = node;
-  node->next = NULL;
+  /* the content is always copied into the buffer */
+  if(!do_copy)
+    RAPTOR_FREE(char*, string);
 
-  if(stringbuffer->string) {
-    RAPTOR_FREE(char*, stringbuffer->string);
-    stringbuffer->string = NULL;
-  }
-  stringbuffer->length += length;
-
-  return 0;
+  return rc;
 }
 
 
@@ -308,33 +303,33 @@ int
 raptor_stringbuffer_append_stringbuffer(raptor_stringbuffer* stringbuffer, 
                                         raptor_stringbuffer* append)
 {
-  raptor_stringbuffer_node *node = append->head;
-
-  if(!node)
+  if(!append->length)
     return 0;
 
-  /* move all append nodes to stringbuffer */
-  if(stringbuffer->tail) {
-    stringbuffer->tail->next = node;
-  } else
-    stringbuffer->head = node;
+  if(!stringbuffer->length && append->size > stringbuffer->size) {
+    /* take over the appended buffer */
+    unsigned char *string = stringbuffer->string;
+    size_t size = stringbuffer->size;
 
-  stringbuffer->tail = append->tail;
+    stringbuffer->string = append->string;
+    stringbuffer->size = append->size;
+    stringbuffer->length = append->length;
 
-  /* adjust our length */
-  stringbuffer->length += append->length;
-  if(stringbuffer->string) {
-    RAPTOR_FREE(char*, stringbuffer->string);
-    stringbuffer->string = NULL;
+    append->string = string;
+    append->size = size;
+  } else {
+    if(raptor_stringbuffer_ensure(stringbuffer, append->length))
+      return 1;
+
+    memcpy(stringbuffer->string + stringbuffer->length, append->string,
+           append->length + 1);
+    stringbuffer->length += append->length;
   }
 
-  /* zap append content */
-  append->head = append->tail = NULL;
+  /* zap append content but keep the buffer for reuse */
   append->length = 0;
-  if(append->string) {
-    RAPTOR_FREE(char*, append->string);
-    append->string = NULL;
-  }
+  if(append->string)
+    *append->string = '\0';
   
   return 0;
 }
@@ -364,38 +359,23 @@ raptor_stringbuffer_prepend_string_common(raptor_stringbuffer* stringbuffer,
                                           const unsigned char *string, size_t length,
                                           int do_copy)
 {
-  raptor_stringbuffer_node *node;
-
-  node = RAPTOR_MALLOC(raptor_stringbuffer_node*, sizeof(*node));
-  if(!node)
-    return 1;
-
-  if(do_copy) {
-    /* Note this copy does not include the \0 character - not needed  */
-    node->string = RAPTOR_MALLOC(unsigned char*, length);
-    if(!node->string) {
-      RAPTOR_FREE(raptor_stringbuffer_node, node);
-      return 1;
-    }
-    memcpy(node->string, string, length);
-  } else
-    node->string = (unsigned char*)string;
-  node->length = length;
-
-
-  node->next = stringbuffer->head;
-  if(stringbuffer->head)
-    stringbuffer->head = node;
-  else
-    stringbuffer->head = stringbuffer->tail = node;
-
-  if(stringbuffer->string) {
-    RAPTOR_FREE(char*, stringbuffer->string);
-    stringbuffer->string = NULL;
+  int rc = 0;
+
+  if(raptor_stringbuffer_ensure(stringbuffer, length))
+    rc = 1;
+  else {
+    memmove(stringbuffer->string + length, stringbuffer->string,
+            stringbuffer->length);
+    memcpy(stringbuffer->string, string, length);
+    stringbuffer->length += length;
+    stringbuffer->string[stringbuffer->length] = '\0';
   }
-  stringbuffer->length += length;
 
-  return 0;
+  /* the content is always copied into the buffer */
+  if(!do_copy)
+    RAPTOR_FREE(char*, string);
+
+  return rc;
 }
 
 
@@ -470,7 +450,8 @@ raptor_stringbuffer_length(raptor_stringbuffer* stringbuffer)
  * Return the stringbuffer as a C string.
  * 
  * Note: the return value is a to a shared string that the stringbuffer
- * allocates and manages.
+ * allocates and manages.  It is only valid until the stringbuffer is
+ * next changed or destroyed.
  *
  * Return value: NULL on failure or stringbuffer is empty, otherwise
  *   a pointer to a shared copy of the string.
@@ -478,26 +459,10 @@ raptor_stringbuffer_length(raptor_stringbuffer* stringbuffer)
 unsigned char *
 raptor_stringbuffer_as_string(raptor_stringbuffer* stringbuffer)
 {
-  raptor_stringbuffer_node *node;
-  unsigned char *p;
-  
   if(!stringbuffer->length)
     return NULL;
-  if(stringbuffer->string)
-    return stringbuffer->string;
-
-  stringbuffer->string = RAPTOR_MALLOC(unsigned char*, stringbuffer->length + 1);
-  if(!stringbuffer->string)
-    return NULL;
 
-  node = stringbuffer->head;
-  p = stringbuffer->string;
-  while(node) {
-    memcpy(p, node->string, node->length);
-    p+= node->length;
-    node = node->next;
-  }
-  *p='\0';
+  /* the buffer is kept '\0' terminated so no copy is needed */
   return stringbuffer->string;
 }
 
@@ -519,26 +484,22 @@ int
 raptor_stringbuffer_copy_to_string(raptor_stringbuffer* stringbuffer,
                                    unsigned char *string, size_t length)
 {
-  raptor_stringbuffer_node *node;
-  unsigned char *p;
-  
   if(!string || length < 1)
     return 1;
 
   if(!stringbuffer->length)
     return 0;
 
-  p = string;
-  for(node = stringbuffer->head; node; node = node->next) {
-    if(node->length > length) {
-      p[-1]='\0';
-      return 1;
-    }
-    memcpy(p, node->string, node->length);
-    p+= node->length;
-    length-= node->length;
+  /* as before, a string of exactly @length bytes is copied and the
+   * '\0' written after it */
+  if(stringbuffer->length > length) {
+    /* truncate to fit */
+    memcpy(string, stringbuffer->string, length - 1);
+    string[length - 1] = '\0';
+    return 1;
   }
-  *p='\0';
+
+  memcpy(string, stringbuffer->string, stringbuffer->length + 1);
   return 0;
 }
 
@@ -666,6 +627,7 @@ main(int argc, char *argv[])
   const char *test_append_results[TEST_APPEND_COUNT]={ "thebrownjumpsthedog", "quickfoxoverlazy" };
   const char *test_append_results_total="thebrownjumpsthedogquickfoxoverlazy";
 #define COPY_STRING_BUFFER_SIZE 100
+#define TEST_MANY_COUNT 1000
   unsigned char *copy_string;
   
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
@@ -886,6 +848,60 @@ main(int argc, char *argv[])
     exit(1);
   }
   free(copy_string);
+
+
+  /* test many small appends into a growing buffer */
+
+  raptor_free_stringbuffer(sb2);
+  sb2 = raptor_new_stringbuffer();
+  if(!sb2) {
+    fprintf(stderr, "%s: Failed to create string buffer\n", program);
+    exit(1);
+  }
+
+  for(i = 0; i < TEST_MANY_COUNT; i++) {
+    unsigned char c = RAPTOR_GOOD_CAST(unsigned char, 'a' + (i % 26));
+
+    if(raptor_stringbuffer_append_counted_string(sb2, &c, 1, 1)) {
+      fprintf(stderr, "%s: Adding character %d failed\n", program, i);
+      exit(1);
+    }
+  }
+
+  len = raptor_stringbuffer_length(sb2);
+  if(len != TEST_MANY_COUNT) {
+    fprintf(stderr, "%s: string buffer len is %d, expected %d\n", program,
+            (int)len, TEST_MANY_COUNT);
+    exit(1);
+  }
+
+  str = raptor_stringbuffer_as_string(sb2);
+  for(i = 0; i < TEST_MANY_COUNT; i++) {
+    if(str[i] != 'a' + (i % 26)) {
+      fprintf(stderr, "%s: string buffer character %d is '%c', expected '%c'\n",
+              program, i, str[i], 'a' + (i % 26));
+      exit(1);
+    }
+  }
+  if(str[TEST_MANY_COUNT] || raptor_stringbuffer_as_string(sb2) != str) {
+    fprintf(stderr, "%s: string buffer was not frozen in place\n", program);
+    exit(1);
+  }
+
+  /* appending a large stringbuffer */
+  if(raptor_stringbuffer_append_stringbuffer(sb, sb2) ||
+     raptor_stringbuffer_length(sb) != items_len + TEST_MANY_COUNT ||
+     raptor_stringbuffer_length(sb2)) {
+    fprintf(stderr, "%s: Failed to append large string buffer\n", program);
+    exit(1);
+  }
+  str = raptor_stringbuffer_as_string(sb);
+  if(strncmp((const char*)str, items_string, items_len) ||
+     str[items_len] != 'a') {
+    fprintf(stderr, "%s: appended string buffer contains '%s'\n",
+            program, str);
+    exit(1);
+  }
   
   
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
@@ -39,6 +39,14 @@
 
 #ifndef STANDALONE
 
+/* threads sharing a term may change its usage at the same time */
+#ifdef HAVE_ATOMIC_BUILTINS
+#define RAPTOR_TERM_GET_USAGE(term) __atomic_load_n(&(term)->usage, __ATOMIC_RELAXED)
+#else
+#define RAPTOR_TERM_GET_USAGE(term) ((term)->usage)
+#endif
+
+
 /**
  * raptor_new_term_from_uri:
  * @world: raptor world
@@ -324,7 +332,10 @@ raptor_new_term_from_counted_blank(raptor_world* world,
     memcpy(new_id, blank, length);
     new_id[length] = '\0';
   } else {
+    /* the generated ID is newly allocated so is used without copying */
     new_id = raptor_world_generate_bnodeid(world);
+    if(!new_id)
+      return NULL;
     length = strlen((const char*)new_id);
   }
 
@@ -413,7 +424,7 @@ raptor_new_term_from_counted_string(raptor_world* world,
   locator.line = -1;
 
   bytes_read = raptor_ntriples_parse_term(world, &locator,
-                                          string, &length, &term, 1);
+                                          string, &length, &term, 1, NULL);
 
   if(!bytes_read || length != 0) {
     if(term)
@@ -425,12 +436,206 @@ raptor_new_term_from_counted_string(raptor_world* world,
 }
 
 
+/*
+ * raptor_arena_new_term:
+ * @arena: arena
+ * @world: raptor world
+ * @type: term type
+ *
+ * INTERNAL - Allocate a term in an arena
+ *
+ * Arena terms have a usage of -1: they are not usage counted and
+ * raptor_free_term() does nothing to them.
+ *
+ * Return value: new term or NULL on failure
+ */
+static raptor_term*
+raptor_arena_new_term(raptor_arena* arena, raptor_world* world,
+                      raptor_term_type type)
+{
+  raptor_term *t;
+
+  t = (raptor_term*)raptor_arena_alloc(arena, sizeof(*t));
+  if(!t)
+    return NULL;
+
+  memset(t, 0, sizeof(*t));
+  t->usage = -1;
+  t->world = world;
+  t->type = type;
+
+  return t;
+}
+
+
+/*
+ * raptor_arena_new_term_from_uri:
+ * @arena: arena
+ * @world: raptor world
+ * @uri: uri
+ *
+ * INTERNAL - Constructor - create a new URI statement term in an arena
+ *
+ * Takes a copy (reference) of the passed in @uri until the arena is
+ * reset.  See raptor_new_term_from_uri().
+ *
+ * Return value: new term or NULL on failure
+ */
+raptor_term*
+raptor_arena_new_term_from_uri(raptor_arena* arena, raptor_world* world,
+                               raptor_uri* uri)
+{
+  raptor_term *t;
+
+  if(!uri)
+    return NULL;
+
+  t = raptor_arena_new_term(arena, world, RAPTOR_TERM_TYPE_URI);
+  if(!t || raptor_arena_add_uri(arena, uri))
+    return NULL;
+
+  t->value.uri = uri;
+
+  return t;
+}
+
+
+/*
+ * raptor_arena_new_term_from_counted_literal:
+ * @arena: arena
+ * @world: raptor world
+ * @literal: UTF-8 encoded literal string (or NULL for empty literal)
+ * @literal_len: length of literal
+ * @datatype: literal datatype URI (or NULL)
+ * @language: literal language (or NULL for no language)
+ * @language_len: literal language length
+ *
+ * INTERNAL - Constructor - create a new literal statement term in an arena
+ *
+ * Takes copies of the passed in @literal, @datatype, @language until
+ * the arena is reset.  See raptor_new_term_from_counted_literal().
+ *
+ * Return value: new term or NULL on failure
+ */
+raptor_term*
+raptor_arena_new_term_from_counted_literal(raptor_arena* arena,
+                                           raptor_world* world,
+                                           const unsigned char* literal,
+                                           size_t literal_len,
+                                           raptor_uri* datatype,
+                                           const unsigned char* language,
+                                           unsigned char language_len)
+{
+  raptor_term *t;
+  unsigned char* new_literal;
+  unsigned char* new_language = NULL;
+
+  if(language && !*language)
+    language = NULL;
+
+  if(language && datatype)
+    return NULL;
+
+  if(!literal || !*literal)
+    literal_len = 0;
+
+  new_literal = (unsigned char*)raptor_arena_alloc(arena, literal_len + 1);
+  if(!new_literal)
+    return NULL;
+
+  if(literal_len)
+    memcpy(new_literal, literal, literal_len);
+  new_literal[literal_len] = '\0';
+
+  if(language) {
+    unsigned char c;
+    unsigned char* l;
+
+    new_language = (unsigned char*)raptor_arena_alloc(arena, language_len + 1);
+    if(!new_language)
+      return NULL;
+
+    l = new_language;
+    while((c = *language++)) {
+      if(c == '_')
+        c = '-';
+      *l++ = c;
+    }
+    *l = '\0';
+  } else
+    language_len = 0;
+
+  if(datatype && raptor_arena_add_uri(arena, datatype))
+    return NULL;
+
+  t = raptor_arena_new_term(arena, world, RAPTOR_TERM_TYPE_LITERAL);
+  if(!t)
+    return NULL;
+
+  t->value.literal.string = new_literal;
+  t->value.literal.string_len = RAPTOR_LANG_LEN_FROM_INT(literal_len);
+  t->value.literal.language = new_language;
+  t->value.literal.language_len = language_len;
+  t->value.literal.datatype = datatype;
+
+  return t;
+}
+
+
+/*
+ * raptor_arena_new_term_from_counted_blank:
+ * @arena: arena
+ * @world: raptor world
+ * @blank: UTF-8 encoded blank node identifier
+ * @length: length of identifier
+ *
+ * INTERNAL - Constructor - create a new blank node statement term in an arena
+ *
+ * Takes a copy of the passed in @blank until the arena is reset.
+ * Unlike raptor_new_term_from_counted_blank() @blank must be given.
+ *
+ * Return value: new term or NULL on failure
+ */
+raptor_term*
+raptor_arena_new_term_from_counted_blank(raptor_arena* arena,
+                                         raptor_world* world,
+                                         const unsigned char* blank,
+                                         size_t length)
+{
+  raptor_term *t;
+  unsigned char* new_id;
+
+  if(!blank)
+    return NULL;
+
+  new_id = (unsigned char*)raptor_arena_alloc(arena, length + 1);
+  if(!new_id)
+    return NULL;
+  memcpy(new_id, blank, length);
+  new_id[length] = '\0';
+
+  t = raptor_arena_new_term(arena, world, RAPTOR_TERM_TYPE_BLANK);
+  if(!t)
+    return NULL;
+
+  t->value.blank.string = new_id;
+  t->value.blank.string_len = RAPTOR_BAD_CAST(unsigned int, length);
+
+  return t;
+}
+
+
 /**
  * raptor_term_copy:
  * @term: raptor term
  *
  * Copy constructor - get a copy of a statement term
  *
+ * A term owned by a parser arena (usage -1), such as those given to
+ * a statement handler when #RAPTOR_OPTION_TERM_ARENA is set, is only
+ * valid until the handler returns.  Copying it makes a new term on
+ * the heap that may be kept.
+ *
  * Return value: new term object or NULL on failure
  */
 raptor_term*
@@ -439,7 +644,32 @@ raptor_term_copy(raptor_term* term)
   if(!term)
     return NULL;
 
-  term->usage++;
+  if(RAPTOR_TERM_GET_USAGE(term) < 0) {
+    /* arena - promote to the heap */
+    switch(term->type) {
+      case RAPTOR_TERM_TYPE_URI:
+        return raptor_new_term_from_uri(term->world, term->value.uri);
+
+      case RAPTOR_TERM_TYPE_LITERAL:
+        return raptor_new_term_from_counted_literal(term->world,
+                                                    term->value.literal.string,
+                                                    term->value.literal.string_len,
+                                                    term->value.literal.datatype,
+                                                    term->value.literal.language,
+                                                    term->value.literal.language_len);
+
+      case RAPTOR_TERM_TYPE_BLANK:
+        return raptor_new_term_from_counted_blank(term->world,
+                                                  term->value.blank.string,
+                                                  term->value.blank.string_len);
+
+      case RAPTOR_TERM_TYPE_UNKNOWN:
+      default:
+        return NULL;
+    }
+  }
+
+  raptor_world_atomic_add(term->world, &term->usage, 1);
   return term;
 }
 
@@ -456,8 +686,12 @@ raptor_free_term(raptor_term *term)
 {
   if(!term)
     return;
+
+  /* arena terms are freed with the arena */
+  if(RAPTOR_TERM_GET_USAGE(term) < 0)
+    return;
   
-  if(--term->usage)
+  if(raptor_world_atomic_add(term->world, &term->usage, -1))
     return;
   
   switch(term->type) {
@@ -626,7 +860,7 @@ raptor_term_equals(raptor_term* t1, raptor_term* t2)
   
   if(t1 == t2)
     return 1;
-  
+
   switch(t1->type) {
     case RAPTOR_TERM_TYPE_URI:
       d = raptor_uri_equals(t1->value.uri, t2->value.uri);
@@ -682,6 +916,91 @@ raptor_term_equals(raptor_term* t1, raptor_term* t2)
 }
 
 
+/* 64 bit FNV-1a hash parameters */
+#define RAPTOR_TERM_HASH_OFFSET_BASIS UINT64_C(14695981039346656037)
+#define RAPTOR_TERM_HASH_PRIME UINT64_C(1099511628211)
+
+static uint64_t
+raptor_term_hash_bytes(uint64_t hash, const unsigned char* p, size_t length)
+{
+  while(length--) {
+    hash ^= *p++;
+    hash *= RAPTOR_TERM_HASH_PRIME;
+  }
+
+  return hash;
+}
+
+
+/**
+ * raptor_term_hash:
+ * @term: term
+ *
+ * Get a hash of a #raptor_term value
+ *
+ * Terms that are equal with raptor_term_equals() have the same hash.
+ * The hash is calculated on each call and is not kept in the term;
+ * callers that need it repeatedly should keep it themselves.
+ *
+ * Return value: non-0 hash or 0 if @term is NULL
+ */
+uint64_t
+raptor_term_hash(raptor_term* term)
+{
+  uint64_t hash = RAPTOR_TERM_HASH_OFFSET_BASIS;
+  unsigned char type;
+  const unsigned char* string;
+  size_t length;
+
+  if(!term)
+    return 0;
+
+  type = RAPTOR_GOOD_CAST(unsigned char, term->type);
+  hash = raptor_term_hash_bytes(hash, &type, 1);
+
+  switch(term->type) {
+    case RAPTOR_TERM_TYPE_URI:
+      string = raptor_uri_as_counted_string(term->value.uri, &length);
+      hash = raptor_term_hash_bytes(hash, string, length);
+      break;
+
+    case RAPTOR_TERM_TYPE_BLANK:
+      hash = raptor_term_hash_bytes(hash, term->value.blank.string,
+                                    term->value.blank.string_len);
+      break;
+
+    case RAPTOR_TERM_TYPE_LITERAL:
+      hash = raptor_term_hash_bytes(hash, term->value.literal.string,
+                                    term->value.literal.string_len);
+
+      if(term->value.literal.language) {
+        string = term->value.literal.language;
+        length = strlen(RAPTOR_GOOD_CAST(const char*, string));
+        hash = raptor_term_hash_bytes(hash, (const unsigned char*)"@", 1);
+        hash = raptor_term_hash_bytes(hash, string, length);
+      }
+
+      if(term->value.literal.datatype) {
+        string = raptor_uri_as_counted_string(term->value.literal.datatype,
+                                              &length);
+        hash = raptor_term_hash_bytes(hash, (const unsigned char*)"^", 1);
+        hash = raptor_term_hash_bytes(hash, string, length);
+      }
+      break;
+
+    case RAPTOR_TERM_TYPE_UNKNOWN:
+    default:
+      break;
+  }
+
+  /* 0 is kept for a NULL term */
+  if(!hash)
+    hash = 1;
+
+  return hash;
+}
+
+
 /**
  * raptor_term_compare:
  * @t1: first term
@@ -714,6 +1033,9 @@ raptor_term_compare(const raptor_term *t1,  const raptor_term *t2)
 
   if(t1->type != t2->type)
     return (t1->type - t2->type);
+
+  if(t1 == t2)
+    return 0;
   
   switch(t1->type) {
     case RAPTOR_TERM_TYPE_URI:
@@ -780,6 +1102,18 @@ static unsigned int bnodeid1_len = 6; /* strlen(bnode_id1) */
 static raptor_term_type bnodeid1_type = RAPTOR_TERM_TYPE_BLANK;
 static const unsigned char* language1 = (const unsigned char*)"en";
 
+static const struct {
+  const char* prefix;
+  int base;
+  const unsigned char* expected;
+} generated_bnodeids[] = {
+  { NULL, 0, (const unsigned char*)"genid1" },
+  { "b", 99, (const unsigned char*)"b99" },
+  { "b", -3, (const unsigned char*)"b1" },
+  { "node", 2147483647, (const unsigned char*)"node2147483647" },
+  { NULL, 0, NULL }
+};
+
 int
 main(int argc, char *argv[])
 {
@@ -794,6 +1128,7 @@ main(int argc, char *argv[])
   raptor_uri* uri1;
   unsigned char* uri_str;
   size_t uri_len;
+  int i;
   
   
   world = raptor_new_world();
@@ -919,6 +1254,33 @@ main(int argc, char *argv[])
   }
   raptor_free_term(term3);
 
+  /* check generated identifiers use the configured prefix and base */
+  for(i = 0; generated_bnodeids[i].expected; i++) {
+    const unsigned char* expected = generated_bnodeids[i].expected;
+
+    raptor_world_set_generate_bnodeid_parameters(world,
+                                                 (char*)generated_bnodeids[i].prefix,
+                                                 generated_bnodeids[i].base);
+    term3 = raptor_new_term_from_blank(world, NULL);
+    if(!term3) {
+      fprintf(stderr, "%s: raptor_new_term_from_blank(NULL) failed\n",
+              program);
+      rc = 1;
+      goto tidy;
+    }
+    if(strcmp((const char*)term3->value.blank.string, (const char*)expected) ||
+       term3->value.blank.string_len != (int)strlen((const char*)expected)) {
+      fprintf(stderr, "%s: generated blank node ID '%s' (length %d) expected '%s'\n",
+              program, term3->value.blank.string,
+              term3->value.blank.string_len, expected);
+      rc = 1;
+      goto tidy;
+    }
+    raptor_free_term(term3);
+    term3 = NULL;
+  }
+  raptor_world_set_generate_bnodeid_parameters(world, NULL, 0);
+
   /* check a blank node term with an identifier succeeds */
   term3 = raptor_new_term_from_counted_blank(world, bnodeid1, bnodeid1_len);
   if(!term3) {
@@ -1017,6 +1379,30 @@ main(int argc, char *argv[])
     rc = 1;
     goto tidy;
   }
+
+
+  /* equal terms have equal hashes */
+  if(raptor_term_hash(term1) != raptor_term_hash(term5)) {
+    fprintf(stderr, "%s: raptor_term_hash (URI %s, URI %s) returned different hashes, expected same\n",
+            program, uri_string1, uri_string1);
+    rc = 1;
+    goto tidy;
+  }
+
+  if(raptor_term_hash(term1) == raptor_term_hash(term4) ||
+     raptor_term_hash(term2) == raptor_term_hash(term3)) {
+    fprintf(stderr, "%s: raptor_term_hash returned the same hash for different terms\n",
+            program);
+    rc = 1;
+    goto tidy;
+  }
+
+  if(!raptor_term_equals(term1, term5) || raptor_term_equals(term1, term4)) {
+    fprintf(stderr, "%s: raptor_term_equals after hashing returned the wrong result\n",
+            program);
+    rc = 1;
+    goto tidy;
+  }
   
 
   tidy:
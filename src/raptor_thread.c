@@ -0,0 +1,1035 @@
+/* -*- Mode: c; c-basic-offset: 2 -*-
+ *
+ * raptor_thread.c - Raptor worker thread pool
+ *
+ * Copyright (C) 2026, agent agent@local
+ *
+ * This package is Free Software and part of Redland http://librdf.org/
+ *
+ * It is licensed under the following three licenses as alternatives:
+ *   1. GNU Lesser General Public License (LGPL) V2.1 or any newer version
+ *   2. GNU General Public License (GPL) V2 or any newer version
+ *   3. Apache License, V2.0 or any newer version
+ *
+ * You may not use this file except in compliance with at least one of
+ * the above three licenses.
+ *
+ * See LICENSE.html or LICENSE.txt at the top of this package for the
+ * complete terms and further detail along with the license texts for
+ * the licenses in COPYING.LIB, COPYING and LICENSE-2.0.txt respectively.
+ *
+ *
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <raptor_config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+/* Raptor includes */
+#include "raptor2.h"
+#include "raptor_internal.h"
+
+
+#ifdef HAVE_PTHREAD_H
+
+/*
+ * raptor_world_add_locking:
+ * @world: world
+ * @delta: amount to add
+ *
+ * INTERNAL - Change the world locking count
+ *
+ * Other threads read the count with RAPTOR_WORLD_LOCKING() while
+ * they use a thread-safe world, so it always changes atomically.
+ */
+static void
+raptor_world_add_locking(raptor_world* world, int delta)
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+  __atomic_add_fetch(&world->locking, delta, __ATOMIC_ACQ_REL);
+#else
+  pthread_mutex_lock(&world->atomic_mutex);
+  world->locking += delta;
+  pthread_mutex_unlock(&world->atomic_mutex);
+#endif
+}
+
+
+struct raptor_thread_pool_s {
+  raptor_world* world;
+
+  pthread_mutex_t mutex;
+  /* signalled when a task is queued or the pool is shutting down */
+  pthread_cond_t task_cond;
+  /* signalled when a task completes */
+  pthread_cond_t done_cond;
+
+  /* tasks waiting for a worker thread, in order added */
+  raptor_thread_task* queue_head;
+  raptor_thread_task* queue_tail;
+
+  /* completed tasks not yet returned by raptor_thread_pool_wait_task() */
+  raptor_thread_task* done_head;
+  raptor_thread_task* done_tail;
+
+  /* tasks added and not yet returned by raptor_thread_pool_wait_task() */
+  int outstanding;
+
+  int shutdown;
+
+  pthread_t* threads;
+  int threads_count;
+};
+
+
+static void*
+raptor_thread_pool_worker(void* arg)
+{
+  raptor_thread_pool* pool = (raptor_thread_pool*)arg;
+
+  pthread_mutex_lock(&pool->mutex);
+  while(1) {
+    raptor_thread_task* task;
+
+    while(!pool->queue_head && !pool->shutdown)
+      pthread_cond_wait(&pool->task_cond, &pool->mutex);
+
+    if(pool->shutdown)
+      break;
+
+    task = pool->queue_head;
+    pool->queue_head = task->next;
+    if(!pool->queue_head)
+      pool->queue_tail = NULL;
+    task->next = NULL;
+    pthread_mutex_unlock(&pool->mutex);
+
+    pthread_setspecific(pool->world->thread_task_key, task);
+    task->handler(task);
+    pthread_setspecific(pool->world->thread_task_key, NULL);
+
+    pthread_mutex_lock(&pool->mutex);
+    if(pool->done_tail)
+      pool->done_tail->next = task;
+    else
+      pool->done_head = task;
+    pool->done_tail = task;
+    pthread_cond_signal(&pool->done_cond);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  return NULL;
+}
+
+#endif
+
+
+/*
+ * raptor_threads_init:
+ * @world: world
+ *
+ * INTERNAL - Initialise the world lock used while worker threads run
+ *
+ * Return value: non-0 on failure
+ */
+int
+raptor_threads_init(raptor_world* world)
+{
+#ifdef HAVE_PTHREAD_H
+  if(pthread_mutex_init(&world->mutex, NULL))
+    return 1;
+
+  if(pthread_mutex_init(&world->atomic_mutex, NULL))
+    goto failed_atomic_mutex;
+
+  if(pthread_key_create(&world->thread_task_key, NULL))
+    goto failed_task_key;
+
+  if(pthread_key_create(&world->thread_log_key, NULL))
+    goto failed_log_key;
+
+  world->threads_initialized = 1;
+
+  /* a thread-safe world is locking for its whole life */
+  if(world->thread_safe)
+    raptor_world_add_locking(world, 1);
+
+  return 0;
+
+  failed_log_key:
+  pthread_key_delete(world->thread_task_key);
+  failed_task_key:
+  pthread_mutex_destroy(&world->atomic_mutex);
+  failed_atomic_mutex:
+  pthread_mutex_destroy(&world->mutex);
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+
+/*
+ * raptor_threads_finish:
+ * @world: world
+ *
+ * INTERNAL - Free resources made by raptor_threads_init()
+ */
+void
+raptor_threads_finish(raptor_world* world)
+{
+#ifdef HAVE_PTHREAD_H
+  if(!world->threads_initialized)
+    return;
+
+  if(world->thread_safe)
+    raptor_world_add_locking(world, -1);
+
+  while(world->thread_log_handlers) {
+    raptor_thread_log_handler* next = world->thread_log_handlers->next;
+
+    RAPTOR_FREE(raptor_thread_log_handler, world->thread_log_handlers);
+    world->thread_log_handlers = next;
+  }
+
+  pthread_key_delete(world->thread_log_key);
+  pthread_key_delete(world->thread_task_key);
+  pthread_mutex_destroy(&world->atomic_mutex);
+  pthread_mutex_destroy(&world->mutex);
+  world->threads_initialized = 0;
+#endif
+}
+
+
+/*
+ * raptor_threads_set_log_handler:
+ * @world: world
+ * @user_data: user data to pass to @handler
+ * @handler: log handler or NULL
+ *
+ * INTERNAL - Set the log handler for the calling thread
+ *
+ * See raptor_world_set_thread_log_handler().
+ *
+ * Return value: non-0 on failure
+ */
+int
+raptor_threads_set_log_handler(raptor_world* world, void* user_data,
+                               raptor_log_handler handler)
+{
+#ifdef HAVE_PTHREAD_H
+  raptor_thread_log_handler* thread_handler;
+
+  if(!world->threads_initialized)
+    return 1;
+
+  thread_handler = (raptor_thread_log_handler*)pthread_getspecific(world->thread_log_key);
+  if(!thread_handler) {
+    if(!handler)
+      return 0;
+
+    thread_handler = RAPTOR_CALLOC(raptor_thread_log_handler*, 1,
+                                   sizeof(*thread_handler));
+    if(!thread_handler)
+      return 1;
+
+    if(pthread_setspecific(world->thread_log_key, thread_handler)) {
+      RAPTOR_FREE(raptor_thread_log_handler, thread_handler);
+      return 1;
+    }
+
+    /* kept until the world is freed since threads may outlive it */
+    pthread_mutex_lock(&world->mutex);
+    thread_handler->next = world->thread_log_handlers;
+    world->thread_log_handlers = thread_handler;
+    pthread_mutex_unlock(&world->mutex);
+  }
+
+  thread_handler->user_data = user_data;
+  thread_handler->handler = handler;
+
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+
+/*
+ * raptor_thread_current_log_handler:
+ * @world: world
+ *
+ * INTERNAL - Get the log handler set for the calling thread
+ *
+ * Return value: handler or NULL if none is set
+ */
+raptor_thread_log_handler*
+raptor_thread_current_log_handler(raptor_world* world)
+{
+#ifdef HAVE_PTHREAD_H
+  raptor_thread_log_handler* thread_handler;
+
+  if(!world->threads_initialized)
+    return NULL;
+
+  thread_handler = (raptor_thread_log_handler*)pthread_getspecific(world->thread_log_key);
+  if(thread_handler && thread_handler->handler)
+    return thread_handler;
+#endif
+
+  return NULL;
+}
+
+
+/*
+ * raptor_world_atomic_add:
+ * @world: world
+ * @value: pointer to value such as a usage count
+ * @delta: amount to add
+ *
+ * INTERNAL - Add to a value that threads may share in a locking world
+ *
+ * Uses atomic builtins when the compiler has them and otherwise a
+ * world mutex.
+ *
+ * Return value: new value
+ */
+int
+raptor_world_atomic_add(raptor_world* world, int* value, int delta)
+{
+#if defined(HAVE_PTHREAD_H) && !defined(HAVE_ATOMIC_BUILTINS)
+  int result;
+#endif
+
+  if(!RAPTOR_WORLD_LOCKING(world))
+    return *value += delta;
+
+#ifdef HAVE_ATOMIC_BUILTINS
+  return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+#elif defined(HAVE_PTHREAD_H)
+  pthread_mutex_lock(&world->atomic_mutex);
+  result = *value += delta;
+  pthread_mutex_unlock(&world->atomic_mutex);
+
+  return result;
+#else
+  return *value += delta;
+#endif
+}
+
+
+/*
+ * raptor_world_atomic_add_unless:
+ * @world: world
+ * @value: pointer to value such as a usage count
+ * @delta: amount to add
+ * @unless: value that is left alone
+ *
+ * INTERNAL - Add to a shared value unless it has a given value
+ *
+ * Return value: non-0 if @delta was added
+ */
+int
+raptor_world_atomic_add_unless(raptor_world* world, int* value, int delta,
+                               int unless)
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+  int old;
+#endif
+#if defined(HAVE_PTHREAD_H) && !defined(HAVE_ATOMIC_BUILTINS)
+  int added = 0;
+#endif
+
+  if(!RAPTOR_WORLD_LOCKING(world)) {
+    if(*value == unless)
+      return 0;
+    *value += delta;
+    return 1;
+  }
+
+#ifdef HAVE_ATOMIC_BUILTINS
+  old = __atomic_load_n(value, __ATOMIC_ACQUIRE);
+  while(old != unless) {
+    if(__atomic_compare_exchange_n(value, &old, old + delta, /* weak */ 1,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      return 1;
+  }
+
+  return 0;
+#elif defined(HAVE_PTHREAD_H)
+  pthread_mutex_lock(&world->atomic_mutex);
+  if(*value != unless) {
+    *value += delta;
+    added = 1;
+  }
+  pthread_mutex_unlock(&world->atomic_mutex);
+
+  return added;
+#else
+  if(*value == unless)
+    return 0;
+  *value += delta;
+  return 1;
+#endif
+}
+
+
+/*
+ * raptor_thread_current_task:
+ * @world: world
+ *
+ * INTERNAL - Get the task being run by the calling thread
+ *
+ * Return value: task or NULL if not called from a pool worker thread
+ */
+raptor_thread_task*
+raptor_thread_current_task(raptor_world* world)
+{
+#ifdef HAVE_PTHREAD_H
+  if(world->threads_initialized)
+    return (raptor_thread_task*)pthread_getspecific(world->thread_task_key);
+#endif
+
+  return NULL;
+}
+
+
+/*
+ * raptor_new_thread_pool:
+ * @world: world
+ * @threads_count: number of worker threads
+ *
+ * INTERNAL - Constructor - start a pool of worker threads
+ *
+ * While any pool exists the world is in locking mode; see
+ * raptor_world_atomic_add().  Tasks are run in the order they are added.
+ *
+ * Return value: new pool or NULL on failure or if threads are not
+ * supported
+ */
+raptor_thread_pool*
+raptor_new_thread_pool(raptor_world* world, int threads_count)
+{
+#ifdef HAVE_PTHREAD_H
+  raptor_thread_pool* pool;
+  int i;
+
+  if(!world->threads_initialized || threads_count < 1)
+    return NULL;
+
+  pool = RAPTOR_CALLOC(raptor_thread_pool*, 1, sizeof(*pool));
+  if(!pool)
+    return NULL;
+
+  pool->world = world;
+
+  pool->threads = RAPTOR_CALLOC(pthread_t*, RAPTOR_GOOD_CAST(size_t, threads_count),
+                                sizeof(pthread_t));
+  if(!pool->threads) {
+    RAPTOR_FREE(raptor_thread_pool, pool);
+    return NULL;
+  }
+
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->task_cond, NULL);
+  pthread_cond_init(&pool->done_cond, NULL);
+
+  /* other threads may be using a thread-safe world */
+  raptor_world_add_locking(world, 1);
+
+  for(i = 0; i < threads_count; i++) {
+    if(pthread_create(&pool->threads[i], NULL, raptor_thread_pool_worker,
+                      pool))
+      break;
+    pool->threads_count++;
+  }
+
+  if(!pool->threads_count) {
+    raptor_free_thread_pool(pool);
+    return NULL;
+  }
+
+  return pool;
+#else
+  return NULL;
+#endif
+}
+
+
+/*
+ * raptor_free_thread_pool:
+ * @pool: pool
+ *
+ * INTERNAL - Destructor - stop the worker threads
+ *
+ * Waits for running tasks to finish.  Queued tasks that have not
+ * started are never run.  Task objects are owned by the caller.
+ */
+void
+raptor_free_thread_pool(raptor_thread_pool* pool)
+{
+#ifdef HAVE_PTHREAD_H
+  int i;
+
+  if(!pool)
+    return;
+
+  pthread_mutex_lock(&pool->mutex);
+  pool->shutdown = 1;
+  pthread_cond_broadcast(&pool->task_cond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for(i = 0; i < pool->threads_count; i++)
+    pthread_join(pool->threads[i], NULL);
+
+  raptor_world_add_locking(pool->world, -1);
+
+  pthread_cond_destroy(&pool->done_cond);
+  pthread_cond_destroy(&pool->task_cond);
+  pthread_mutex_destroy(&pool->mutex);
+
+  RAPTOR_FREE(pthread_t*, pool->threads);
+  RAPTOR_FREE(raptor_thread_pool, pool);
+#endif
+}
+
+
+/*
+ * raptor_thread_pool_add_task:
+ * @pool: pool
+ * @task: task
+ *
+ * INTERNAL - Queue a task to be run by the next free worker thread
+ *
+ * The task must stay valid until returned by
+ * raptor_thread_pool_wait_task() or the pool is freed.
+ *
+ * Return value: non-0 on failure
+ */
+int
+raptor_thread_pool_add_task(raptor_thread_pool* pool, raptor_thread_task* task)
+{
+#ifdef HAVE_PTHREAD_H
+  task->next = NULL;
+
+  pthread_mutex_lock(&pool->mutex);
+  if(pool->queue_tail)
+    pool->queue_tail->next = task;
+  else
+    pool->queue_head = task;
+  pool->queue_tail = task;
+  pool->outstanding++;
+  pthread_cond_signal(&pool->task_cond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+
+/*
+ * raptor_thread_pool_wait_task:
+ * @pool: pool
+ *
+ * INTERNAL - Wait for a task to complete
+ *
+ * Tasks are returned in the order they complete which need not be
+ * the order they were added.
+ *
+ * Return value: completed task or NULL if no tasks are outstanding
+ */
+raptor_thread_task*
+raptor_thread_pool_wait_task(raptor_thread_pool* pool)
+{
+#ifdef HAVE_PTHREAD_H
+  raptor_thread_task* task = NULL;
+
+  pthread_mutex_lock(&pool->mutex);
+  if(pool->outstanding) {
+    while(!pool->done_head)
+      pthread_cond_wait(&pool->done_cond, &pool->mutex);
+
+    task = pool->done_head;
+    pool->done_head = task->next;
+    if(!pool->done_head)
+      pool->done_tail = NULL;
+    task->next = NULL;
+    pool->outstanding--;
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  return task;
+#else
+  return NULL;
+#endif
+}
+
+
+
+#ifdef STANDALONE
+
+/* one more prototype */
+int main(int argc, char *argv[]);
+
+
+#define TEST_TASKS_COUNT 200
+
+typedef struct {
+  raptor_thread_task task;
+  int input;
+  int output;
+  int done;
+} test_task;
+
+
+static void
+test_task_handler(raptor_thread_task* task)
+{
+  test_task* t = (test_task*)task->user_data;
+  int i;
+
+  t->output = 0;
+  for(i = 0; i <= t->input; i++)
+    t->output += i;
+}
+
+
+#ifdef HAVE_PTHREAD_H
+#define TEST_THREADS_COUNT 4
+#define TEST_THREAD_ROUNDS 2000
+/* rdf:_n ordinal used by each round; at most 5000 */
+#define TEST_THREAD_ORDINAL(i) (1 + ((i) * 37) % 5000)
+
+typedef struct {
+  raptor_world* world;
+  int messages;
+  int bnodeids[TEST_THREAD_ROUNDS];
+  int failures;
+} test_thread;
+
+
+static void
+test_thread_log_handler(void *user_data, raptor_log_message* message)
+{
+  test_thread* t = (test_thread*)user_data;
+
+  t->messages++;
+}
+
+
+static void
+test_world_log_handler(void *user_data, raptor_log_message* message)
+{
+  int* count = (int*)user_data;
+
+  (*count)++;
+}
+
+
+static void*
+test_thread_run(void* arg)
+{
+  test_thread* t = (test_thread*)arg;
+  raptor_world* world = t->world;
+  int i;
+
+  if(raptor_world_set_thread_log_handler(world, t, test_thread_log_handler))
+    t->failures++;
+
+  for(i = 0; i < TEST_THREAD_ROUNDS; i++) {
+    char buf[64];
+    raptor_uri* uri;
+    raptor_uri* relative_uri;
+    raptor_uri* ordinal_uri;
+    raptor_term* term;
+    raptor_term* type_term;
+    unsigned char* id;
+
+    /* all threads intern the same URIs */
+    snprintf(buf, sizeof(buf), "http://example.org/thread/%d", i % 100);
+    uri = raptor_new_uri(world, (const unsigned char*)buf);
+    /* resolving against a shared URI parses and keeps its detail */
+    relative_uri = raptor_new_uri_relative_to_base(world, uri,
+                                                   (const unsigned char*)"x");
+    if(relative_uri)
+      raptor_free_uri(relative_uri);
+    else
+      t->failures++;
+    term = raptor_new_term_from_uri(world, uri);
+    raptor_free_uri(raptor_uri_copy(uri));
+
+    /* kept ordinal URIs are made and found by all threads */
+    ordinal_uri = raptor_new_uri_from_rdf_ordinal(world,
+                                                  TEST_THREAD_ORDINAL(i));
+    if(ordinal_uri)
+      raptor_free_uri(ordinal_uri);
+    else
+      t->failures++;
+
+    raptor_free_uri(uri);
+    raptor_free_term(raptor_term_copy(term));
+    raptor_free_term(term);
+
+    /* and share the world terms */
+    type_term = raptor_term_copy(RAPTOR_RDF_type_term(world));
+    raptor_term_hash(type_term);
+    raptor_free_term(type_term);
+
+    id = raptor_world_generate_bnodeid(world);
+    t->bnodeids[i] = id ? atoi((const char*)id + 5) : 0;
+    if(id)
+      raptor_free_memory(id);
+
+    if(!(i % 100))
+      raptor_log_error(world, RAPTOR_LOG_LEVEL_WARN, NULL, "test message");
+  }
+
+  raptor_world_set_thread_log_handler(world, NULL, NULL);
+
+  return NULL;
+}
+
+
+static int
+test_thread_safe_world(const char* program)
+{
+  raptor_world *world;
+  test_thread threads[TEST_THREADS_COUNT];
+  pthread_t ids[TEST_THREADS_COUNT];
+  char* seen;
+  int failures = 0;
+  int world_messages = 0;
+  unsigned int interned;
+  int i;
+  int j;
+
+  world = raptor_new_world();
+  if(!world ||
+     raptor_world_set_flag(world, RAPTOR_WORLD_FLAG_THREAD_SAFE, 1) ||
+     raptor_world_open(world)) {
+    fprintf(stderr, "%s: failed to open a thread-safe world\n", program);
+    return 1;
+  }
+  raptor_world_set_log_handler(world, &world_messages, test_world_log_handler);
+
+  if(!RAPTOR_WORLD_LOCKING(world)) {
+    fprintf(stderr, "%s: thread-safe world is not locking\n", program);
+    failures++;
+  }
+
+  /* the mode is fixed once the world is open */
+  if(raptor_world_set_flag(world, RAPTOR_WORLD_FLAG_THREAD_SAFE, 0) <= 0 ||
+     !RAPTOR_WORLD_LOCKING(world)) {
+    fprintf(stderr, "%s: thread-safe flag was cleared on an open world\n",
+            program);
+    failures++;
+  }
+
+  interned = raptor_uri_interned_count(world);
+
+  for(i = 0; i < TEST_THREADS_COUNT; i++) {
+    memset(&threads[i], '\0', sizeof(threads[i]));
+    threads[i].world = world;
+    pthread_create(&ids[i], NULL, test_thread_run, &threads[i]);
+  }
+  for(i = 0; i < TEST_THREADS_COUNT; i++)
+    pthread_join(ids[i], NULL);
+
+  /* the world keeps the ordinal URIs after rdf:_32 that were used */
+  seen = (char*)calloc(5001, 1);
+  for(i = 0; i < TEST_THREAD_ROUNDS; i++) {
+    int ordinal = TEST_THREAD_ORDINAL(i);
+
+    if(ordinal > 32 && !seen[ordinal]) {
+      seen[ordinal] = 1;
+      interned++;
+    }
+  }
+  free(seen);
+
+  if(raptor_uri_interned_count(world) != interned) {
+    fprintf(stderr, "%s: %u URIs interned after threads ended, expected %u\n",
+            program, raptor_uri_interned_count(world), interned);
+    failures++;
+  }
+
+  /* every generated blank node ID is different */
+  seen = (char*)calloc(TEST_THREADS_COUNT * TEST_THREAD_ROUNDS + 1, 1);
+  for(i = 0; i < TEST_THREADS_COUNT; i++) {
+    failures += threads[i].failures;
+
+    if(threads[i].messages != TEST_THREAD_ROUNDS / 100) {
+      fprintf(stderr, "%s: thread %d got %d messages, expected %d\n",
+              program, i, threads[i].messages, TEST_THREAD_ROUNDS / 100);
+      failures++;
+    }
+
+    for(j = 0; j < TEST_THREAD_ROUNDS; j++) {
+      int id = threads[i].bnodeids[j];
+
+      if(id < 1 || id > TEST_THREADS_COUNT * TEST_THREAD_ROUNDS || seen[id]) {
+        fprintf(stderr, "%s: thread %d got bad or repeated blank node ID %d\n",
+                program, i, id);
+        failures++;
+        break;
+      }
+      seen[id] = 1;
+    }
+  }
+  free(seen);
+
+  if(world_messages) {
+    fprintf(stderr, "%s: world log handler got %d thread messages\n",
+            program, world_messages);
+    failures++;
+  }
+
+  raptor_free_world(world);
+
+  return failures;
+}
+
+
+#ifdef RAPTOR_PARSER_NTRIPLES
+/* enough lines for several raptor_ntriples_parse_chunk_parallel() segments */
+#define TEST_PARSE_LINES 8000
+#define TEST_PARSE_CHUNK_SIZE 4096
+
+typedef struct {
+  raptor_world* world;
+  const unsigned char* content;
+  size_t content_length;
+  int statements;
+  int failures;
+} test_parse_thread;
+
+
+static void
+test_parse_statement_handler(void *user_data, raptor_statement* statement)
+{
+  test_parse_thread* t = (test_parse_thread*)user_data;
+
+  t->statements++;
+}
+
+
+static void*
+test_parse_thread_run(void* arg)
+{
+  test_parse_thread* t = (test_parse_thread*)arg;
+  raptor_parser* parser;
+  raptor_uri* base_uri;
+  size_t offset;
+
+  parser = raptor_new_parser(t->world, "ntriples");
+  base_uri = raptor_new_uri(t->world,
+                            (const unsigned char*)"http://example.org/base");
+  if(!parser || !base_uri) {
+    t->failures++;
+    goto tidy;
+  }
+
+  /* each parser starts and frees its own pool of worker threads */
+  raptor_parser_set_option(parser, RAPTOR_OPTION_PARALLEL_THREADS, NULL, 2);
+  raptor_parser_set_statement_handler(parser, t, test_parse_statement_handler);
+
+  if(raptor_parser_parse_start(parser, base_uri)) {
+    t->failures++;
+    goto tidy;
+  }
+
+  for(offset = 0; offset < t->content_length; offset += TEST_PARSE_CHUNK_SIZE) {
+    size_t len = t->content_length - offset;
+
+    if(len > TEST_PARSE_CHUNK_SIZE)
+      len = TEST_PARSE_CHUNK_SIZE;
+    if(raptor_parser_parse_chunk(parser, t->content + offset, len, 0)) {
+      t->failures++;
+      goto tidy;
+    }
+  }
+  if(raptor_parser_parse_chunk(parser, NULL, 0, 1))
+    t->failures++;
+
+  tidy:
+  if(base_uri)
+    raptor_free_uri(base_uri);
+  if(parser)
+    raptor_free_parser(parser);
+
+  return NULL;
+}
+
+
+/* several threads each parsing in parallel with one thread-safe world */
+static int
+test_thread_safe_parsers(const char* program)
+{
+  raptor_world *world;
+  test_parse_thread threads[TEST_THREADS_COUNT];
+  pthread_t ids[TEST_THREADS_COUNT];
+  raptor_stringbuffer* sb;
+  unsigned char* content;
+  size_t content_length;
+  int failures = 0;
+  unsigned int interned;
+  int i;
+
+  world = raptor_new_world();
+  if(!world ||
+     raptor_world_set_flag(world, RAPTOR_WORLD_FLAG_THREAD_SAFE, 1) ||
+     raptor_world_open(world)) {
+    fprintf(stderr, "%s: failed to open a thread-safe world\n", program);
+    return 1;
+  }
+
+  sb = raptor_new_stringbuffer();
+  for(i = 0; i < TEST_PARSE_LINES; i++) {
+    char buf[128];
+
+    /* all threads intern the same subject and predicate URIs */
+    snprintf(buf, sizeof(buf),
+             "<http://example.org/s%d> <http://example.org/p%d> _:b%d .\n",
+             i % 100, i % 7, i);
+    raptor_stringbuffer_append_string(sb, (const unsigned char*)buf, 1);
+  }
+  content_length = raptor_stringbuffer_length(sb);
+  content = raptor_stringbuffer_as_string(sb);
+
+  interned = raptor_uri_interned_count(world);
+
+  for(i = 0; i < TEST_THREADS_COUNT; i++) {
+    memset(&threads[i], '\0', sizeof(threads[i]));
+    threads[i].world = world;
+    threads[i].content = content;
+    threads[i].content_length = content_length;
+    pthread_create(&ids[i], NULL, test_parse_thread_run, &threads[i]);
+  }
+  for(i = 0; i < TEST_THREADS_COUNT; i++)
+    pthread_join(ids[i], NULL);
+
+  for(i = 0; i < TEST_THREADS_COUNT; i++) {
+    failures += threads[i].failures;
+
+    if(threads[i].statements != TEST_PARSE_LINES) {
+      fprintf(stderr, "%s: parser thread %d got %d statements, expected %d\n",
+              program, i, threads[i].statements, TEST_PARSE_LINES);
+      failures++;
+    }
+  }
+
+  if(!RAPTOR_WORLD_LOCKING(world)) {
+    fprintf(stderr, "%s: thread-safe world stopped locking after pools freed\n",
+            program);
+    failures++;
+  }
+
+  if(raptor_uri_interned_count(world) != interned) {
+    fprintf(stderr, "%s: %u URIs interned after parsers ended, expected %u\n",
+            program, raptor_uri_interned_count(world), interned);
+    failures++;
+  }
+
+  raptor_free_stringbuffer(sb);
+  raptor_free_world(world);
+
+  return failures;
+}
+#endif
+#endif
+
+
+int
+main(int argc, char *argv[])
+{
+  const char *program = raptor_basename(argv[0]);
+  raptor_world *world;
+  raptor_thread_pool* pool;
+  test_task* tasks;
+  raptor_thread_task* task;
+  int failures = 0;
+  int i;
+  int count = 0;
+
+  world = raptor_new_world();
+  if(!world || raptor_world_open(world))
+    exit(1);
+
+  pool = raptor_new_thread_pool(world, 4);
+  if(!pool) {
+#ifdef HAVE_PTHREAD_H
+    fprintf(stderr, "%s: raptor_new_thread_pool() failed\n", program);
+    failures++;
+#endif
+    raptor_free_world(world);
+    return failures;
+  }
+
+  if(!RAPTOR_WORLD_LOCKING(world)) {
+    fprintf(stderr, "%s: world not locking with a running pool\n", program);
+    failures++;
+  }
+
+  tasks = (test_task*)calloc(TEST_TASKS_COUNT, sizeof(*tasks));
+  for(i = 0; i < TEST_TASKS_COUNT; i++) {
+    tasks[i].task.handler = test_task_handler;
+    tasks[i].task.user_data = &tasks[i];
+    tasks[i].input = i;
+    raptor_thread_pool_add_task(pool, &tasks[i].task);
+  }
+
+  while((task = raptor_thread_pool_wait_task(pool))) {
+    test_task* t = (test_task*)task->user_data;
+
+    if(t->done) {
+      fprintf(stderr, "%s: task %d returned twice\n", program, t->input);
+      failures++;
+    }
+    t->done = 1;
+    count++;
+  }
+
+  if(count != TEST_TASKS_COUNT) {
+    fprintf(stderr, "%s: got %d completed tasks, expected %d\n", program,
+            count, TEST_TASKS_COUNT);
+    failures++;
+  }
+
+  for(i = 0; i < TEST_TASKS_COUNT; i++) {
+    if(tasks[i].output != (i * (i + 1)) / 2) {
+      fprintf(stderr, "%s: task %d returned %d, expected %d\n", program,
+              i, tasks[i].output, (i * (i + 1)) / 2);
+      failures++;
+    }
+  }
+
+  raptor_free_thread_pool(pool);
+
+  if(RAPTOR_WORLD_LOCKING(world)) {
+    fprintf(stderr, "%s: world still locking after pool freed\n", program);
+    failures++;
+  }
+
+  free(tasks);
+  raptor_free_world(world);
+
+#ifdef HAVE_PTHREAD_H
+  failures += test_thread_safe_world(program);
+#ifdef RAPTOR_PARSER_NTRIPLES
+  failures += test_thread_safe_parsers(program);
+#endif
+#endif
+
+  return failures;
+}
+
+#endif
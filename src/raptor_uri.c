@@ -75,11 +75,182 @@ struct raptor_uri_s {
   unsigned int length;
   /* usage count */
   int usage;
+  /* hash of string - see raptor_uri_hash_string() */
+  unsigned int hash;
+  /* parsed string made on first use as a base URI or NULL */
+  raptor_uri_detail* detail;
 };
 
 
 #ifndef STANDALONE
 
+#define RAPTOR_URI_TABLE_INITIAL_SIZE 1024
+
+/* Resolved URIs up to this long are built on the stack */
+#define RAPTOR_URI_RESOLVE_BUFFER_SIZE 1024
+
+/* table for a URI hash: the top bits pick one so the low bits used
+ * for the slot stay spread out */
+#define RAPTOR_URI_TABLE(world, hash) \
+  (&(world)->uris_tables[((hash) >> 28) & ((world)->uris_tables_count - 1)])
+
+#ifdef HAVE_PTHREAD_H
+#define RAPTOR_URI_TABLE_LOCK(world, table)                             \
+  do {                                                                  \
+    if(RAPTOR_WORLD_LOCKING(world))                                     \
+      pthread_mutex_lock(&(table)->mutex);                              \
+  } while(0)
+#define RAPTOR_URI_TABLE_UNLOCK(world, table)                           \
+  do {                                                                  \
+    if(RAPTOR_WORLD_LOCKING(world))                                     \
+      pthread_mutex_unlock(&(table)->mutex);                            \
+  } while(0)
+#else
+#define RAPTOR_URI_TABLE_LOCK(world, table) do { } while(0)
+#define RAPTOR_URI_TABLE_UNLOCK(world, table) do { } while(0)
+#endif
+
+/*
+ * raptor_uri_hash_string:
+ * @string: URI string
+ * @length: length of @string
+ *
+ * INTERNAL - Hash a counted URI string
+ *
+ * Uses the 32 bit FNV-1a hash which mixes well on long keys that
+ * share a common prefix such as URIs in one namespace.
+ *
+ * Return value: hash value
+ */
+static unsigned int
+raptor_uri_hash_string(const unsigned char *string, size_t length)
+{
+  unsigned int hash = 2166136261U;
+
+  while(length--) {
+    hash ^= *string++;
+    hash *= 16777619U;
+  }
+
+  return hash;
+}
+
+
+/*
+ * raptor_uri_table_lookup:
+ * @table: URI table
+ * @string: URI string
+ * @length: length of @string
+ * @hash: hash of @string
+ *
+ * INTERNAL - Find the slot for a URI string in the interning table
+ *
+ * Return value: index of slot holding the matching URI or of the empty
+ * slot where it would be added
+ */
+static unsigned int
+raptor_uri_table_lookup(raptor_uri_table* table, const unsigned char *string,
+                        unsigned int length, unsigned int hash)
+{
+  unsigned int mask = table->size - 1;
+  unsigned int i = hash & mask;
+  raptor_uri* uri;
+
+  while((uri = table->uris[i])) {
+    if(uri->hash == hash && uri->length == length &&
+       !memcmp(uri->string, string, length))
+      break;
+    i = (i + 1) & mask;
+  }
+
+  return i;
+}
+
+
+/*
+ * raptor_uri_table_grow:
+ * @table: URI table
+ *
+ * INTERNAL - Double the size of an interning table
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_uri_table_grow(raptor_uri_table* table)
+{
+  raptor_uri** old_table = table->uris;
+  unsigned int old_size = table->size;
+  unsigned int new_size = old_size << 1;
+  unsigned int mask = new_size - 1;
+  raptor_uri** new_table;
+  unsigned int i;
+
+  new_table = RAPTOR_CALLOC(raptor_uri**, new_size, sizeof(raptor_uri*));
+  if(!new_table)
+    return 1;
+
+  for(i = 0; i < old_size; i++) {
+    raptor_uri* uri = old_table[i];
+    unsigned int j;
+
+    if(!uri)
+      continue;
+
+    /* all entries are distinct so no need to compare strings */
+    for(j = uri->hash & mask; new_table[j]; j = (j + 1) & mask)
+      ;
+    new_table[j] = uri;
+  }
+
+  RAPTOR_FREE(raptor_uri**, old_table);
+  table->uris = new_table;
+  table->size = new_size;
+
+  return 0;
+}
+
+
+/*
+ * raptor_uri_table_remove:
+ * @table: URI table
+ * @uri: URI to remove
+ *
+ * INTERNAL - Remove a URI from an interning table
+ *
+ * Uses backward shift deletion so that no tombstones are needed
+ * and probe sequences stay short.
+ */
+static void
+raptor_uri_table_remove(raptor_uri_table* table, raptor_uri* uri)
+{
+  unsigned int mask = table->size - 1;
+  unsigned int i;
+  unsigned int j;
+
+  for(i = uri->hash & mask; table->uris[i] != uri; i = (i + 1) & mask) {
+    if(!table->uris[i])
+      /* not interned - can happen if the table add failed */
+      return;
+  }
+
+  table->uris[i] = NULL;
+  table->count--;
+
+  /* move following entries of the probe run back into the hole if
+   * their home slot is not between the hole and where they are now
+   */
+  for(j = (i + 1) & mask; table->uris[j]; j = (j + 1) & mask) {
+    unsigned int home = table->uris[j]->hash & mask;
+
+    if(((j - home) & mask) >= ((j - i) & mask)) {
+      table->uris[i] = table->uris[j];
+      table->uris[j] = NULL;
+      i = j;
+    }
+  }
+}
+
+
 /**
  * raptor_new_uri_from_counted_string:
  * @world: raptor_world object
@@ -100,6 +271,9 @@ raptor_new_uri_from_counted_string(raptor_world* world,
 {
   raptor_uri* new_uri;
   unsigned char *new_string;
+  unsigned int hash;
+  unsigned int slot = 0;
+  raptor_uri_table* table = NULL;
   
   RAPTOR_CHECK_CONSTRUCTOR_WORLD(world);
 
@@ -108,24 +282,24 @@ raptor_new_uri_from_counted_string(raptor_world* world,
 
   raptor_world_open(world);
 
-  if(world->uris_tree) {
-    raptor_uri key; /* on stack - not allocated */
+  hash = raptor_uri_hash_string(uri_string, length);
 
-    /* just to be safe */
-    memset(&key, 0, sizeof(key));
+  if(world->uris_tables) {
+    table = RAPTOR_URI_TABLE(world, hash);
+    RAPTOR_URI_TABLE_LOCK(world, table);
 
-    key.string = (unsigned char*)uri_string;
-    key.length = (unsigned int)length;
+    slot = raptor_uri_table_lookup(table, uri_string, (unsigned int)length,
+                                   hash);
 
-    /* if existing URI found in tree, return it */
-    new_uri = (raptor_uri*)raptor_avltree_search(world->uris_tree, &key);
+    /* if existing URI found in table, return it */
+    new_uri = table->uris[slot];
     if(new_uri) {
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
       RAPTOR_DEBUG3("Found existing URI %s with current usage %d\n",
                     uri_string, new_uri->usage);
 #endif
       
-      new_uri->usage++;
+      raptor_world_atomic_add(world, &new_uri->usage, 1);
       
       goto unlock;
     }
@@ -146,6 +320,7 @@ raptor_new_uri_from_counted_string(raptor_world* world,
 
   new_uri->world = world;
   new_uri->length = (unsigned int)length;
+  new_uri->hash = hash;
 
   new_string = RAPTOR_MALLOC(unsigned char*, length + 1);
   if(!new_string) {
@@ -160,16 +335,26 @@ raptor_new_uri_from_counted_string(raptor_world* world,
 
   new_uri->usage = 1; /* for user */
 
-  /* store in tree */
-  if(world->uris_tree) {
-    if(raptor_avltree_add(world->uris_tree, new_uri)) {
-      RAPTOR_FREE(char*, new_string);
-      RAPTOR_FREE(raptor_uri, new_uri);
-      new_uri = NULL;
+  /* store in table, keeping it at most half full */
+  if(table) {
+    if((table->count + 1) << 1 > table->size) {
+      if(raptor_uri_table_grow(table)) {
+        RAPTOR_FREE(char*, new_string);
+        RAPTOR_FREE(raptor_uri, new_uri);
+        new_uri = NULL;
+        goto unlock;
+      }
+      slot = raptor_uri_table_lookup(table, uri_string, (unsigned int)length,
+                                     hash);
     }
+
+    table->uris[slot] = new_uri;
+    table->count++;
   }
 
  unlock:
+  if(table)
+    RAPTOR_URI_TABLE_UNLOCK(world, table);
 
   return new_uri;
 }
@@ -247,6 +432,59 @@ raptor_new_uri_from_uri_local_name(raptor_world* world, raptor_uri *uri,
 }
 
 
+/*
+ * raptor_uri_get_detail:
+ * @uri: URI
+ *
+ * INTERNAL - Get the parsed components of a URI
+ *
+ * The URI string is parsed on the first call and the result kept
+ * with the URI, so resolving many references against one base URI
+ * parses it once.  The detail is owned by @uri and must not be
+ * modified or freed.  In a locking world only the call that parses
+ * it takes the URI table lock.
+ *
+ * Return value: URI detail or NULL on failure
+ */
+raptor_uri_detail*
+raptor_uri_get_detail(raptor_uri* uri)
+{
+  raptor_world* world = uri->world;
+  raptor_uri_table* table = NULL;
+  raptor_uri_detail* detail;
+
+#ifdef HAVE_ATOMIC_BUILTINS
+  /* once set the detail does not change until the URI is freed */
+  detail = __atomic_load_n(&uri->detail, __ATOMIC_ACQUIRE);
+  if(detail)
+    return detail;
+#endif
+
+  if(RAPTOR_WORLD_LOCKING(world)) {
+    /* the table lock guards setting the detail of a shared URI */
+    if(!world->uris_tables)
+      return NULL;
+    table = RAPTOR_URI_TABLE(world, uri->hash);
+    RAPTOR_URI_TABLE_LOCK(world, table);
+  }
+
+  detail = uri->detail;
+  if(!detail) {
+    detail = raptor_new_uri_detail(uri->string);
+#ifdef HAVE_ATOMIC_BUILTINS
+    __atomic_store_n(&uri->detail, detail, __ATOMIC_RELEASE);
+#else
+    uri->detail = detail;
+#endif
+  }
+
+  if(table)
+    RAPTOR_URI_TABLE_UNLOCK(world, table);
+
+  return detail;
+}
+
+
 /**
  * raptor_new_uri_relative_to_base_counted:
  * @world: raptor_world object
@@ -264,7 +502,8 @@ raptor_new_uri_relative_to_base_counted(raptor_world* world,
                                         const unsigned char *uri_string,
                                         size_t uri_len)
 {
-  unsigned char *buffer;
+  unsigned char stack_buffer[RAPTOR_URI_RESOLVE_BUFFER_SIZE];
+  unsigned char *buffer = stack_buffer;
   size_t buffer_length;
   raptor_uri* new_uri;
   size_t actual_length;
@@ -285,15 +524,21 @@ raptor_new_uri_relative_to_base_counted(raptor_world* world,
   
   /* +1 for adding any missing URI path '/' */
   buffer_length = base_uri->length + uri_len + 1;
-  buffer = RAPTOR_MALLOC(unsigned char*, buffer_length + 1);
-  if(!buffer)
-    return NULL;
+  if(buffer_length + 1 > sizeof(stack_buffer)) {
+    buffer = RAPTOR_MALLOC(unsigned char*, buffer_length + 1);
+    if(!buffer)
+      return NULL;
+  }
   
-  actual_length = raptor_uri_resolve_uri_reference(base_uri->string, uri_string,
-                                                   buffer, buffer_length);
+  /* a NULL detail (out of memory) makes the resolver parse the base */
+  actual_length = raptor_uri_resolve_uri_reference_detail(base_uri->string,
+                                                          raptor_uri_get_detail(base_uri),
+                                                          uri_string,
+                                                          buffer, buffer_length);
 
   new_uri = raptor_new_uri_from_counted_string(world, buffer, actual_length);
-  RAPTOR_FREE(char*, buffer);
+  if(buffer != stack_buffer)
+    RAPTOR_FREE(char*, buffer);
   return new_uri;
 }
 
@@ -338,7 +583,10 @@ raptor_new_uri_from_id(raptor_world *world, raptor_uri *base_uri,
                        const unsigned char *id) 
 {
   raptor_uri *new_uri;
-  unsigned char *local_name;
+  unsigned char stack_buffer[RAPTOR_URI_RESOLVE_BUFFER_SIZE];
+  unsigned char *buffer = stack_buffer;
+  const unsigned char *fragment;
+  size_t base_len;
   size_t len;
 
   RAPTOR_CHECK_CONSTRUCTOR_WORLD(world);
@@ -352,17 +600,29 @@ raptor_new_uri_from_id(raptor_world *world, raptor_uri *base_uri,
   RAPTOR_DEBUG2("Using ID %s\n", id);
 #endif
 
+  /* Resolving "#id" against the base replaces any base fragment so
+   * build "base-without-fragment#id" directly */
+  base_len = base_uri->length;
+  fragment = (const unsigned char*)memchr(base_uri->string, '#', base_len);
+  if(fragment)
+    base_len = fragment - base_uri->string;
+
   len = strlen((char*)id);
-  /* "#id\0" */
-  local_name = RAPTOR_MALLOC(unsigned char*, len + 1 + 1);
-  if(!local_name)
-    return NULL;
+  /* "base#id\0" */
+  if(base_len + 1 + len + 1 > sizeof(stack_buffer)) {
+    buffer = RAPTOR_MALLOC(unsigned char*, base_len + 1 + len + 1);
+    if(!buffer)
+      return NULL;
+  }
 
-  *local_name = '#';
-  memcpy(local_name + 1, id, len + 1); /* len+1 to copy NUL */
+  memcpy(buffer, base_uri->string, base_len);
+  buffer[base_len] = '#';
+  memcpy(buffer + base_len + 1, id, len + 1); /* len+1 to copy NUL */
 
-  new_uri = raptor_new_uri_relative_to_base(world, base_uri, local_name);
-  RAPTOR_FREE(char*, local_name);
+  new_uri = raptor_new_uri_from_counted_string(world, buffer,
+                                               base_len + 1 + len);
+  if(buffer != stack_buffer)
+    RAPTOR_FREE(char*, buffer);
   return new_uri;
 }
 
@@ -474,24 +734,39 @@ raptor_new_uri_from_uri_or_file_string(raptor_world* world,
 void
 raptor_free_uri(raptor_uri *uri)
 {
+  raptor_world* world;
+
   if(!uri)
     return;
 
-  uri->usage--;
-  
-#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-  RAPTOR_DEBUG3("URI %s usage count now %d\n", uri->string, uri->usage);
-#endif
+  world = uri->world;
 
-  /* decrement usage, don't free if not 0 yet*/
-  if(uri->usage > 0) {
+  /* drop a reference that is not the last without taking the table
+   * lock; the last one is dropped with it held so that a lookup
+   * cannot find the URI while it is freed */
+  if(raptor_world_atomic_add_unless(world, &uri->usage, -1, 1))
     return;
-  }
 
-  /* this does not free the uri */
-  if(uri->world->uris_tree)
-    raptor_avltree_delete(uri->world->uris_tree, uri);
+  if(world->uris_tables) {
+    raptor_uri_table* table = RAPTOR_URI_TABLE(world, uri->hash);
+
+    RAPTOR_URI_TABLE_LOCK(world, table);
+    /* a lookup may have found it before the lock was taken */
+    if(raptor_world_atomic_add(world, &uri->usage, -1) > 0) {
+      RAPTOR_URI_TABLE_UNLOCK(world, table);
+      return;
+    }
+    raptor_uri_table_remove(table, uri);
+    RAPTOR_URI_TABLE_UNLOCK(world, table);
+  } else if(raptor_world_atomic_add(world, &uri->usage, -1) > 0)
+    return;
 
+#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
+  RAPTOR_DEBUG2("URI %s usage count now 0\n", uri->string);
+#endif
+
+  if(uri->detail)
+    raptor_free_uri_detail(uri->detail);
   if(uri->string)
     RAPTOR_FREE(char*, uri->string);
   RAPTOR_FREE(raptor_uri, uri);
@@ -516,8 +791,8 @@ raptor_uri_equals(raptor_uri* uri1, raptor_uri* uri2)
     /* Both not-NULL - compare for equality */
     if(uri1 == uri2)
       return 1;
-    else if (uri1->length != uri2->length)
-      /* Different if lengths are different */
+    else if (uri1->length != uri2->length || uri1->hash != uri2->hash)
+      /* Different if lengths or hashes are different */
       return 0;
     else
       /* Same length compare: do not need strncmp() NUL checking */
@@ -581,7 +856,8 @@ raptor_uri_copy(raptor_uri *uri)
 {
   RAPTOR_ASSERT_OBJECT_POINTER_RETURN_VALUE(uri, raptor_uri, NULL);
   
-  uri->usage++;
+  raptor_world_atomic_add(uri->world, &uri->usage, 1);
+
   return uri;
 }
 
@@ -1164,19 +1440,44 @@ raptor_new_uri_for_retrieval(raptor_uri* old_uri)
 int
 raptor_uri_init(raptor_world* world)
 {
-  if(world->uri_interning && !world->uris_tree) {
-    world->uris_tree = raptor_new_avltree((raptor_data_compare_handler)raptor_uri_compare,
-                                          /* free */ NULL, 0);
-    if(!world->uris_tree) {
+  unsigned int count;
+  unsigned int i;
+
+  if(!world->uri_interning || world->uris_tables)
+    return 0;
+
+  count = world->thread_safe ? RAPTOR_URI_TABLES_COUNT : 1;
+  world->uris_tables = RAPTOR_CALLOC(raptor_uri_table*, count,
+                                     sizeof(raptor_uri_table));
+  if(!world->uris_tables)
+    goto failed;
+  world->uris_tables_count = count;
+
+  for(i = 0; i < count; i++) {
+    raptor_uri_table* table = &world->uris_tables[i];
+
+    table->uris = RAPTOR_CALLOC(raptor_uri**, RAPTOR_URI_TABLE_INITIAL_SIZE,
+                                sizeof(raptor_uri*));
+    if(!table->uris) {
+      world->uris_tables_count = i;
+      raptor_uri_finish(world);
+      goto failed;
+    }
+    table->size = RAPTOR_URI_TABLE_INITIAL_SIZE;
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_init(&table->mutex, NULL);
+#endif
+  }
+
+  return 0;
+
+  failed:
 #ifdef RAPTOR_DEBUG
-      RAPTOR_FATAL1("Failed to create raptor URI avltree");
+  RAPTOR_FATAL1("Failed to create raptor URI table");
 #else
-      raptor_log_error(world, RAPTOR_LOG_LEVEL_ERROR, NULL,
-                       "Failed to create raptor URI avltree");
+  raptor_log_error(world, RAPTOR_LOG_LEVEL_ERROR, NULL,
+                   "Failed to create raptor URI table");
 #endif
-    }
-    
-  }
 
   return 0;
 }
@@ -1185,10 +1486,44 @@ raptor_uri_init(raptor_world* world)
 void
 raptor_uri_finish(raptor_world* world)
 {
-  if(world->uris_tree) {
-    raptor_free_avltree(world->uris_tree);
-    world->uris_tree = NULL;
+  unsigned int i;
+
+  if(!world->uris_tables)
+    return;
+
+  for(i = 0; i < world->uris_tables_count; i++) {
+    raptor_uri_table* table = &world->uris_tables[i];
+
+    RAPTOR_FREE(raptor_uri**, table->uris);
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_destroy(&table->mutex);
+#endif
   }
+
+  RAPTOR_FREE(raptor_uri_table*, world->uris_tables);
+  world->uris_tables = NULL;
+  world->uris_tables_count = 0;
+}
+
+
+/*
+ * raptor_uri_interned_count:
+ * @world: world
+ *
+ * INTERNAL - Get the number of URIs in the interning tables
+ *
+ * Return value: number of URIs
+ */
+unsigned int
+raptor_uri_interned_count(raptor_world* world)
+{
+  unsigned int count = 0;
+  unsigned int i;
+
+  for(i = 0; i < world->uris_tables_count; i++)
+    count += world->uris_tables[i].count;
+
+  return count;
 }
 
 
@@ -1352,6 +1687,7 @@ raptor_uri_to_relative_counted_uri_string(raptor_uri *base_uri,
                                           raptor_uri *reference_uri,
                                           size_t *length_p) {
   raptor_uri_detail *base_detail = NULL, *reference_detail;
+  raptor_uri_detail *base_detail_alloc = NULL;
   const unsigned char *base, *reference_str, *base_file, *reference_file;
   unsigned char *suffix, *cur_ptr;
   size_t base_len, reference_len, reference_file_len, suffix_len;
@@ -1373,7 +1709,9 @@ raptor_uri_to_relative_counted_uri_string(raptor_uri *base_uri,
     goto buildresult;
   
   base = raptor_uri_as_counted_string(base_uri, &base_len);
-  base_detail = raptor_new_uri_detail(base);
+  base_detail = raptor_uri_get_detail(base_uri);
+  if(!base_detail)
+    base_detail = base_detail_alloc = raptor_new_uri_detail(base);
   if(!base_detail)
     goto err;
   
@@ -1503,8 +1841,8 @@ raptor_uri_to_relative_counted_uri_string(raptor_uri *base_uri,
   }
   
   err:
-  if(base_detail)
-    raptor_free_uri_detail(base_detail);
+  if(base_detail_alloc)
+    raptor_free_uri_detail(base_detail_alloc);
   raptor_free_uri_detail(reference_detail);
   
   return result;
@@ -1618,30 +1956,187 @@ raptor_uri_to_string(raptor_uri *uri)
 }
 
 
+/* rdf:_1 to rdf:_32 are made when the world is opened */
+#define RAPTOR_URI_ORDINALS_INITIAL_SIZE 33
+
+/* ordinal URI chunk 0 holds rdf:_n for n below this and each later
+ * chunk k holds as many again from n = this << (k - 1), so chunks
+ * never move once made */
+#define RAPTOR_URI_ORDINALS_CHUNK_SIZE 32
+
+/* rdf:_n URIs from this are made on every call and not kept */
+#define RAPTOR_URI_ORDINALS_MAX_SIZE \
+  (RAPTOR_URI_ORDINALS_CHUNK_SIZE << (RAPTOR_URI_ORDINALS_CHUNKS - 1))
+
+
+static raptor_uri*
+raptor_new_uri_for_rdf_ordinal(raptor_world* world, int ordinal)
+{
+  /* strlen(rdf namespace URI) + _ + decimal int number + \0 */
+  unsigned char uri_string[43 + 1 + MAX_ASCII_INT_SIZE + 1];
+  unsigned char *p = uri_string;
+
+  memcpy(p, raptor_rdf_namespace_uri, raptor_rdf_namespace_uri_len);
+  p += raptor_rdf_namespace_uri_len;
+  *p++ = '_';
+  (void)raptor_format_integer(RAPTOR_GOOD_CAST(char*, p),
+                              MAX_ASCII_INT_SIZE + 1, ordinal, /* base */ 10,
+                              -1, '\0');
+
+  return raptor_new_uri(world, uri_string);
+}
+
+
+/* get the size of ordinal URI chunk @chunk */
+static int
+raptor_uri_ordinals_chunk_size(int chunk)
+{
+  return chunk ? RAPTOR_URI_ORDINALS_CHUNK_SIZE << (chunk - 1) :
+                 RAPTOR_URI_ORDINALS_CHUNK_SIZE;
+}
+
+
+/* get the ordinal URI chunk holding @ordinal and the index in it */
+static int
+raptor_uri_ordinals_chunk(int ordinal, int* index_p)
+{
+  int chunk = 0;
+
+  while(ordinal >= (RAPTOR_URI_ORDINALS_CHUNK_SIZE << chunk))
+    chunk++;
+
+  *index_p = chunk ? ordinal - (RAPTOR_URI_ORDINALS_CHUNK_SIZE << (chunk - 1)) :
+                     ordinal;
+
+  return chunk;
+}
+
+
+/*
+ * raptor_uri_ordinals_init:
+ * @world: world
+ *
+ * INTERNAL - Make the world's small rdf:_n ordinal URIs
+ *
+ * Return value: non-0 on failure
+ */
+int
+raptor_uri_ordinals_init(raptor_world* world)
+{
+  int i;
+
+  for(i = 1; i < RAPTOR_URI_ORDINALS_INITIAL_SIZE; i++) {
+    raptor_uri* uri = raptor_new_uri_from_rdf_ordinal(world, i);
+
+    if(!uri)
+      return 1;
+    raptor_free_uri(uri);
+  }
+
+  return 0;
+}
+
+
+/*
+ * raptor_uri_ordinals_finish:
+ * @world: world
+ *
+ * INTERNAL - Free the world's rdf:_n ordinal URIs
+ */
+void
+raptor_uri_ordinals_finish(raptor_world* world)
+{
+  int chunk;
+
+  for(chunk = 0; chunk < RAPTOR_URI_ORDINALS_CHUNKS; chunk++) {
+    raptor_uri** uris = world->ordinal_uris[chunk];
+    int size = raptor_uri_ordinals_chunk_size(chunk);
+    int i;
+
+    if(!uris)
+      continue;
+
+    for(i = 0; i < size; i++) {
+      if(uris[i])
+        raptor_free_uri(uris[i]);
+    }
+
+    RAPTOR_FREE(raptor_uri**, uris);
+    world->ordinal_uris[chunk] = NULL;
+  }
+}
+
+
 /**
  * raptor_new_uri_from_rdf_ordinal:
  * @world: raptor_world object
  * @ordinal: integer rdf:_n
  * 
  * Internal - convert an integer rdf:_n ordinal to the resource URI
+ *
+ * The URIs are kept in the world so that after the first use of an
+ * ordinal this is an array lookup and a reference count change.  A
+ * chunk or URI is only set once, so in a locking world a kept URI is
+ * found without the world lock.
  * 
  * Return value: new URI object or NULL on failure
  **/
 raptor_uri*
 raptor_new_uri_from_rdf_ordinal(raptor_world* world, int ordinal)
 {
-  /* strlen(rdf namespace URI) + _ + decimal int number + \0 */
-  unsigned char uri_string[43 + 1 + MAX_ASCII_INT_SIZE + 1];
-  unsigned char *p = uri_string;
+  raptor_uri** uris;
+  raptor_uri* uri = NULL;
+  int chunk;
+  int index;
 
-  memcpy(p, raptor_rdf_namespace_uri, raptor_rdf_namespace_uri_len);
-  p += raptor_rdf_namespace_uri_len;
-  *p++ = '_';
-  (void)raptor_format_integer(RAPTOR_GOOD_CAST(char*, p),
-                              MAX_ASCII_INT_SIZE + 1, ordinal, /* base */ 10,
-                              -1, '\0');
+  if(ordinal < 1 || ordinal >= RAPTOR_URI_ORDINALS_MAX_SIZE)
+    return raptor_new_uri_for_rdf_ordinal(world, ordinal);
 
-  return raptor_new_uri(world, uri_string);
+  chunk = raptor_uri_ordinals_chunk(ordinal, &index);
+
+#ifdef HAVE_ATOMIC_BUILTINS
+  uris = __atomic_load_n(&world->ordinal_uris[chunk], __ATOMIC_ACQUIRE);
+  if(uris) {
+    uri = __atomic_load_n(&uris[index], __ATOMIC_ACQUIRE);
+    if(uri)
+      return raptor_uri_copy(uri);
+  }
+#endif
+
+  /* parsers in several threads may make the same chunk or URI */
+  RAPTOR_WORLD_LOCK(world);
+
+  uris = world->ordinal_uris[chunk];
+  if(!uris) {
+    uris = RAPTOR_CALLOC(raptor_uri**,
+                         RAPTOR_GOOD_CAST(size_t, raptor_uri_ordinals_chunk_size(chunk)),
+                         sizeof(raptor_uri*));
+    if(!uris)
+      goto unlock;
+#ifdef HAVE_ATOMIC_BUILTINS
+    __atomic_store_n(&world->ordinal_uris[chunk], uris, __ATOMIC_RELEASE);
+#else
+    world->ordinal_uris[chunk] = uris;
+#endif
+  }
+
+  uri = uris[index];
+  if(!uri) {
+    uri = raptor_new_uri_for_rdf_ordinal(world, ordinal);
+    if(!uri)
+      goto unlock;
+#ifdef HAVE_ATOMIC_BUILTINS
+    __atomic_store_n(&uris[index], uri, __ATOMIC_RELEASE);
+#else
+    uris[index] = uri;
+#endif
+  }
+  uri = raptor_uri_copy(uri);
+
+  unlock:
+  RAPTOR_WORLD_UNLOCK(world);
+
+  return uri;
 }
 
 
@@ -2084,6 +2579,75 @@ main(int argc, char *argv[])
     raptor_free_uri(u2);
   }
 
+  if(1) {
+    /* enough URIs to make the interning table grow several times */
+#define INTERN_TEST_COUNT 5000
+    raptor_uri* uris[INTERN_TEST_COUNT];
+    unsigned int count = raptor_uri_interned_count(world);
+    char buf[64];
+    int j;
+
+    for(j = 0; j < INTERN_TEST_COUNT; j++) {
+      snprintf(buf, sizeof(buf), "http://example.org/intern/%d", j);
+      uris[j] = raptor_new_uri(world, (const unsigned char*)buf);
+    }
+
+    /* remove every other URI, exercising deletion inside probe runs */
+    for(j = 0; j < INTERN_TEST_COUNT; j += 2)
+      raptor_free_uri(uris[j]);
+
+    for(j = 1; j < INTERN_TEST_COUNT; j += 2) {
+      raptor_uri* u;
+
+      snprintf(buf, sizeof(buf), "http://example.org/intern/%d", j);
+      u = raptor_new_uri(world, (const unsigned char*)buf);
+      if(u != uris[j]) {
+        fprintf(stderr,
+                "%s: raptor_new_uri(%s) FAILED to return interned URI\n",
+                program, buf);
+        failures++;
+      }
+      raptor_free_uri(u);
+      raptor_free_uri(uris[j]);
+    }
+
+    if(raptor_uri_interned_count(world) != count) {
+      fprintf(stderr,
+              "%s: URI interning table has %u entries after freeing, expected %u\n",
+              program, raptor_uri_interned_count(world), count);
+      failures++;
+    }
+  }
+
+  if(1) {
+    /* kept ordinals, one grown on first use and one never kept */
+    int ordinals[4] = { 1, 32, 1000, 100000 };
+    char buf[64];
+    int j;
+
+    for(j = 0; j < 4; j++) {
+      raptor_uri* u1;
+      raptor_uri* u2;
+
+      snprintf(buf, sizeof(buf), "%s_%d", raptor_rdf_namespace_uri,
+               ordinals[j]);
+      u1 = raptor_new_uri_from_rdf_ordinal(world, ordinals[j]);
+      u2 = raptor_new_uri_from_rdf_ordinal(world, ordinals[j]);
+      if(!u1 || !u2 || strcmp((const char*)raptor_uri_as_string(u1), buf) ||
+         !raptor_uri_equals(u1, u2)) {
+        fprintf(stderr,
+                "%s: raptor_new_uri_from_rdf_ordinal(%d) FAILED gave %s expected %s\n",
+                program, ordinals[j],
+                u1 ? (const char*)raptor_uri_as_string(u1) : "NULL", buf);
+        failures++;
+      }
+      if(u1)
+        raptor_free_uri(u1);
+      if(u2)
+        raptor_free_uri(u2);
+    }
+  }
+
   raptor_free_world(world);
 
   return failures ;
@@ -945,6 +945,155 @@ raptor_xml_name_check(const unsigned char *string, size_t length,
 }
 
 
+/*
+ * raptor_xml_namestartchar_check:
+ * @string: UTF-8 string
+ * @length: length of string
+ * @xml_version: XML version
+ *
+ * INTERNAL - Check the first character of a string can start an XML name
+ *
+ * Return value: non-0 if the string starts with a legal XML name start char
+ */
+static int
+raptor_xml_namestartchar_check(const unsigned char *string, size_t length,
+                               int xml_version)
+{
+  raptor_unichar unichar = 0;
+  int unichar_len;
+
+  unichar_len = raptor_unicode_utf8_string_get_char(string, length, &unichar);
+  if(unichar_len < 0 || RAPTOR_GOOD_CAST(size_t, unichar_len) > length)
+    return 0;
+
+  if(unichar > raptor_unicode_max_codepoint)
+    return 0;
+
+  if(xml_version == 10)
+    return raptor_unicode_is_xml10_namestartchar(unichar);
+  else if(xml_version == 11)
+    return raptor_unicode_is_xml11_namestartchar(unichar);
+
+  return 0;
+}
+
+
+/*
+ * raptor_xml_namechars_suffix_offset:
+ * @string: UTF-8 string
+ * @length: length of string
+ * @xml_version: XML version
+ *
+ * INTERNAL - Find where the trailing run of XML name characters starts
+ *
+ * Scans @string once.  Every character from the returned offset to
+ * the end of the string is a legal (UTF-8) XML name character, so a
+ * suffix starting at offset N >= the returned offset is a legal XML
+ * name exactly when raptor_xml_name_suffix_check() accepts it.
+ *
+ * Return value: offset of the run or @length if there is none
+ */
+size_t
+raptor_xml_namechars_suffix_offset(const unsigned char *string, size_t length,
+                                   int xml_version)
+{
+  size_t offset = 0;
+  size_t run_offset = 0;
+
+  if(xml_version != 10 && xml_version != 11)
+    return length;
+
+  while(offset < length) {
+    raptor_unichar unichar = 0;
+    int unichar_len;
+    int ok;
+
+    unichar_len = raptor_unicode_utf8_string_get_char(string + offset,
+                                                      length - offset,
+                                                      &unichar);
+    if(unichar_len < 0 ||
+       RAPTOR_GOOD_CAST(size_t, unichar_len) > length - offset) {
+      /* skip the bad byte; no name can contain it */
+      offset++;
+      run_offset = offset;
+      continue;
+    }
+
+    if(unichar > raptor_unicode_max_codepoint)
+      ok = 0;
+    else if(xml_version == 10)
+      ok = raptor_unicode_is_xml10_namechar(unichar);
+    else
+      ok = raptor_unicode_is_xml11_namechar(unichar);
+
+    offset += unichar_len;
+    if(!ok)
+      run_offset = offset;
+  }
+
+  return run_offset;
+}
+
+
+/*
+ * raptor_xml_name_suffix_check:
+ * @string: UTF-8 string
+ * @length: length of string
+ * @offset: offset of candidate name in @string
+ * @run_offset: result of raptor_xml_namechars_suffix_offset() for @string
+ * @xml_version: XML version
+ *
+ * INTERNAL - Check the suffix of a string at @offset is a legal XML name
+ *
+ * Equivalent to raptor_xml_name_check(@string + @offset,
+ * @length - @offset) for a non-empty suffix but takes constant time.
+ *
+ * Return value: non-0 if the suffix is a legal XML name
+ */
+int
+raptor_xml_name_suffix_check(const unsigned char *string, size_t length,
+                             size_t offset, size_t run_offset,
+                             int xml_version)
+{
+  if(offset >= length || offset < run_offset)
+    return 0;
+
+  return raptor_xml_namestartchar_check(string + offset, length - offset,
+                                        xml_version);
+}
+
+
+/*
+ * raptor_xml_name_split_offset:
+ * @string: UTF-8 string
+ * @length: length of string
+ * @xml_version: XML version
+ *
+ * INTERNAL - Find the longest suffix of a string that is a legal XML name
+ *
+ * Used to split a URI into a namespace URI and a local name in time
+ * linear in the length of the string.
+ *
+ * Return value: offset of the suffix or @length if there is none
+ */
+size_t
+raptor_xml_name_split_offset(const unsigned char *string, size_t length,
+                             int xml_version)
+{
+  size_t offset;
+
+  offset = raptor_xml_namechars_suffix_offset(string, length, xml_version);
+  while(offset < length) {
+    if(raptor_xml_namestartchar_check(string + offset, length - offset,
+                                      xml_version))
+      return offset;
+    offset++;
+  }
+
+  return length;
+}
+
+
 #endif
 
 
@@ -25,6 +25,10 @@
 #ifndef TURTLE_COMMON_H
 #define TURTLE_COMMON_H
 
+#ifdef HAVE_SETJMP_H
+#include <setjmp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,15 +43,24 @@ RAPTOR_INTERNAL_API size_t raptor_turtle_expand_qname_escapes(unsigned char *nam
 extern void turtle_token_free(raptor_world* world, int token, YYSTYPE *lval);
 
 
+typedef struct raptor_turtle_segment_s raptor_turtle_segment;
+
+
 /*
  * Turtle parser object
  */
 struct raptor_turtle_parser_s {
-  /* buffer */
+  /* input buffer */
   char *buffer;
 
-  /* buffer length */
+  /* allocated size of buffer */
   size_t buffer_length;
+
+  /* offset of the first byte in buffer not yet given to the lexer */
+  size_t buffer_start;
+
+  /* offset of the end of the input in buffer */
+  size_t buffer_end;
   
   raptor_namespace_stack namespaces; /* static */
 
@@ -59,17 +72,20 @@ struct raptor_turtle_parser_s {
 
   int scanner_set;
 
+  /* push parser state, kept across chunks */
+  turtle_parser_pstate *pstate;
+
   int lineno;
-  int lineno_last_good;
 
-  /* for the chunk parser, how much of the input has been consumed */
+  /* how much of the bytes given to the lexer it has consumed */
   size_t consumed;
-  /* likewise, how much of the input has been successfully processed */
-  size_t processed;
-  /* indicates what can be processed at most */
-  size_t consumable;
-  /* real end-of-buffer indicator, as we kill the last line */
-  size_t end_of_buffer;
+
+  /* set by the lexer to the quote character when the input ends in
+   * the middle of a long literal */
+  int long_literal_delim;
+
+  /* bytes after buffer_start already searched for the end of it */
+  size_t long_literal_searched;
 
   /* a sequence holding deferred statements */
   raptor_sequence *deferred;
@@ -88,6 +104,47 @@ struct raptor_turtle_parser_s {
 
   /* Last run of many */
   int is_end;
+
+  /* segment being parsed by a worker thread or NULL */
+  raptor_turtle_segment* segment;
+
+  /* Worker threads when parsing in parallel or NULL */
+  raptor_thread_pool* pool;
+
+  /* Segments given to the pool and not yet returned, in input order */
+  raptor_turtle_segment* segments;
+  raptor_turtle_segment* segments_tail;
+  int segments_count;
+
+  /* Maximum number of segments parsed or waiting at one time */
+  int segments_max;
+
+  /* Non-0 to return segments as they are parsed, not in input order */
+  int unordered;
+
+  /* statement boundary scanner state; see turtle_scan_statement() */
+  size_t scan_offset;
+  int scan_state;
+  int scan_quote;
+  int scan_quotes_count;
+  int scan_escape;
+  int scan_cr;
+  int scan_depth;
+  int scan_lineno;
+  int scan_started;
+  int scan_directive;
+  char scan_keyword[8];
+  int scan_keyword_length;
+
+  /* end of the complete statements after buffer_start not yet given
+   * to a segment and the line there */
+  size_t statements_end;
+  int statements_end_lineno;
+
+#ifdef HAVE_SETJMP
+  /* where the lexer returns to after a fatal error */
+  jmp_buf fatal_error_env;
+#endif
 };
 
 
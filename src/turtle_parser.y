@@ -88,9 +88,6 @@ const char * turtle_token_print(raptor_world* world, int token, YYSTYPE *lval);
 /* the lexer does not seem to track this */
 #undef RAPTOR_TURTLE_USE_ERROR_COLUMNS
 
-/* set api.push-pull to "push" if this is defined */
-#undef TURTLE_PUSH_PARSE
-
 /* Prototypes */ 
 int turtle_parser_error(raptor_parser* rdf_parser, void* scanner, const char *msg);
 
@@ -103,8 +100,14 @@ static void raptor_turtle_generate_statement(raptor_parser *parser, raptor_state
 
 static void raptor_turtle_defer_statement(raptor_parser *parser, raptor_statement *triple);
 
+static void raptor_turtle_push_deferred(raptor_parser *parser, raptor_statement *triple);
+
 static void raptor_turtle_handle_statement(raptor_parser *parser, raptor_statement *triple);
 
+static raptor_term* turtle_new_generated_blank(raptor_parser *rdf_parser);
+
+static void raptor_turtle_segment_yield_deferred(raptor_parser *rdf_parser);
+
 %}
 
 
@@ -130,8 +133,9 @@ static void raptor_turtle_handle_statement(raptor_parser *parser, raptor_stateme
 /* Pure parser - want a reentrant parser  */
 %define api.pure full
 
-/* Push or pull parser? */
-%define api.push-pull pull
+/* Push or pull parser? Push so that parsing can stop at the end of
+ * a chunk and carry on with the next one */
+%define api.push-pull push
 
 /* Pure parser argument: lexer - yylex() and parser - yyparse() */
 %lex-param { yyscan_t yyscanner }
@@ -305,15 +309,6 @@ dotTriplesList: triples
 ;
 
 statementList: statementList statement
-{
-  raptor_turtle_parser* turtle_parser;
-
-  turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
-
-  /* sync up consumed/processed so we know what to unwind */
-  turtle_parser->processed = turtle_parser->consumed;
-  turtle_parser->lineno_last_good = turtle_parser->lineno;
-}
 | statementList error
 | %empty
 ;
@@ -327,6 +322,8 @@ statement: directive
 
   /* yield deferred statements, if any */
   turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+  if(turtle_parser->segment)
+    raptor_turtle_segment_yield_deferred(rdf_parser);
   if(turtle_parser->deferred) {
     raptor_sequence* def = turtle_parser->deferred;
 
@@ -616,7 +613,12 @@ verb: predicate
   printf("verb predicate = rdf:type (a)\n");
 #endif
 
-  $$ = raptor_term_copy(RAPTOR_RDF_type_term(rdf_parser->world));
+  if(((raptor_turtle_parser*)rdf_parser->context)->segment)
+    /* the world term is not shared between threads */
+    $$ = raptor_new_term_from_uri(rdf_parser->world,
+                                  RAPTOR_RDF_type_URI(rdf_parser->world));
+  else
+    $$ = raptor_term_copy(RAPTOR_RDF_type_term(rdf_parser->world));
   if(!$$)
     YYERROR;
 }
@@ -1105,17 +1107,8 @@ blankNode: BLANK_LITERAL
 blankNodePropertyList: LEFT_SQUARE predicateObjectListOpt RIGHT_SQUARE
 {
   int i;
-  const unsigned char *id;
-
-  id = raptor_world_generate_bnodeid(rdf_parser->world);
-  if(!id) {
-    if($2)
-      raptor_free_sequence($2);
-    YYERROR;
-  }
 
-  $$ = raptor_new_term_from_blank(rdf_parser->world, id);
-  RAPTOR_FREE(char*, id);
+  $$ = turtle_new_generated_blank(rdf_parser);
   if(!$$) {
     if($2)
       raptor_free_sequence($2);
@@ -1193,15 +1186,8 @@ collection: LEFT_ROUND itemList RIGHT_ROUND
   for(i = raptor_sequence_size($2)-1; i>=0; i--) {
     raptor_term* temp;
     raptor_statement* t2 = (raptor_statement*)raptor_sequence_get_at($2, i);
-    const unsigned char *blank_id;
-
-    blank_id = raptor_world_generate_bnodeid(rdf_parser->world);
-    if(!blank_id)
-      YYERR_MSG_GOTO(err_collection, "Cannot create bnodeid");
 
-    blank = raptor_new_term_from_blank(rdf_parser->world,
-                                       blank_id);
-    RAPTOR_FREE(char*, blank_id);
+    blank = turtle_new_generated_blank(rdf_parser);
     if(!blank)
       YYERR_MSG_GOTO(err_collection, "Cannot create bnode");
     
@@ -1276,6 +1262,86 @@ collection: LEFT_ROUND itemList RIGHT_ROUND
 %%
 
 
+/* Input collected before it is handed to a worker thread */
+#define RAPTOR_TURTLE_SEGMENT_SIZE (1 << 16)
+
+/* First byte of the IDs of blank nodes generated in a segment.  It
+ * cannot start a blank node label in the input. */
+#define RAPTOR_TURTLE_SEGMENT_BLANK_MARK '\x01'
+
+/*
+ * A statement or graph mark from a segment, kept until the segment
+ * is returned.
+ */
+typedef struct {
+  /* statement terms or all NULL for a graph mark */
+  raptor_term* subject;
+  raptor_term* predicate;
+  raptor_term* object;
+  raptor_term* graph;
+
+  /* graph mark URI or NULL for the default graph */
+  raptor_uri* graph_uri;
+  int graph_flags;
+
+  /* Non-0 for a statement still deferred at the end of the segment */
+  int deferred;
+
+  /* Non-0 where statements deferred before the segment are returned */
+  int yield_deferred;
+} raptor_turtle_segment_item;
+
+
+/*
+ * A run of complete top level statements with no directives parsed
+ * by a worker thread when the parallelThreads option is set.
+ */
+struct raptor_turtle_segment_s {
+  raptor_thread_task task;
+
+  /* parser the segment is parsed for */
+  raptor_parser* rdf_parser;
+
+  /* namespaces of @rdf_parser, shared by all segments */
+  raptor_namespace_stack* namespaces;
+
+  /* parser used by the worker thread */
+  raptor_parser parser;
+  raptor_turtle_parser turtle_parser;
+
+  /* statements with room for 2 more bytes after them for the lexer */
+  char* buffer;
+  size_t length;
+
+  /* lines at the start and the end of the segment */
+  int lineno;
+  int end_lineno;
+
+  /* parsed statements and graph marks in order */
+  raptor_turtle_segment_item* items;
+  int items_count;
+  int items_size;
+
+  /* number of blank nodes generated while parsing */
+  int blanks_count;
+
+  /* Non-0 if the segment must be parsed again in the calling thread */
+  int failed;
+
+  /* Non-0 once statements deferred before the segment are yielded */
+  int yielded_deferred;
+
+  /* Non-0 when parsed and the statements can be returned */
+  int done;
+
+  /* next segment in input order */
+  raptor_turtle_segment* next;
+};
+
+
+static void raptor_turtle_parallel_finish(raptor_parser* rdf_parser);
+
+
 /* Support functions */
 
 int
@@ -1285,14 +1351,6 @@ turtle_parser_error(raptor_parser* rdf_parser, void* scanner, const char *msg)
 
   turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
 
-  if(turtle_parser->consumed == turtle_parser->consumable &&
-     turtle_parser->processed < turtle_parser->consumed &&
-     !turtle_parser->is_end) {
-    /* we encountered an error on or around the last byte of the buffer
-     * sorting it in the next run aye? */
-    return 0;
-  }
-  
   if(turtle_parser->error_count++)
     return 0;
 
@@ -1354,105 +1412,578 @@ turtle_qname_to_uri(raptor_parser *rdf_parser, unsigned char *name, size_t name_
   if(!name_len)
     return NULL;
   
+  if(turtle_parser->segment)
+    /* not changed while any segment is being parsed */
+    return raptor_qname_string_to_uri(turtle_parser->segment->namespaces,
+                                      name, name_len);
+
   return raptor_qname_string_to_uri(&turtle_parser->namespaces, name, name_len);
 }
 
 
 
-#ifndef TURTLE_PUSH_PARSE
+/*
+ * turtle_push_token:
+ * @rdf_parser: parser
+ * @token: token from the lexer or 0 at the end of input
+ * @lval: token value or NULL
+ *
+ * INTERNAL - Pass one token to the push parser
+ *
+ * Return value: non-0 if the parser has stopped
+ */
 static int
-turtle_parse(raptor_parser *rdf_parser, const char *string, size_t length)
+turtle_push_token(raptor_parser *rdf_parser, int token, YYSTYPE *lval)
 {
-  raptor_turtle_parser* turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
-  int rc;
-  
-  if(!string || !*string)
-    return 0;
-  
-  if(turtle_lexer_lex_init(&turtle_parser->scanner))
-    return 1;
-  turtle_parser->scanner_set = 1;
+  raptor_turtle_parser* turtle_parser;
+  int status;
 
-#if defined(YYDEBUG) && YYDEBUG > 0
-  turtle_lexer_set_debug(1 ,&turtle_parser->scanner);
-  turtle_parser_debug = 1;
-#endif
+  turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
 
-  turtle_lexer_set_extra(rdf_parser, turtle_parser->scanner);
-  (void)turtle_lexer__scan_bytes((char *)string, (int)length, turtle_parser->scanner);
+#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
+  printf("token %s\n", turtle_token_print(rdf_parser->world, token, lval));
+#endif
 
-  rc = turtle_parser_parse(rdf_parser, turtle_parser->scanner);
+  status = turtle_parser_push_parse(turtle_parser->pstate, token, lval,
+                                    rdf_parser, turtle_parser->scanner);
+  if(status == YYPUSH_MORE)
+    return 0;
 
-  turtle_lexer_lex_destroy(turtle_parser->scanner);
-  turtle_parser->scanner_set = 0;
+  if(token && !turtle_parser->error_count) {
+    /* gave up before the end of input without saying why */
+    turtle_parser->error_count++;
+    raptor_parser_fatal_error(rdf_parser, "Turtle parser failed");
+  }
 
-  return rc;
+  return (status != 0);
 }
-#endif
 
 
-#ifdef TURTLE_PUSH_PARSE
+/*
+ * turtle_lex_bytes:
+ * @rdf_parser: parser
+ * @base: bytes with room for 2 more after them
+ * @length: length of @base
+ *
+ * INTERNAL - Lex bytes in place and push the tokens to the parser,
+ * setting consumed to how many bytes were lexed.
+ *
+ * Return value: non-0 on failure
+ */
 static int
-turtle_push_parse(raptor_parser *rdf_parser, 
-                  const char *string, size_t length)
+turtle_lex_bytes(raptor_parser *rdf_parser, char *base, size_t length)
 {
-#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-  raptor_world* world = rdf_parser->world;
-#endif
   raptor_turtle_parser* turtle_parser;
-  void *buffer;
-  int status;
-  yypstate *ps;
+  char saved[2];
+  YY_BUFFER_STATE buffer_state;
+  int rc = 0;
 
   turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
 
-  if(!string || !*string)
-    return 0;
-  
-  if(turtle_lexer_lex_init(&turtle_parser->scanner))
+  /* flex scans a buffer in place when it ends with two NULs; the
+   * buffer always has room for them but they may overwrite input
+   * after @length, so keep it */
+  saved[0] = base[length];
+  saved[1] = base[length + 1];
+  base[length] = base[length + 1] = '\0';
+
+  buffer_state = turtle_lexer__scan_buffer(base, length + 2,
+                                           turtle_parser->scanner);
+  if(!buffer_state) {
+    base[length] = saved[0];
+    base[length + 1] = saved[1];
+    raptor_parser_fatal_error(rdf_parser, "Out of memory");
     return 1;
-  turtle_parser->scanner_set = 1;
-
-#if defined(YYDEBUG) && YYDEBUG > 0
-  turtle_lexer_set_debug(1 ,&turtle_parser->scanner);
-  turtle_parser_debug = 1;
-#endif
-
-  turtle_lexer_set_extra(rdf_parser, turtle_parser->scanner);
-  buffer = turtle_lexer__scan_bytes(string, length, turtle_parser->scanner);
+  }
 
-  /* returns a parser instance or 0 on out of memory */
-  ps = yypstate_new();
-  if(!ps)
-    return 1;
+  turtle_parser->consumed = 0;
+  turtle_parser->long_literal_delim = 0;
 
-  do {
+  while(1) {
+    size_t token_start = turtle_parser->consumed;
+    int token_lineno = turtle_parser->lineno;
     YYSTYPE lval;
     int token;
 
     memset(&lval, 0, sizeof(YYSTYPE));
-    
     token = turtle_lexer_lex(&lval, turtle_parser->scanner);
 
-#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-    printf("token %s\n", turtle_token_print(world, token, &lval));
-#endif
-
-    status = yypush_parse(ps, token, &lval, rdf_parser, turtle_parser->scanner);
+    if(turtle_parser->long_literal_delim) {
+      /* input ended in a long literal; wait for the rest of it */
+      turtle_parser->consumed = token_start;
+      turtle_parser->lineno = token_lineno;
+      break;
+    }
 
-    /* turtle_token_free(world, token, &lval); */
+    if(!token || token == EOF)
+      break;
 
-    if(!token || token == EOF || token == ERROR_TOKEN)
+    if(turtle_push_token(rdf_parser, token, &lval)) {
+      rc = 1;
       break;
-  } while (status == YYPUSH_MORE);
-  yypstate_delete(ps);
+    }
+  }
+
+  turtle_lexer__delete_buffer(buffer_state, turtle_parser->scanner);
+  base[length] = saved[0];
+  base[length + 1] = saved[1];
+
+  if(!rc && !turtle_parser->long_literal_delim &&
+     turtle_parser->consumed != length) {
+    /* the lexer stopped early */
+    rc = 1;
+  }
+
+  return rc;
+}
+
+
+/*
+ * turtle_long_literal_searched:
+ * @turtle_parser: parser
+ * @end: offset in the buffer the literal is known to be open at
+ *
+ * INTERNAL - Record that the unfinished long literal has no closing
+ * quotes before @end.
+ *
+ * The next search starts again at the quotes and backslashes just
+ * before @end since they may be part of the closing quotes or of an
+ * escape split over two searches.
+ */
+static void
+turtle_long_literal_searched(raptor_turtle_parser *turtle_parser, size_t end)
+{
+  char delim = RAPTOR_GOOD_CAST(char, turtle_parser->long_literal_delim);
+  const char *buffer = turtle_parser->buffer;
+  size_t start = turtle_parser->buffer_start;
+
+  while(end > start && (buffer[end - 1] == delim || buffer[end - 1] == '\\'))
+    end--;
+
+  turtle_parser->long_literal_searched = end - start;
+}
+
+
+/*
+ * turtle_lex:
+ * @rdf_parser: parser
+ * @end: offset in the buffer to lex up to
+ *
+ * INTERNAL - Lex the buffer from buffer_start up to @end in place and
+ * push the tokens to the parser.
+ *
+ * Apart from a long literal that is not finished by @end, each byte is
+ * lexed once.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+turtle_lex(raptor_parser *rdf_parser, size_t end)
+{
+  raptor_turtle_parser* turtle_parser;
+  int rc;
+
+  turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+
+  rc = turtle_lex_bytes(rdf_parser,
+                        turtle_parser->buffer + turtle_parser->buffer_start,
+                        end - turtle_parser->buffer_start);
+
+  turtle_parser->buffer_start += turtle_parser->consumed;
+
+  /* the lexer has been through the rest of an unfinished long
+   * literal so only new input needs searching for its end */
+  if(!rc && turtle_parser->long_literal_delim)
+    turtle_long_literal_searched(turtle_parser, end);
+
+  return rc;
+}
+
+
+/* initial size of the input buffer */
+#define TURTLE_BUFFER_SIZE 4096
+
+/*
+ * turtle_buffer_append:
+ * @rdf_parser: parser
+ * @s: bytes
+ * @len: length of @s
+ *
+ * INTERNAL - Append input to the buffer, first moving down any
+ * unlexed bytes when the buffer is full
+ *
+ * Return value: non-0 on failure
+ */
+static int
+turtle_buffer_append(raptor_parser *rdf_parser,
+                     const unsigned char *s, size_t len)
+{
+  raptor_turtle_parser* turtle_parser;
+  size_t pending;
+
+  turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+
+  pending = turtle_parser->buffer_end - turtle_parser->buffer_start;
+
+  /* +2 for the NULs that flex needs after the bytes it lexes */
+  if(turtle_parser->buffer_end + len + 2 > turtle_parser->buffer_length) {
+    if(turtle_parser->buffer_start) {
+      memmove(turtle_parser->buffer,
+              turtle_parser->buffer + turtle_parser->buffer_start, pending);
+      if(turtle_parser->pool) {
+        turtle_parser->scan_offset -= turtle_parser->buffer_start;
+        turtle_parser->statements_end -= turtle_parser->buffer_start;
+      }
+      turtle_parser->buffer_start = 0;
+      turtle_parser->buffer_end = pending;
+    }
+
+    if(pending + len + 2 > turtle_parser->buffer_length) {
+      size_t new_length = turtle_parser->buffer_length;
+      char *new_buffer;
+
+      if(!new_length)
+        new_length = TURTLE_BUFFER_SIZE;
+      while(new_length < pending + len + 2)
+        new_length <<= 1;
+
+      new_buffer = RAPTOR_REALLOC(char*, turtle_parser->buffer, new_length);
+      if(!new_buffer) {
+        raptor_parser_fatal_error(rdf_parser, "Out of memory");
+        return 1;
+      }
+      turtle_parser->buffer = new_buffer;
+      turtle_parser->buffer_length = new_length;
+    }
+  }
 
-  turtle_lexer_lex_destroy(turtle_parser->scanner);
-  turtle_parser->scanner_set = 0;
+  memcpy(turtle_parser->buffer + turtle_parser->buffer_end, s, len);
+  turtle_parser->buffer_end += len;
 
   return 0;
 }
-#endif
+
+
+/*
+ * turtle_may_continue_line:
+ * @turtle_parser: parser
+ * @end: offset in the buffer just after a newline
+ *
+ * INTERNAL - Check if the token before the newline at @end might join
+ * with what comes after it.  In TriG a URI or QName followed by
+ * whitespace and a '{' is lexed as one graph name token.
+ *
+ * Return value: non-0 if the line may continue
+ */
+static int
+turtle_may_continue_line(raptor_turtle_parser *turtle_parser, size_t end)
+{
+  const char *p = turtle_parser->buffer + end;
+  const char *p_start = turtle_parser->buffer + turtle_parser->buffer_start;
+
+  while(p > p_start) {
+    int c = *(const unsigned char*)--p;
+
+    if(c == ' ' || c == '\t' || c == '\v' || c == '\r' || c == '\n')
+      continue;
+    return (c == '>' || c == '=' || c == ':' || c == '_' || c == '-' ||
+            isalnum(c) || c >= 0x80);
+  }
+
+  return 0;
+}
+
+
+/*
+ * turtle_long_literal_ended:
+ * @turtle_parser: parser
+ * @end: offset in the buffer to search up to
+ *
+ * INTERNAL - Check if the closing quotes of the unfinished long
+ * literal are before @end, searching only bytes not seen before
+ * and skipping escaped characters
+ *
+ * Return value: non-0 if the quotes may have been found
+ */
+static int
+turtle_long_literal_ended(raptor_turtle_parser *turtle_parser, size_t end)
+{
+  char delim = RAPTOR_GOOD_CAST(char, turtle_parser->long_literal_delim);
+  const char *p;
+  const char *p_end;
+  int count = 0;
+
+  p = turtle_parser->buffer + turtle_parser->buffer_start +
+      turtle_parser->long_literal_searched;
+  p_end = turtle_parser->buffer + end;
+
+  for(; p < p_end; p++) {
+    if(*p == '\\') {
+      p++;
+      count = 0;
+    } else if(*p != delim)
+      count = 0;
+    else if(++count == 3)
+      return 1;
+  }
+
+  turtle_long_literal_searched(turtle_parser, end);
+  return 0;
+}
+
+
+/* States of the statement boundary scanner */
+enum {
+  TURTLE_SCAN_TOP,
+  TURTLE_SCAN_COMMENT,
+  TURTLE_SCAN_IRI,
+  /* one or two quotes that start a string */
+  TURTLE_SCAN_QUOTES,
+  TURTLE_SCAN_STRING,
+  TURTLE_SCAN_LONG_STRING,
+  /* a '.' outside any brackets */
+  TURTLE_SCAN_DOT,
+  /* the first word of a statement */
+  TURTLE_SCAN_KEYWORD
+};
+
+
+/*
+ * turtle_scan_is_name_char:
+ * @c: byte
+ *
+ * INTERNAL - Check if a byte can continue a prefixed name, so that a
+ * statement starting "prefix" or "base" is not a directive
+ *
+ * Return value: non-0 if so
+ */
+static int
+turtle_scan_is_name_char(int c)
+{
+  return (c == '_' || c == '-' || c == ':' || (c >= '0' && c <= '9') ||
+          (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c >= 0x80);
+}
+
+
+/*
+ * turtle_scan_statement:
+ * @turtle_parser: parser
+ * @directive_p: pointer to store if the statement is a directive
+ *
+ * INTERNAL - Scan the buffer from scan_offset for the end of a top
+ * level statement: a '.' outside any brackets followed by whitespace
+ * or a comment or, in TriG, a '}' closing a graph.  Strings, IRIs and
+ * comments are skipped.
+ *
+ * The scan stops at the end of the buffer and carries on from there
+ * when called again with more input.  Lines are counted the same way
+ * as the lexer does into scan_lineno.
+ *
+ * A statement is taken to be a directive if it starts with '@' or with
+ * the word PREFIX or BASE in any case.
+ *
+ * Return value: non-0 if a statement ends at scan_offset
+ */
+static int
+turtle_scan_statement(raptor_turtle_parser *turtle_parser, int *directive_p)
+{
+  const unsigned char *buffer = (const unsigned char*)turtle_parser->buffer;
+  size_t offset = turtle_parser->scan_offset;
+  size_t end = turtle_parser->buffer_end;
+  int found = 0;
+
+  while(offset < end && !found) {
+    int c = buffer[offset];
+
+    switch(turtle_parser->scan_state) {
+      case TURTLE_SCAN_COMMENT:
+        if(c == '\r' || c == '\n') {
+          /* count the line end at the top level */
+          turtle_parser->scan_state = TURTLE_SCAN_TOP;
+          continue;
+        }
+        break;
+
+      case TURTLE_SCAN_IRI:
+        if(c == '>')
+          turtle_parser->scan_state = TURTLE_SCAN_TOP;
+        else if(c == '\r' || c == '\n') {
+          /* not an IRI */
+          turtle_parser->scan_state = TURTLE_SCAN_TOP;
+          continue;
+        }
+        break;
+
+      case TURTLE_SCAN_QUOTES:
+        if(c == turtle_parser->scan_quote) {
+          if(++turtle_parser->scan_quotes_count == 3) {
+            turtle_parser->scan_quotes_count = 0;
+            turtle_parser->scan_state = TURTLE_SCAN_LONG_STRING;
+          }
+          break;
+        }
+        /* two quotes are an empty string */
+        turtle_parser->scan_state = (turtle_parser->scan_quotes_count == 2) ?
+          TURTLE_SCAN_TOP : TURTLE_SCAN_STRING;
+        turtle_parser->scan_quotes_count = 0;
+        continue;
+
+      case TURTLE_SCAN_STRING:
+        if(turtle_parser->scan_escape)
+          turtle_parser->scan_escape = 0;
+        else if(c == '\\')
+          turtle_parser->scan_escape = 1;
+        else if(c == turtle_parser->scan_quote)
+          turtle_parser->scan_state = TURTLE_SCAN_TOP;
+        else if(c == '\r' || c == '\n') {
+          /* not a string */
+          turtle_parser->scan_state = TURTLE_SCAN_TOP;
+          continue;
+        }
+        break;
+
+      case TURTLE_SCAN_LONG_STRING:
+        if(c == '\n')
+          turtle_parser->scan_lineno++;
+
+        if(turtle_parser->scan_escape) {
+          turtle_parser->scan_escape = 0;
+          turtle_parser->scan_quotes_count = 0;
+        } else if(c == '\\') {
+          turtle_parser->scan_escape = 1;
+          turtle_parser->scan_quotes_count = 0;
+        } else if(c != turtle_parser->scan_quote)
+          turtle_parser->scan_quotes_count = 0;
+        else if(++turtle_parser->scan_quotes_count == 3) {
+          turtle_parser->scan_quotes_count = 0;
+          turtle_parser->scan_state = TURTLE_SCAN_TOP;
+        }
+        break;
+
+      case TURTLE_SCAN_DOT:
+        turtle_parser->scan_state = TURTLE_SCAN_TOP;
+        if(c == ' ' || c == '\t' || c == '\v' || c == '\r' || c == '\n' ||
+           c == '#')
+          /* the statement ends before this byte */
+          found = 1;
+        continue;
+
+      case TURTLE_SCAN_KEYWORD:
+        if((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+          if(turtle_parser->scan_keyword_length < (int)sizeof(turtle_parser->scan_keyword))
+            turtle_parser->scan_keyword[turtle_parser->scan_keyword_length] = RAPTOR_GOOD_CAST(char, c);
+          turtle_parser->scan_keyword_length++;
+          break;
+        }
+
+        if(((turtle_parser->scan_keyword_length == 6 &&
+             !raptor_strncasecmp(turtle_parser->scan_keyword, "prefix", 6)) ||
+            (turtle_parser->scan_keyword_length == 4 &&
+             !raptor_strncasecmp(turtle_parser->scan_keyword, "base", 4))) &&
+           !turtle_scan_is_name_char(c))
+          turtle_parser->scan_directive = 1;
+        turtle_parser->scan_state = TURTLE_SCAN_TOP;
+        continue;
+
+      case TURTLE_SCAN_TOP:
+      default:
+        if(c == '\r') {
+          turtle_parser->scan_lineno++;
+          turtle_parser->scan_cr = 1;
+          break;
+        }
+        if(c == '\n') {
+          /* \r\n is one line end */
+          if(!turtle_parser->scan_cr)
+            turtle_parser->scan_lineno++;
+          turtle_parser->scan_cr = 0;
+          break;
+        }
+        turtle_parser->scan_cr = 0;
+
+        if(turtle_parser->scan_escape) {
+          /* escaped byte in a prefixed name */
+          turtle_parser->scan_escape = 0;
+          break;
+        }
+
+        if(c == ' ' || c == '\t' || c == '\v')
+          break;
+
+        if(c == '#') {
+          turtle_parser->scan_state = TURTLE_SCAN_COMMENT;
+          break;
+        }
+
+        if(!turtle_parser->scan_started) {
+          turtle_parser->scan_started = 1;
+          if(c == '@')
+            turtle_parser->scan_directive = 1;
+          else if(c == 'P' || c == 'p' || c == 'B' || c == 'b') {
+            turtle_parser->scan_keyword_length = 0;
+            turtle_parser->scan_state = TURTLE_SCAN_KEYWORD;
+            continue;
+          }
+        }
+
+        switch(c) {
+          case '\\':
+            turtle_parser->scan_escape = 1;
+            break;
+
+          case '<':
+            turtle_parser->scan_state = TURTLE_SCAN_IRI;
+            break;
+
+          case '"':
+          case '\'':
+            turtle_parser->scan_quote = c;
+            turtle_parser->scan_quotes_count = 1;
+            turtle_parser->scan_state = TURTLE_SCAN_QUOTES;
+            break;
+
+          case '[':
+          case '(':
+          case '{':
+            turtle_parser->scan_depth++;
+            break;
+
+          case ']':
+          case ')':
+          case '}':
+            if(turtle_parser->scan_depth && !--turtle_parser->scan_depth &&
+               c == '}' && turtle_parser->trig) {
+              /* the statement ends after this byte */
+              offset++;
+              found = 1;
+              continue;
+            }
+            break;
+
+          case '.':
+            if(!turtle_parser->scan_depth)
+              turtle_parser->scan_state = TURTLE_SCAN_DOT;
+            break;
+
+          default:
+            break;
+        }
+        break;
+    }
+
+    offset++;
+  }
+
+  turtle_parser->scan_offset = offset;
+
+  if(found) {
+    *directive_p = turtle_parser->scan_directive;
+    turtle_parser->scan_started = 0;
+    turtle_parser->scan_directive = 0;
+  }
+
+  return found;
+}
 
 
 /**
@@ -1486,8 +2017,15 @@ static void
 raptor_turtle_parse_terminate(raptor_parser *rdf_parser) {
   raptor_turtle_parser *turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
 
+  raptor_turtle_parallel_finish(rdf_parser);
+
   raptor_namespaces_clear(&turtle_parser->namespaces);
 
+  if(turtle_parser->pstate) {
+    turtle_parser_pstate_delete(turtle_parser->pstate);
+    turtle_parser->pstate = NULL;
+  }
+
   if(turtle_parser->scanner_set) {
     turtle_lexer_lex_destroy(turtle_parser->scanner);
     turtle_parser->scanner_set = 0;
@@ -1496,6 +2034,16 @@ raptor_turtle_parse_terminate(raptor_parser *rdf_parser) {
   if(turtle_parser->buffer)
     RAPTOR_FREE(cdata, turtle_parser->buffer);
 
+  if(turtle_parser->deferred) {
+    raptor_free_sequence(turtle_parser->deferred);
+    turtle_parser->deferred = NULL;
+  }
+
+  if(turtle_parser->sb) {
+    raptor_free_stringbuffer(turtle_parser->sb);
+    turtle_parser->sb = NULL;
+  }
+
   if(turtle_parser->graph_name) {
     raptor_free_term(turtle_parser->graph_name);
     turtle_parser->graph_name = NULL;
@@ -1590,7 +2138,6 @@ static void
 raptor_turtle_defer_statement(raptor_parser *parser, raptor_statement *t)
 {
   raptor_statement* st;
-  raptor_turtle_parser* turtle_parser;
 
   raptor_turtle_clone_statement(parser, t);
   st = raptor_new_statement(parser->world);
@@ -1603,6 +2150,15 @@ raptor_turtle_defer_statement(raptor_parser *parser, raptor_statement *t)
   st->object = parser->statement.object, parser->statement.object = NULL;
   st->graph = parser->statement.graph, parser->statement.graph = NULL;
 
+  raptor_turtle_push_deferred(parser, st);
+}
+
+/* append an owned statement to the deferred list */
+static void
+raptor_turtle_push_deferred(raptor_parser *parser, raptor_statement *st)
+{
+  raptor_turtle_parser* turtle_parser;
+
   /* prep deferred list */
   turtle_parser = (raptor_turtle_parser*)parser->context;
   if(!turtle_parser->deferred) {
@@ -1619,111 +2175,690 @@ raptor_turtle_defer_statement(raptor_parser *parser, raptor_statement *t)
 }
 
 
-
-static int
-raptor_turtle_parse_chunk(raptor_parser* rdf_parser, 
-                          const unsigned char *s, size_t len,
-                          int is_end)
+static raptor_term*
+turtle_new_generated_blank(raptor_parser *rdf_parser)
 {
-  raptor_turtle_parser *turtle_parser;
-  char *ptr;
-  int rc;
+  raptor_turtle_parser* turtle_parser;
+  raptor_turtle_segment* segment;
+  char id[sizeof(int) * 3 + 2];
+  size_t len;
 
   turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
-  
-#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-  RAPTOR_DEBUG2("adding %d bytes to line buffer\n", (int)len);
-#endif
+  segment = turtle_parser->segment;
+  if(!segment)
+    return raptor_new_term_from_blank(rdf_parser->world, NULL);
 
-  if(!len && !is_end) {
-    /* nothing to do */
-    return 0;
-  }
+  /* numbered in the segment and given an ID when it is returned so
+   * that IDs are made in the same order as a sequential parse */
+  id[0] = RAPTOR_TURTLE_SEGMENT_BLANK_MARK;
+  len = raptor_format_integer(&id[1], sizeof(id) - 1, segment->blanks_count++,
+                              /* base */ 10, -1, '0');
 
-  /* the actual buffer will contained unprocessed characters from
-   * the last run plus the chunk passed here */
-  turtle_parser->end_of_buffer = turtle_parser->consumed + len;
-  if(turtle_parser->end_of_buffer > turtle_parser->buffer_length) {
-    /* resize */
-    size_t new_buffer_length = turtle_parser->end_of_buffer;
+  return raptor_new_term_from_counted_blank(rdf_parser->world,
+                                            (const unsigned char*)id, len + 1);
+}
 
-    turtle_parser->buffer = RAPTOR_REALLOC(char*, turtle_parser->buffer,
-                                           new_buffer_length + 1);
 
-    /* adjust stored length */
-    turtle_parser->buffer_length = new_buffer_length;
+static void
+raptor_free_turtle_segment(raptor_turtle_segment* segment)
+{
+  int i;
+
+  for(i = 0; i < segment->items_count; i++) {
+    raptor_turtle_segment_item* item = &segment->items[i];
+
+    raptor_free_term(item->subject);
+    raptor_free_term(item->predicate);
+    raptor_free_term(item->object);
+    raptor_free_term(item->graph);
+    if(item->graph_uri)
+      raptor_free_uri(item->graph_uri);
+  }
+  if(segment->items)
+    RAPTOR_FREE(raptor_turtle_segment_item*, segment->items);
+
+  if(segment->parser.base_uri)
+    raptor_free_uri(segment->parser.base_uri);
+
+  if(segment->buffer)
+    RAPTOR_FREE(cdata, segment->buffer);
+
+  RAPTOR_FREE(raptor_turtle_segment, segment);
+}
+
+
+/*
+ * raptor_turtle_segment_add_item:
+ * @segment: segment
+ *
+ * Add an empty statement or graph mark to a segment
+ *
+ * Return value: new item or NULL on failure
+ */
+static raptor_turtle_segment_item*
+raptor_turtle_segment_add_item(raptor_turtle_segment* segment)
+{
+  raptor_turtle_segment_item* item;
+
+  if(segment->items_count == segment->items_size) {
+    int new_size = segment->items_size ? segment->items_size << 1 : 256;
+    raptor_turtle_segment_item* items;
+
+    items = RAPTOR_REALLOC(raptor_turtle_segment_item*, segment->items,
+                           RAPTOR_GOOD_CAST(size_t, new_size) * sizeof(*items));
+    if(!items) {
+      /* parse it again in the calling thread */
+      segment->failed = 1;
+      return NULL;
+    }
+
+    segment->items = items;
+    segment->items_size = new_size;
+  }
+
+  item = &segment->items[segment->items_count++];
+  memset(item, '\0', sizeof(*item));
+
+  return item;
+}
+
+
+/* raptor_statement_handler for segments */
+static void
+raptor_turtle_segment_statement_handler(void* user_data,
+                                        raptor_statement* statement)
+{
+  raptor_turtle_segment* segment = (raptor_turtle_segment*)user_data;
+  raptor_turtle_segment_item* item;
+
+  item = raptor_turtle_segment_add_item(segment);
+  if(!item)
+    return;
+
+  item->subject = raptor_term_copy(statement->subject);
+  item->predicate = raptor_term_copy(statement->predicate);
+  item->object = raptor_term_copy(statement->object);
+  item->graph = raptor_term_copy(statement->graph);
+}
+
+
+/*
+ * raptor_turtle_segment_yield_deferred:
+ * @rdf_parser: parser of a segment
+ *
+ * Record where the statements deferred before the segment started
+ * are returned: at the end of its first triples statement.
+ */
+static void
+raptor_turtle_segment_yield_deferred(raptor_parser *rdf_parser)
+{
+  raptor_turtle_parser* turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+  raptor_turtle_segment* segment = turtle_parser->segment;
+  raptor_turtle_segment_item* item;
+
+  if(segment->yielded_deferred)
+    return;
+
+  item = raptor_turtle_segment_add_item(segment);
+  if(!item)
+    return;
+
+  item->yield_deferred = 1;
+  segment->yielded_deferred = 1;
+}
+
+
+/* raptor_graph_mark_handler for segments */
+static void
+raptor_turtle_segment_graph_mark_handler(void* user_data, raptor_uri* graph,
+                                         int flags)
+{
+  raptor_turtle_segment* segment = (raptor_turtle_segment*)user_data;
+  raptor_turtle_segment_item* item;
+
+  item = raptor_turtle_segment_add_item(segment);
+  if(!item)
+    return;
+
+  item->graph_uri = graph ? raptor_uri_copy(graph) : NULL;
+  item->graph_flags = flags;
+}
+
+
+/* raptor_thread_task_log_handler for segments */
+static void
+raptor_turtle_segment_log_handler(raptor_thread_task* task,
+                                  raptor_log_level level,
+                                  raptor_locator* locator,
+                                  const char* text)
+{
+  raptor_turtle_segment* segment = (raptor_turtle_segment*)task->user_data;
+
+  /* the message is logged when the segment is parsed again */
+  segment->failed = 1;
+}
+
+
+/* raptor_thread_task_handler for segments */
+static void
+raptor_turtle_segment_run(raptor_thread_task* task)
+{
+  raptor_turtle_segment* segment = (raptor_turtle_segment*)task->user_data;
+  raptor_parser* rdf_parser = &segment->parser;
+  raptor_turtle_parser* turtle_parser = &segment->turtle_parser;
+
+  if(raptor_namespaces_init(rdf_parser->world, &turtle_parser->namespaces, 0) ||
+     turtle_lexer_lex_init(&turtle_parser->scanner)) {
+    segment->failed = 1;
+    goto tidy;
   }
-  if(!turtle_parser->buffer && turtle_parser->buffer_length) {
-    /* we tried to alloc a buffer but we failed */
+  turtle_parser->scanner_set = 1;
+  turtle_lexer_set_extra(rdf_parser, turtle_parser->scanner);
+
+  turtle_parser->pstate = turtle_parser_pstate_new();
+  if(!turtle_parser->pstate) {
+    segment->failed = 1;
+    goto tidy;
+  }
+
+  if(turtle_lex_bytes(rdf_parser, segment->buffer, segment->length))
+    segment->failed = 1;
+
+  /* always end the input so that the parser frees any values left on
+   * its stack; messages from here are not kept */
+  if(turtle_push_token(rdf_parser, 0, NULL) || turtle_parser->error_count)
+    segment->failed = 1;
+
+  /* TriG graph blocks can leave statements deferred to the end of a
+   * triples statement in a later segment */
+  if(turtle_parser->deferred && !segment->failed) {
+    raptor_sequence* def = turtle_parser->deferred;
+    raptor_statement* t;
+
+    while((t = (raptor_statement*)raptor_sequence_unshift(def))) {
+      raptor_turtle_segment_item* item;
+
+      item = raptor_turtle_segment_add_item(segment);
+      if(item) {
+        item->subject = t->subject, t->subject = NULL;
+        item->predicate = t->predicate, t->predicate = NULL;
+        item->object = t->object, t->object = NULL;
+        item->graph = t->graph, t->graph = NULL;
+        item->deferred = 1;
+      }
+      raptor_free_statement(t);
+    }
+  }
+
+  tidy:
+  raptor_turtle_parse_terminate(rdf_parser);
+  raptor_statement_clear(&rdf_parser->statement);
+}
+
+
+/*
+ * raptor_turtle_segment_add:
+ * @rdf_parser: parser
+ *
+ * Hand the complete statements after buffer_start up to
+ * statements_end, if any, to a worker thread.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_turtle_segment_add(raptor_parser* rdf_parser)
+{
+  raptor_turtle_parser *turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+  raptor_turtle_segment* segment;
+  size_t length;
+
+  length = turtle_parser->statements_end - turtle_parser->buffer_start;
+  if(!length)
+    return 0;
+
+  segment = RAPTOR_CALLOC(raptor_turtle_segment*, 1, sizeof(*segment));
+  if(!segment) {
     raptor_parser_fatal_error(rdf_parser, "Out of memory");
     return 1;
   }
-  if(is_end && !turtle_parser->end_of_buffer) {
-    /* Nothing to do */
-    return 0;
+
+  /* +2 for the NULs that flex needs after the bytes it lexes */
+  segment->buffer = RAPTOR_MALLOC(char*, length + 2);
+  if(!segment->buffer) {
+    RAPTOR_FREE(raptor_turtle_segment, segment);
+    raptor_parser_fatal_error(rdf_parser, "Out of memory");
+    return 1;
+  }
+  memcpy(segment->buffer, turtle_parser->buffer + turtle_parser->buffer_start,
+         length);
+  segment->length = length;
+
+  segment->rdf_parser = rdf_parser;
+  segment->namespaces = &turtle_parser->namespaces;
+  segment->lineno = turtle_parser->lineno;
+  segment->end_lineno = turtle_parser->statements_end_lineno;
+
+  turtle_parser->buffer_start = turtle_parser->statements_end;
+  turtle_parser->lineno = turtle_parser->statements_end_lineno;
+
+  segment->parser.world = rdf_parser->world;
+  segment->parser.locator = rdf_parser->locator;
+  segment->parser.emit_graph_marks = 1;
+  segment->parser.base_uri = raptor_uri_copy(rdf_parser->base_uri);
+  raptor_statement_init(&segment->parser.statement, rdf_parser->world);
+  segment->parser.options = rdf_parser->options;
+  segment->parser.user_data = segment;
+  segment->parser.statement_handler = raptor_turtle_segment_statement_handler;
+  segment->parser.graph_mark_handler = raptor_turtle_segment_graph_mark_handler;
+  segment->parser.context = &segment->turtle_parser;
+  segment->parser.factory = rdf_parser->factory;
+
+  segment->turtle_parser.segment = segment;
+  segment->turtle_parser.trig = turtle_parser->trig;
+  segment->turtle_parser.is_end = 1;
+  segment->turtle_parser.lineno = segment->lineno;
+
+  segment->task.handler = raptor_turtle_segment_run;
+  segment->task.log_handler = raptor_turtle_segment_log_handler;
+  segment->task.user_data = segment;
+
+  if(turtle_parser->segments_tail)
+    turtle_parser->segments_tail->next = segment;
+  else
+    turtle_parser->segments = segment;
+  turtle_parser->segments_tail = segment;
+  turtle_parser->segments_count++;
+
+  raptor_thread_pool_add_task(turtle_parser->pool, &segment->task);
+
+  return 0;
+}
+
+
+/*
+ * raptor_turtle_segment_term:
+ * @term: term from a segment (owned)
+ * @blanks: terms for the blank nodes generated in the segment
+ *
+ * Swap a blank node generated in a segment for its term
+ *
+ * Return value: term
+ */
+static raptor_term*
+raptor_turtle_segment_term(raptor_term* term, raptor_term** blanks)
+{
+  long i;
+
+  if(!term || term->type != RAPTOR_TERM_TYPE_BLANK ||
+     term->value.blank.string[0] != RAPTOR_TURTLE_SEGMENT_BLANK_MARK)
+    return term;
+
+  i = strtol((const char*)term->value.blank.string + 1, NULL, 10);
+  raptor_free_term(term);
+
+  return raptor_term_copy(blanks[i]);
+}
+
+
+/*
+ * raptor_turtle_segment_deliver:
+ * @rdf_parser: parser
+ * @segment: parsed segment
+ *
+ * Return the statements and graph marks from a segment to the user
+ * as a sequential parse would.  A segment that failed is parsed again
+ * here so that any messages and statements are the same too.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_turtle_segment_deliver(raptor_parser* rdf_parser,
+                              raptor_turtle_segment* segment)
+{
+  raptor_turtle_parser *turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+  raptor_term** blanks = NULL;
+  int rc = 0;
+  int i;
+
+  if(segment->failed) {
+    int lineno = turtle_parser->lineno;
+    int is_end = turtle_parser->is_end;
+
+    turtle_parser->lineno = segment->lineno;
+    turtle_parser->is_end = 1;
+    rc = turtle_lex_bytes(rdf_parser, segment->buffer, segment->length);
+    turtle_parser->lineno = lineno;
+    turtle_parser->is_end = is_end;
+
+    return (rc || turtle_parser->error_count);
+  }
+
+  if(segment->blanks_count) {
+    blanks = RAPTOR_CALLOC(raptor_term**,
+                           RAPTOR_GOOD_CAST(size_t, segment->blanks_count),
+                           sizeof(raptor_term*));
+    if(!blanks)
+      goto oom;
+
+    for(i = 0; i < segment->blanks_count; i++) {
+      blanks[i] = raptor_new_term_from_blank(rdf_parser->world, NULL);
+      if(!blanks[i])
+        goto oom;
+    }
+  }
+
+  for(i = 0; i < segment->items_count; i++) {
+    raptor_turtle_segment_item* item = &segment->items[i];
+    raptor_statement *statement = &rdf_parser->statement;
+
+    if(item->yield_deferred) {
+      if(turtle_parser->deferred) {
+        raptor_sequence* def = turtle_parser->deferred;
+        int j;
+
+        for(j = 0; j < raptor_sequence_size(def); j++) {
+          raptor_statement *t2 = (raptor_statement*)raptor_sequence_get_at(def, j);
+
+          raptor_turtle_handle_statement(rdf_parser, t2);
+        }
+        raptor_free_sequence(def);
+        turtle_parser->deferred = NULL;
+      }
+      continue;
+    }
+
+    if(item->deferred) {
+      raptor_statement* t = raptor_new_statement(rdf_parser->world);
+
+      if(!t)
+        goto oom;
+      t->subject = raptor_turtle_segment_term(item->subject, blanks);
+      t->predicate = item->predicate;
+      t->object = raptor_turtle_segment_term(item->object, blanks);
+      t->graph = item->graph;
+      item->subject = NULL;
+      item->predicate = NULL;
+      item->object = NULL;
+      item->graph = NULL;
+
+      raptor_turtle_push_deferred(rdf_parser, t);
+      continue;
+    }
+
+    if(!item->subject) {
+      /* graph marks change emitted_default_graph as the grammar does */
+      if(!(item->graph_flags & RAPTOR_GRAPH_MARK_START)) {
+        raptor_parser_end_graph(rdf_parser, item->graph_uri, 1);
+        rdf_parser->emitted_default_graph = 0;
+      } else if(item->graph_flags & RAPTOR_GRAPH_MARK_DECLARED) {
+        raptor_parser_start_graph(rdf_parser, item->graph_uri, 1);
+        if(!item->graph_uri)
+          rdf_parser->emitted_default_graph++;
+      } else if(!rdf_parser->emitted_default_graph) {
+        /* default graph started at the first triple */
+        raptor_parser_start_graph(rdf_parser, NULL, 0);
+        rdf_parser->emitted_default_graph++;
+      }
+      continue;
+    }
+
+    statement->subject = raptor_turtle_segment_term(item->subject, blanks);
+    statement->predicate = item->predicate;
+    statement->object = raptor_turtle_segment_term(item->object, blanks);
+    statement->graph = item->graph;
+    item->subject = NULL;
+    item->predicate = NULL;
+    item->object = NULL;
+    item->graph = NULL;
+
+    raptor_turtle_handle_statement(rdf_parser, statement);
+    raptor_statement_clear(statement);
+  }
+
+  if(0) {
+    oom:
+    raptor_parser_fatal_error(rdf_parser, "Out of memory");
+    rc = 1;
+  }
+
+  if(blanks) {
+    for(i = 0; i < segment->blanks_count; i++)
+      raptor_free_term(blanks[i]);
+    RAPTOR_FREE(raptor_term**, blanks);
+  }
+
+  return rc;
+}
+
+
+/*
+ * raptor_turtle_parallel_wait:
+ * @rdf_parser: parser
+ * @max_segments: number of segments that may be left unreturned
+ *
+ * Wait for segments to be parsed and return their statements until
+ * no more than @max_segments remain.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_turtle_parallel_wait(raptor_parser* rdf_parser, int max_segments)
+{
+  raptor_turtle_parser *turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+
+  while(turtle_parser->segments_count > max_segments) {
+    raptor_thread_task* task;
+    raptor_turtle_segment* segment;
+    raptor_turtle_segment* prev = NULL;
+
+    task = raptor_thread_pool_wait_task(turtle_parser->pool);
+    if(!task)
+      break;
+
+    ((raptor_turtle_segment*)task->user_data)->done = 1;
+
+    /* return the done segments at the start of the list or, if
+     * unordered, anywhere in the list
+     */
+    segment = turtle_parser->segments;
+    while(segment) {
+      raptor_turtle_segment* next = segment->next;
+      int rc;
+
+      if(!segment->done) {
+        if(!turtle_parser->unordered)
+          break;
+        prev = segment;
+        segment = next;
+        continue;
+      }
+
+      if(prev)
+        prev->next = next;
+      else
+        turtle_parser->segments = next;
+      if(turtle_parser->segments_tail == segment)
+        turtle_parser->segments_tail = prev;
+      turtle_parser->segments_count--;
+
+      rc = raptor_turtle_segment_deliver(rdf_parser, segment);
+      raptor_free_turtle_segment(segment);
+      if(rc)
+        return rc;
+
+      segment = next;
+    }
+  }
+
+  return 0;
+}
+
+
+/*
+ * raptor_turtle_parallel_finish:
+ * @rdf_parser: parser
+ *
+ * Stop the worker threads and drop any segments not yet returned.
+ */
+static void
+raptor_turtle_parallel_finish(raptor_parser* rdf_parser)
+{
+  raptor_turtle_parser *turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+  raptor_turtle_segment* segment;
+
+  if(turtle_parser->pool) {
+    raptor_free_thread_pool(turtle_parser->pool);
+    turtle_parser->pool = NULL;
   }
 
-  /* move pointer to end of cdata buffer */
-  ptr = turtle_parser->buffer + turtle_parser->consumed;
+  while((segment = turtle_parser->segments)) {
+    turtle_parser->segments = segment->next;
+    raptor_free_turtle_segment(segment);
+  }
+  turtle_parser->segments_tail = NULL;
+  turtle_parser->segments_count = 0;
+}
+
 
-  /* now write new stuff at end of cdata buffer */
-  memcpy(ptr, s, len);
-  ptr += len;
-  *ptr = '\0';
+/*
+ * raptor_turtle_parse_chunk_parallel:
+ * @rdf_parser: parser
+ * @is_end: non-0 if no more input follows
+ *
+ * Hand runs of complete top level statements in the buffer to worker
+ * threads and return statements from parsed segments.
+ *
+ * Segments share the namespaces and base URI of the parser so
+ * directives are parsed in this thread once all earlier segments
+ * have been returned.  At the end of the input, whatever follows the
+ * last statement is left for the caller to parse.
+ *
+ * Return value: non-0 on failure
+ */
+static int
+raptor_turtle_parse_chunk_parallel(raptor_parser* rdf_parser, int is_end)
+{
+  raptor_turtle_parser *turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+  int directive;
+
+  while(turtle_scan_statement(turtle_parser, &directive)) {
+    if(!directive) {
+      turtle_parser->statements_end = turtle_parser->scan_offset;
+      turtle_parser->statements_end_lineno = turtle_parser->scan_lineno;
+
+      if(turtle_parser->statements_end - turtle_parser->buffer_start >= RAPTOR_TURTLE_SEGMENT_SIZE &&
+         raptor_turtle_segment_add(rdf_parser))
+        goto failed;
+      continue;
+    }
+
+    if(raptor_turtle_segment_add(rdf_parser) ||
+       raptor_turtle_parallel_wait(rdf_parser, 0) ||
+       turtle_lex(rdf_parser, turtle_parser->scan_offset) ||
+       turtle_parser->error_count)
+      goto failed;
+
+    turtle_parser->statements_end = turtle_parser->buffer_start;
+    turtle_parser->statements_end_lineno = turtle_parser->lineno;
+  }
 
-  /* reset processed counter */
-  turtle_parser->processed = 0U;
-  /* unconsume */
-  turtle_parser->consumed = 0U;
-  /* reset line numbers */
-  turtle_parser->lineno = turtle_parser->lineno_last_good;
+  if(is_end && raptor_turtle_segment_add(rdf_parser))
+    goto failed;
+
+  if(raptor_turtle_parallel_wait(rdf_parser,
+                                 is_end ? 0 : turtle_parser->segments_max))
+    goto failed;
+
+  return 0;
+
+  failed:
+  raptor_turtle_parallel_finish(rdf_parser);
+  return 1;
+}
+
+
+
+static int
+raptor_turtle_parse_chunk(raptor_parser* rdf_parser, 
+                          const unsigned char *s, size_t len,
+                          int is_end)
+{
+  raptor_turtle_parser *turtle_parser;
+  size_t end;
+  int rc = 0;
+
+  turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+  
+#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
+  RAPTOR_DEBUG2("adding %d bytes to line buffer\n", (int)len);
+#endif
+
+  if(!len && !is_end) {
+    /* nothing to do */
+    return 0;
+  }
+
+  if(turtle_parser->error_count)
+    return 1;
+
+  if(len && turtle_buffer_append(rdf_parser, s, len))
+    return 1;
 
   /* let everyone know if this is the last chunk */
   turtle_parser->is_end = is_end;
+
+  if(turtle_parser->pool) {
+    rc = raptor_turtle_parse_chunk_parallel(rdf_parser, is_end);
+    if(rc || !is_end)
+      return rc;
+    /* the input after the last statement is parsed below */
+  }
+
+  end = turtle_parser->buffer_end;
   if(!is_end) {
-    /* it's safer not to pass the very last line to the lexer
-     * just in case we end up with EOB-in-the-middle-of-X situations */
-    size_t i = turtle_parser->end_of_buffer;
-    while(i > 0U && turtle_parser->buffer[--i] != '\n');
-    /* either i == 0U or i points to the last \n before the end-of-buffer */
-    turtle_parser->consumable = i;
-  } else {
-    /* otherwise the consumable number of bytes coincides with the EOB */
-    turtle_parser->consumable = turtle_parser->end_of_buffer;
+    /* Only pass complete lines to the lexer so that no token is split
+     * except a long literal.  The bytes before this chunk have no
+     * newline left in them so only this chunk needs searching. */
+    size_t chunk_start = end - len;
+
+    while(1) {
+      while(end > chunk_start && turtle_parser->buffer[end - 1] != '\n')
+        end--;
+      if(end == chunk_start)
+        return 0;
+      if(!turtle_parser->trig || !turtle_may_continue_line(turtle_parser, end))
+        break;
+      end--;
+    }
+
+    if(turtle_parser->long_literal_delim &&
+       !turtle_long_literal_ended(turtle_parser, end))
+      return 0;
   }
 
 #if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-    RAPTOR_DEBUG3("buffer buffer now '%s' (%ld bytes)\n", 
-                  turtle_parser->buffer, turtle_parser->buffer_length);
+  RAPTOR_DEBUG3("lexing %ld of %ld buffered bytes\n",
+                (long)(end - turtle_parser->buffer_start),
+                (long)(turtle_parser->buffer_end - turtle_parser->buffer_start));
 #endif
 
-#ifdef TURTLE_PUSH_PARSE
-  rc = turtle_push_parse(rdf_parser, 
-                         turtle_parser->buffer, turtle_parser->consumable);
-#else
-  rc = turtle_parse(rdf_parser, turtle_parser->buffer, turtle_parser->consumable);
-#endif  
+  if(end > turtle_parser->buffer_start)
+    rc = turtle_lex(rdf_parser, end);
 
-  if(turtle_parser->error_count) {
+  if(!rc && is_end)
+    rc = turtle_push_token(rdf_parser, 0, NULL);
+
+  if(rc || turtle_parser->error_count) {
     rc = 1;
-  } else if(!is_end) {
-    /* move stuff to the beginning of the buffer */
-    turtle_parser->consumed = turtle_parser->end_of_buffer - turtle_parser->processed;
-    if(turtle_parser->consumed && turtle_parser->processed) {
-      memmove(turtle_parser->buffer,
-              turtle_parser->buffer + turtle_parser->processed,
-              turtle_parser->consumed);
-      /* cancel all deferred eval's */
-      if(turtle_parser->deferred) {
-        raptor_free_sequence(turtle_parser->deferred);
-        turtle_parser->deferred = NULL;
-      }
-    }
-  } else if(rdf_parser->emitted_default_graph) {
+  } else if(is_end && rdf_parser->emitted_default_graph) {
     /* for non-TRIG - end default graph after last triple */
     raptor_parser_end_graph(rdf_parser, NULL, 0);
     rdf_parser->emitted_default_graph--;
   }
+
+  if(is_end)
+    raptor_turtle_parallel_finish(rdf_parser);
+
   return rc;
 }
 
@@ -1733,23 +2868,74 @@ raptor_turtle_parse_start(raptor_parser *rdf_parser)
 {
   raptor_locator *locator=&rdf_parser->locator;
   raptor_turtle_parser *turtle_parser = (raptor_turtle_parser*)rdf_parser->context;
+  int threads;
 
   /* base URI required for Turtle */
   if(!rdf_parser->base_uri)
     return 1;
 
+  /* drop any earlier parse that did not reach the end */
+  raptor_turtle_parallel_finish(rdf_parser);
+
   locator->line = 1;
   locator->column= -1; /* No column info */
   locator->byte= -1; /* No bytes info */
 
-  if(turtle_parser->buffer_length) {
-    RAPTOR_FREE(cdata, turtle_parser->buffer);
-    turtle_parser->buffer = NULL;
-    turtle_parser->buffer_length = 0;
+  /* keep any buffer from a previous parse */
+  turtle_parser->buffer_start = 0;
+  turtle_parser->buffer_end = 0;
+
+  turtle_parser->long_literal_delim = 0;
+  if(turtle_parser->sb) {
+    raptor_free_stringbuffer(turtle_parser->sb);
+    turtle_parser->sb = NULL;
   }
+
+  /* a new lexer and parser state since a previous parse may not have
+   * finished */
+  if(turtle_parser->scanner_set) {
+    turtle_lexer_lex_destroy(turtle_parser->scanner);
+    turtle_parser->scanner_set = 0;
+  }
+  if(turtle_lexer_lex_init(&turtle_parser->scanner))
+    return 1;
+  turtle_parser->scanner_set = 1;
+  turtle_lexer_set_extra(rdf_parser, turtle_parser->scanner);
+
+#if defined(YYDEBUG) && YYDEBUG > 0
+  turtle_lexer_set_debug(1, turtle_parser->scanner);
+  turtle_parser_debug = 1;
+#endif
+
+  if(turtle_parser->pstate)
+    turtle_parser_pstate_delete(turtle_parser->pstate);
+  turtle_parser->pstate = turtle_parser_pstate_new();
+  if(!turtle_parser->pstate)
+    return 1;
   
   turtle_parser->lineno = 1;
 
+  turtle_parser->scan_offset = 0;
+  turtle_parser->scan_state = TURTLE_SCAN_TOP;
+  turtle_parser->scan_quotes_count = 0;
+  turtle_parser->scan_escape = 0;
+  turtle_parser->scan_cr = 0;
+  turtle_parser->scan_depth = 0;
+  turtle_parser->scan_lineno = 1;
+  turtle_parser->scan_started = 0;
+  turtle_parser->scan_directive = 0;
+  turtle_parser->statements_end = 0;
+  turtle_parser->statements_end_lineno = 1;
+
+  threads = RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_PARALLEL_THREADS);
+  /* a user blank node ID handler might not expect other threads */
+  if(threads > 1 && !rdf_parser->world->generate_bnodeid_handler) {
+    /* falls back to parsing in this thread if there are no threads */
+    turtle_parser->pool = raptor_new_thread_pool(rdf_parser->world, threads);
+    turtle_parser->segments_max = threads << 1;
+    turtle_parser->unordered = RAPTOR_OPTIONS_GET_NUMERIC(rdf_parser, RAPTOR_OPTION_PARALLEL_UNORDERED);
+  }
+
   return 0;
 }
 
@@ -2048,11 +3234,9 @@ main(int argc, char *argv[])
   
   turtle_parser.error_count = 0;
 
-#ifdef TURTLE_PUSH_PARSE
-  turtle_push_parse(&rdf_parser, string, strlen(string));
-#else
-  turtle_parse(&rdf_parser, string, strlen(string));
-#endif
+  if(!raptor_turtle_parse_start(&rdf_parser))
+    raptor_turtle_parse_chunk(&rdf_parser, (const unsigned char*)string,
+                              strlen(string), 1);
 
   raptor_turtle_parse_terminate(&rdf_parser);
   
@@ -184,7 +184,7 @@ relay_namespaces(void* user_data, raptor_namespace *nspace)
 #endif
 
 
-#define GETOPT_STRING "cef:ghi:I:o:O:qrtvw"
+#define GETOPT_STRING "cef:ghi:I:j:o:O:qrtvw"
 
 #ifdef HAVE_GETOPT_LONG
 #define SHOW_NAMESPACES_FLAG 0x100
@@ -200,6 +200,7 @@ static const struct option long_options[] =
   {"help", 0, 0, 'h'},
   {"input", 1, 0, 'i'},
   {"input-uri", 1, 0, 'I'},
+  {"threads", 1, 0, 'j'},
   {"output", 1, 0, 'o'},
   {"output-uri", 1, 0, 'O'},
   {"quiet", 0, 0, 'q'},
@@ -322,6 +323,7 @@ main(int argc, char *argv[])
   const char *syntax_name="rdfxml";
   raptor_sequence* parser_options = NULL;
   int trace = 0;
+  int threads = 0;
 
   /* output variables - serializer */
   /* 'serializer' object variable is a global */
@@ -597,6 +599,18 @@ main(int argc, char *argv[])
         if(optarg)
           base_uri_string = (unsigned char*)optarg;
         break;
+
+      case 'j':
+        if(optarg) {
+          threads = atoi(optarg);
+          if(threads < 1) {
+            fprintf(stderr,
+                    "%s: invalid argument `%s' for `" HELP_ARG(j, threads) "'\n",
+                    program, optarg);
+            usage = 1;
+          }
+        }
+        break;
         
       case 'w':
         ignore_warnings = 1;
@@ -708,6 +722,7 @@ main(int argc, char *argv[])
     puts(HELP_TEXT("f OPTION(=VALUE)", "feature OPTION(=VALUE)", HELP_PAD "Set parser or serializer options" HELP_PAD "Use `-f help' for a list of valid options"));
     puts(HELP_TEXT("g", "guess           ", "Guess the input syntax (same as -i guess)"));
     puts(HELP_TEXT("h", "help            ", "Print this help, then exit"));
+    puts(HELP_TEXT("j NUMBER", "threads NUMBER ", "Parse with NUMBER threads if the parser supports it"));
     puts(HELP_TEXT("q", "quiet           ", "No extra information messages"));
     puts(HELP_TEXT("r", "replace-newlines", "Replace newlines with spaces in literals"));
 #ifdef SHOW_GRAPHS_FLAG
@@ -808,6 +823,10 @@ main(int argc, char *argv[])
 
   raptor_world_set_log_handler(world, rdf_parser, rapper_log_handler);
   
+  if(threads > 1)
+    raptor_parser_set_option(rdf_parser, RAPTOR_OPTION_PARALLEL_THREADS,
+                             NULL, threads);
+
   if(parser_options) {
     option_value *fv;
     while((fv = (option_value*)raptor_sequence_pop(parser_options))) {
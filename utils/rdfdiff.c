@@ -52,6 +52,9 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 #if 0
 #undef RAPTOR_DEBUG
@@ -61,6 +64,7 @@
 #ifndef RAPTOR_INTERNAL
 #define RAPTOR_MALLOC(type, size)		(type)malloc(size)
 #define RAPTOR_CALLOC(type, nmemb, size)	(type)calloc(nmemb, size)
+#define RAPTOR_REALLOC(type, ptr, size)		(type)realloc(ptr, size)
 #define RAPTOR_FREE(type, ptr)			free((void*)ptr)
 #endif
 
@@ -73,7 +77,7 @@ extern char *optarg;
 #define RDF_NAMESPACE_URI_LEN 43
 #define ORDINAL_STRING_LEN (RDF_NAMESPACE_URI_LEN + MAX_ASCII_INT_SIZE + 1)
 
-#define GETOPT_STRING "bhf:t:u:"
+#define GETOPT_STRING "bhf:j:t:u:"
 
 #ifdef HAVE_GETOPT_LONG
 static const struct option long_options[] =
@@ -82,6 +86,7 @@ static const struct option long_options[] =
   {"brief"       , 0, 0, 'b'},
   {"help"        , 0, 0, 'h'},
   {"from-format" , 1, 0, 'f'},
+  {"threads"     , 1, 0, 'j'},
   {"to-format"   , 1, 0, 't'},
   {"base-uri"    , 1, 0, 'u'},
   {NULL          , 0, 0, 0}
@@ -98,18 +103,61 @@ static const struct option long_options[] =
 #define HELP_PAD "\n      "
 #endif
 
-typedef struct rdfdiff_link_s {
-  struct rdfdiff_link_s *next;
+/* shards of ground statements per thread so the work is spread evenly */
+#define RDFDIFF_SHARDS_PER_THREAD 4
+
+/* FNV-1a 64 bit prime used to combine hashes */
+#define RDFDIFF_HASH_PRIME 0x100000001b3ULL
+
+/* stands in for any blank node in a first pass blank node signature */
+#define RDFDIFF_BLANK_HASH 0x9e3779b97f4a7c15ULL
+
+/* most rounds of blank node signature refinement */
+#define RDFDIFF_SIGNATURE_ROUNDS 32
+
+/* most blank node pairings tried when searching for an isomorphism */
+#define RDFDIFF_MATCH_STEPS 1000000
+
+/* rdfdiff_statement state */
+#define RDFDIFF_STATE_UNMATCHED 0
+#define RDFDIFF_STATE_MATCHED   1
+#define RDFDIFF_STATE_DUPLICATE 2
+
+/* a statement with no blank nodes */
+typedef struct {
   raptor_statement *statement;
-} rdfdiff_link;
+  /* hash of the subject, predicate and object */
+  uint64_t hash;
+  int state;
+} rdfdiff_statement;
 
-typedef struct rdfdiff_blank_s {
-  struct rdfdiff_blank_s *next;
-  raptor_world *world;
-  char *blank_id;
-  raptor_statement *owner;
-  rdfdiff_link *first;
-  rdfdiff_link *last;
+/* indexes of the statements with subjects hashing to one shard */
+typedef struct {
+  size_t *indexes;
+  size_t count;
+  size_t size;
+} rdfdiff_shard;
+
+/* a list of statements */
+typedef struct {
+  raptor_statement **statements;
+  /* blanks index of the other node of each statement or -1 if it is
+   * not a blank node; see rdfdiff_resolve_blanks() */
+  int *blanks;
+  /* hash of the predicate and any ground other node of each statement */
+  uint64_t *hashes;
+  int count;
+  int size;
+} rdfdiff_statements;
+
+typedef struct {
+  raptor_term *term;
+  /* statements with this blank node as object */
+  rdfdiff_statements owners;
+  /* statements with this blank node as subject */
+  rdfdiff_statements statements;
+  /* hash of the neighbourhood; see rdfdiff_blank_signature() */
+  uint64_t signature;
   int matched;
 } rdfdiff_blank;
 
@@ -117,16 +165,49 @@ typedef struct {
   raptor_world *world;
   char *name;
   raptor_parser *parser;
-  rdfdiff_link *first;
-  rdfdiff_link *last;
-  rdfdiff_blank *first_blank;
-  rdfdiff_blank *last_blank;
+  /* statements with no blank nodes in the order parsed */
+  rdfdiff_statement *statements;
+  size_t statements_count;
+  size_t statements_size;
+  rdfdiff_shard *shards;
+  /* blank nodes in the order first seen */
+  rdfdiff_blank *blanks;
+  int blanks_count;
+  int blanks_size;
+  /* open addressing table of (blanks index + 1) by blank node ID */
+  int *blanks_table;
+  int blanks_table_size;
+  /* rounds of refinement the blank node signatures have had */
+  int signature_rounds;
+  /* open addressing table of the statements with blank nodes seen */
+  raptor_statement **blank_statements;
+  size_t blank_statements_count;
+  size_t blank_statements_size;
   int statement_count;
   int error_count;
   int warning_count;
   int difference_count;
+  int failed;
 } rdfdiff_file;
 
+typedef struct {
+  int shard;
+  /* file to sign the blank nodes of or NULL to compare a shard */
+  rdfdiff_file *file;
+  int failed;
+} rdfdiff_task;
+
+/* tasks shared by the worker threads */
+typedef struct {
+  rdfdiff_task *tasks;
+  int count;
+  /* index of the next task to run */
+  int next;
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_t mutex;
+#endif
+} rdfdiff_tasks;
+
 static int brief = 0;
 static char *program = NULL;
 static const char * const title_string="Raptor RDF diff utility";
@@ -134,6 +215,7 @@ static int ignore_errors = 0;
 static int ignore_warnings = 0;
 static int emit_from_header = 1;
 static int emit_to_header = 1;
+static int shards_count = 1;
 
 static rdfdiff_file* from_file = NULL;
 static rdfdiff_file*to_file = NULL;
@@ -141,13 +223,6 @@ static rdfdiff_file*to_file = NULL;
 static rdfdiff_file* rdfdiff_new_file(raptor_world* world, const unsigned char *name, const char *syntax);
 static void rdfdiff_free_file(rdfdiff_file* file);
 
-static rdfdiff_blank *rdfdiff_find_blank(rdfdiff_blank *first, char *blank_id);
-static rdfdiff_blank *rdfdiff_new_blank(raptor_world *world, char *blank_id);
-static void rdfdiff_free_blank(rdfdiff_blank *blank);
-
-static int  rdfdiff_blank_equals(const rdfdiff_blank *b1, const rdfdiff_blank *b2,
-                                 rdfdiff_file*b1_file, rdfdiff_file*b2_file);
-
 static void rdfdiff_log_handler(void *data, raptor_log_message *message);
 
 static void rdfdiff_collect_statements(void *user_data, raptor_statement *statement);
@@ -155,22 +230,19 @@ static void rdfdiff_collect_statements(void *user_data, raptor_statement *statem
 int main(int argc, char *argv[]);
 
 
-/* Version of strcmp that can take NULL parameters. Assume that
- * Non-NULL strings are lexically greater than NULL strings 
- */
-static int
-safe_strcmp(const char *s1, const char *s2)
+static void
+rdfdiff_free_statements(rdfdiff_statements *list)
 {
-  if(s1 == NULL && s2 == NULL) {
-    return 0;
-  } else if(s1 == NULL && s2 != NULL) {
-    return -1;
-  } else if(s1 != NULL && s2 == NULL) {
-    return 1;
-  } else {
-    return strcmp(s1, s2);
-  }
-  
+  int i;
+
+  for(i = 0; i < list->count; i++)
+    raptor_free_statement(list->statements[i]);
+  if(list->statements)
+    RAPTOR_FREE(raptor_statement**, list->statements);
+  if(list->blanks)
+    RAPTOR_FREE(int*, list->blanks);
+  if(list->hashes)
+    RAPTOR_FREE(uint64_t*, list->hashes);
 }
 
 
@@ -187,6 +259,14 @@ rdfdiff_new_file(raptor_world *world, const unsigned char *name, const char *syn
       return(0);
     }
     memcpy(file->name, name, name_len + 1);
+
+    file->shards = RAPTOR_CALLOC(rdfdiff_shard*,
+                                 (size_t)shards_count,
+                                 sizeof(rdfdiff_shard));
+    if(!file->shards) {
+      rdfdiff_free_file(file);
+      return(0);
+    }
     
     file->parser = raptor_new_parser(world, syntax);
     if(file->parser) {
@@ -198,7 +278,6 @@ rdfdiff_new_file(raptor_world *world, const unsigned char *name, const char *syn
       return(0);
     }
 
-
   }
   
   return file;  
@@ -208,26 +287,45 @@ rdfdiff_new_file(raptor_world *world, const unsigned char *name, const char *syn
 static void
 rdfdiff_free_file(rdfdiff_file* file) 
 {
-  rdfdiff_link *cur, *next;
-  rdfdiff_blank *cur1, *next1;
+  size_t i;
+  int j;
   
   if(file->name)
     RAPTOR_FREE(char*, file->name);
 
   if(file->parser)
     raptor_free_parser(file->parser);
-  
-  for(cur = file->first; cur; cur = next) {
-    next = cur->next;
 
-    raptor_free_statement(cur->statement);
-    RAPTOR_FREE(rdfdiff_link, cur);
+  for(i = 0; i < file->statements_count; i++)
+    raptor_free_statement(file->statements[i].statement);
+  if(file->statements)
+    RAPTOR_FREE(rdfdiff_statement*, file->statements);
+
+  if(file->shards) {
+    for(j = 0; j < shards_count; j++) {
+      if(file->shards[j].indexes)
+        RAPTOR_FREE(size_t*, file->shards[j].indexes);
+    }
+    RAPTOR_FREE(rdfdiff_shard*, file->shards);
   }
 
-  for(cur1 = file->first_blank; cur1; cur1 = next1) {
-    next1 = cur1->next;
+  for(j = 0; j < file->blanks_count; j++) {
+    rdfdiff_blank *blank = &file->blanks[j];
 
-    rdfdiff_free_blank(cur1);
+    raptor_free_term(blank->term);
+    rdfdiff_free_statements(&blank->owners);
+    rdfdiff_free_statements(&blank->statements);
+  }
+  if(file->blanks)
+    RAPTOR_FREE(rdfdiff_blank*, file->blanks);
+  if(file->blanks_table)
+    RAPTOR_FREE(int*, file->blanks_table);
+  if(file->blank_statements) {
+    for(i = 0; i < file->blank_statements_size; i++) {
+      if(file->blank_statements[i])
+        raptor_free_statement(file->blank_statements[i]);
+    }
+    RAPTOR_FREE(raptor_statement**, file->blank_statements);
   }
   
   RAPTOR_FREE(rdfdiff_file, file);  
@@ -235,482 +333,1260 @@ rdfdiff_free_file(rdfdiff_file* file)
 }
 
 
+static uint64_t
+rdfdiff_hash_combine(uint64_t hash, uint64_t value)
+{
+  return (hash ^ value) * RDFDIFF_HASH_PRIME;
+}
+
+
+/* spread the bits of a hash before adding it into an unordered sum */
+static uint64_t
+rdfdiff_hash_mix(uint64_t hash)
+{
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+
+  return hash;
+}
+
+
+static uint64_t
+rdfdiff_statement_hash(raptor_statement *statement)
+{
+  uint64_t hash = RDFDIFF_HASH_PRIME;
+
+  hash = rdfdiff_hash_combine(hash, raptor_term_hash(statement->subject));
+  hash = rdfdiff_hash_combine(hash, raptor_term_hash(statement->predicate));
+  hash = rdfdiff_hash_combine(hash, raptor_term_hash(statement->object));
+
+  return hash;
+}
+
+
+/* compare subject, predicate and object of statements */
+static int
+rdfdiff_statement_equals(const raptor_statement *s1, const raptor_statement *s2)
+{
+  return raptor_term_equals(s1->subject, s2->subject) &&
+         raptor_term_equals(s1->predicate, s2->predicate) &&
+         raptor_term_equals(s1->object, s2->object);
+}
+
+
+static void
+rdfdiff_log_handler(void *data, raptor_log_message *message)
+{
+  rdfdiff_file* file = (rdfdiff_file*)data;
+  
+   switch(message->level) {
+    case RAPTOR_LOG_LEVEL_FATAL:
+    case RAPTOR_LOG_LEVEL_ERROR:
+      if(!ignore_errors) {
+        fprintf(stderr, "%s: Error - ", program);
+        raptor_locator_print(message->locator, stderr);
+        fprintf(stderr, " - %s\n", message->text);
+        
+        raptor_parser_parse_abort(file->parser);
+      }
+      
+      file->error_count++;
+      break;
+      
+    case RAPTOR_LOG_LEVEL_WARN:
+      if(!ignore_warnings) {
+        fprintf(stderr, "%s: Warning - ", program);
+        raptor_locator_print(message->locator, stderr);
+        fprintf(stderr, " - %s\n", message->text);
+      }
+      
+      file->warning_count++;
+      break;
+      
+    case RAPTOR_LOG_LEVEL_NONE:
+    case RAPTOR_LOG_LEVEL_TRACE:
+    case RAPTOR_LOG_LEVEL_DEBUG:
+    case RAPTOR_LOG_LEVEL_INFO:
+
+      fprintf(stderr, "%s: Unexpected %s message - ", program,
+              raptor_log_level_get_label(message->level));
+      raptor_locator_print(message->locator, stderr);
+      fprintf(stderr, " - %s\n", message->text);
+      break;
+  }
+  
+}
+
+
+static int
+rdfdiff_grow_blanks_table(rdfdiff_file* file)
+{
+  int new_size = file->blanks_table_size ? file->blanks_table_size << 1 : 1024;
+  int *table;
+  int i;
+
+  table = RAPTOR_CALLOC(int*, (size_t)new_size, sizeof(int));
+  if(!table)
+    return 1;
+
+  for(i = 0; i < file->blanks_count; i++) {
+    int j = (int)(raptor_term_hash(file->blanks[i].term) &
+                  (uint64_t)(new_size - 1));
+
+    while(table[j])
+      j = (j + 1) & (new_size - 1);
+    table[j] = i + 1;
+  }
+
+  if(file->blanks_table)
+    RAPTOR_FREE(int*, file->blanks_table);
+  file->blanks_table = table;
+  file->blanks_table_size = new_size;
+
+  return 0;
+}
+
+
+/* get the blanks index of the blank node for @term or -1 */
+static int
+rdfdiff_find_blank(rdfdiff_file* file, raptor_term *term)
+{
+  int i;
+
+  if(!file->blanks_table_size)
+    return -1;
+
+  i = (int)(raptor_term_hash(term) &
+            (uint64_t)(file->blanks_table_size - 1));
+  while(file->blanks_table[i]) {
+    int index = file->blanks_table[i] - 1;
+
+    if(raptor_term_equals(file->blanks[index].term, term))
+      return index;
+    i = (i + 1) & (file->blanks_table_size - 1);
+  }
+
+  return -1;
+}
+
+
+/* find the blank node for @term, adding it if it is new */
 static rdfdiff_blank *
-rdfdiff_new_blank(raptor_world* world, char *blank_id) 
+rdfdiff_lookup_blank(rdfdiff_file* file, raptor_term *term)
 {
-  rdfdiff_blank *blank = RAPTOR_CALLOC(rdfdiff_blank*, 1, sizeof(*blank));
-
-  if(blank) {
-    size_t blank_id_len = strlen(blank_id);
-    blank->world = world;
-    blank->blank_id = RAPTOR_MALLOC(char*, blank_id_len + 1);
-    if(!blank->blank_id) {
-      rdfdiff_free_blank(blank);
+  rdfdiff_blank *blank;
+  int i;
+
+  i = rdfdiff_find_blank(file, term);
+  if(i >= 0)
+    return &file->blanks[i];
+
+  /* keep the table at most half full */
+  if((file->blanks_count + 1) * 2 > file->blanks_table_size &&
+     rdfdiff_grow_blanks_table(file))
+    return NULL;
+
+  if(file->blanks_count == file->blanks_size) {
+    int new_size = file->blanks_size ? file->blanks_size << 1 : 64;
+    rdfdiff_blank *blanks;
+
+    blanks = RAPTOR_REALLOC(rdfdiff_blank*, file->blanks,
+                            (size_t)new_size * sizeof(*blanks));
+    if(!blanks)
       return NULL;
+    file->blanks = blanks;
+    file->blanks_size = new_size;
+  }
+
+  blank = &file->blanks[file->blanks_count];
+  memset(blank, 0, sizeof(*blank));
+  blank->term = raptor_term_copy(term);
+  if(!blank->term)
+    return NULL;
+
+  i = (int)(raptor_term_hash(term) &
+            (uint64_t)(file->blanks_table_size - 1));
+  while(file->blanks_table[i])
+    i = (i + 1) & (file->blanks_table_size - 1);
+  file->blanks_table[i] = ++file->blanks_count;
+
+  return blank;
+}
+
+
+/* check if @file has a statement with blank nodes equal to @statement */
+static int
+rdfdiff_blank_statement_find(rdfdiff_file* file, raptor_statement *statement)
+{
+  size_t mask;
+  size_t i;
+
+  if(!file->blank_statements_size)
+    return 0;
+
+  mask = file->blank_statements_size - 1;
+  i = (size_t)rdfdiff_statement_hash(statement) & mask;
+  while(file->blank_statements[i]) {
+    if(rdfdiff_statement_equals(file->blank_statements[i], statement))
+      return 1;
+    i = (i + 1) & mask;
+  }
+
+  return 0;
+}
+
+
+/*
+ * rdfdiff_blank_statement_seen:
+ *
+ * Check if a statement with blank nodes was seen before, adding it
+ * if not.  Duplicates are dropped as they would change the signatures
+ * of the blank nodes.
+ *
+ * Return value: 1 if seen, 0 if not or <0 on failure
+ */
+static int
+rdfdiff_blank_statement_seen(rdfdiff_file* file, raptor_statement *statement)
+{
+  size_t mask;
+  size_t i;
+
+  /* keep the table at most half full */
+  if((file->blank_statements_count + 1) * 2 > file->blank_statements_size) {
+    size_t new_size = file->blank_statements_size ? file->blank_statements_size << 1 : 1024;
+    raptor_statement **table;
+
+    table = RAPTOR_CALLOC(raptor_statement**, new_size, sizeof(*table));
+    if(!table)
+      return -1;
+
+    for(i = 0; i < file->blank_statements_size; i++) {
+      raptor_statement *s = file->blank_statements[i];
+      size_t j;
+
+      if(!s)
+        continue;
+      j = (size_t)rdfdiff_statement_hash(s) & (new_size - 1);
+      while(table[j])
+        j = (j + 1) & (new_size - 1);
+      table[j] = s;
     }
 
-    memcpy(blank->blank_id, blank_id, blank_id_len + 1);
+    if(file->blank_statements)
+      RAPTOR_FREE(raptor_statement**, file->blank_statements);
+    file->blank_statements = table;
+    file->blank_statements_size = new_size;
   }
-  
-  return blank;
+
+  mask = file->blank_statements_size - 1;
+  i = (size_t)rdfdiff_statement_hash(statement) & mask;
+  while(file->blank_statements[i]) {
+    if(rdfdiff_statement_equals(file->blank_statements[i], statement))
+      return 1;
+    i = (i + 1) & mask;
+  }
+
+  file->blank_statements[i] = raptor_statement_copy(statement);
+  if(!file->blank_statements[i])
+    return -1;
+  file->blank_statements_count++;
+
+  return 0;
 }
 
 
-static void
-rdfdiff_free_blank(rdfdiff_blank *blank) 
+static int
+rdfdiff_statements_add(rdfdiff_statements *list, raptor_statement *statement)
 {
-  rdfdiff_link *cur, *next;
+  if(list->count == list->size) {
+    int new_size = list->size ? list->size << 1 : 4;
+    raptor_statement **statements;
+
+    statements = RAPTOR_REALLOC(raptor_statement**, list->statements,
+                                (size_t)new_size * sizeof(*statements));
+    if(!statements)
+      return 1;
+    list->statements = statements;
+    list->size = new_size;
+  }
 
-  if(blank->blank_id)
-    RAPTOR_FREE(char*, blank->blank_id);
+  list->statements[list->count] = raptor_statement_copy(statement);
+  if(!list->statements[list->count])
+    return 1;
+  list->count++;
 
-  if(blank->owner)
-    raptor_free_statement(blank->owner);
-  
-  for(cur = blank->first; cur; cur = next) {
-    next = cur->next;
+  return 0;
+}
 
-    raptor_free_statement(cur->statement);
-    RAPTOR_FREE(rdfdiff_link, cur);
+
+static int
+rdfdiff_add_blank_statement(rdfdiff_file* file,
+                            raptor_statement *statement)
+{
+  rdfdiff_blank *blank;
+
+  blank = rdfdiff_lookup_blank(file, statement->subject);
+  if(!blank || rdfdiff_statements_add(&blank->statements, statement)) {
+    fprintf(stderr, "%s: Internal Error\n", program);
+    return 1;
   }
 
-  RAPTOR_FREE(rdfdiff_blank, blank);
-  
+  return 0;
 }
 
 
 static int
-rdfdiff_statement_equals(raptor_world *world, const raptor_statement *s1, const raptor_statement *s2)
+rdfdiff_add_blank_statement_owner(rdfdiff_file* file,
+                                  raptor_statement *statement)
 {
-  int rv = 0;
-  
-  if(!s1 || !s2)
-    return 0;
+  rdfdiff_blank *blank;
 
-#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-  fprintf(stderr, "(rdfdiff_statement_equals) Comparing ");
-  raptor_statement_print_as_ntriples(s1, stderr);
-  fprintf(stderr, " to ");
-  raptor_statement_print_as_ntriples(s2, stderr);
-#endif
+  blank = rdfdiff_lookup_blank(file, statement->object);
+  if(!blank || rdfdiff_statements_add(&blank->owners, statement)) {
+    fprintf(stderr, "%s: Internal Error\n", program);
+    return 1;
+  }
+
+  return 0;
+}
+
+
+static int
+rdfdiff_add_statement(rdfdiff_file* file, raptor_statement *statement) 
+{
+  rdfdiff_statement *st;
+  rdfdiff_shard *shard;
+
+  if(file->statements_count == file->statements_size) {
+    size_t new_size = file->statements_size ? file->statements_size << 1 : 1024;
+    rdfdiff_statement *statements;
+
+    statements = RAPTOR_REALLOC(rdfdiff_statement*, file->statements,
+                                new_size * sizeof(*statements));
+    if(!statements)
+      goto failed;
+    file->statements = statements;
+    file->statements_size = new_size;
+  }
 
-  /* normal comparison */
-  if(s1->subject->type != s2->subject->type) {
-    rv = 0;
-    goto done;
+  shard = &file->shards[raptor_term_hash(statement->subject) %
+                        (uint64_t)shards_count];
+  if(shard->count == shard->size) {
+    size_t new_size = shard->size ? shard->size << 1 : 256;
+    size_t *indexes;
+
+    indexes = RAPTOR_REALLOC(size_t*, shard->indexes,
+                             new_size * sizeof(*indexes));
+    if(!indexes)
+      goto failed;
+    shard->indexes = indexes;
+    shard->size = new_size;
   }
 
-  if(s1->subject->type == RAPTOR_TERM_TYPE_BLANK) {
-    /* Here for completeness. Anonymous nodes are taken care of
-     * elsewhere */
-    /*if(strcmp((const char *)s1->subject, (const char *)s2->subject->value) != 0)
-      return 0;*/
+  st = &file->statements[file->statements_count];
+  st->statement = raptor_statement_copy(statement);
+  if(!st->statement)
+    goto failed;
+
+  st->hash = rdfdiff_statement_hash(st->statement);
+  st->state = RDFDIFF_STATE_UNMATCHED;
+
+  shard->indexes[shard->count++] = file->statements_count++;
+
+  return 0;
+
+failed:
+  fprintf(stderr, "%s: Internal Error\n", program);
+  return 1;
+}
+
+
+/*
+ * rdfdiff_collect_statements - Called when parsing "from" file to build a
+ * list of statements for comparison with those in the "to" file.
+ */
+static void
+rdfdiff_collect_statements(void *user_data, raptor_statement *statement)
+{
+  int rv = 0;
+  rdfdiff_file* file = (rdfdiff_file*)user_data;
+
+  file->statement_count++;
+
+  if(statement->subject->type == RAPTOR_TERM_TYPE_BLANK ||
+     statement->object->type  == RAPTOR_TERM_TYPE_BLANK) {
+
+    rv = rdfdiff_blank_statement_seen(file, statement);
+    if(rv > 0)
+      return;
+
+    if(rv == 0 && statement->subject->type == RAPTOR_TERM_TYPE_BLANK)
+      rv = rdfdiff_add_blank_statement(file, statement);
+
+    if(rv == 0 && statement->object->type == RAPTOR_TERM_TYPE_BLANK)
+      rv = rdfdiff_add_blank_statement_owner(file, statement);
+
   } else {
-    if(!raptor_uri_equals(s1->subject->value.uri,
-                          s2->subject->value.uri)) {
-      rv = 0;
-      goto done;
-    }
+    rv = rdfdiff_add_statement(file, statement);
   }
 
-  if(s1->predicate->type != s2->predicate->type) {
-    rv = 0;
-    goto done;
+  if(rv != 0) {
+    file->failed = 1;
+    raptor_parser_parse_abort(file->parser);
   }
   
-  if(!raptor_uri_equals(s1->predicate->value.uri,
-                        s2->predicate->value.uri)) {
-    rv = 0;
-    goto done;
+}
+
+
+/*
+ * rdfdiff_shard_table:
+ *
+ * Build an open addressing table of the statements in one shard of
+ * @file.  Statements equal to one already in the table are marked as
+ * duplicates.  The table holds statement indexes + 1.
+ */
+static size_t*
+rdfdiff_shard_table(rdfdiff_file* file, int shard_index, size_t *table_size_p)
+{
+  rdfdiff_shard *shard = &file->shards[shard_index];
+  size_t table_size = 16;
+  size_t *table;
+  size_t i;
+
+  while(table_size < shard->count * 2)
+    table_size <<= 1;
+
+  table = RAPTOR_CALLOC(size_t*, table_size, sizeof(size_t));
+  if(!table)
+    return NULL;
+
+  for(i = 0; i < shard->count; i++) {
+    rdfdiff_statement *st = &file->statements[shard->indexes[i]];
+    size_t j = (size_t)st->hash & (table_size - 1);
+
+    while(table[j]) {
+      rdfdiff_statement *other = &file->statements[table[j] - 1];
+
+      if(other->hash == st->hash &&
+         rdfdiff_statement_equals(other->statement, st->statement)) {
+        st->state = RDFDIFF_STATE_DUPLICATE;
+        break;
+      }
+      j = (j + 1) & (table_size - 1);
+    }
+
+    if(!table[j])
+      table[j] = shard->indexes[i] + 1;
   }
-  
-  if(s1->object->type != s2->object->type) {
-    rv = 0;
-    goto done;
+
+  *table_size_p = table_size;
+  return table;
+}
+
+
+/* match the statements in one shard of the "to" and "from" files */
+static int
+rdfdiff_compare_shard(int shard_index)
+{
+  rdfdiff_shard *shard = &to_file->shards[shard_index];
+  size_t *from_table;
+  size_t *to_table;
+  size_t table_size;
+  size_t to_table_size;
+  size_t i;
+
+  from_table = rdfdiff_shard_table(from_file, shard_index, &table_size);
+  if(!from_table)
+    return 1;
+
+  /* only used to mark duplicates in the "to" file */
+  to_table = rdfdiff_shard_table(to_file, shard_index, &to_table_size);
+  if(!to_table) {
+    RAPTOR_FREE(size_t*, from_table);
+    return 1;
   }
-  
-  if(s1->object->type == RAPTOR_TERM_TYPE_LITERAL) {
-    int equal;
-    
-    equal= !safe_strcmp((char *)s1->object->value.literal.string,
-                        (char *)s2->object->value.literal.string);
-
-    if(equal) {
-      if(s1->object->value.literal.language && s2->object->value.literal.language)
-        equal = !strcmp((char *)s1->object->value.literal.language,
-                        (char *)s2->object->value.literal.language);
-      else if(s1->object->value.literal.language || s2->object->value.literal.language)
-        equal = 0;
-      else
-        equal = 1;
+  RAPTOR_FREE(size_t*, to_table);
+
+  for(i = 0; i < shard->count; i++) {
+    rdfdiff_statement *st = &to_file->statements[shard->indexes[i]];
+    size_t j;
+
+    if(st->state == RDFDIFF_STATE_DUPLICATE)
+      continue;
 
-      if(equal)
-        equal = raptor_uri_equals(s1->object->value.literal.datatype, 
-                                  s2->object->value.literal.datatype);
+    j = (size_t)st->hash & (table_size - 1);
+    while(from_table[j]) {
+      rdfdiff_statement *other = &from_file->statements[from_table[j] - 1];
+
+      if(other->hash == st->hash &&
+         rdfdiff_statement_equals(other->statement, st->statement)) {
+        other->state = RDFDIFF_STATE_MATCHED;
+        st->state = RDFDIFF_STATE_MATCHED;
+        break;
+      }
+      j = (j + 1) & (table_size - 1);
     }
+  }
 
-    rv = equal;
-    goto done;
-  } else if(s1->object->type == RAPTOR_TERM_TYPE_BLANK) {
-    /* Here for completeness. Anonymous nodes are taken care of
-     * elsewhere */
-    /* if(strcmp((const char *)s1->object, (const char *)s2->object->value) != 0)
-       return 0; */
-  } else {
-    if(!raptor_uri_equals(s1->object->value.uri,
-                          s2->object->value.uri)) {
-      rv = 0;
-      goto done;
+  RAPTOR_FREE(size_t*, from_table);
+
+  return 0;
+}
+
+
+/*
+ * rdfdiff_resolve_blanks:
+ *
+ * Record the blanks index of the other node of each statement with a
+ * blank node, and hash the parts of each statement that do not change
+ * between signature rounds.
+ */
+static int
+rdfdiff_resolve_blanks(rdfdiff_file* file)
+{
+  int i;
+
+  for(i = 0; i < file->blanks_count; i++) {
+    rdfdiff_blank *blank = &file->blanks[i];
+    int owners;
+
+    for(owners = 0; owners < 2; owners++) {
+      rdfdiff_statements *list = owners ? &blank->owners : &blank->statements;
+      int j;
+
+      if(!list->count)
+        continue;
+
+      list->blanks = RAPTOR_MALLOC(int*, (size_t)list->count * sizeof(int));
+      list->hashes = RAPTOR_MALLOC(uint64_t*,
+                                   (size_t)list->count * sizeof(uint64_t));
+      if(!list->blanks || !list->hashes)
+        return 1;
+
+      for(j = 0; j < list->count; j++) {
+        raptor_statement *statement = list->statements[j];
+        raptor_term *node = owners ? statement->subject : statement->object;
+        uint64_t hash;
+
+        hash = rdfdiff_hash_combine((uint64_t)owners,
+                                    raptor_term_hash(statement->predicate));
+        if(node->type == RAPTOR_TERM_TYPE_BLANK)
+          list->blanks[j] = rdfdiff_find_blank(file, node);
+        else {
+          list->blanks[j] = -1;
+          hash = rdfdiff_hash_combine(hash, raptor_term_hash(node));
+        }
+        list->hashes[j] = hash;
+      }
     }
   }
 
-  rv = 1;
-  done:
+  return 0;
+}
+
+
+/*
+ * rdfdiff_statements_signature:
+ *
+ * Get an unordered sum of hashes of the predicate and the other node
+ * (subject or object) of each statement with a blank node.  Other
+ * blank nodes are hashed by their signature in @signatures or, if
+ * that is NULL, match any blank node.
+ */
+static uint64_t
+rdfdiff_statements_signature(rdfdiff_statements *list,
+                             const uint64_t *signatures)
+{
+  uint64_t sum = 0;
+  int i;
+
+  for(i = 0; i < list->count; i++) {
+    uint64_t hash = list->hashes[i];
+
+    if(list->blanks[i] >= 0)
+      hash = rdfdiff_hash_combine(hash, signatures ?
+                                  signatures[list->blanks[i]] :
+                                  RDFDIFF_BLANK_HASH);
+    sum += rdfdiff_hash_mix(hash);
+  }
+
+  return sum;
+}
+
+
+/*
+ * rdfdiff_blank_signature:
+ *
+ * Get a hash of the neighbourhood of blank node @index: the
+ * statements it is the object of and the statements it is the
+ * subject of, in any order.
+ *
+ * With @signatures NULL this is the first pass signature, where all
+ * other blank nodes look the same.  Otherwise it refines the
+ * signatures of the previous round in @signatures, so after n rounds
+ * it covers the blank nodes up to n statements away.  Equal
+ * signatures only make blank nodes candidates for pairing; see
+ * rdfdiff_match_blanks().
+ */
+static uint64_t
+rdfdiff_blank_signature(rdfdiff_file* file, int index,
+                        const uint64_t *signatures)
+{
+  rdfdiff_blank *blank = &file->blanks[index];
+  uint64_t hash = signatures ? signatures[index] : RDFDIFF_HASH_PRIME;
+
+  hash = rdfdiff_hash_combine(hash, (uint64_t)blank->owners.count);
+  hash = rdfdiff_hash_combine(hash, rdfdiff_statements_signature(&blank->owners, signatures));
+  hash = rdfdiff_hash_combine(hash, (uint64_t)blank->statements.count);
+  hash = rdfdiff_hash_combine(hash, rdfdiff_statements_signature(&blank->statements, signatures));
+
+  return hash;
+}
+
+
+static int
+rdfdiff_compare_signatures(const void *a, const void *b)
+{
+  uint64_t s1 = *(const uint64_t*)a;
+  uint64_t s2 = *(const uint64_t*)b;
+
+  return (s1 > s2) - (s1 < s2);
+}
+
+
+/*
+ * rdfdiff_refine_blanks:
+ *
+ * Run one round of signature refinement over the blank nodes of
+ * @file using @signatures as scratch space.
+ *
+ * Return value: number of different signatures after the round
+ */
+static int
+rdfdiff_refine_blanks(rdfdiff_file* file, uint64_t *signatures)
+{
+  int classes = 0;
+  int i;
+
+  for(i = 0; i < file->blanks_count; i++)
+    signatures[i] = file->blanks[i].signature;
+
+  for(i = 0; i < file->blanks_count; i++)
+    file->blanks[i].signature = rdfdiff_blank_signature(file, i, signatures);
+  file->signature_rounds++;
+
+  for(i = 0; i < file->blanks_count; i++)
+    signatures[i] = file->blanks[i].signature;
+  qsort(signatures, (size_t)file->blanks_count, sizeof(uint64_t),
+        rdfdiff_compare_signatures);
+
+  for(i = 0; i < file->blanks_count; i++) {
+    if(!i || signatures[i] != signatures[i - 1])
+      classes++;
+  }
+
+  return classes;
+}
+
+
+/*
+ * rdfdiff_sign_blanks:
+ *
+ * Sign the blank nodes of @file, refining the signatures until they
+ * split the blank nodes no further or for RDFDIFF_SIGNATURE_ROUNDS.
+ */
+static int
+rdfdiff_sign_blanks(rdfdiff_file* file)
+{
+  uint64_t *signatures;
+  int classes = 0;
+  int i;
+
+  if(rdfdiff_resolve_blanks(file))
+    return 1;
+
+  if(!file->blanks_count)
+    return 0;
+
+  for(i = 0; i < file->blanks_count; i++)
+    file->blanks[i].signature = rdfdiff_blank_signature(file, i, NULL);
+
+  signatures = RAPTOR_MALLOC(uint64_t*,
+                             (size_t)file->blanks_count * sizeof(uint64_t));
+  if(!signatures)
+    return 1;
+
+  /* a round that adds no signatures leaves the blank nodes split the
+   * same way, and so would every later round */
+  while(file->signature_rounds < RDFDIFF_SIGNATURE_ROUNDS) {
+    int new_classes = rdfdiff_refine_blanks(file, signatures);
+
+    if(new_classes == classes || new_classes == file->blanks_count)
+      break;
+    classes = new_classes;
+  }
+
+  RAPTOR_FREE(uint64_t*, signatures);
+
+  return 0;
+}
+
 
-#if defined(RAPTOR_DEBUG) && RAPTOR_DEBUG > 1
-  fprintf(stderr, " : %s\n", (rv ? "equal" : "not equal"));
+static void
+rdfdiff_run_task(rdfdiff_task* task)
+{
+  if(task->file)
+    task->failed = rdfdiff_sign_blanks(task->file);
+  else
+    task->failed = rdfdiff_compare_shard(task->shard);
+}
+
+
+/* run tasks until there are none left */
+static void*
+rdfdiff_worker(void* arg)
+{
+  rdfdiff_tasks* tasks = (rdfdiff_tasks*)arg;
+
+  while(1) {
+    int i;
+
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_lock(&tasks->mutex);
 #endif
-  return rv;
+    i = tasks->next++;
+#ifdef HAVE_PTHREAD_H
+    pthread_mutex_unlock(&tasks->mutex);
+#endif
+
+    if(i >= tasks->count)
+      break;
+
+    rdfdiff_run_task(&tasks->tasks[i]);
+  }
+
+  return NULL;
+}
+
+
+/* state of rdfdiff_match_blanks(); arrays of "to" blanks indexes
+ * except where noted
+ */
+typedef struct {
+  /* "from" blanks indexes in signature order */
+  int *from_order;
+  /* range of from_order with the signature of each blank node */
+  int *first;
+  int *last;
+  /* blank nodes in the order they are paired */
+  int *order;
+  /* an earlier blank node in order that shares a statement or -1 */
+  int *parent;
+  /* next candidate to try by position in order */
+  int *next;
+  /* "from" blanks index paired with each blank node or -1 */
+  int *map;
+  /* if each "from" blank node is paired; by "from" blanks index */
+  char *used;
+} rdfdiff_matcher;
+
+
+/* order "from" blanks indexes by signature */
+static int
+rdfdiff_compare_from_blanks(const void *a, const void *b)
+{
+  uint64_t s1 = from_file->blanks[*(const int*)a].signature;
+  uint64_t s2 = from_file->blanks[*(const int*)b].signature;
+
+  if(s1 != s2)
+    return (s1 > s2) - (s1 < s2);
+  /* keep file order within a signature */
+  return *(const int*)a - *(const int*)b;
 }
 
 
+static rdfdiff_matcher* rdfdiff_matcher_sort;
+
+/* order "to" blanks indexes by fewest candidates */
 static int
-rdfdiff_blank_equals(const rdfdiff_blank *b1, const rdfdiff_blank *b2,
-                     rdfdiff_file *b1_file, rdfdiff_file *b2_file) 
+rdfdiff_compare_to_blanks(const void *a, const void *b)
 {
-  /* first compare "owners". Owners are subject/predicate or arcs
-   * in. */
-  int equal = 0;
-
-  if(b1->owner == NULL && b2->owner == NULL) {
-    /* Both are "top-level" anonymous objects. I.E. Neither is the
-     * object of a statement. Fall through and compare based on their
-     * contents. */
-    equal = 1;
-  } else if(b1->owner == NULL || b2->owner == NULL) {
-    equal = 0;
-  } else if(b1->owner->subject->type != RAPTOR_TERM_TYPE_BLANK &&
-            b2->owner->subject->type != RAPTOR_TERM_TYPE_BLANK) {
-    /* Neither are anonymous. Normal comparison. This will return
-     * false if both the subject and the predicates don't match. We
-     * know the objects are blank nodes. */
-    equal = rdfdiff_statement_equals(b1->world, b1->owner, b2->owner);
-    
-  } else if(b1->owner->subject->type == RAPTOR_TERM_TYPE_BLANK &&
-            b2->owner->subject->type == RAPTOR_TERM_TYPE_BLANK) {
-    rdfdiff_blank *p1;
-    rdfdiff_blank *p2;
+  rdfdiff_matcher* m = rdfdiff_matcher_sort;
+  int i1 = *(const int*)a;
+  int i2 = *(const int*)b;
+  int c1 = m->last[i1] - m->first[i1];
+  int c2 = m->last[i2] - m->first[i2];
+
+  if(c1 != c2)
+    return c1 - c2;
+  return i1 - i2;
+}
 
-    /* Both are anonymous.  Need further testing. Check that the
-     * containing anononymous nodes are eaual. */
-#if 0
-    fprintf(stderr, "b1->owner: ");    
-    raptor_statement_print_as_ntriples(b1->owner, stderr);
-    fprintf(stderr, "\n");
-
-    fprintf(stderr, "b2->owner: ");    
-    raptor_statement_print_as_ntriples(b2->owner, stderr);
-    fprintf(stderr, "\n");
-#endif    
-    p1 = rdfdiff_find_blank(b1_file->first_blank, 
-                            (char *)b1->owner->subject->value.blank.string);
-    p2 = rdfdiff_find_blank(b2_file->first_blank,
-                            (char *)b2->owner->subject->value.blank.string);
-    equal = rdfdiff_blank_equals(p1, p2, b1_file, b2_file);
-  } else {
-    equal = 0;
-  }
 
-  /* Now compare the contents. This accounts for the case where a
-   * subject has several properties (of the same predicate value) with
-   * different blank nodes as values. */
-  if(equal) {
-    rdfdiff_link *s1 = b1->first;
-    while(s1) {
+/*
+ * rdfdiff_matcher_order:
+ *
+ * Order the "to" blank nodes breadth first over the statements
+ * between them, starting from those with fewest candidates, so that
+ * most blank nodes are paired next to an already paired one.
+ */
+static void
+rdfdiff_matcher_order(rdfdiff_matcher* m)
+{
+  int count = to_file->blanks_count;
+  int head = 0;
+  int tail = 0;
+  int i;
+
+  for(i = 0; i < count; i++) {
+    m->next[i] = i;
+    m->parent[i] = -2;
+  }
+  rdfdiff_matcher_sort = m;
+  qsort(m->next, (size_t)count, sizeof(int), rdfdiff_compare_to_blanks);
 
-      rdfdiff_link *s2 = b2->first;
-      while(s2) {
+  for(i = 0; i < count; i++) {
+    if(m->parent[m->next[i]] != -2)
+      continue;
 
-        if(rdfdiff_statement_equals(b1->world, s1->statement, s2->statement))
-          break;
-          
-        s2 = s2->next;
+    m->parent[m->next[i]] = -1;
+    m->order[tail++] = m->next[i];
 
-      }
+    while(head < tail) {
+      rdfdiff_blank *blank = &to_file->blanks[m->order[head]];
+      int owners;
 
-      if(s2 == 0) {
-        equal = 0;
-        break;
-      }
+      for(owners = 0; owners < 2; owners++) {
+        rdfdiff_statements *list = owners ? &blank->owners : &blank->statements;
+        int j;
 
-      s1 = s1->next;
+        for(j = 0; j < list->count; j++) {
+          int node_index = list->blanks[j];
 
+          if(node_index >= 0 && m->parent[node_index] == -2) {
+            m->parent[node_index] = m->order[head];
+            m->order[tail++] = node_index;
+          }
+        }
+      }
+      head++;
     }
-    
   }
-  
-  return equal;
 }
 
 
-static void
-rdfdiff_log_handler(void *data, raptor_log_message *message)
+/*
+ * rdfdiff_matcher_candidate:
+ *
+ * Get candidate number @pos for pairing with "to" blank node @index.
+ * If the blank node's parent is paired, the candidates are the blank
+ * nodes sharing a statement with the parent's pair, else all "from"
+ * blank nodes with the same signature.
+ *
+ * Return value: "from" blanks index, -1 to skip or -2 after the last
+ */
+static int
+rdfdiff_matcher_candidate(rdfdiff_matcher* m, int index, int pos)
 {
-  rdfdiff_file* file = (rdfdiff_file*)data;
-  
-   switch(message->level) {
-    case RAPTOR_LOG_LEVEL_FATAL:
-    case RAPTOR_LOG_LEVEL_ERROR:
-      if(!ignore_errors) {
-        fprintf(stderr, "%s: Error - ", program);
-        raptor_locator_print(message->locator, stderr);
-        fprintf(stderr, " - %s\n", message->text);
-        
-        raptor_parser_parse_abort(file->parser);
-      }
-      
-      file->error_count++;
-      break;
-      
-    case RAPTOR_LOG_LEVEL_WARN:
-      if(!ignore_warnings) {
-        fprintf(stderr, "%s: Warning - ", program);
-        raptor_locator_print(message->locator, stderr);
-        fprintf(stderr, " - %s\n", message->text);
-      }
-      
-      file->warning_count++;
-      break;
-      
-    case RAPTOR_LOG_LEVEL_NONE:
-    case RAPTOR_LOG_LEVEL_TRACE:
-    case RAPTOR_LOG_LEVEL_DEBUG:
-    case RAPTOR_LOG_LEVEL_INFO:
-
-      fprintf(stderr, "%s: Unexpected %s message - ", program,
-              raptor_log_level_get_label(message->level));
-      raptor_locator_print(message->locator, stderr);
-      fprintf(stderr, " - %s\n", message->text);
-      break;
+  int candidate;
+
+  if(m->parent[index] >= 0 && m->map[m->parent[index]] >= 0) {
+    rdfdiff_blank *pair = &from_file->blanks[m->map[m->parent[index]]];
+
+    if(pos < pair->owners.count)
+      candidate = pair->owners.blanks[pos];
+    else if(pos - pair->owners.count < pair->statements.count)
+      candidate = pair->statements.blanks[pos - pair->owners.count];
+    else
+      return -2;
+
+    if(candidate < 0 ||
+       from_file->blanks[candidate].signature !=
+       to_file->blanks[index].signature)
+      return -1;
+  } else {
+    if(m->first[index] + pos >= m->last[index])
+      return -2;
+    candidate = m->from_order[m->first[index] + pos];
   }
-  
-}
 
+  return m->used[candidate] ? -1 : candidate;
+}
 
 
-static rdfdiff_blank *
-rdfdiff_find_blank(rdfdiff_blank *first, char *blank_id) 
+/*
+ * rdfdiff_blank_consistent:
+ * @m: matcher
+ * @to_index: "to" blank node
+ * @from_index: "from" blank node
+ * @all: if every statement must be checked
+ *
+ * Check that the statements of a "to" blank node are in the "from"
+ * file when it is paired with a "from" blank node.  If @all is 0,
+ * statements with another blank node that is not paired yet are
+ * skipped; they are checked when that one is paired.
+ *
+ * Return value: non-0 if consistent
+ */
+static int
+rdfdiff_blank_consistent(rdfdiff_matcher* m, int to_index, int from_index,
+                         int all)
 {
-  rdfdiff_blank *rv_blank = 0;
-  rdfdiff_blank *cur = first;
-
-  while(cur) {
+  rdfdiff_blank *blank = &to_file->blanks[to_index];
+  rdfdiff_blank *pair = &from_file->blanks[from_index];
+  int owners;
 
-    if(strcmp(cur->blank_id, blank_id) == 0) {
-      rv_blank = cur;
-      break;
-    }
+  if(blank->owners.count != pair->owners.count ||
+     blank->statements.count != pair->statements.count)
+    return 0;
 
-    cur = cur->next;
-    
-  }
-  
-  return rv_blank;
-  
-}
+  for(owners = 0; owners < 2; owners++) {
+    rdfdiff_statements *list = owners ? &blank->owners : &blank->statements;
+    int i;
+
+    for(i = 0; i < list->count; i++) {
+      raptor_statement *statement = list->statements[i];
+      raptor_statement mapped;
+      raptor_term *node = owners ? statement->subject : statement->object;
+      int node_index = list->blanks[i];
+
+      if(node_index == to_index)
+        node = pair->term;
+      else if(node_index >= 0) {
+        if(m->map[node_index] < 0) {
+          if(all)
+            return 0;
+          continue;
+        }
+        node = from_file->blanks[m->map[node_index]].term;
+      }
 
+      memset(&mapped, 0, sizeof(mapped));
+      mapped.subject = owners ? node : pair->term;
+      mapped.predicate = statement->predicate;
+      mapped.object = owners ? pair->term : node;
 
-static rdfdiff_blank *
-rdfdiff_lookup_blank(rdfdiff_file* file, char *blank_id) 
-{
-  rdfdiff_blank *rv_blank = rdfdiff_find_blank(file->first_blank, blank_id);
-  
-  if(!rv_blank) {
-    rv_blank = rdfdiff_new_blank(file->world, blank_id);
-    if(rv_blank) {
-
-      if(!file->first_blank) {
-        file->first_blank = rv_blank;
-        file->last_blank = rv_blank;
-      } else {
-        file->last_blank->next = rv_blank;
-        file->last_blank = rv_blank;
-      }
-    }    
+      if(!rdfdiff_blank_statement_find(from_file, &mapped))
+        return 0;
+    }
   }
 
-  return rv_blank;
-  
+  return 1;
 }
 
 
+/*
+ * rdfdiff_matcher_search:
+ *
+ * Search for a pairing of all the blank nodes, backtracking when a
+ * pairing turns out inconsistent, for at most RDFDIFF_MATCH_STEPS
+ * tries.
+ *
+ * Return value: non-0 if all the blank nodes were paired
+ */
 static int
-rdfdiff_add_blank_statement(rdfdiff_file* file,
-                            raptor_statement *statement)
+rdfdiff_matcher_search(rdfdiff_matcher* m)
 {
-  rdfdiff_blank *blank;
-  rdfdiff_link *dlink;
+  int count = to_file->blanks_count;
+  int steps = RDFDIFF_MATCH_STEPS;
+  int depth = 0;
+  int i;
 
-  blank = rdfdiff_lookup_blank(file, (char *)statement->subject->value.blank.string);
-  if(!blank)
-    goto failed;
+  if(count != from_file->blanks_count ||
+     to_file->blank_statements_count != from_file->blank_statements_count)
+    return 0;
 
-  dlink = RAPTOR_MALLOC(rdfdiff_link*, sizeof(*dlink));
-  if(!dlink)
-    goto failed;
-  
-  dlink->statement = raptor_statement_copy(statement);
-  if(!dlink->statement) {
-    RAPTOR_FREE(rdfdiff_link, dlink);
-    goto failed;
+  for(i = 0; i < count; i++) {
+    if(m->first[i] == m->last[i])
+      return 0;
   }
-  
-  dlink->next = NULL;
-  if(!blank->first) {
-    blank->first = dlink;
-    blank->last = dlink;
-  } else {
-    blank->last->next = dlink;
-    blank->last = dlink;
+
+  m->next[0] = 0;
+  while(depth >= 0 && depth < count) {
+    int index = m->order[depth];
+    int candidate = -1;
+
+    if(m->map[index] >= 0) {
+      m->used[m->map[index]] = 0;
+      m->map[index] = -1;
+    }
+
+    while(steps > 0) {
+      candidate = rdfdiff_matcher_candidate(m, index, m->next[depth]++);
+      if(candidate == -2)
+        break;
+      if(candidate < 0)
+        continue;
+      steps--;
+      if(rdfdiff_blank_consistent(m, index, candidate, 0))
+        break;
+      candidate = -1;
+    }
+
+    if(!steps && candidate < 0)
+      return 0;
+
+    if(candidate >= 0) {
+      m->map[index] = candidate;
+      m->used[candidate] = 1;
+      if(++depth < count)
+        m->next[depth] = 0;
+    } else
+      depth--;
   }
-  
-  return 0;
 
-failed:
-  fprintf(stderr, "%s: Internal Error\n", program);
-  return 1;
+  return depth == count;
 }
 
 
-static int
-rdfdiff_add_blank_statement_owner(rdfdiff_file* file,
-                                  raptor_statement *statement)
+/*
+ * rdfdiff_matcher_pair:
+ *
+ * Pair each "to" blank node with the first consistent candidate, then
+ * unpair those with statements that do not map.
+ */
+static void
+rdfdiff_matcher_pair(rdfdiff_matcher* m)
 {
-  rdfdiff_blank *blank;
-
-  blank = rdfdiff_lookup_blank(file,
-                               (char*)statement->object->value.blank.string);
-  if(!blank)
-    goto failed;
+  int count = to_file->blanks_count;
+  int changed;
+  int i;
+
+  for(i = 0; i < count; i++) {
+    if(m->map[i] >= 0) {
+      m->used[m->map[i]] = 0;
+      m->map[i] = -1;
+    }
+  }
 
-  if(blank->owner)
-    raptor_free_statement(blank->owner);
+  for(i = 0; i < count; i++) {
+    int index = m->order[i];
+    int pos;
 
-  blank->owner = raptor_statement_copy(statement);
-  if(!blank->owner)
-    goto failed;
+    for(pos = 0; ; pos++) {
+      int candidate = rdfdiff_matcher_candidate(m, index, pos);
 
-  return 0;
+      if(candidate == -2)
+        break;
+      if(candidate >= 0 &&
+         rdfdiff_blank_consistent(m, index, candidate, 0)) {
+        m->map[index] = candidate;
+        m->used[candidate] = 1;
+        break;
+      }
+    }
+  }
 
-failed:
-  fprintf(stderr, "%s: Internal Error\n", program);
-  return 1;
+  /* unpairing can leave neighbours with statements that do not map */
+  do {
+    changed = 0;
+    for(i = 0; i < count; i++) {
+      if(m->map[i] >= 0 && !rdfdiff_blank_consistent(m, i, m->map[i], 1)) {
+        m->used[m->map[i]] = 0;
+        m->map[i] = -1;
+        changed = 1;
+      }
+    }
+  } while(changed);
 }
 
 
+/*
+ * rdfdiff_match_blanks:
+ *
+ * Pair the "to" blank nodes with "from" blank nodes of the same
+ * signature such that every statement with blank nodes maps onto a
+ * "from" statement.
+ *
+ * The signatures only partition the blank nodes; blank nodes in a
+ * regular structure can share a signature without being
+ * interchangeable.  So a complete pairing is searched for.  If there
+ * is none, or it is not found in time, the files differ (or are too
+ * ambiguous to tell) and the blank nodes are paired where they can
+ * be, leaving the rest unmatched.
+ */
 static int
-rdfdiff_add_statement(rdfdiff_file* file, raptor_statement *statement) 
+rdfdiff_match_blanks(void)
 {
-  int rv = 0;
-  
-  rdfdiff_link *dlink = RAPTOR_MALLOC(rdfdiff_link*, sizeof(*dlink));
+  rdfdiff_matcher m;
+  int to_count = to_file->blanks_count;
+  int from_count = from_file->blanks_count;
+  int failed = 1;
+  int i;
 
-  if(dlink) {
+  if(!to_count || !from_count)
+    return 0;
 
-    dlink->statement = raptor_statement_copy(statement);
+  /* refine both files' signatures to the same number of rounds */
+  if(to_file->signature_rounds != from_file->signature_rounds) {
+    rdfdiff_file* file;
+    int rounds;
+    uint64_t *signatures;
 
-    if(dlink->statement) {
-      
-      dlink->next = NULL;
-
-      if(!file->first) {
-        file->first = dlink;
-        file->last = dlink;
-      } else {
-        file->last->next = dlink;
-        file->last = dlink;
-      }
-      
+    if(to_file->signature_rounds < from_file->signature_rounds) {
+      file = to_file;
+      rounds = from_file->signature_rounds;
     } else {
-      RAPTOR_FREE(rdfdiff_link, dlink);
-      rv = 1;
+      file = from_file;
+      rounds = to_file->signature_rounds;
     }
-    
-  } else {
-    rv = 1;
+
+    signatures = RAPTOR_MALLOC(uint64_t*,
+                               (size_t)file->blanks_count * sizeof(uint64_t));
+    if(!signatures)
+      return 1;
+    while(file->signature_rounds < rounds)
+      rdfdiff_refine_blanks(file, signatures);
+    RAPTOR_FREE(uint64_t*, signatures);
   }
 
-  if(rv != 0)
-    fprintf(stderr, "%s: Internal Error\n", program);
+  m.from_order = RAPTOR_MALLOC(int*, (size_t)from_count * sizeof(int));
+  m.first = RAPTOR_MALLOC(int*, (size_t)to_count * sizeof(int));
+  m.last = RAPTOR_MALLOC(int*, (size_t)to_count * sizeof(int));
+  m.order = RAPTOR_MALLOC(int*, (size_t)to_count * sizeof(int));
+  m.parent = RAPTOR_MALLOC(int*, (size_t)to_count * sizeof(int));
+  m.next = RAPTOR_MALLOC(int*, (size_t)to_count * sizeof(int));
+  m.map = RAPTOR_MALLOC(int*, (size_t)to_count * sizeof(int));
+  m.used = RAPTOR_CALLOC(char*, (size_t)from_count, 1);
+  if(!m.from_order || !m.first || !m.last || !m.order || !m.parent ||
+     !m.next || !m.map || !m.used)
+    goto tidy;
+
+  for(i = 0; i < from_count; i++)
+    m.from_order[i] = i;
+  qsort(m.from_order, (size_t)from_count, sizeof(int),
+        rdfdiff_compare_from_blanks);
+
+  for(i = 0; i < to_count; i++) {
+    uint64_t signature = to_file->blanks[i].signature;
+    int lo = 0;
+    int hi = from_count;
+
+    /* find the first "from" blank node with the signature */
+    while(lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+
+      if(from_file->blanks[m.from_order[mid]].signature < signature)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    m.first[i] = lo;
+    while(hi < from_count &&
+          from_file->blanks[m.from_order[hi]].signature == signature)
+      hi++;
+    m.last[i] = hi;
 
-  return rv;
+    m.map[i] = -1;
+  }
 
-}
+  rdfdiff_matcher_order(&m);
 
+  if(!rdfdiff_matcher_search(&m))
+    rdfdiff_matcher_pair(&m);
 
-static rdfdiff_link*
-rdfdiff_statement_find(rdfdiff_file* file, const raptor_statement *statement,
-                       rdfdiff_link** prev_p)
-{
-  rdfdiff_link* prev = NULL;
-  rdfdiff_link* cur = file->first;
-  
-  while(cur) {
-    if(rdfdiff_statement_equals(file->world, cur->statement, statement)) {
-      if(prev_p)
-        *prev_p=prev;
-      return cur;
+  for(i = 0; i < to_count; i++) {
+    if(m.map[i] >= 0) {
+      to_file->blanks[i].matched = 1;
+      from_file->blanks[m.map[i]].matched = 1;
     }
-    prev = cur;
-    cur = cur->next;
   }
 
-  return NULL;
+  failed = 0;
+
+  tidy:
+  if(m.from_order)
+    RAPTOR_FREE(int*, m.from_order);
+  if(m.first)
+    RAPTOR_FREE(int*, m.first);
+  if(m.last)
+    RAPTOR_FREE(int*, m.last);
+  if(m.order)
+    RAPTOR_FREE(int*, m.order);
+  if(m.parent)
+    RAPTOR_FREE(int*, m.parent);
+  if(m.next)
+    RAPTOR_FREE(int*, m.next);
+  if(m.map)
+    RAPTOR_FREE(int*, m.map);
+  if(m.used)
+    RAPTOR_FREE(char*, m.used);
+
+  return failed;
 }
 
 
+/*
+ * rdfdiff_compare:
+ *
+ * Match the statements of the two files using @threads threads.
+ * Ground statements are compared one shard at a time and the blank
+ * nodes of each file are signed at the same time.
+ */
 static int
-rdfdiff_statement_exists(rdfdiff_file* file, const raptor_statement *statement)
+rdfdiff_compare(int threads)
 {
-  rdfdiff_link* node;
-  rdfdiff_link* prev = NULL;
-  node = rdfdiff_statement_find(file, statement, &prev);
-  return (node != NULL);
-}
+  rdfdiff_tasks tasks;
+#ifdef HAVE_PTHREAD_H
+  pthread_t *thread_ids = NULL;
+  int threads_started = 0;
+#endif
+  int failed = 0;
+  int i;
+
+  tasks.count = shards_count + 2;
+  tasks.next = 0;
+  tasks.tasks = RAPTOR_CALLOC(rdfdiff_task*, (size_t)tasks.count,
+                              sizeof(rdfdiff_task));
+  if(!tasks.tasks)
+    return 1;
 
+  /* the blank node tasks are run first as they take longest */
+  tasks.tasks[0].file = from_file;
+  tasks.tasks[1].file = to_file;
+  for(i = 2; i < tasks.count; i++)
+    tasks.tasks[i].shard = i - 2;
+
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_init(&tasks.mutex, NULL);
+
+  if(threads > 1)
+    thread_ids = RAPTOR_CALLOC(pthread_t*, (size_t)(threads - 1),
+                               sizeof(pthread_t));
+  if(thread_ids) {
+    for(i = 0; i < threads - 1; i++) {
+      if(pthread_create(&thread_ids[threads_started], NULL, rdfdiff_worker,
+                        &tasks))
+        break;
+      threads_started++;
+    }
+  }
+#endif
 
-/*
- * rdfdiff_collect_statements - Called when parsing "from" file to build a
- * list of statements for comparison with those in the "to" file.
- */
-static void
-rdfdiff_collect_statements(void *user_data, raptor_statement *statement)
-{
-  int rv = 0;
-  rdfdiff_file* file = (rdfdiff_file*)user_data;
+  /* this thread works too */
+  rdfdiff_worker(&tasks);
 
-  if(rdfdiff_statement_exists(file, statement))
-    return;
-  
-  file->statement_count++;
+#ifdef HAVE_PTHREAD_H
+  for(i = 0; i < threads_started; i++)
+    pthread_join(thread_ids[i], NULL);
+  if(thread_ids)
+    RAPTOR_FREE(pthread_t*, thread_ids);
 
-  if(statement->subject->type == RAPTOR_TERM_TYPE_BLANK ||
-     statement->object->type  == RAPTOR_TERM_TYPE_BLANK) {
+  pthread_mutex_destroy(&tasks.mutex);
+#endif
 
-    if(statement->subject->type == RAPTOR_TERM_TYPE_BLANK)
-      rv = rdfdiff_add_blank_statement(file, statement);
+  for(i = 0; i < tasks.count; i++)
+    failed |= tasks.tasks[i].failed;
 
-    if(rv == 0 && statement->object->type == RAPTOR_TERM_TYPE_BLANK)
-      rv = rdfdiff_add_blank_statement_owner(file, statement);
+  RAPTOR_FREE(rdfdiff_task*, tasks.tasks);
 
-  } else {
-    rv = rdfdiff_add_statement(file, statement);
-  }
+  if(!failed)
+    failed = rdfdiff_match_blanks();
 
-  if(rv != 0) {
-    raptor_parser_parse_abort(file->parser);
-  }
-  
+  return failed;
 }
 
 
@@ -732,8 +1608,9 @@ main(int argc, char *argv[])
   int help = 0;
   char *p;
   int rv = 0;
-  rdfdiff_blank *b1;
-  rdfdiff_link *cur;
+  int threads = 0;
+  size_t i;
+  int j;
   
   program = argv[0];
   if((p = strrchr(program, '/')))
@@ -781,6 +1658,18 @@ main(int argc, char *argv[])
           from_syntax = optarg;
         break;
 
+      case 'j':
+        if(optarg) {
+          threads = atoi(optarg);
+          if(threads < 1) {
+            fprintf(stderr,
+                    "%s: invalid argument `%s' for `" HELP_ARG(j, threads) "'\n",
+                    program, optarg);
+            usage = 1;
+          }
+        }
+        break;
+
       case 't':
         if(optarg)
           to_syntax = optarg;
@@ -821,11 +1710,21 @@ main(int argc, char *argv[])
     puts(HELP_TEXT("b", "brief                     ", "Report only whether files differ"));
     puts(HELP_TEXT("u BASE-URI", "base-uri BASE-URI  ", "Set the base URI for the files"));
     puts(HELP_TEXT("f FORMAT",   "from-format FORMAT ", "Format of <from URI> (default is rdfxml)"));
+    puts(HELP_TEXT("j NUMBER",   "threads NUMBER     ", "Compare with NUMBER threads (default is all CPUs)"));
     puts(HELP_TEXT("t FORMAT",   "to-format FORMAT   ", "Format of <to URI> (default is rdfxml)"));
     rv = 1;
     goto exit;
   }
 
+  if(!threads) {
+#ifdef _SC_NPROCESSORS_ONLN
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if(threads < 1)
+      threads = 1;
+  }
+  shards_count = threads * RDFDIFF_SHARDS_PER_THREAD;
+
   from_string = (unsigned char *)argv[optind++];
   to_string = (unsigned char *)argv[optind];
   
@@ -879,6 +1778,13 @@ main(int argc, char *argv[])
     goto exit;
   }
 
+  if(threads > 1) {
+    raptor_parser_set_option(from_file->parser, RAPTOR_OPTION_PARALLEL_THREADS,
+                             NULL, threads);
+    raptor_parser_set_option(to_file->parser, RAPTOR_OPTION_PARALLEL_THREADS,
+                             NULL, threads);
+  }
+
   /* parse the files */
   raptor_parser_set_statement_handler(from_file->parser, from_file,
                                rdfdiff_collect_statements);
@@ -902,131 +1808,87 @@ main(int argc, char *argv[])
   }
 
 
-  /* Compare triples with no blank nodes */
-  cur = to_file->first;
-  while(cur) {
-    rdfdiff_link* node;
-    rdfdiff_link* prev;
-    node = rdfdiff_statement_find(from_file, cur->statement, &prev);
-    if(node) {
-      /* exists in from file - remove it from the list */
-      if(from_file->first == node) {
-        from_file->first = node->next;
-      } else {
-        prev->next = node->next;
-      }
-      raptor_free_statement(node->statement);
-      RAPTOR_FREE(rdfdiff_link, node);
-    } else {
-      if(!brief) {
-        if(emit_from_header) {
-          fprintf(stderr, "Statements in %s but not in %s\n",
-                  to_file->name, from_file->name);
-          emit_from_header = 0;
-        }
-        
-        fprintf(stderr, "<    ");
-        raptor_statement_print_as_ntriples(cur->statement, stderr);
-        fprintf(stderr, "\n");
-      }
-      
-      to_file->difference_count++;
-    }
-    cur = cur->next;
+  if(from_file->failed || to_file->failed ||
+     rdfdiff_compare(threads)) {
+    fprintf(stderr, "%s: Internal Error\n", program);
+    rv = 2;
+    goto exit;
   }
 
-  
-  /* Now compare the blank nodes */
-  b1 = to_file->first_blank;
-  while(b1) {
-
-    rdfdiff_blank *b2 = from_file->first_blank;
-
-    while(b2) {
+  /* Report triples with no blank nodes */
+  for(i = 0; i < to_file->statements_count; i++) {
+    if(to_file->statements[i].state != RDFDIFF_STATE_UNMATCHED)
+      continue;
 
-      if(!b2->matched && rdfdiff_blank_equals(b1, b2, to_file, from_file)) {
-        b1->matched = 1;
-        b2->matched = 1;
-        break;
+    if(!brief) {
+      if(emit_from_header) {
+        fprintf(stderr, "Statements in %s but not in %s\n",
+                to_file->name, from_file->name);
+        emit_from_header = 0;
       }
-      
-      b2 = b2->next;
-      
+
+      fprintf(stderr, "<    ");
+      raptor_statement_print_as_ntriples(to_file->statements[i].statement,
+                                         stderr);
+      fprintf(stderr, "\n");
     }
 
-    if(b2 == 0) {
-      if(!brief) {        
-#if 0
-        fprintf(stderr, "<    ");
-        raptor_statement_print_as_ntriples(b1->owner, stderr);
-        fprintf(stderr, "\n");
-#else
-        if(emit_from_header) {
-          fprintf(stderr, "Statements in %s but not in %s\n",  to_file->name, from_file->name);
-          emit_from_header = 0;
-        }
+    to_file->difference_count++;
+  }
+
+  /* Now report the blank nodes */
+  for(j = 0; j < to_file->blanks_count; j++) {
+    if(to_file->blanks[j].matched)
+      continue;
 
-        fprintf(stderr, "<    anonymous node %s\n", b1->blank_id);
-#endif        
+    if(!brief) {
+      if(emit_from_header) {
+        fprintf(stderr, "Statements in %s but not in %s\n",  to_file->name, from_file->name);
+        emit_from_header = 0;
       }
-      
-      to_file->difference_count++;
+
+      fprintf(stderr, "<    anonymous node %s\n",
+              (const char*)to_file->blanks[j].term->value.blank.string);
     }
-    
-    b1 = b1->next;
 
+    to_file->difference_count++;
   }
-  
-  if(from_file->first) {
-    /* The entrys left in from_file have not been found in to_file. */
-    if(!brief) {
+
+  /* The statements left in from_file have not been found in to_file. */
+  if(!brief) {
+    for(i = 0; i < from_file->statements_count; i++) {
+      if(from_file->statements[i].state != RDFDIFF_STATE_UNMATCHED)
+        continue;
 
       if(emit_to_header) {
         fprintf(stderr, "Statements in %s but not in %s\n",  from_file->name,
                 to_file->name);
         emit_to_header = 0;
       }
-      
-      cur = from_file->first;
-      while(cur) {
-        if(!brief) {
-          fprintf(stderr, ">    ");
-          raptor_statement_print_as_ntriples(cur->statement, stderr);
-          fprintf(stderr, "\n");
-        }
-      
-        cur = cur->next;
-        from_file->difference_count++;
-      }
-    }
 
+      fprintf(stderr, ">    ");
+      raptor_statement_print_as_ntriples(from_file->statements[i].statement,
+                                         stderr);
+      fprintf(stderr, "\n");
+
+      from_file->difference_count++;
+    }
   }
 
-  if(from_file->first_blank) {
-    rdfdiff_blank *blank = from_file->first_blank;
-    while(blank) {
+  for(j = 0; j < from_file->blanks_count; j++) {
+    if(from_file->blanks[j].matched)
+      continue;
 
-      if(!blank->matched) {
-        if(!brief) {
-#if 0          
-          fprintf(stderr, ">    ");
-          raptor_statement_print_as_ntriples(blank->owner, stderr);
-          fprintf(stderr, "\n");
-#else
-          if(emit_to_header) {
-            fprintf(stderr, "Statements in %s but not in %s\n",  from_file->name, to_file->name);
-            emit_to_header = 0;
-          }
-          fprintf(stderr, ">    anonymous node %s\n", blank->blank_id);
-#endif          
-        }
-        from_file->difference_count++;
+    if(!brief) {
+      if(emit_to_header) {
+        fprintf(stderr, "Statements in %s but not in %s\n",  from_file->name, to_file->name);
+        emit_to_header = 0;
       }
-    
-      blank = blank->next;
-      
+      fprintf(stderr, ">    anonymous node %s\n",
+              (const char*)from_file->blanks[j].term->value.blank.string);
     }
 
+    from_file->difference_count++;
   }
   
   if(!(from_file->difference_count == 0 &&